@@ -50,6 +50,7 @@ MEMGRAPH_BUILD_DEPS=(
     #
     PyYAML # Package name here does not correspond to the yum package!
     libcurl-devel # mg-requests
+    lz4-devel libzstd-devel # compression of the history store
     sbcl # for custom Lisp C++ preprocessing
     rpm-build rpmlint # for RPM package building
     doxygen graphviz # source documentation generators
@@ -49,6 +49,7 @@ MEMGRAPH_BUILD_DEPS=(
     #
     PyYAML # Package name here does not correspond to the yum package!
     libcurl-devel # mg-requests
+    lz4-devel libzstd-devel # compression of the history store
     rpm-build rpmlint # for RPM package building
     doxygen graphviz # source documentation generators
     which nodejs golang zip unzip java-11-openjdk-devel # for driver tests
@@ -48,6 +48,7 @@ MEMGRAPH_BUILD_DEPS=(
     python3 virtualenv python3-virtualenv python3-pip # for qa, macro_benchmark and stress tests
     python3-yaml # for the configuration generator
     libcurl4-openssl-dev # mg-requests
+    liblz4-dev libzstd-dev # compression of the history store
     sbcl # for custom Lisp C++ preprocessing
     doxygen graphviz # source documentation generators
     mono-runtime mono-mcs zip unzip default-jdk-headless # for driver tests
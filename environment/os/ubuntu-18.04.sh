@@ -48,6 +48,7 @@ MEMGRAPH_BUILD_DEPS=(
     python3 virtualenv python3-virtualenv python3-pip # qa, macro bench and stress tests
     python3-yaml # the configuration generator
     libcurl4-openssl-dev # mg-requests
+    liblz4-dev libzstd-dev # compression of the history store
     sbcl # custom Lisp C++ preprocessing
     doxygen graphviz # source documentation generators
     mono-runtime mono-mcs nodejs zip unzip default-jdk-headless # driver tests
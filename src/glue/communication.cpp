@@ -84,9 +84,8 @@ storage::Result<communication::bolt::Vertex> ToBoltHistoryVertex(const storage::
   }
 
   // std::map<std::string, Value> properties;
-  auto maybe_properties = vertex.properties;
   std::map<std::string, Value> properties;
-  for (const auto &prop : maybe_properties) {
+  for (const auto &prop : vertex.Properties()) {
     properties[db.PropertyToName(prop.first)] = ToBoltValue(prop.second);
   }
   return communication::bolt::Vertex{id, labels, properties};
@@ -97,9 +96,8 @@ storage::Result<communication::bolt::Edge> ToBoltHistoryEdge(const storage::Hist
   auto id = communication::bolt::Id::FromUint(edge.gid.AsUint());
   auto from = communication::bolt::Id::FromUint(edge.from_gid.AsUint());
   auto to = communication::bolt::Id::FromUint(edge.to_gid.AsUint());
-  auto maybe_properties = edge.properties;
   std::map<std::string, Value> properties;
-  for (const auto &prop : maybe_properties) {
+  for (const auto &prop : edge.Properties()) {
     properties[db.PropertyToName(prop.first)] = ToBoltValue(prop.second);
   }
   auto type = db.EdgeTypeToName(edge.type);
@@ -9,34 +9,197 @@
 // by the Apache License, Version 2.0, included in the file
 // licenses/APL.txt.
 
+#include <rocksdb/cache.h>
+#include <rocksdb/compaction_filter.h>
 #include <rocksdb/db.h>
+#include <rocksdb/filter_policy.h>
 #include <rocksdb/options.h>
+#include <rocksdb/slice_transform.h>
+#include <rocksdb/statistics.h>
+#include <rocksdb/table.h>
 
 #include "kvstore/kvstore.hpp"
 #include "utils/file.hpp"
+#include "utils/logging.hpp"
 
+#include <algorithm>
 #include <iostream>
+#include <optional>
 
 namespace kvstore {
 
+// Shared with the segment files.
+rocksdb::CompressionType ToRocksDb(Compression compression) {
+  switch (compression) {
+    case Compression::NONE:
+      return rocksdb::kNoCompression;
+    case Compression::SNAPPY:
+      return rocksdb::kSnappyCompression;
+    case Compression::ZLIB:
+      return rocksdb::kZlibCompression;
+    case Compression::LZ4:
+      return rocksdb::kLZ4Compression;
+    case Compression::ZSTD:
+      return rocksdb::kZSTD;
+  }
+  return rocksdb::kNoCompression;
+}
+
+namespace {
+
+// Keys are moved between column families in batches of this size.
+constexpr size_t kMoveBatchSize = 10000;
+
+// Iterators over the whole key space, the prefix extractor would otherwise
+// allow the iterator to skip keys outside of the prefix group of the seek key.
+rocksdb::ReadOptions TotalOrderReadOptions() {
+  rocksdb::ReadOptions options;
+  options.total_order_seek = true;
+  return options;
+}
+
+// Drops the entries selected by `Options::compaction_filter`.
+class KeyCompactionFilter : public rocksdb::CompactionFilter {
+ public:
+  explicit KeyCompactionFilter(std::function<bool(std::string_view)> filter) : filter_(std::move(filter)) {}
+
+  bool Filter(int /*level*/, const rocksdb::Slice &key, const rocksdb::Slice & /*existing_value*/,
+              std::string * /*new_value*/, bool * /*value_changed*/) const override {
+    return filter_({key.data(), key.size()});
+  }
+
+  const char *Name() const override { return "KeyCompactionFilter"; }
+
+ private:
+  std::function<bool(std::string_view)> filter_;
+};
+
+}  // namespace
+
 struct KVStore::impl {
   std::filesystem::path storage;
+  // Outlives the database, whose compactions use it.
+  std::unique_ptr<rocksdb::CompactionFilter> compaction_filter;
   std::unique_ptr<rocksdb::DB> db;
   rocksdb::Options options;
+  uint32_t prefix_length{0};
+  std::shared_ptr<rocksdb::Statistics> statistics;
+  // Handles of all opened column families, the default one first.
+  std::vector<rocksdb::ColumnFamilyHandle *> handles;
+  // Key prefixes of the configured column families and their handles.
+  std::vector<std::pair<std::string, rocksdb::ColumnFamilyHandle *>> families;
+
+  ~impl() {
+    if (!db) return;
+    for (auto *handle : handles) db->DestroyColumnFamilyHandle(handle);
+  }
+
+  rocksdb::ColumnFamilyHandle *Family(const std::string &key) const {
+    for (const auto &[prefix, handle] : families) {
+      if (key.compare(0, prefix.size(), prefix) == 0) return handle;
+    }
+    return db->DefaultColumnFamily();
+  }
+
+  // Moves the keys which start with `prefix` from one family to the other,
+  // every batch is written atomically to both families.
+  void MoveKeys(rocksdb::ColumnFamilyHandle *from, rocksdb::ColumnFamilyHandle *to, const std::string &prefix) {
+    rocksdb::WriteBatch batch;
+    auto flush = [&] {
+      if (batch.Count() == 0) return;
+      auto s = db->Write(rocksdb::WriteOptions(), &batch);
+      if (!s.ok())
+        throw KVStoreError("Couldn't move keys between the column families of the key-value store " +
+                           storage.string() + " -- " + s.ToString());
+      batch.Clear();
+    };
+    std::unique_ptr<rocksdb::Iterator> iter(db->NewIterator(TotalOrderReadOptions(), from));
+    for (iter->Seek(prefix); iter->Valid() && iter->key().starts_with(prefix); iter->Next()) {
+      batch.Put(to, iter->key(), iter->value());
+      batch.Delete(from, iter->key());
+      if (batch.Count() >= 2 * kMoveBatchSize) flush();
+    }
+    flush();
+  }
 };
 
-KVStore::KVStore(std::filesystem::path storage) : pimpl_(std::make_unique<impl>()) {
+KVStore::KVStore(std::filesystem::path storage) : KVStore(std::move(storage), Options{}) {}
+
+KVStore::KVStore(std::filesystem::path storage, const Options &options) : pimpl_(std::make_unique<impl>()) {
   pimpl_->storage = storage;
+  pimpl_->prefix_length = options.prefix_length;
   if (!utils::EnsureDir(pimpl_->storage))
     throw KVStoreError("Folder for the key-value store " + pimpl_->storage.string() + " couldn't be initialized!");
-  pimpl_->options.create_if_missing = true;
-  pimpl_->options.write_buffer_size=640 << 20;// hjm begin
+  auto &db_options = pimpl_->options;
+  db_options.create_if_missing = true;
+  db_options.create_missing_column_families = true;
+  db_options.write_buffer_size = options.write_buffer_size;
+  // Bounds the memtables of all families together by the size a single
+  // keyspace had.
+  if (!options.column_families.empty()) db_options.db_write_buffer_size = options.write_buffer_size;
+  if (options.statistics) {
+    pimpl_->statistics = rocksdb::CreateDBStatistics();
+    db_options.statistics = pimpl_->statistics;
+  }
+  rocksdb::BlockBasedTableOptions table_options;
+  if (options.block_cache_bytes != 0) table_options.block_cache = rocksdb::NewLRUCache(options.block_cache_bytes);
+  if (options.bloom_bits_per_key != 0) {
+    table_options.filter_policy.reset(rocksdb::NewBloomFilterPolicy(options.bloom_bits_per_key, false));
+    table_options.whole_key_filtering = true;
+  }
+  // All families share the table factory and with it the block cache.
+  db_options.table_factory.reset(rocksdb::NewBlockBasedTableFactory(table_options));
+  if (options.prefix_length != 0) {
+    db_options.prefix_extractor.reset(rocksdb::NewFixedPrefixTransform(options.prefix_length));
+  }
+  if (options.compression) db_options.compression = ToRocksDb(*options.compression);
+  if (options.bottommost_compression) db_options.bottommost_compression = ToRocksDb(*options.bottommost_compression);
+  if (options.compaction_filter) {
+    pimpl_->compaction_filter = std::make_unique<KeyCompactionFilter>(options.compaction_filter);
+    db_options.compaction_filter = pimpl_->compaction_filter.get();
+  }
+
+  std::vector<std::string> names{rocksdb::kDefaultColumnFamilyName};
+  std::vector<std::string> prefixes{""};
+  for (const auto &family : options.column_families) {
+    if (family.prefix.empty() || std::find(names.begin(), names.end(), family.name) != names.end()) continue;
+    names.push_back(family.name);
+    prefixes.push_back(family.prefix);
+  }
+  auto configured = names.size();
+  // Families of an earlier run which aren't configured anymore are opened to
+  // move their keys back to the default family.
+  std::vector<std::string> existing;
+  if (rocksdb::DB::ListColumnFamilies(db_options, storage.string(), &existing).ok()) {
+    for (const auto &name : existing) {
+      if (std::find(names.begin(), names.end(), name) == names.end()) names.push_back(name);
+    }
+  }
+  std::vector<rocksdb::ColumnFamilyDescriptor> descriptors;
+  for (const auto &name : names) descriptors.emplace_back(name, rocksdb::ColumnFamilyOptions(db_options));
   rocksdb::DB *db = nullptr;
-  auto s = rocksdb::DB::Open(pimpl_->options, storage.c_str(), &db);
+  auto s = rocksdb::DB::Open(db_options, storage.string(), descriptors, &pimpl_->handles, &db);
   if (!s.ok())
     throw KVStoreError("RocksDB couldn't be initialized inside " + storage.string() + " -- " +
                        std::string(s.ToString()));
   pimpl_->db.reset(db);
+
+  auto *default_family = pimpl_->handles[0];
+  while (pimpl_->handles.size() > configured) {
+    auto *handle = pimpl_->handles.back();
+    pimpl_->MoveKeys(handle, default_family, "");
+    s = db->DropColumnFamily(handle);
+    if (!s.ok())
+      throw KVStoreError("Couldn't drop the column family " + handle->GetName() + " of the key-value store " +
+                         storage.string() + " -- " + s.ToString());
+    db->DestroyColumnFamilyHandle(handle);
+    pimpl_->handles.pop_back();
+  }
+  for (size_t i = 1; i < configured; ++i) {
+    pimpl_->families.emplace_back(prefixes[i], pimpl_->handles[i]);
+    // Keys written before the family existed, a no-op after the first run.
+    pimpl_->MoveKeys(default_family, pimpl_->handles[i], prefixes[i]);
+  }
 }
 
 KVStore::~KVStore() {}
@@ -49,14 +212,25 @@ KVStore &KVStore::operator=(KVStore &&other) {
 }
 
 bool KVStore::Put(const std::string &key, const std::string &value) {
-  auto s = pimpl_->db->Put(rocksdb::WriteOptions(), key, value);
+  auto s = pimpl_->db->Put(rocksdb::WriteOptions(), pimpl_->Family(key), key, value);
   return s.ok();
 }
 
 bool KVStore::PutMultiple(const std::map<std::string, std::string> &items) {
   rocksdb::WriteBatch batch;
   for (const auto &item : items) {
-    batch.Put(item.first, item.second);
+    batch.Put(pimpl_->Family(item.first), item.first, item.second);
+  }
+  auto s = pimpl_->db->Write(rocksdb::WriteOptions(), &batch);
+  return s.ok();
+}
+
+bool KVStore::PutMultiple(const std::vector<std::map<std::string, std::string>> &partitions) {
+  rocksdb::WriteBatch batch;
+  for (const auto &items : partitions) {
+    for (const auto &item : items) {
+      batch.Put(pimpl_->Family(item.first), item.first, item.second);
+    }
   }
   auto s = pimpl_->db->Write(rocksdb::WriteOptions(), &batch);
   return s.ok();
@@ -64,30 +238,31 @@ bool KVStore::PutMultiple(const std::map<std::string, std::string> &items) {
 
 std::optional<std::string> KVStore::Get(const std::string &key) const noexcept {
   std::string value;
-  auto s = pimpl_->db->Get(rocksdb::ReadOptions(), key, &value);
+  auto s = pimpl_->db->Get(rocksdb::ReadOptions(), pimpl_->Family(key), key, &value);
   if (!s.ok()) return std::nullopt;
   return value;
 }
 
 bool KVStore::Delete(const std::string &key) {
-  auto s = pimpl_->db->Delete(rocksdb::WriteOptions(), key);
+  auto s = pimpl_->db->Delete(rocksdb::WriteOptions(), pimpl_->Family(key), key);
   return s.ok();
 }
 
 bool KVStore::DeleteMultiple(const std::vector<std::string> &keys) {
   rocksdb::WriteBatch batch;
   for (const auto &key : keys) {
-    batch.Delete(key);
+    batch.Delete(pimpl_->Family(key), key);
   }
   auto s = pimpl_->db->Write(rocksdb::WriteOptions(), &batch);
   return s.ok();
 }
 
 bool KVStore::DeletePrefix(const std::string &prefix) {
+  auto *family = pimpl_->Family(prefix);
   std::unique_ptr<rocksdb::Iterator> iter =
-      std::unique_ptr<rocksdb::Iterator>(pimpl_->db->NewIterator(rocksdb::ReadOptions()));
+      std::unique_ptr<rocksdb::Iterator>(pimpl_->db->NewIterator(TotalOrderReadOptions(), family));
   for (iter->Seek(prefix); iter->Valid() && iter->key().starts_with(prefix); iter->Next()) {
-    if (!pimpl_->db->Delete(rocksdb::WriteOptions(), iter->key()).ok()) return false;
+    if (!pimpl_->db->Delete(rocksdb::WriteOptions(), family, iter->key()).ok()) return false;
   }
   return true;
 }
@@ -96,10 +271,26 @@ bool KVStore::PutAndDeleteMultiple(const std::map<std::string, std::string> &ite
                                    const std::vector<std::string> &keys) {
   rocksdb::WriteBatch batch;
   for (const auto &item : items) {
-    batch.Put(item.first, item.second);
+    batch.Put(pimpl_->Family(item.first), item.first, item.second);
   }
   for (const auto &key : keys) {
-    batch.Delete(key);
+    batch.Delete(pimpl_->Family(key), key);
+  }
+  auto s = pimpl_->db->Write(rocksdb::WriteOptions(), &batch);
+  return s.ok();
+}
+
+bool KVStore::PutAndDeleteRanges(const std::map<std::string, std::string> &items, const std::vector<std::string> &keys,
+                                 const std::vector<std::pair<std::string, std::string>> &ranges) {
+  rocksdb::WriteBatch batch;
+  for (const auto &item : items) {
+    batch.Put(pimpl_->Family(item.first), item.first, item.second);
+  }
+  for (const auto &key : keys) {
+    batch.Delete(pimpl_->Family(key), key);
+  }
+  for (const auto &[begin, end] : ranges) {
+    batch.DeleteRange(pimpl_->Family(begin), begin, end);
   }
   auto s = pimpl_->db->Write(rocksdb::WriteOptions(), &batch);
   return s.ok();
@@ -111,6 +302,10 @@ struct KVStore::iterator::impl {
   const KVStore *kvstore;
   std::string prefix;
   std::unique_ptr<rocksdb::Iterator> it;
+  // Length of the prefix groups of an iterator created by `group_begin`, and
+  // its RocksDB iterator once it ran past its group, kept for `Seek`.
+  std::optional<size_t> group;
+  std::unique_ptr<rocksdb::Iterator> exhausted;
   std::pair<std::string, std::string> disk_prop;
 };
 
@@ -118,7 +313,8 @@ KVStore::iterator::iterator(const KVStore *kvstore, const std::string &prefix, b
     : pimpl_(std::make_unique<impl>()) {
   pimpl_->kvstore = kvstore;
   pimpl_->prefix = prefix;
-  pimpl_->it = std::unique_ptr<rocksdb::Iterator>(pimpl_->kvstore->pimpl_->db->NewIterator(rocksdb::ReadOptions()));
+  pimpl_->it = std::unique_ptr<rocksdb::Iterator>(
+      pimpl_->kvstore->pimpl_->db->NewIterator(TotalOrderReadOptions(), pimpl_->kvstore->pimpl_->Family(prefix)));
   pimpl_->it->Seek(pimpl_->prefix);
   if (!pimpl_->it->Valid() || !pimpl_->it->key().starts_with(pimpl_->prefix) || at_end) pimpl_->it = nullptr;
 }
@@ -129,7 +325,8 @@ KVStore::iterator::iterator(const std::string &prefix,const KVStore *kvstore,boo
     : pimpl_(std::make_unique<impl>()) {
   pimpl_->kvstore = kvstore;
   pimpl_->prefix = prefix.substr(0,3);;
-  pimpl_->it = std::unique_ptr<rocksdb::Iterator>(pimpl_->kvstore->pimpl_->db->NewIterator(rocksdb::ReadOptions()));
+  pimpl_->it = std::unique_ptr<rocksdb::Iterator>(
+      pimpl_->kvstore->pimpl_->db->NewIterator(TotalOrderReadOptions(), pimpl_->kvstore->pimpl_->Family(prefix)));
   pimpl_->it->Seek(prefix);
   if (!pimpl_->it->Valid() || !pimpl_->it->key().starts_with(pimpl_->prefix)|| at_end) pimpl_->it = nullptr;
 }
@@ -138,7 +335,8 @@ KVStore::iterator::iterator(const KVStore *kvstore, bool at_begin,const std::str
     : pimpl_(std::make_unique<impl>()) {
   pimpl_->kvstore = kvstore;
   pimpl_->prefix = prefix;
-  pimpl_->it = std::unique_ptr<rocksdb::Iterator>(pimpl_->kvstore->pimpl_->db->NewIterator(rocksdb::ReadOptions()));
+  pimpl_->it = std::unique_ptr<rocksdb::Iterator>(
+      pimpl_->kvstore->pimpl_->db->NewIterator(TotalOrderReadOptions(), pimpl_->kvstore->pimpl_->Family(prefix)));
   pimpl_->it->SeekToLast();//SeekForPrev(pimpl_->prefix);//
   if (!pimpl_->it->Valid()|| at_begin) {//!pimpl_->it->key().starts_with(pimpl_->prefix)
     // std::cout<<std::to_string(at_begin)<<" not fond\n";
@@ -149,6 +347,31 @@ KVStore::iterator::iterator(const KVStore *kvstore, bool at_begin,const std::str
 }
 //hjm end
 
+KVStore::iterator::iterator(const KVStore *kvstore, const std::string &key, bool at_end, GroupTag)
+    : pimpl_(std::make_unique<impl>()) {
+  pimpl_->kvstore = kvstore;
+  auto group = kvstore->pimpl_->prefix_length;
+  if (key.size() < group) group = 0;
+  pimpl_->prefix = key.substr(0, group);
+  pimpl_->group = group;
+  if (at_end) return;
+  rocksdb::ReadOptions options;
+  // Pins the blocks read by the iterator for its lifetime, so walking a
+  // version chain doesn't pin and release a block on every step.
+  options.pin_data = true;
+  if (group != 0) {
+    options.prefix_same_as_start = true;
+  } else {
+    options.total_order_seek = true;
+  }
+  pimpl_->it =
+      std::unique_ptr<rocksdb::Iterator>(kvstore->pimpl_->db->NewIterator(options, kvstore->pimpl_->Family(key)));
+  pimpl_->it->Seek(key);
+  if (!pimpl_->it->Valid() || !pimpl_->it->key().starts_with(pimpl_->prefix)) {
+    pimpl_->exhausted = std::move(pimpl_->it);
+  }
+}
+
 KVStore::iterator::iterator(KVStore::iterator &&other) { pimpl_ = std::move(other.pimpl_); }
 
 KVStore::iterator::~iterator() {}
@@ -160,7 +383,20 @@ KVStore::iterator &KVStore::iterator::operator=(KVStore::iterator &&other) {
 
 KVStore::iterator &KVStore::iterator::operator++() {
   pimpl_->it->Next();
-  if (!pimpl_->it->Valid() || !pimpl_->it->key().starts_with(pimpl_->prefix)) pimpl_->it = nullptr;
+  if (!pimpl_->it->Valid() || !pimpl_->it->key().starts_with(pimpl_->prefix)) {
+    pimpl_->exhausted = std::move(pimpl_->it);
+  }
+  return *this;
+}
+
+KVStore::iterator &KVStore::iterator::Seek(const std::string &key) {
+  if (!pimpl_->it) pimpl_->it = std::move(pimpl_->exhausted);
+  MG_ASSERT(pimpl_->group && pimpl_->it, "Only iterators returned by group_begin can seek!");
+  pimpl_->prefix = key.substr(0, std::min(*pimpl_->group, key.size()));
+  pimpl_->it->Seek(key);
+  if (!pimpl_->it->Valid() || !pimpl_->it->key().starts_with(pimpl_->prefix)) {
+    pimpl_->exhausted = std::move(pimpl_->it);
+  }
   return *this;
 }
 
@@ -192,6 +428,16 @@ KVStore::iterator::reference KVStore::iterator::operator*() {
 
 KVStore::iterator::pointer KVStore::iterator::operator->() { return &**this; }
 
+std::string_view KVStore::iterator::key() const {
+  auto key = pimpl_->it->key();
+  return {key.data(), key.size()};
+}
+
+std::string_view KVStore::iterator::value() const {
+  auto value = pimpl_->it->value();
+  return {value.data(), value.size()};
+}
+
 void KVStore::iterator::SetInvalid() { pimpl_->it = nullptr; }
 
 bool KVStore::iterator::IsValid() { return pimpl_->it != nullptr; }
@@ -208,8 +454,18 @@ bool KVStore::CompactRange(const std::string &begin_prefix, const std::string &e
   rocksdb::CompactRangeOptions options;
   rocksdb::Slice begin(begin_prefix);
   rocksdb::Slice end(end_prefix);
-  auto s = pimpl_->db->CompactRange(options, &begin, &end);
-  return s.ok();
+  for (auto *handle : pimpl_->handles) {
+    if (!pimpl_->db->CompactRange(options, handle, &begin, &end).ok()) return false;
+  }
+  return true;
+}
+
+KVStore::Statistics KVStore::GetStatistics() const {
+  const auto &statistics = pimpl_->statistics;
+  if (!statistics) return {0, 0, 0};
+  return {statistics->getTickerCount(rocksdb::BLOCK_CACHE_HIT), statistics->getTickerCount(rocksdb::BLOCK_CACHE_MISS),
+          statistics->getTickerCount(rocksdb::BLOOM_FILTER_USEFUL) +
+              statistics->getTickerCount(rocksdb::BLOOM_FILTER_PREFIX_USEFUL)};
 }
 
 }  // namespace kvstore
@@ -11,11 +11,15 @@
 
 #pragma once
 
+#include <cstdint>
 #include <filesystem>
+#include <functional>
 #include <map>
 #include <memory>
 #include <optional>
 #include <string>
+#include <string_view>
+#include <utility>
 #include <vector>
 
 #include "utils/exceptions.hpp"
@@ -27,12 +31,63 @@ class KVStoreError : public utils::BasicException {
   using utils::BasicException::BasicException;
 };
 
+/// Block compression of the stored data.
+enum class Compression : uint8_t { NONE, SNAPPY, ZLIB, LZ4, ZSTD };
+
 /**
  * Abstraction used to manage key-value pairs. The underlying implementation
  * guarantees thread safety and durability properties.
  */
 class KVStore final {
  public:
+  /// Keys starting with `prefix` are stored in the column family `name`.
+  struct ColumnFamily {
+    std::string name;
+    std::string prefix;
+  };
+
+  /**
+   * Tuning of the underlying storage. The defaults keep a single keyspace
+   * without filters or compression.
+   */
+  struct Options {
+    /// Column families besides the default one. None of the prefixes may
+    /// start with another one. Keys are routed to the family of the prefix
+    /// they start with, all other keys go to the default family. Keys are
+    /// moved between families when the list changes between two runs.
+    std::vector<ColumnFamily> column_families;
+    /// A key's prefix group is its first `prefix_length` bytes. Prefix bloom
+    /// filters are built on the groups and `group_begin` iterates a single
+    /// group. 0 disables prefix groups.
+    uint32_t prefix_length{0};
+    /// Bits per key of the bloom filters, 0 disables them.
+    uint32_t bloom_bits_per_key{0};
+    /// Size of the block cache shared by all families, 0 keeps the RocksDB
+    /// default cache of each family.
+    uint64_t block_cache_bytes{0};
+    /// Compression of all levels but the last one.
+    std::optional<Compression> compression;
+    /// Compression of the last level, which holds the coldest data.
+    std::optional<Compression> bottommost_compression;
+    uint64_t write_buffer_size{640ULL << 20};
+    /// Collects the counters returned by `GetStatistics`.
+    bool statistics{false};
+    /// Called by compactions with the key of every entry they rewrite, the
+    /// entry is dropped when it returns true. Entries which expire this way
+    /// cost nothing until their file is compacted. Runs on the compaction
+    /// threads, concurrently with everything else.
+    std::function<bool(std::string_view key)> compaction_filter;
+  };
+
+  /// Read counters of the store, all zero unless `Options::statistics` is set.
+  struct Statistics {
+    uint64_t block_cache_hits;
+    uint64_t block_cache_misses;
+    /// Point and prefix lookups answered by a bloom filter without reading
+    /// the data block.
+    uint64_t bloom_filter_useful;
+  };
+
   KVStore() = delete;
 
   /**
@@ -43,6 +98,12 @@ class KVStore final {
    */
   explicit KVStore(std::filesystem::path storage);
 
+  /**
+   * @param storage Path to a directory where the data is persisted.
+   * @param options Tuning of the underlying storage.
+   */
+  KVStore(std::filesystem::path storage, const Options &options);
+
   KVStore(const KVStore &other) = delete;
   KVStore(KVStore &&other);
 
@@ -72,6 +133,16 @@ class KVStore final {
    */
   bool PutMultiple(const std::map<std::string, std::string> &items);
 
+  /**
+   * Store values from all given maps in a single atomic write.
+   *
+   * @param partitions
+   *
+   * @return true if the items have been successfully stored.
+   *         In case of any error false is going to be returned.
+   */
+  bool PutMultiple(const std::vector<std::map<std::string, std::string>> &partitions);
+
   /**
    * Retrieve value for the given key.
    *
@@ -127,6 +198,22 @@ class KVStore final {
    */
   bool PutAndDeleteMultiple(const std::map<std::string, std::string> &items, const std::vector<std::string> &keys);
 
+  /**
+   * Store values under the given keys, delete the keys and delete all keys in
+   * the given ranges in a single atomic write. A range [begin, end) is
+   * dropped with a single tombstone however many keys it holds, both of its
+   * ends have to be in the same column family.
+   *
+   * @param items
+   * @param keys
+   * @param ranges
+   *
+   * @return true if the items have been successfully stored and deleted.
+   *         In case of any error false is going to be returned.
+   */
+  bool PutAndDeleteRanges(const std::map<std::string, std::string> &items, const std::vector<std::string> &keys,
+                          const std::vector<std::pair<std::string, std::string>> &ranges);
+
   /**
    * Returns total number of stored (key, value) pairs. The function takes an
    * optional prefix parameter used for filtering keys that start with that
@@ -152,12 +239,21 @@ class KVStore final {
    */
   bool CompactRange(const std::string &begin_prefix, const std::string &end_prefix);
 
+  /**
+   * Returns the read counters collected since the store was opened.
+   */
+  Statistics GetStatistics() const;
+
   /**
    * Custom prefix-based iterator over kvstore.
    *
    * It filters all (key, value) pairs where the key has a certain prefix
    * and behaves as if all of those pairs are stored in a single iterable
    * collection of std::pair<std::string, std::string>.
+   *
+   * Keys are iterated within the column family selected by the prefix, a
+   * prefix which selects no family (including the empty one) only walks
+   * the default family.
    */
   class iterator final : public std::iterator<std::input_iterator_tag,                      // iterator_category
                                               std::pair<std::string, std::string>,          // value_type
@@ -194,15 +290,37 @@ class KVStore final {
 
     bool operator!=(const iterator &other) const;
 
+    /// Copies the current key and value, prefer `key` and `value` on hot
+    /// paths.
     reference operator*();
 
     pointer operator->();
 
+    /// Current key, without copying it. The view points into the underlying
+    /// storage and is valid until the iterator is moved or destroyed.
+    std::string_view key() const;
+
+    /// Current value, without copying it. Valid for as long as `key`.
+    std::string_view value() const;
+
     void SetInvalid();
 
     bool IsValid();
 
+    /// Moves an iterator returned by `group_begin` to `key`, which has to be
+    /// in the same column family, and restricts it to the prefix group of
+    /// `key`, reusing the underlying RocksDB iterator.
+    /// Lookups of many groups in key order seek one iterator forward instead
+    /// of creating one per group. Compare it with `group_end(key)` afterwards.
+    iterator &Seek(const std::string &key);
+
    private:
+    friend class KVStore;
+
+    struct GroupTag {};
+
+    iterator(const KVStore *kvstore, const std::string &key, bool at_end, GroupTag);
+
     struct impl;
     std::unique_ptr<impl> pimpl_;
   };
@@ -222,6 +340,16 @@ class KVStore final {
 
   //hjm end
 
+  /**
+   * Iterates the keys of the prefix group of `key`, starting from `key`, see
+   * `Options::prefix_length`. Prefix bloom filters skip the files which hold
+   * no key of the group. Without prefix groups, or for keys shorter than the
+   * group, the iteration runs to the end of the key's column family.
+   */
+  iterator group_begin(const std::string &key) const { return iterator(this, key, false, iterator::GroupTag{}); }
+
+  iterator group_end(const std::string &key) const { return iterator(this, key, true, iterator::GroupTag{}); }
+
  private:
   struct impl;
   std::unique_ptr<impl> pimpl_;
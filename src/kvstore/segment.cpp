@@ -0,0 +1,121 @@
+// Copyright 2021 Memgraph Ltd.
+//
+// Use of this software is governed by the Business Source License
+// included in the file licenses/BSL.txt; by using this file, you agree to be bound by the terms of the Business Source
+// License, and you may not use this file except in compliance with the Business Source License.
+//
+// As of the Change Date specified in that file, in accordance with
+// the Business Source License, use of this software will be governed
+// by the Apache License, Version 2.0, included in the file
+// licenses/APL.txt.
+
+#include <rocksdb/filter_policy.h>
+#include <rocksdb/options.h>
+#include <rocksdb/slice_transform.h>
+#include <rocksdb/sst_file_reader.h>
+#include <rocksdb/sst_file_writer.h>
+#include <rocksdb/table.h>
+
+#include "kvstore/segment.hpp"
+
+namespace kvstore {
+
+rocksdb::CompressionType ToRocksDb(Compression compression);
+
+namespace {
+
+rocksdb::Options ToRocksDbOptions(const SegmentOptions &options) {
+  rocksdb::Options db_options;
+  rocksdb::BlockBasedTableOptions table_options;
+  table_options.block_size = options.block_size;
+  if (options.bloom_bits_per_key != 0) {
+    table_options.filter_policy.reset(rocksdb::NewBloomFilterPolicy(options.bloom_bits_per_key, false));
+    table_options.whole_key_filtering = true;
+  }
+  db_options.table_factory.reset(rocksdb::NewBlockBasedTableFactory(table_options));
+  if (options.prefix_length != 0) {
+    db_options.prefix_extractor.reset(rocksdb::NewFixedPrefixTransform(options.prefix_length));
+  }
+  // Segments are written once, so they are compressed as the last level of
+  // a store would be.
+  db_options.compression = ToRocksDb(options.compression);
+  db_options.bottommost_compression = db_options.compression;
+  return db_options;
+}
+
+}  // namespace
+
+struct SegmentWriter::impl {
+  std::filesystem::path path;
+  rocksdb::Options options;
+  std::unique_ptr<rocksdb::SstFileWriter> writer;
+};
+
+SegmentWriter::SegmentWriter(std::filesystem::path path, const SegmentOptions &options)
+    : pimpl_(std::make_unique<impl>()) {
+  pimpl_->path = std::move(path);
+  pimpl_->options = ToRocksDbOptions(options);
+  pimpl_->writer = std::make_unique<rocksdb::SstFileWriter>(rocksdb::EnvOptions(), pimpl_->options);
+  auto s = pimpl_->writer->Open(pimpl_->path.string());
+  if (!s.ok()) throw KVStoreError("Couldn't create the segment " + pimpl_->path.string() + " -- " + s.ToString());
+}
+
+SegmentWriter::~SegmentWriter() {}
+
+void SegmentWriter::Put(std::string_view key, std::string_view value) {
+  auto s = pimpl_->writer->Put(rocksdb::Slice(key.data(), key.size()), rocksdb::Slice(value.data(), value.size()));
+  if (!s.ok()) throw KVStoreError("Couldn't write to the segment " + pimpl_->path.string() + " -- " + s.ToString());
+}
+
+uint64_t SegmentWriter::Finish() {
+  rocksdb::ExternalSstFileInfo info;
+  auto s = pimpl_->writer->Finish(&info);
+  if (!s.ok()) throw KVStoreError("Couldn't write the segment " + pimpl_->path.string() + " -- " + s.ToString());
+  return info.file_size;
+}
+
+struct Segment::impl {
+  std::filesystem::path path;
+  rocksdb::Options options;
+  bool prefix_groups;
+  std::unique_ptr<rocksdb::SstFileReader> reader;
+};
+
+Segment::Segment(std::filesystem::path path, const SegmentOptions &options) : pimpl_(std::make_unique<impl>()) {
+  pimpl_->path = std::move(path);
+  pimpl_->options = ToRocksDbOptions(options);
+  pimpl_->prefix_groups = options.prefix_length != 0;
+  pimpl_->reader = std::make_unique<rocksdb::SstFileReader>(pimpl_->options);
+  auto s = pimpl_->reader->Open(pimpl_->path.string());
+  if (!s.ok()) throw KVStoreError("Couldn't open the segment " + pimpl_->path.string() + " -- " + s.ToString());
+}
+
+Segment::~Segment() {}
+
+const std::filesystem::path &Segment::Path() const { return pimpl_->path; }
+
+std::optional<std::string> Segment::Get(const std::string &key) const {
+  std::optional<std::string> value;
+  Scan(key, [&](std::string_view found_key, std::string_view found_value) {
+    if (found_key == key) value.emplace(found_value);
+    return false;
+  });
+  return value;
+}
+
+void Segment::Scan(const std::string &key, const std::function<bool(std::string_view, std::string_view)> &func) const {
+  rocksdb::ReadOptions options;
+  if (pimpl_->prefix_groups) {
+    options.prefix_same_as_start = true;
+  } else {
+    options.total_order_seek = true;
+  }
+  std::unique_ptr<rocksdb::Iterator> iter(pimpl_->reader->NewIterator(options));
+  for (iter->Seek(key); iter->Valid(); iter->Next()) {
+    auto found_key = iter->key();
+    auto found_value = iter->value();
+    if (!func({found_key.data(), found_key.size()}, {found_value.data(), found_value.size()})) break;
+  }
+}
+
+}  // namespace kvstore
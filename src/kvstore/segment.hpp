@@ -0,0 +1,112 @@
+// Copyright 2021 Memgraph Ltd.
+//
+// Use of this software is governed by the Business Source License
+// included in the file licenses/BSL.txt; by using this file, you agree to be bound by the terms of the Business Source
+// License, and you may not use this file except in compliance with the Business Source License.
+//
+// As of the Change Date specified in that file, in accordance with
+// the Business Source License, use of this software will be governed
+// by the Apache License, Version 2.0, included in the file
+// licenses/APL.txt.
+
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include "kvstore/kvstore.hpp"
+
+namespace kvstore {
+
+/**
+ * Layout of segment files, readers have to use the options the segment was
+ * written with.
+ */
+struct SegmentOptions {
+  /// Same as `KVStore::Options::prefix_length`, scans only read the prefix
+  /// group they start in.
+  uint32_t prefix_length{0};
+  /// Bits per key of the bloom filters on the keys and their prefix groups,
+  /// 0 disables them.
+  uint32_t bloom_bits_per_key{0};
+  Compression compression{Compression::ZSTD};
+  /// Size of the uncompressed blocks, larger blocks compress better and keep
+  /// the index smaller.
+  uint64_t block_size{64ULL << 10};
+};
+
+/**
+ * Writes an immutable segment file of key-value pairs, which are added in
+ * ascending key order.
+ */
+class SegmentWriter final {
+ public:
+  /**
+   * @param path File the segment is written to, it is created by `Finish`.
+   */
+  SegmentWriter(std::filesystem::path path, const SegmentOptions &options);
+
+  SegmentWriter(const SegmentWriter &other) = delete;
+  SegmentWriter &operator=(const SegmentWriter &other) = delete;
+
+  ~SegmentWriter();
+
+  /**
+   * Adds a key-value pair, the key has to be greater than all keys added
+   * before.
+   *
+   * @throw KVStoreError if the pair couldn't be added.
+   */
+  void Put(std::string_view key, std::string_view value);
+
+  /**
+   * Writes the segment file, returns its size in bytes.
+   *
+   * @throw KVStoreError if the file couldn't be written.
+   */
+  uint64_t Finish();
+
+ private:
+  struct impl;
+  std::unique_ptr<impl> pimpl_;
+};
+
+/**
+ * Read-only segment file written by `SegmentWriter`. The pairs are stored in
+ * compressed blocks and the index holds the last key of every block, so it is
+ * sparse over the keys and a lookup reads a single block of the file.
+ */
+class Segment final {
+ public:
+  /**
+   * @throw KVStoreError if the segment couldn't be opened.
+   */
+  Segment(std::filesystem::path path, const SegmentOptions &options);
+
+  Segment(const Segment &other) = delete;
+  Segment &operator=(const Segment &other) = delete;
+
+  ~Segment();
+
+  const std::filesystem::path &Path() const;
+
+  std::optional<std::string> Get(const std::string &key) const;
+
+  /**
+   * Calls `func` with the pairs from `key` on, in key order, for as long as
+   * it returns true. With prefix groups only the group of `key` is read. The
+   * views are valid during the call.
+   */
+  void Scan(const std::string &key, const std::function<bool(std::string_view, std::string_view)> &func) const;
+
+ private:
+  struct impl;
+  std::unique_ptr<impl> pimpl_;
+};
+
+}  // namespace kvstore
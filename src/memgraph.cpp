@@ -38,6 +38,7 @@
 #include "communication/websocket/auth.hpp"
 #include "communication/websocket/server.hpp"
 #include "helpers.hpp"
+#include "kvstore/kvstore.hpp"
 #include "py/py.hpp"
 #include "query/auth_checker.hpp"
 #include "query/discard_value_stream.hpp"
@@ -157,6 +158,13 @@ DEFINE_string(bolt_server_name_for_init, "",
 DEFINE_VALIDATED_int32(anchor_num, 11,
                        "Anchor num",
                        FLAG_IN_RANGE(0, std::numeric_limits<uint16_t>::max()));
+DEFINE_bool(adaptive_anchor, false,
+            "Choose the anchor interval of every vertex and edge from its update rate, delta size and historical "
+            "reads instead of using --anchor-num.");
+DEFINE_VALIDATED_int32(max_anchor_num, 64,
+                       "Upper bound on the anchor interval, and so on the deltas replayed by a historical read, "
+                       "when --adaptive-anchor is set.",
+                       FLAG_IN_RANGE(1, std::numeric_limits<uint16_t>::max()));
 
                        
 //TODO: extend features 
@@ -169,6 +177,44 @@ DEFINE_VALIDATED_uint64(retention_interval_sec, 60,
 DEFINE_VALIDATED_uint64(retention_period_sec, 15,
                         "Reclaim history interval (in seconds). ",
                         FLAG_IN_RANGE(0, 7 * 24 * 3600));
+DEFINE_VALIDATED_uint64(history_migration_threads, 1,
+                        "Number of threads that encode history records before they are written to the historical "
+                        "storage. Set to 0 to write them synchronously during garbage collection.",
+                        FLAG_IN_RANGE(0, 256));
+DEFINE_VALIDATED_uint64(history_migration_queue_size, 16,
+                        "Maximum number of garbage collection cycles waiting to be written to the historical "
+                        "storage. Garbage collection blocks when the queue is full.",
+                        FLAG_IN_RANGE(1, std::numeric_limits<uint32_t>::max()));
+DEFINE_uint64(history_cache_size_mib, 256,
+              "Memory budget, in MiB, of the cache of vertex and edge versions rebuilt from the historical storage. "
+              "Set to 0 to disable the cache.");
+DEFINE_bool(history_column_families, true,
+            "Store every kind of history record in its own column family of the historical storage.");
+DEFINE_VALIDATED_uint64(history_bloom_bits_per_key, 10,
+                        "Bits per key of the bloom filters of the historical storage. Set to 0 to disable the filters.",
+                        FLAG_IN_RANGE(0, 64));
+DEFINE_uint64(history_block_cache_size_mib, 512,
+              "Size, in MiB, of the block cache shared by the column families of the historical storage.");
+DEFINE_bool(history_statistics, false,
+            "Collect the read counters of the historical storage, they are reported by SHOW STORAGE INFO.");
+DEFINE_VALIDATED_uint64(history_scan_batch_size, 256,
+                        "Number of vertices whose history a temporal scan looks up in the historical storage at once.",
+                        FLAG_IN_RANGE(1, 1 << 20));
+DEFINE_VALIDATED_uint64(history_scan_threads, 1,
+                        "Number of threads that rebuild the versions of a temporal scan batch from the historical "
+                        "storage, each one a contiguous range of vertices. The current vertices are still scanned "
+                        "and aggregated on the thread of the query. Set to 1 to rebuild them on the thread of the "
+                        "query.",
+                        FLAG_IN_RANGE(1, 256));
+DEFINE_string(history_cold_directory, "",
+              "Directory of the cold tier of the historical storage, old history is moved there into compressed, "
+              "read-only segment files. Requires --real-time-flag. Leave empty to keep all history in the historical "
+              "storage.");
+DEFINE_uint64(history_cold_after_sec, 30 * 24 * 3600,
+              "History which ended longer ago than this many seconds is moved to the cold tier.");
+DEFINE_VALIDATED_uint64(history_cold_interval_sec, 3600,
+                        "Interval, in seconds, of moving old history to the cold tier.",
+                        FLAG_IN_RANGE(1, 7 * 24 * 3600));
 
 // General purpose flags.
 // NOTE: The `data_directory` flag must be the same here and in
@@ -286,6 +332,54 @@ DEFINE_VALIDATED_string(isolation_level, "SNAPSHOT_ISOLATION", isolation_level_h
 });
 
 namespace {
+constexpr std::array history_compression_mappings{
+    std::pair{"none"sv, kvstore::Compression::NONE}, std::pair{"snappy"sv, kvstore::Compression::SNAPPY},
+    std::pair{"zlib"sv, kvstore::Compression::ZLIB}, std::pair{"lz4"sv, kvstore::Compression::LZ4},
+    std::pair{"zstd"sv, kvstore::Compression::ZSTD}};
+
+const std::string history_compression_help_string =
+    fmt::format("Compression of the recent history in the historical storage. Allowed values: {}",
+                GetAllowedEnumValuesString(history_compression_mappings));
+
+const std::string history_bottommost_compression_help_string =
+    fmt::format("Compression of the oldest history in the historical storage. Allowed values: {}",
+                GetAllowedEnumValuesString(history_compression_mappings));
+
+bool ValidateHistoryCompression(const std::string &value) {
+  if (const auto result = IsValidEnumValueString(value, history_compression_mappings); result.HasError()) {
+    const auto error = result.GetError();
+    switch (error) {
+      case ValidationError::EmptyValue: {
+        std::cout << "History compression cannot be empty." << std::endl;
+        break;
+      }
+      case ValidationError::InvalidValue: {
+        std::cout << "Invalid value for history compression. Allowed values: "
+                  << GetAllowedEnumValuesString(history_compression_mappings) << std::endl;
+        break;
+      }
+    }
+    return false;
+  }
+
+  return true;
+}
+}  // namespace
+
+// NOLINTNEXTLINE (cppcoreguidelines-avoid-non-const-global-variables)
+DEFINE_VALIDATED_string(history_compression, "lz4", history_compression_help_string.c_str(),
+                        { return ValidateHistoryCompression(value); });
+// NOLINTNEXTLINE (cppcoreguidelines-avoid-non-const-global-variables)
+DEFINE_VALIDATED_string(history_bottommost_compression, "zstd", history_bottommost_compression_help_string.c_str(),
+                        { return ValidateHistoryCompression(value); });
+
+namespace {
+kvstore::Compression ParseHistoryCompression(const std::string &value) {
+  const auto compression = StringToEnum<kvstore::Compression>(value, history_compression_mappings);
+  MG_ASSERT(compression, "Invalid history compression");
+  return *compression;
+}
+
 storage::IsolationLevel ParseIsolationLevel() {
   const auto isolation_level = StringToEnum<storage::IsolationLevel>(FLAGS_isolation_level, isolation_level_mappings);
   MG_ASSERT(isolation_level, "Invalid isolation level");
@@ -1145,7 +1239,9 @@ int main(int argc, char **argv) {
       .gc = {.type = storage::Config::Gc::Type::PERIODIC, .interval = std::chrono::seconds(FLAGS_storage_gc_cycle_sec)},
       .items = {.properties_on_edges = FLAGS_storage_properties_on_edges,
                 .AnchorNum=FLAGS_anchor_num,
-                .realTimeFlag=FLAGS_real_time_flag},
+                .realTimeFlag=FLAGS_real_time_flag,
+                .adaptiveAnchorFlag=FLAGS_adaptive_anchor,
+                .MaxAnchorNum=FLAGS_max_anchor_num},
       .durability = {.storage_directory = FLAGS_data_directory,
                      .recover_on_startup = FLAGS_storage_recover_on_startup,
                      .snapshot_retention_count = FLAGS_storage_snapshot_retention_count,
@@ -1155,7 +1251,21 @@ int main(int argc, char **argv) {
       .transaction = {.isolation_level = ParseIsolationLevel()},
       .rocksdb_retention = {.retention_on_startup = FLAGS_retention_on_startup,
                             .retention_period=std::chrono::seconds(FLAGS_retention_period_sec),
-                            .retention_interval=std::chrono::seconds(FLAGS_retention_interval_sec)}};
+                            .retention_interval=std::chrono::seconds(FLAGS_retention_interval_sec)},
+      .history = {.migration_threads = FLAGS_history_migration_threads,
+                  .migration_queue_size = FLAGS_history_migration_queue_size,
+                  .cache_bytes = FLAGS_history_cache_size_mib * 1024 * 1024,
+                  .column_families = FLAGS_history_column_families,
+                  .bloom_bits_per_key = static_cast<uint32_t>(FLAGS_history_bloom_bits_per_key),
+                  .block_cache_bytes = FLAGS_history_block_cache_size_mib * 1024 * 1024,
+                  .compression = ParseHistoryCompression(FLAGS_history_compression),
+                  .bottommost_compression = ParseHistoryCompression(FLAGS_history_bottommost_compression),
+                  .statistics = FLAGS_history_statistics,
+                  .scan_batch_size = FLAGS_history_scan_batch_size,
+                  .scan_threads = FLAGS_history_scan_threads,
+                  .cold_directory = FLAGS_history_cold_directory,
+                  .cold_after = std::chrono::seconds(FLAGS_history_cold_after_sec),
+                  .cold_interval = std::chrono::seconds(FLAGS_history_cold_interval_sec)}};
   if (FLAGS_storage_snapshot_interval_sec == 0) {
     if (FLAGS_storage_wal_enabled) {
       LOG_FATAL(
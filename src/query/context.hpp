@@ -60,6 +60,14 @@ inline std::vector<storage::LabelId> NamesToLabels(const std::vector<std::string
   return labels;
 }
 
+/// Transaction time window read by a query with a `TT` clause, `TT AS t` reads
+/// the window starting and ending at `t`. Also the valid time window of a `VT`
+/// clause.
+struct TemporalBounds {
+  int64_t ts;
+  int64_t te;
+};
+
 struct ExecutionContext {
   DbAccessor *db_accessor{nullptr};
   SymbolTable symbol_table;
@@ -72,12 +80,13 @@ struct ExecutionContext {
   ExecutionStats execution_stats;
   TriggerContextCollector *trigger_context_collector{nullptr};
   utils::AsyncTimer timer;
-  // wzy edit begin: add std::string addition
-  // std::optional<std::string> addition;
-  // std::optional<std::string> addition_right;
-
-  std::optional<int64_t> addition;
-  std::optional<int64_t> addition_right;
+  // wzy edit begin
+  /// Set for queries with a `TT` clause, evaluated for every query since the
+  /// cached plan is shared between sessions.
+  std::optional<TemporalBounds> temporal_bounds;
+  /// Set for queries with a `VT` clause, only vertices and edges whose valid
+  /// time overlaps the window are matched.
+  std::optional<TemporalBounds> valid_bounds;
   // std::map<uint64_t,std::vector<std::tuple<storage::HistoryVertex*,uint64_t,uint64_t>>> all_vertex_;//pair gid,transaction_st vertex info 
   // std::map<int,std::vector<nlohmann::json>> fiter_history_e_datas;
 
@@ -181,11 +181,11 @@ std::unique_ptr<LogicalPlan> MakeLogicalPlan(AstStorage ast_storage, CypherQuery
   auto symbol_table = MakeSymbolTable(query, predefined_identifiers);
   auto planning_context = plan::MakePlanningContext(&ast_storage, &symbol_table, query, &vertex_counts);
   auto [root, cost] = plan::MakeLogicalPlan(&planning_context, parameters, FLAGS_query_cost_planner);
-  //hjm begin
-  auto history_info=planning_context.history_info_;
-  //hjm end
+  // The bounds point into `ast_storage`, which is kept by the plan.
+  auto history_info = planning_context.history_infos_;
+  auto valid_info = planning_context.valid_infos_;
   return std::make_unique<SingleNodeLogicalPlan>(std::move(root), cost, std::move(ast_storage),
-                                                 std::move(symbol_table),history_info);
+                                                 std::move(symbol_table), history_info, valid_info);
 }
 
 std::shared_ptr<CachedPlan> CypherQueryToPlan(uint64_t hash, AstStorage ast_storage, CypherQuery *query,
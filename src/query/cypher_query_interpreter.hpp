@@ -47,7 +47,11 @@ class LogicalPlan {
   virtual const AstStorage &GetAstStorage() const = 0;
 
   //hjm begin
-  virtual const std::optional<std::pair<int,int>> &getHistoryInfo() const =0;
+  /// Returns the bounds of the TT clause, they point into the AST storage of
+  /// the plan. The second bound isn't set for `TT AS`.
+  virtual const std::optional<std::pair<Expression *, Expression *>> &getHistoryInfo() const = 0;
+  /// Returns the bounds of the VT clause, like `getHistoryInfo`.
+  virtual const std::optional<std::pair<Expression *, Expression *>> &getValidInfo() const = 0;
   //hjm end
 };
 
@@ -62,6 +66,7 @@ class CachedPlan {
 
   //hjm begin
   const auto &getHistoryInfo() const { return plan_->getHistoryInfo(); }
+  const auto &getValidInfo() const { return plan_->getValidInfo(); }
   //hjm end
 
   bool IsExpired() const {
@@ -130,17 +135,25 @@ class SingleNodeLogicalPlan final : public LogicalPlan {
       : root_(std::move(root)), cost_(cost), storage_(std::move(storage)), symbol_table_(symbol_table) {}
 
  SingleNodeLogicalPlan(std::unique_ptr<plan::LogicalOperator> root, double cost, AstStorage storage,
-                        const SymbolTable &symbol_table,std::optional<std::pair<int,int>> history_info)
-      : root_(std::move(root)), cost_(cost), storage_(std::move(storage)), symbol_table_(symbol_table),history_info_(history_info) {}
+                        const SymbolTable &symbol_table,
+                        std::optional<std::pair<Expression *, Expression *>> history_info,
+                        std::optional<std::pair<Expression *, Expression *>> valid_info = std::nullopt)
+      : root_(std::move(root)),
+        cost_(cost),
+        storage_(std::move(storage)),
+        symbol_table_(symbol_table),
+        history_info_(history_info),
+        valid_info_(valid_info) {}
 
   const plan::LogicalOperator &GetRoot() const override { return *root_; }
   double GetCost() const override { return cost_; }
   const SymbolTable &GetSymbolTable() const override { return symbol_table_; }
   const AstStorage &GetAstStorage() const override { return storage_; }
 
-  const std::optional<std::pair<int,int>> &getHistoryInfo() const override{
+  const std::optional<std::pair<Expression *, Expression *>> &getHistoryInfo() const override {
     return history_info_;
   };
+  const std::optional<std::pair<Expression *, Expression *>> &getValidInfo() const override { return valid_info_; }
 
  private:
   std::unique_ptr<plan::LogicalOperator> root_;
@@ -149,8 +162,9 @@ class SingleNodeLogicalPlan final : public LogicalPlan {
   SymbolTable symbol_table_;
 
   //hjm begin
-  std::optional<std::pair<int,int>> history_info_;
+  std::optional<std::pair<Expression *, Expression *>> history_info_;
   //hjm end
+  std::optional<std::pair<Expression *, Expression *>> valid_info_;
 };
 
 std::unique_ptr<LogicalPlan> MakeLogicalPlan(AstStorage ast_storage, CypherQuery *query, const Parameters &parameters,
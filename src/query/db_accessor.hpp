@@ -93,6 +93,8 @@ class EdgeAccessor final {
   uint64_t transaction_st(){return impl_.transaction_st();}
   uint64_t tt_te(){return impl_.tt_te();}
 
+  storage::AnchorStats GetAnchorStats() const { return impl_.GetAnchorStats(); }
+
   storage::Delta *getDeltas(){
     return impl_.getDeltas();
   }
@@ -217,6 +219,8 @@ class VertexAccessor final {
 
   uint64_t transaction_st(){return impl_.transaction_st();};
   uint64_t tt_te(){return impl_.tt_te();}
+
+  storage::AnchorStats GetAnchorStats() const { return impl_.GetAnchorStats(); }
   bool operator==(const VertexAccessor &v) const noexcept {
     static_assert(noexcept(impl_ == v.impl_));
     return impl_ == v.impl_;
@@ -275,43 +279,38 @@ class DbAccessor final {
 
   
 
-  void ClearHistory(){
-    return accessor_->ClearHistory();
-  }
-  
-  std::optional<std::list<storage::HistoryVertex*>> FindHistoryVertex(uint64_t gid,uint64_t c_ts,uint64_t c_te){
-    return accessor_->FindHistoryVertex(gid,c_ts,c_te);
+  std::optional<std::vector<storage::HistoryVertex>> FindHistoryVertexVersions(
+      const VertexAccessor &vertex, const history_delta::historyContext &context) {
+    return accessor_->FindHistoryVertexVersions(vertex.impl_, context);
   }
 
-  void saveHistoryVertex(uint64_t gid,uint64_t c_ts,uint64_t c_te,storage::HistoryVertex* vertex,uint64_t tt_ts,uint64_t tt_te){
-    return accessor_->saveHistoryVertex(gid,c_ts,c_te,vertex,tt_ts,tt_te);
-  }
-  bool FindHistoryEdgeFlag(uint64_t gid,uint64_t c_ts,uint64_t c_te){
-    return accessor_->FindHistoryEdgeFlag(gid, c_ts,c_te);
-  }
-  void saveHistoryEdgeFlag(uint64_t gid,uint64_t c_ts,uint64_t c_te){
-    return accessor_->saveHistoryEdgeFlag(gid, c_ts,c_te);
+  void SaveHistoryVertexVersion(const VertexAccessor &vertex, const storage::HistoryVertex &version) {
+    accessor_->SaveHistoryVertexVersion(vertex.impl_, version);
   }
 
-  std::optional<std::vector<std::tuple<storage::HistoryEdge*,uint64_t,uint64_t>>> FindHistoryEdge(uint64_t gid,uint64_t c_ts,uint64_t c_te){
-    return accessor_->FindHistoryEdge(gid,c_ts,c_te);
+  std::optional<std::vector<storage::HistoryEdge>> FindHistoryEdgeVersions(
+      storage::Gid gid, const history_delta::historyContext &context) {
+    return accessor_->FindHistoryEdgeVersions(gid, context);
   }
 
-  void saveHistoryEdge(uint64_t gid,uint64_t c_ts,uint64_t c_te,storage::HistoryEdge* edge,uint64_t tt_ts,uint64_t tt_te){
-    return accessor_->saveHistoryEdge(gid,c_ts,c_te,edge,tt_ts,tt_te);
-  }
+  void SaveHistoryEdgeVersion(const storage::HistoryEdge &version) { accessor_->SaveHistoryEdgeVersion(version); }
 
-  bool FindHistoryVertexFlag(uint64_t gid,uint64_t c_ts,uint64_t c_te){
-    return accessor_->FindHistoryVertexFlag(gid, c_ts,c_te);
+  bool RollBackVertex(const VertexAccessor &vertex, uint64_t timestamp, std::vector<storage::LabelId> *labels,
+                      std::map<storage::PropertyId, storage::PropertyValue> *properties) {
+    return accessor_->RollBackVertex(vertex.impl_, timestamp, labels, properties);
   }
-  void saveHistoryVertexFlag(uint64_t gid,uint64_t c_ts,uint64_t c_te){
-    return accessor_->saveHistoryVertexFlag(gid, c_ts,c_te);
+
+  bool RollBackEdge(const EdgeAccessor &edge, uint64_t timestamp,
+                    std::map<storage::PropertyId, storage::PropertyValue> *properties) {
+    return accessor_->RollBackEdge(edge.impl_, timestamp, properties);
   }
 
+  uint64_t StartTimestamp() const { return accessor_->StartTimestamp(); }
+
   static EdgeAccessor MakeEdgeAccessor(const storage::EdgeAccessor impl) { return EdgeAccessor(impl); }
   
 
-  auto Edges(std::vector<std::tuple<storage::EdgeTypeId, storage::Vertex *, storage::EdgeRef>> &edges_,const std::vector<storage::EdgeTypeId> &edge_types,storage::Gid gid,bool from,std::optional<storage::Gid> existing_gid) const
+  auto Edges(const std::vector<std::tuple<storage::EdgeTypeId, storage::Vertex *, storage::EdgeRef>> &edges_,const std::vector<storage::EdgeTypeId> &edge_types,storage::Gid gid,bool from,std::optional<storage::Gid> existing_gid) const
       -> storage::Result<decltype(iter::imap(MakeEdgeAccessor, *accessor_->Edges(edges_,edge_types, gid,from,existing_gid)))> {
     auto maybe_edges = accessor_->Edges(edges_,edge_types,gid,from,existing_gid);
     if (maybe_edges.HasError()) return maybe_edges.GetError();
@@ -319,11 +318,11 @@ class DbAccessor final {
   }
 
   storage::Gid IdToGid(const uint64_t key) { return accessor_->IdToGid(key); }
-  storage::HistoryVertex CreateHistoryVertexFromKV(const storage::HistoryVertex another,nlohmann::json gid_delta_,history_delta::historyContext &historyContext_){
+  storage::HistoryVertex CreateHistoryVertexFromKV(const storage::HistoryVertex another,const history_delta::HistoryRecord &gid_delta_,history_delta::historyContext &historyContext_){
     return accessor_->CreateHistoryVertexFromKV(another,gid_delta_,historyContext_);
   }
 
-  storage::HistoryVertex CreateHistoryVertexFromKV(const storage::VertexAccessor &another,nlohmann::json gid_delta_,history_delta::historyContext &historyContext_){
+  storage::HistoryVertex CreateHistoryVertexFromKV(const storage::VertexAccessor &another,const history_delta::HistoryRecord &gid_delta_,history_delta::historyContext &historyContext_){
     return accessor_->CreateHistoryVertexFromKV(another,gid_delta_,historyContext_);
   }
 
@@ -331,10 +330,10 @@ class DbAccessor final {
     return accessor_->CreateHistoryVertexFromDelta(another,may_props,historyContext_);
   }
 
-  storage::HistoryEdge CreateHistoryEdgeFromKV(const storage::EdgeAccessor &another,nlohmann::json gid_delta_){
+  storage::HistoryEdge CreateHistoryEdgeFromKV(const storage::EdgeAccessor &another,const history_delta::HistoryRecord &gid_delta_){
     return accessor_->CreateHistoryEdgeFromKV(another,gid_delta_);
   }
-  storage::HistoryEdge CreateHistoryEdgeFromKV(storage::HistoryEdge edge_,nlohmann::json gid_delta_){
+  storage::HistoryEdge CreateHistoryEdgeFromKV(storage::HistoryEdge edge_,const history_delta::HistoryRecord &gid_delta_){
     return accessor_->CreateHistoryEdgeFromKV(edge_,gid_delta_);
   }
 
@@ -371,6 +370,23 @@ class DbAccessor final {
     return VerticesIterable(accessor_->Vertices(label, property, lower, upper, view));
   }
 
+  VerticesIterable HistoryVertices(storage::View view, storage::LabelId label) {
+    return VerticesIterable(accessor_->HistoryVertices(label, view));
+  }
+
+  VerticesIterable HistoryVertices(storage::View view, storage::LabelId label, storage::PropertyId property,
+                                   const storage::PropertyValue &value) {
+    return VerticesIterable(accessor_->HistoryVertices(label, property, value, view));
+  }
+
+  VerticesIterable ValidTimeVertices(storage::View view, uint64_t ts, uint64_t te) {
+    return VerticesIterable(accessor_->ValidTimeVertices(ts, te, view));
+  }
+
+  VerticesIterable HistoryValidTimeVertices(storage::View view, uint64_t ts, uint64_t te) {
+    return VerticesIterable(accessor_->HistoryValidTimeVertices(ts, te, view));
+  }
+
   VertexAccessor InsertVertex() { return VertexAccessor(accessor_->CreateVertex()); }
 
   storage::Result<EdgeAccessor> InsertEdge(VertexAccessor *from, VertexAccessor *to,
@@ -475,6 +491,13 @@ class DbAccessor final {
     return accessor_->ApproximateVertexCount(label, property, lower, upper);
   }
 
+  /// Statistics of the history store, std::nullopt when history isn't kept.
+  std::optional<history_delta::HistoryStatistics> HistoryStatistics() {
+    auto &history = accessor_->GetHistoryDelta();
+    if (!history) return std::nullopt;
+    return history->GetHistoryStatistics();
+  }
+
   storage::IndicesInfo ListAllIndices() const { return accessor_->ListAllIndices(); }
 
   storage::ConstraintsInfo ListAllConstraints() const { return accessor_->ListAllConstraints(); }
@@ -11,11 +11,15 @@
 
 #include "query/dump.hpp"
 
+#include <algorithm>
+#include <deque>
 #include <iomanip>
+#include <iterator>
 #include <limits>
 #include <map>
 #include <optional>
 #include <ostream>
+#include <thread>
 #include <utility>
 #include <vector>
 
@@ -25,6 +29,7 @@
 #include "query/exceptions.hpp"
 #include "query/stream.hpp"
 #include "query/typed_value.hpp"
+#include "storage/v2/history_delta.hpp"
 #include "storage/v2/property_value.hpp"
 #include "storage/v2/storage.hpp"
 #include "utils/algorithm.hpp"
@@ -45,6 +50,10 @@ const char *kInternalPropertyId = "__mg_id__";
 // index on internal property id.
 const char *kInternalVertexLabel = "__mg_vertex__";
 
+// Number of vertices whose history is rebuilt at once when a past state is
+// dumped, which bounds the memory held by the dump.
+constexpr size_t kAsOfBatchSize = 10000;
+
 /// A helper function that escapes label, edge type and property names.
 std::string EscapeName(const std::string_view &value) {
   std::string out;
@@ -168,9 +177,19 @@ void DumpProperties(std::ostream *os, query::DbAccessor *dba,
   *os << "}";
 }
 
-void DumpVertex(std::ostream *os, query::DbAccessor *dba, const query::VertexAccessor &vertex) {
+void DumpVertex(std::ostream *os, query::DbAccessor *dba, const std::vector<storage::LabelId> &labels,
+                const std::map<storage::PropertyId, storage::PropertyValue> &properties, int64_t cypher_id) {
   *os << "CREATE (";
   *os << ":" << kInternalVertexLabel;
+  for (const auto &label : labels) {
+    *os << ":" << EscapeName(dba->LabelToName(label));
+  }
+  *os << " ";
+  DumpProperties(os, dba, properties, cypher_id);
+  *os << ");";
+}
+
+void DumpVertex(std::ostream *os, query::DbAccessor *dba, const query::VertexAccessor &vertex) {
   auto maybe_labels = vertex.Labels(storage::View::OLD);
   if (maybe_labels.HasError()) {
     switch (maybe_labels.GetError()) {
@@ -184,10 +203,6 @@ void DumpVertex(std::ostream *os, query::DbAccessor *dba, const query::VertexAcc
         throw query::QueryRuntimeException("Unexpected error when getting labels.");
     }
   }
-  for (const auto &label : *maybe_labels) {
-    *os << ":" << EscapeName(dba->LabelToName(label));
-  }
-  *os << " ";
   auto maybe_props = vertex.Properties(storage::View::OLD);
   if (maybe_props.HasError()) {
     switch (maybe_props.GetError()) {
@@ -201,20 +216,28 @@ void DumpVertex(std::ostream *os, query::DbAccessor *dba, const query::VertexAcc
         throw query::QueryRuntimeException("Unexpected error when getting properties.");
     }
   }
-  DumpProperties(os, dba, *maybe_props, vertex.CypherId());
-  *os << ");";
+  DumpVertex(os, dba, *maybe_labels, *maybe_props, vertex.CypherId());
 }
 
-void DumpEdge(std::ostream *os, query::DbAccessor *dba, const query::EdgeAccessor &edge) {
+void DumpEdge(std::ostream *os, query::DbAccessor *dba, int64_t from_id, int64_t to_id, storage::EdgeTypeId edge_type,
+              const std::map<storage::PropertyId, storage::PropertyValue> &properties) {
   *os << "MATCH ";
   *os << "(u:" << kInternalVertexLabel << "), ";
   *os << "(v:" << kInternalVertexLabel << ")";
   *os << " WHERE ";
-  *os << "u." << kInternalPropertyId << " = " << edge.From().CypherId();
+  *os << "u." << kInternalPropertyId << " = " << from_id;
   *os << " AND ";
-  *os << "v." << kInternalPropertyId << " = " << edge.To().CypherId() << " ";
+  *os << "v." << kInternalPropertyId << " = " << to_id << " ";
   *os << "CREATE (u)-[";
-  *os << ":" << EscapeName(dba->EdgeTypeToName(edge.EdgeType()));
+  *os << ":" << EscapeName(dba->EdgeTypeToName(edge_type));
+  if (properties.size() > 0) {
+    *os << " ";
+    DumpProperties(os, dba, properties);
+  }
+  *os << "]->(v);";
+}
+
+void DumpEdge(std::ostream *os, query::DbAccessor *dba, const query::EdgeAccessor &edge) {
   auto maybe_props = edge.Properties(storage::View::OLD);
   if (maybe_props.HasError()) {
     switch (maybe_props.GetError()) {
@@ -228,11 +251,95 @@ void DumpEdge(std::ostream *os, query::DbAccessor *dba, const query::EdgeAccesso
         throw query::QueryRuntimeException("Unexpected error when getting properties.");
     }
   }
-  if (maybe_props->size() > 0) {
-    *os << " ";
-    DumpProperties(os, dba, *maybe_props);
+  DumpEdge(os, dba, edge.From().CypherId(), edge.To().CypherId(), edge.EdgeType(), *maybe_props);
+}
+
+// Rolls labels and properties back with a record of the history store, null
+// properties didn't exist in that version.
+void ApplyHistoryRecord(const history_delta::HistoryRecord &record, std::vector<storage::LabelId> *labels,
+                        std::map<storage::PropertyId, storage::PropertyValue> *properties) {
+  for (const auto &[property, value] : record.properties) {
+    if (value.IsNull()) {
+      properties->erase(property);
+    } else {
+      (*properties)[property] = value;
+    }
+  }
+  if (labels == nullptr) return;
+  for (const auto &[action, label] : record.labels) {
+    auto it = std::find(labels->begin(), labels->end(), label);
+    if (action == history_delta::LabelAction::ADD) {
+      if (it == labels->end()) labels->push_back(label);
+    } else if (it != labels->end()) {
+      labels->erase(it);
+    }
   }
-  *os << "]->(v);";
+}
+
+// Record of the version of a vertex visible at `timestamp` replayed from the
+// history store, std::nullopt if none of its stored versions was visible then.
+std::optional<history_delta::HistoryRecord> VertexRecordAt(history_delta::History_delta *history, uint64_t gid,
+                                                           uint64_t timestamp) {
+  std::optional<history_delta::HistoryRecord> version;
+  history->ForEachVertexVersion(storage::Gid::FromUint(gid), timestamp, timestamp, "as of",
+                                [&](history_delta::HistoryRecord &&record) {
+                                  version.emplace(std::move(record));
+                                  return false;
+                                });
+  return version;
+}
+
+std::optional<history_delta::HistoryRecord> EdgeRecordAt(history_delta::History_delta *history, uint64_t gid,
+                                                         uint64_t timestamp) {
+  std::optional<history_delta::HistoryRecord> version;
+  history->ForEachEdgeVersion(gid, timestamp, timestamp, "as of", [&](history_delta::HistoryRecord &&record) {
+    version.emplace(std::move(record));
+    return false;
+  });
+  return version;
+}
+
+// Dumps the version of a vertex visible at `timestamp`. The vertex is given
+// by its accessor while it's still in the storage and by its record replayed
+// from the history store, if any. Returns false if the vertex didn't exist
+// then.
+bool DumpVertexAsOf(std::ostream *os, query::DbAccessor *dba, uint64_t gid,
+                    const std::optional<query::VertexAccessor> &vertex,
+                    const std::optional<history_delta::HistoryRecord> &record, uint64_t timestamp) {
+  std::vector<storage::LabelId> labels;
+  std::map<storage::PropertyId, storage::PropertyValue> properties;
+  if (!vertex || !dba->RollBackVertex(*vertex, timestamp, &labels, &properties)) {
+    if (!record) return false;
+    ApplyHistoryRecord(*record, &labels, &properties);
+  }
+  DumpVertex(os, dba, labels, properties, storage::Gid::FromUint(gid).AsInt());
+  return true;
+}
+
+// Same as `DumpVertexAsOf` for an edge which is still in the storage.
+bool DumpEdgeAsOf(std::ostream *os, query::DbAccessor *dba, const query::EdgeAccessor &edge, uint64_t timestamp) {
+  std::map<storage::PropertyId, storage::PropertyValue> properties;
+  if (!dba->RollBackEdge(edge, timestamp, &properties)) {
+    auto record = EdgeRecordAt(&*dba->GetHistoryDelta(), edge.Gid().AsUint(), timestamp);
+    if (!record) return false;
+    ApplyHistoryRecord(*record, nullptr, &properties);
+  }
+  DumpEdge(os, dba, edge.From().CypherId(), edge.To().CypherId(), edge.EdgeType(), properties);
+  return true;
+}
+
+// Calls `rebuild` for every gid of a batch. The batch is split into one
+// contiguous gid range per thread of the pool, so every thread reads its part
+// of the history store in key order. The results keep the order of the batch.
+template <typename TResult, typename TFunc>
+std::vector<TResult> RebuildBatch(utils::ThreadPool *pool, const std::vector<uint64_t> &gids, const TFunc &rebuild) {
+  std::vector<TResult> results(gids.size());
+  if (gids.empty()) return results;
+  const size_t threads = std::max(1U, std::thread::hardware_concurrency());
+  utils::RunRanges(pool, gids.size(), threads, [&](size_t begin, size_t end) {
+    for (auto i = begin; i < end; ++i) results[i] = rebuild(gids[i]);
+  });
+  return results;
 }
 
 void DumpLabelIndex(std::ostream *os, query::DbAccessor *dba, const storage::LabelId label) {
@@ -262,8 +369,11 @@ void DumpUniqueConstraint(std::ostream *os, query::DbAccessor *dba, storage::Lab
 
 }  // namespace
 
-PullPlanDump::PullPlanDump(DbAccessor *dba)
+PullPlanDump::PullPlanDump(DbAccessor *dba, std::optional<uint64_t> as_of)
     : dba_(dba),
+      as_of_(as_of),
+      history_pool_(as_of ? std::make_unique<utils::ThreadPool>(std::max(1U, std::thread::hardware_concurrency()))
+                          : nullptr),
       vertices_iterable_(dba->Vertices(storage::View::OLD)),
       pull_chunks_{// Dump all label indices
                    CreateLabelIndicesPullChunk(),
@@ -276,9 +386,11 @@ PullPlanDump::PullPlanDump(DbAccessor *dba)
                    // Create internal index for faster edge creation
                    CreateInternalIndexPullChunk(),
                    // Dump all vertices
-                   CreateVertexPullChunk(),
+                   as_of ? CreateVertexAsOfPullChunk() : CreateVertexPullChunk(),
                    // Dump all edges
-                   CreateEdgePullChunk(),
+                   as_of ? CreateEdgeAsOfPullChunk() : CreateEdgePullChunk(),
+                   // Dump the edges of a past state removed from the storage
+                   CreateRemovedEdgeAsOfPullChunk(),
                    // Drop the internal index
                    CreateDropInternalIndexPullChunk(),
                    // Internal index cleanup
@@ -420,7 +532,8 @@ PullPlanDump::PullChunk PullPlanDump::CreateUniqueConstraintsPullChunk() {
 
 PullPlanDump::PullChunk PullPlanDump::CreateInternalIndexPullChunk() {
   return [this](AnyStream *stream, std::optional<int>) mutable -> std::optional<size_t> {
-    if (vertices_iterable_.begin() != vertices_iterable_.end()) {
+    // A past state may consist only of vertices removed from the storage.
+    if (as_of_ || vertices_iterable_.begin() != vertices_iterable_.end()) {
       std::ostringstream os;
       os << "CREATE INDEX ON :" << kInternalVertexLabel << "(" << kInternalPropertyId << ");";
       stream->Result({TypedValue(os.str())});
@@ -512,6 +625,164 @@ PullPlanDump::PullChunk PullPlanDump::CreateEdgePullChunk() {
   };
 }
 
+PullPlanDump::PullChunk PullPlanDump::CreateVertexAsOfPullChunk() {
+  // The vertices of the storage and the vertices with history are both
+  // ordered by gid and merged, a vertex in both is rebuilt from the two.
+  return [this, maybe_current_iter = std::optional<VertexAccessorIterableIterator>{},
+          batch = std::deque<std::pair<uint64_t, std::optional<history_delta::HistoryRecord>>>{},
+          next_gid = uint64_t{0}, history_done = false](AnyStream *stream,
+                                                        std::optional<int> n) mutable -> std::optional<size_t> {
+    if (!maybe_current_iter) {
+      maybe_current_iter.emplace(vertices_iterable_.begin());
+    }
+    auto &current_iter{*maybe_current_iter};
+    auto *history = &*dba_->GetHistoryDelta();
+    const auto timestamp = *as_of_;
+
+    size_t local_counter = 0;
+    while (!n || local_counter < *n) {
+      if (batch.empty() && !history_done) {
+        auto gids = history->GetVerticesWithHistory(timestamp, timestamp, next_gid, kAsOfBatchSize);
+        history_done = gids.size() < kAsOfBatchSize;
+        if (!gids.empty()) next_gid = gids.back() + 1;
+        auto records = RebuildBatch<std::optional<history_delta::HistoryRecord>>(
+            history_pool_.get(), gids, [&](uint64_t gid) { return VertexRecordAt(history, gid, timestamp); });
+        for (size_t i = 0; i < gids.size(); ++i) batch.emplace_back(gids[i], std::move(records[i]));
+      }
+      const bool live = current_iter != vertices_iterable_.end();
+      if (!live && batch.empty()) {
+        return local_counter;
+      }
+
+      std::ostringstream os;
+      bool dumped = false;
+      if (live && (batch.empty() || (*current_iter).Gid().AsUint() <= batch.front().first)) {
+        const auto &vertex = *current_iter;
+        auto gid = vertex.Gid().AsUint();
+        std::optional<history_delta::HistoryRecord> record;
+        if (!batch.empty() && batch.front().first == gid) {
+          record = std::move(batch.front().second);
+          batch.pop_front();
+        }
+        dumped = DumpVertexAsOf(&os, dba_, gid, vertex, record, timestamp);
+        ++current_iter;
+      } else {
+        // The vertex was deleted, it may still be kept in memory.
+        auto [gid, record] = std::move(batch.front());
+        batch.pop_front();
+        auto deleted_vertex = dba_->FindDeleteVertex(storage::Gid::FromUint(gid), storage::View::OLD);
+        dumped = DumpVertexAsOf(&os, dba_, gid, deleted_vertex, record, timestamp);
+      }
+      if (dumped) {
+        stream->Result({TypedValue(os.str())});
+        ++local_counter;
+      }
+    }
+
+    return std::nullopt;
+  };
+}
+
+PullPlanDump::PullChunk PullPlanDump::CreateEdgeAsOfPullChunk() {
+  return [this, maybe_current_vertex_iter = std::optional<VertexAccessorIterableIterator>{},
+          // we need to save the iterable which contains list of accessor so
+          // our saved iterator is valid in the next run
+          maybe_edge_iterable = std::shared_ptr<EdgeAccessorIterable>{nullptr},
+          maybe_current_edge_iter = std::optional<EdgeAccessorIterableIterator>{}](
+             AnyStream *stream, std::optional<int> n) mutable -> std::optional<size_t> {
+    if (!maybe_current_vertex_iter) {
+      maybe_current_vertex_iter.emplace(vertices_iterable_.begin());
+    }
+
+    auto &current_vertex_iter{*maybe_current_vertex_iter};
+    size_t local_counter = 0U;
+    for (; current_vertex_iter != vertices_iterable_.end() && (!n || local_counter < *n); ++current_vertex_iter) {
+      const auto &vertex = *current_vertex_iter;
+      if (!maybe_edge_iterable) {
+        maybe_edge_iterable = std::make_shared<EdgeAccessorIterable>(vertex.OutEdges(storage::View::OLD));
+      }
+      auto &maybe_edges = *maybe_edge_iterable;
+      MG_ASSERT(maybe_edges.HasValue(), "Invalid database state!");
+      auto current_edge_iter = maybe_current_edge_iter ? *maybe_current_edge_iter : maybe_edges->begin();
+      for (; current_edge_iter != maybe_edges->end() && (!n || local_counter < *n); ++current_edge_iter) {
+        std::ostringstream os;
+        if (!DumpEdgeAsOf(&os, dba_, *current_edge_iter, *as_of_)) continue;
+        stream->Result({TypedValue(os.str())});
+
+        ++local_counter;
+      }
+
+      if (current_edge_iter != maybe_edges->end()) {
+        maybe_current_edge_iter.emplace(current_edge_iter);
+        return std::nullopt;
+      }
+
+      maybe_current_edge_iter = std::nullopt;
+      maybe_edge_iterable = nullptr;
+    }
+
+    if (current_vertex_iter == vertices_iterable_.end()) {
+      return local_counter;
+    }
+
+    return std::nullopt;
+  };
+}
+
+PullPlanDump::PullChunk PullPlanDump::CreateRemovedEdgeAsOfPullChunk() {
+  // Edges removed from the storage are found through the removals recorded on
+  // their source vertices.
+  struct RemovedEdge {
+    int64_t from_id;
+    int64_t to_id;
+    storage::EdgeTypeId edge_type;
+    std::map<storage::PropertyId, storage::PropertyValue> properties;
+  };
+  return [this, batch = std::deque<RemovedEdge>{}, next_gid = uint64_t{0}, history_done = false](
+             AnyStream *stream, std::optional<int> n) mutable -> std::optional<size_t> {
+    if (!as_of_) return 0;
+    auto *history = &*dba_->GetHistoryDelta();
+    const auto timestamp = *as_of_;
+
+    size_t local_counter = 0;
+    while (!n || local_counter < *n) {
+      if (batch.empty() && !history_done) {
+        // Edges removed after the timestamp, the vertices which removed them
+        // may have changed since.
+        auto gids = history->GetVerticesWithHistory(timestamp, std::numeric_limits<uint64_t>::max(), next_gid,
+                                                    kAsOfBatchSize);
+        history_done = gids.size() < kAsOfBatchSize;
+        if (!gids.empty()) next_gid = gids.back() + 1;
+        auto edges = RebuildBatch<std::vector<RemovedEdge>>(history_pool_.get(), gids, [&](uint64_t gid) {
+          std::vector<RemovedEdge> removed;
+          for (const auto &[edge_gid, edge] :
+               history->GetRemovedEdges(gid, true, {}, timestamp, std::numeric_limits<uint64_t>::max())) {
+            auto record = EdgeRecordAt(history, edge_gid, timestamp);
+            if (!record) continue;
+            RemovedEdge version{edge.from_gid.AsInt(), edge.to_gid.AsInt(), edge.edge_type, {}};
+            ApplyHistoryRecord(*record, nullptr, &version.properties);
+            removed.push_back(std::move(version));
+          }
+          return removed;
+        });
+        for (auto &removed : edges) std::move(removed.begin(), removed.end(), std::back_inserter(batch));
+        continue;
+      }
+      if (batch.empty()) {
+        return local_counter;
+      }
+      std::ostringstream os;
+      const auto &edge = batch.front();
+      DumpEdge(&os, dba_, edge.from_id, edge.to_id, edge.edge_type, edge.properties);
+      batch.pop_front();
+      stream->Result({TypedValue(os.str())});
+      ++local_counter;
+    }
+
+    return std::nullopt;
+  };
+}
+
 PullPlanDump::PullChunk PullPlanDump::CreateDropInternalIndexPullChunk() {
   return [this](AnyStream *stream, std::optional<int>) {
     if (internal_index_created_) {
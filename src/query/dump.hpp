@@ -11,18 +11,25 @@
 
 #pragma once
 
+#include <memory>
+#include <optional>
 #include <ostream>
 
 #include "query/db_accessor.hpp"
 #include "query/stream.hpp"
 #include "storage/v2/storage.hpp"
+#include "utils/thread_pool.hpp"
 
 namespace query {
 
 void DumpDatabaseToCypherQueries(query::DbAccessor *dba, AnyStream *stream);
 
 struct PullPlanDump {
-  explicit PullPlanDump(query::DbAccessor *dba);
+  /// Dumps the current state of the database or, with `as_of`, the state
+  /// visible at that timestamp. The past state is rebuilt from the deltas kept
+  /// in memory and from the history store, which is read in batches of gids
+  /// split among threads.
+  explicit PullPlanDump(query::DbAccessor *dba, std::optional<uint64_t> as_of = std::nullopt);
 
   /// Pull the dump results lazily
   /// @return true if all results were returned, false otherwise
@@ -30,6 +37,10 @@ struct PullPlanDump {
 
  private:
   query::DbAccessor *dba_ = nullptr;
+  std::optional<uint64_t> as_of_;
+  // Rebuilds the objects of a batch from the history store, only set when a
+  // past state is dumped.
+  std::unique_ptr<utils::ThreadPool> history_pool_;
 
   std::optional<storage::IndicesInfo> indices_info_ = std::nullopt;
   std::optional<storage::ConstraintsInfo> constraints_info_ = std::nullopt;
@@ -60,6 +71,9 @@ struct PullPlanDump {
   PullChunk CreateInternalIndexPullChunk();
   PullChunk CreateVertexPullChunk();
   PullChunk CreateEdgePullChunk();
+  PullChunk CreateVertexAsOfPullChunk();
+  PullChunk CreateEdgeAsOfPullChunk();
+  PullChunk CreateRemovedEdgeAsOfPullChunk();
   PullChunk CreateDropInternalIndexPullChunk();
   PullChunk CreateInternalIndexCleanupPullChunk();
 };
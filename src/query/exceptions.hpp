@@ -200,6 +200,12 @@ class TriggerModificationInMulticommandTxException : public QueryException {
       : QueryException("Trigger queries not allowed in multicommand transactions.") {}
 };
 
+class TemporalRollupInMulticommandTxException : public QueryException {
+ public:
+  TemporalRollupInMulticommandTxException()
+      : QueryException("Temporal rollup queries are not allowed in multicommand transactions.") {}
+};
+
 class StreamQueryInMulticommandTxException : public QueryException {
  public:
   StreamQueryInMulticommandTxException()
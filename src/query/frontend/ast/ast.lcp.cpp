@@ -26,6 +26,9 @@ const utils::TypeInfo query::Where::kType{0x39448BD33A0696DAULL, "Where",
 const utils::TypeInfo query::Tt::kType{0xFFD39EFC73DCC623ULL, "Tt",
                                        &query::Tree::kType};
 
+const utils::TypeInfo query::Vt::kType{0x5E1C7A93D04B2F6AULL, "Vt",
+                                       &query::Tree::kType};
+
 const utils::TypeInfo query::BinaryOperator::kType{
     0x9233B629DA1AFE3EULL, "BinaryOperator", &query::Expression::kType};
 
@@ -272,6 +275,9 @@ const utils::TypeInfo query::FreeMemoryQuery::kType{
 const utils::TypeInfo query::TriggerQuery::kType{
     0x2904D628D8A52B7BULL, "TriggerQuery", &query::Query::kType};
 
+const utils::TypeInfo query::TemporalRollupQuery::kType{
+    0x5F0A3C9E71B2D846ULL, "TemporalRollupQuery", &query::Query::kType};
+
 const utils::TypeInfo query::IsolationLevelQuery::kType{
     0x72D37B05E02C69B7ULL, "IsolationLevelQuery", &query::Query::kType};
 
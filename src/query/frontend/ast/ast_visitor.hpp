@@ -69,6 +69,7 @@ class IfOperator;
 class Delete;
 class Where;
 class Tt;
+class Vt;
 class SetProperty;
 class SetProperties;
 class SetLabels;
@@ -89,6 +90,7 @@ class LockPathQuery;
 class LoadCsv;
 class FreeMemoryQuery;
 class TriggerQuery;
+class TemporalRollupQuery;
 class IsolationLevelQuery;
 class CreateSnapshotQuery;
 class StreamQuery;
@@ -102,7 +104,7 @@ using TreeCompositeVisitor = ::utils::CompositeVisitor<
     LessOperator, GreaterOperator, LessEqualOperator, GreaterEqualOperator, InListOperator, SubscriptOperator,
     ListSlicingOperator, IfOperator, UnaryPlusOperator, UnaryMinusOperator, IsNullOperator, ListLiteral, MapLiteral,
     PropertyLookup, LabelsTest, Aggregation, Function, Reduce, Coalesce, Extract, All, Single, Any, None, CallProcedure,
-    Create, Match, Return, With, Pattern, NodeAtom, EdgeAtom, Delete, Where, Tt, SetProperty, SetProperties, SetLabels,
+    Create, Match, Return, With, Pattern, NodeAtom, EdgeAtom, Delete, Where, Tt, Vt, SetProperty, SetProperties, SetLabels,
     RemoveProperty, RemoveLabels, Merge, Unwind, RegexMatch, LoadCsv>;
 
 using TreeLeafVisitor = ::utils::LeafVisitor<Identifier, PrimitiveLiteral, ParameterLookup>;
@@ -129,6 +131,7 @@ template <class TResult>
 class QueryVisitor : public ::utils::Visitor<TResult, CypherQuery, ExplainQuery, ProfileQuery, IndexQuery, AuthQuery,
                                              InfoQuery, ConstraintQuery, DumpQuery, ReplicationQuery, LockPathQuery,
                                              FreeMemoryQuery, TriggerQuery, IsolationLevelQuery, CreateSnapshotQuery,
-                                             StreamQuery, SettingQuery, VersionQuery, SnapshotQuery> {};
+                                             StreamQuery, SettingQuery, VersionQuery, SnapshotQuery,
+                                             TemporalRollupQuery> {};
 
 }  // namespace query
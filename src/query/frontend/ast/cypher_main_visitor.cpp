@@ -231,6 +231,7 @@ antlrcpp::Any CypherMainVisitor::visitAuthQuery(MemgraphCypher::AuthQueryContext
 
 antlrcpp::Any CypherMainVisitor::visitDumpQuery(MemgraphCypher::DumpQueryContext *ctx) {
   auto *dump_query = storage_->Create<DumpQuery>();
+  if (ctx->asOf) dump_query->as_of_ = ctx->asOf->accept(this);
   query_ = dump_query;
   return dump_query;
 }
@@ -447,6 +448,56 @@ antlrcpp::Any CypherMainVisitor::visitShowTriggers(MemgraphCypher::ShowTriggersC
   return trigger_query;
 }
 
+antlrcpp::Any CypherMainVisitor::visitTemporalRollupQuery(MemgraphCypher::TemporalRollupQueryContext *ctx) {
+  MG_ASSERT(ctx->children.size() == 1, "TemporalRollupQuery should have exactly one child!");
+  auto *rollup_query = ctx->children[0]->accept(this).as<TemporalRollupQuery *>();
+  query_ = rollup_query;
+  return rollup_query;
+}
+
+antlrcpp::Any CypherMainVisitor::visitCreateTemporalRollup(MemgraphCypher::CreateTemporalRollupContext *ctx) {
+  auto *rollup_query = storage_->Create<TemporalRollupQuery>();
+  rollup_query->action_ = TemporalRollupQuery::Action::CREATE_TEMPORAL_ROLLUP;
+  rollup_query->rollup_name_ = ctx->rollupName()->symbolicName()->accept(this).as<std::string>();
+  rollup_query->label_ = AddLabel(ctx->labelName()->accept(this));
+  rollup_query->property_ = ctx->propertyKeyName()->accept(this).as<PropertyIx>();
+  static const std::unordered_map<std::string, TemporalRollupQuery::Aggregate> kAggregates{
+      {"count", TemporalRollupQuery::Aggregate::COUNT}, {"sum", TemporalRollupQuery::Aggregate::SUM},
+      {"min", TemporalRollupQuery::Aggregate::MIN},     {"max", TemporalRollupQuery::Aggregate::MAX},
+      {"avg", TemporalRollupQuery::Aggregate::AVG}};
+  auto aggregate = kAggregates.find(utils::ToLowerCase(ctx->aggregate->accept(this).as<std::string>()));
+  if (aggregate == kAggregates.end()) {
+    throw SemanticException("A temporal rollup aggregates with COUNT, SUM, MIN, MAX or AVG.");
+  }
+  rollup_query->aggregate_ = aggregate->second;
+  if (!ctx->width->numberLiteral() || !ctx->width->numberLiteral()->integerLiteral()) {
+    throw SyntaxException("The width of the rollup buckets must be an integer literal!");
+  }
+  rollup_query->width_ = ctx->width->accept(this);
+  return rollup_query;
+}
+
+antlrcpp::Any CypherMainVisitor::visitDropTemporalRollup(MemgraphCypher::DropTemporalRollupContext *ctx) {
+  auto *rollup_query = storage_->Create<TemporalRollupQuery>();
+  rollup_query->action_ = TemporalRollupQuery::Action::DROP_TEMPORAL_ROLLUP;
+  rollup_query->rollup_name_ = ctx->rollupName()->symbolicName()->accept(this).as<std::string>();
+  return rollup_query;
+}
+
+antlrcpp::Any CypherMainVisitor::visitShowTemporalRollups(MemgraphCypher::ShowTemporalRollupsContext *ctx) {
+  auto *rollup_query = storage_->Create<TemporalRollupQuery>();
+  rollup_query->action_ = TemporalRollupQuery::Action::SHOW_TEMPORAL_ROLLUPS;
+  return rollup_query;
+}
+
+antlrcpp::Any CypherMainVisitor::visitShowTemporalRollup(MemgraphCypher::ShowTemporalRollupContext *ctx) {
+  auto *rollup_query = storage_->Create<TemporalRollupQuery>();
+  rollup_query->action_ = TemporalRollupQuery::Action::SHOW_TEMPORAL_ROLLUP;
+  rollup_query->rollup_name_ = ctx->rollupName()->symbolicName()->accept(this).as<std::string>();
+  if (ctx->tt()) rollup_query->tt_ = ctx->tt()->accept(this);
+  return rollup_query;
+}
+
 antlrcpp::Any CypherMainVisitor::visitIsolationLevelQuery(MemgraphCypher::IsolationLevelQueryContext *ctx) {
   auto *isolation_level_query = storage_->Create<IsolationLevelQuery>();
 
@@ -1057,6 +1108,9 @@ antlrcpp::Any CypherMainVisitor::visitCypherMatch(MemgraphCypher::CypherMatchCon
   if (ctx->tt()) {
     match->tt_= ctx->tt()->accept(this);
   }
+  if (ctx->vt()) {
+    match->vt_ = ctx->vt()->accept(this);
+  }
   //wzy edit end
   match->patterns_ = ctx->pattern()->accept(this).as<std::vector<Pattern *>>();
   return match;
@@ -2116,6 +2170,16 @@ antlrcpp::Any CypherMainVisitor::visitFunctionInvocation(MemgraphCypher::Functio
         storage_->Create<Aggregation>(expressions[1], expressions[0], Aggregation::Op::COLLECT_MAP));
   }
 
+  if (function_name == Aggregation::kTtWindow) {
+    // The versions are told apart by the variable the property is read from.
+    auto *lookup = expressions.size() == 2U ? utils::Downcast<PropertyLookup>(expressions[0]) : nullptr;
+    if (!lookup || !utils::Downcast<Identifier>(lookup->expression_)) {
+      throw SemanticException("TT_WINDOW takes a property of a variable and the width of the windows.");
+    }
+    return static_cast<Expression *>(
+        storage_->Create<Aggregation>(expressions[0], expressions[1], Aggregation::Op::TT_WINDOW));
+  }
+
   auto function = NameToFunction(function_name);
   if (!function) throw SemanticException("Function '{}' doesn't exist.", function_name);
   return static_cast<Expression *>(storage_->Create<Function>(function_name, expressions));
@@ -2167,14 +2231,24 @@ antlrcpp::Any CypherMainVisitor::visitWhere(MemgraphCypher::WhereContext *ctx) {
 antlrcpp::Any CypherMainVisitor::visitTt(MemgraphCypher::TtContext *ctx) {
   auto *tt = storage_->Create<Tt>();
   if(ctx->AS()){
-    tt->tt_left_ =ctx->as_literal->accept(this);// ctx->_localctx->as_literal->accept(this);
-    tt->tt_right_ =ctx->as_literal->accept(this);// ctx->_localctx->as_literal->accept(this);
+    tt->tt_left_ = ctx->as_expression->accept(this);
     return tt;
   }
-  tt->tt_left_ = ctx->from_literal->accept(this);
-  tt->tt_right_ = ctx->to_literal->accept(this);
+  tt->tt_left_ = ctx->from_expression->accept(this);
+  tt->tt_right_ = ctx->to_expression->accept(this);
   return tt;
 }
+
+antlrcpp::Any CypherMainVisitor::visitVt(MemgraphCypher::VtContext *ctx) {
+  auto *vt = storage_->Create<Vt>();
+  if (ctx->AS()) {
+    vt->vt_left_ = ctx->as_expression->accept(this);
+    return vt;
+  }
+  vt->vt_left_ = ctx->from_expression->accept(this);
+  vt->vt_right_ = ctx->to_expression->accept(this);
+  return vt;
+}
 //wzy edit end
 
 antlrcpp::Any CypherMainVisitor::visitSet(MemgraphCypher::SetContext *ctx) {
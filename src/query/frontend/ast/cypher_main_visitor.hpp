@@ -249,6 +249,31 @@ class CypherMainVisitor : public antlropencypher::MemgraphCypherBaseVisitor {
    */
   antlrcpp::Any visitShowTriggers(MemgraphCypher::ShowTriggersContext *ctx) override;
 
+  /**
+   * @return TemporalRollupQuery*
+   */
+  antlrcpp::Any visitTemporalRollupQuery(MemgraphCypher::TemporalRollupQueryContext *ctx) override;
+
+  /**
+   * @return TemporalRollupQuery*
+   */
+  antlrcpp::Any visitCreateTemporalRollup(MemgraphCypher::CreateTemporalRollupContext *ctx) override;
+
+  /**
+   * @return TemporalRollupQuery*
+   */
+  antlrcpp::Any visitDropTemporalRollup(MemgraphCypher::DropTemporalRollupContext *ctx) override;
+
+  /**
+   * @return TemporalRollupQuery*
+   */
+  antlrcpp::Any visitShowTemporalRollups(MemgraphCypher::ShowTemporalRollupsContext *ctx) override;
+
+  /**
+   * @return TemporalRollupQuery*
+   */
+  antlrcpp::Any visitShowTemporalRollup(MemgraphCypher::ShowTemporalRollupContext *ctx) override;
+
   /**
    * @return IsolationLevelQuery*
    */
@@ -795,6 +820,8 @@ class CypherMainVisitor : public antlropencypher::MemgraphCypherBaseVisitor {
 
   antlrcpp::Any visitTt(MemgraphCypher::TtContext *ctx) override;
 
+  antlrcpp::Any visitVt(MemgraphCypher::VtContext *ctx) override;
+
   /**
    * return vector<Clause*>
    */
@@ -76,11 +76,11 @@ clause : cypherMatch
 
 cypherMatch : OPTIONAL? MATCH pattern where? tt? vt?;
 
-tt : TT AS as_literal=literal
-   | TT FROM from_literal=literal TO to_literal=literal;
+tt : TT AS as_expression=expression
+   | TT FROM from_expression=expression TO to_expression=expression;
 
-vt : VT AS as_vliteral=literal
-   | VT From from_vliteral=literal TO to_vliteral=literal;
+vt : VT AS as_expression=expression
+   | VT FROM from_expression=expression TO to_expression=expression;
 
 unwind : UNWIND expression AS variable ;
 
@@ -383,6 +383,7 @@ cypherKeyword : ALL
               | TO
               | TRUE
               | TT
+              | VT
               | UNION
               | UNIQUE
               | UNWIND
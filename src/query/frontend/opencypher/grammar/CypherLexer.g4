@@ -134,6 +134,7 @@ THEN           : T H E N ;
 TO             : T O ;
 TRUE           : T R U E ;
 TT             : T T ;
+VT             : V T ;
 UNION          : U N I O N ;
 UNIQUE         : U N I Q U E ;
 UNLIMITED      : U N L I M I T E D ;
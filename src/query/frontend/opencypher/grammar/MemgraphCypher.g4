@@ -45,6 +45,7 @@ memgraphCypherKeyword : cypherKeyword
                       | DENY
                       | DROP
                       | DUMP
+                      | EVERY
                       | EXECUTE
                       | FOR
                       | FREE
@@ -74,6 +75,8 @@ memgraphCypherKeyword : cypherKeyword
                       | REVOKE
                       | ROLE
                       | ROLES
+                      | ROLLUP
+                      | ROLLUPS
                       | QUOTE
                       | SESSION
                       | SETTING
@@ -84,6 +87,7 @@ memgraphCypherKeyword : cypherKeyword
                       | STREAM
                       | STREAMS
                       | SYNC
+                      | TEMPORAL
                       | TIMEOUT
                       | TO
                       | TOPICS
@@ -116,6 +120,7 @@ query : cypherQuery
       | lockPathQuery
       | freeMemoryQuery
       | triggerQuery
+      | temporalRollupQuery
       | isolationLevelQuery
       | createSnapshotQuery
       | streamQuery
@@ -153,6 +158,12 @@ triggerQuery : createTrigger
              | showTriggers
              ;
 
+temporalRollupQuery : createTemporalRollup
+                    | dropTemporalRollup
+                    | showTemporalRollups
+                    | showTemporalRollup
+                    ;
+
 clause : cypherMatch
        | unwind
        | merge
@@ -254,7 +265,7 @@ showRoleForUser : SHOW ROLE FOR user=userOrRoleName ;
 
 showUsersForRole : SHOW USERS FOR role=userOrRoleName ;
 
-dumpQuery: DUMP DATABASE ;
+dumpQuery: DUMP DATABASE ( TT AS asOf=expression )? ;
 
 setReplicationRole  : SET REPLICATION ROLE TO ( MAIN | REPLICA )
                       ( WITH PORT port=literal ) ? ;
@@ -292,6 +303,17 @@ dropTrigger : DROP TRIGGER triggerName ;
 
 showTriggers : SHOW TRIGGERS ;
 
+rollupName : symbolicName ;
+
+createTemporalRollup : CREATE TEMPORAL ROLLUP rollupName ON ':' labelName '(' propertyKeyName ')'
+                     AS aggregate=symbolicName EVERY width=literal ;
+
+dropTemporalRollup : DROP TEMPORAL ROLLUP rollupName ;
+
+showTemporalRollups : SHOW TEMPORAL ROLLUPS ;
+
+showTemporalRollup : SHOW TEMPORAL ROLLUP rollupName tt? ;
+
 isolationLevel : SNAPSHOT ISOLATION | READ COMMITTED | READ UNCOMMITTED ;
 
 isolationLevelScope : GLOBAL | SESSION | NEXT ;
@@ -53,6 +53,7 @@ DROP                : D R O P ;
 DUMP                : D U M P ;
 DURABILITY          : D U R A B I L I T Y ;
 EXECUTE             : E X E C U T E ;
+EVERY               : E V E R Y ;
 FOR                 : F O R ;
 FREE                : F R E E ;
 FREE_MEMORY         : F R E E UNDERSCORE M E M O R Y ;
@@ -87,6 +88,8 @@ REPLICATION         : R E P L I C A T I O N ;
 REVOKE              : R E V O K E ;
 ROLE                : R O L E ;
 ROLES               : R O L E S ;
+ROLLUP              : R O L L U P ;
+ROLLUPS             : R O L L U P S ;
 QUOTE               : Q U O T E ;
 SERVICE_URL         : S E R V I C E UNDERSCORE U R L ;
 SESSION             : S E S S I O N ;
@@ -99,6 +102,7 @@ STOP                : S T O P ;
 STREAM              : S T R E A M ;
 STREAMS             : S T R E A M S ;
 SYNC                : S Y N C ;
+TEMPORAL            : T E M P O R A L ;
 TIMEOUT             : T I M E O U T ;
 TO                  : T O ;
 TOPICS              : T O P I C S;
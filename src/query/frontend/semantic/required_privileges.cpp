@@ -68,6 +68,19 @@ class PrivilegeExtractor : public QueryVisitor<void>, public HierarchicalTreeVis
 
   void Visit(TriggerQuery &trigger_query) override { AddPrivilege(AuthQuery::Privilege::TRIGGER); }
 
+  void Visit(TemporalRollupQuery &rollup_query) override {
+    switch (rollup_query.action_) {
+      case TemporalRollupQuery::Action::CREATE_TEMPORAL_ROLLUP:
+      case TemporalRollupQuery::Action::DROP_TEMPORAL_ROLLUP:
+        AddPrivilege(AuthQuery::Privilege::INDEX);
+        break;
+      case TemporalRollupQuery::Action::SHOW_TEMPORAL_ROLLUPS:
+      case TemporalRollupQuery::Action::SHOW_TEMPORAL_ROLLUP:
+        AddPrivilege(AuthQuery::Privilege::STATS);
+        break;
+    }
+  }
+
   void Visit(StreamQuery &stream_query) override { AddPrivilege(AuthQuery::Privilege::STREAM); }
 
   void Visit(ReplicationQuery &replication_query) override { AddPrivilege(AuthQuery::Privilege::REPLICATION); }
@@ -229,6 +229,24 @@ bool SymbolGenerator::PostVisit(Where &) {
   return true;
 }
 
+bool SymbolGenerator::PreVisit(Tt &) {
+  scope_.in_tt = true;
+  return true;
+}
+bool SymbolGenerator::PostVisit(Tt &) {
+  scope_.in_tt = false;
+  return true;
+}
+
+bool SymbolGenerator::PreVisit(Vt &) {
+  scope_.in_vt = true;
+  return true;
+}
+bool SymbolGenerator::PostVisit(Vt &) {
+  scope_.in_vt = false;
+  return true;
+}
+
 bool SymbolGenerator::PreVisit(Merge &) {
   scope_.in_merge = true;
   return true;
@@ -270,6 +288,11 @@ SymbolGenerator::ReturnType SymbolGenerator::Visit(Identifier &ident) {
   if (scope_.in_skip || scope_.in_limit) {
     throw SemanticException("Variables are not allowed in {}.", scope_.in_skip ? "SKIP" : "LIMIT");
   }
+  // The windows of TT and VT clauses are evaluated once, before the query is
+  // run.
+  if (scope_.in_tt || scope_.in_vt) {
+    throw SemanticException("Variables are not allowed in {}.", scope_.in_tt ? "TT" : "VT");
+  }
   Symbol symbol;
   if (scope_.in_pattern && !(scope_.in_node_atom || scope_.visiting_edge)) {
     // If we are in the pattern, and outside of a node or an edge, the
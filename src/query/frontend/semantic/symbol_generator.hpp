@@ -54,6 +54,10 @@ class SymbolGenerator : public HierarchicalTreeVisitor {
   bool PreVisit(With &) override;
   bool PreVisit(Where &) override;
   bool PostVisit(Where &) override;
+  bool PreVisit(Tt &) override;
+  bool PostVisit(Tt &) override;
+  bool PreVisit(Vt &) override;
+  bool PostVisit(Vt &) override;
   bool PreVisit(Merge &) override;
   bool PostVisit(Merge &) override;
   bool PostVisit(Unwind &) override;
@@ -106,6 +110,8 @@ class SymbolGenerator : public HierarchicalTreeVisitor {
     bool in_limit{false};
     bool in_order_by{false};
     bool in_where{false};
+    bool in_tt{false};
+    bool in_vt{false};
     bool in_match{false};
     // True when visiting a pattern atom (node or edge) identifier, which can be
     // reused or created in the pattern itself.
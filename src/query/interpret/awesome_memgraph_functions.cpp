@@ -1061,6 +1061,23 @@ TypedValue FromByteString(const TypedValue *args, int64_t nargs, const FunctionC
   return TypedValue(std::move(str));
 }
 
+// Returns the statistics used to place the anchors of a vertex or an edge in
+// the history store.
+TypedValue AnchorStats(const TypedValue *args, int64_t nargs, const FunctionContext &ctx) {
+  FType<Or<Null, Vertex, Edge>>("anchorStats", args, nargs);
+  const auto &value = args[0];
+  if (value.IsNull()) return TypedValue(ctx.memory);
+  auto stats = value.IsVertex() ? value.ValueVertex().GetAnchorStats() : value.ValueEdge().GetAnchorStats();
+  TypedValue::TMap result(ctx.memory);
+  result.emplace("versions", static_cast<int64_t>(stats.versions));
+  result.emplace("sinceAnchor", static_cast<int64_t>(stats.since_anchor));
+  result.emplace("interval", static_cast<int64_t>(stats.interval));
+  result.emplace("anchors", static_cast<int64_t>(stats.anchors));
+  result.emplace("historyReads", static_cast<int64_t>(stats.history_reads));
+  result.emplace("deltaBytes", static_cast<int64_t>(stats.delta_bytes));
+  return TypedValue(std::move(result));
+}
+
 template <typename T>
 concept IsNumberOrInteger = utils::SameAsAnyOf<T, Number, Integer>;
 
@@ -1257,6 +1274,7 @@ std::function<TypedValue(const TypedValue *, int64_t, const FunctionContext &ctx
   if (function_name == "COUNTER") return Counter;
   if (function_name == "TOBYTESTRING") return ToByteString;
   if (function_name == "FROMBYTESTRING") return FromByteString;
+  if (function_name == "ANCHORSTATS") return AnchorStats;
 
   // Functions for temporal types
   if (function_name == "DATE") return Date;
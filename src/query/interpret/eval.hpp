@@ -765,23 +765,23 @@ class ExpressionEvaluator : public ExpressionVisitor<TypedValue> {
   //hjm begin
   template <typename TRecord>
   storage::PropertyValue GetHistoryProperty(const TRecord &record_accessor, const std::string_view &name) {
-    auto record_prop = record_accessor.properties;//.GetProperty(dba_->NameToProperty(name));
-    auto prop_id=dba_->NameToProperty(name);
-    if(record_prop.find(prop_id)==record_prop.end()){
+    const auto &record_prop = record_accessor.Properties();//.GetProperty(dba_->NameToProperty(name));
+    auto found=record_prop.find(dba_->NameToProperty(name));
+    if(found==record_prop.end()){
       return storage::PropertyValue();
     }else{
-      return record_prop[prop_id];
+      return found->second;
     }
     // return record_prop[prop_id];
   }
   template <typename TRecord>
   storage::PropertyValue GetHistoryProperty(const TRecord &record_accessor, PropertyIx prop) {
-    auto record_prop = record_accessor.properties;//.GetProperty( ctx_->properties[prop.ix]);
-    auto prop_id=ctx_->properties[prop.ix];
-    if(record_prop.find(prop_id)==record_prop.end()){
+    const auto &record_prop = record_accessor.Properties();//.GetProperty( ctx_->properties[prop.ix]);
+    auto found=record_prop.find(ctx_->properties[prop.ix]);
+    if(found==record_prop.end()){
       return storage::PropertyValue();
     }else{
-      return record_prop[prop_id];
+      return found->second;
     }
     // return record_prop[prop_id];
   }
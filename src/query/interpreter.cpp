@@ -827,6 +827,26 @@ Callback HandleSettingQuery(SettingQuery *setting_query, const Parameters &param
   }
 }
 
+// Evaluates the window of the `TT` or `VT` clause of the plan. Cached plans are
+// shared by all sessions and by queries reading different windows, so the
+// window is only kept in the execution context of the query.
+std::optional<TemporalBounds> EvaluateTemporalBounds(const std::optional<std::pair<Expression *, Expression *>> &bounds,
+                                                     const char *clause, ExpressionEvaluator *evaluator) {
+  if (!bounds) return std::nullopt;
+  auto evaluate = [evaluator, clause](Expression *expression) {
+    auto value = expression->Accept(*evaluator);
+    if (!value.IsInt()) {
+      throw QueryRuntimeException("The bounds of {} have to be integers, got {}.", clause, value.type());
+    }
+    if (value.ValueInt() < 0) throw QueryRuntimeException("The bounds of {} can't be negative.", clause);
+    return value.ValueInt();
+  };
+  auto ts = evaluate(bounds->first);
+  auto te = bounds->second ? evaluate(bounds->second) : ts;
+  if (ts > te) throw QueryRuntimeException("The start of the {} window is after its end.", clause);
+  return TemporalBounds{ts, te};
+}
+
 // Struct for lazy pulling from a vector
 struct PullPlanVector {
   explicit PullPlanVector(std::vector<std::vector<TypedValue>> values) : values_(std::move(values)) {}
@@ -905,14 +925,9 @@ PullPlan::PullPlan(const std::shared_ptr<CachedPlan> plan, const Parameters &par
   ctx_.is_profile_query = is_profile_query;
   ctx_.trigger_context_collector = trigger_context_collector;
   
-  //hjm begin
-  auto &left=interpreter_context->addition;
-  auto &right=interpreter_context->addition_right;
-  ctx_.addition = left;//interpreter_context->addition;
-  ctx_.addition_right = right;//interpreter_context->addition_right;
-  left=std::nullopt;
-  right=std::nullopt;
-  //hjm end
+  ExpressionEvaluator evaluator(&frame_, ctx_.symbol_table, ctx_.evaluation_context, dba, storage::View::OLD);
+  ctx_.temporal_bounds = EvaluateTemporalBounds(plan->getHistoryInfo(), "TT", &evaluator);
+  ctx_.valid_bounds = EvaluateTemporalBounds(plan->getValidInfo(), "VT", &evaluator);
 
 }
 //wzy edit end
@@ -1005,7 +1020,6 @@ std::optional<plan::ProfilingStatsWithTotalTime> PullPlan::Pull(AnyStream *strea
   ctx_.all_vertex.clear();
   ctx_.all_vertex_flag.clear();
   // std::cout<<"interpreter shutdown\n";
-  // ctx_.db_accessor->ClearHistory();
   ctx_.profile_execution_time = execution_time_;
   return GetStatsWithTotalTime(ctx_);
 }
@@ -1118,18 +1132,6 @@ PreparedQuery PrepareCypherQuery(ParsedQuery parsed_query, std::map<std::string,
                                 parsed_query.parameters,
                                 parsed_query.is_cacheable ? &interpreter_context->plan_cache : nullptr, dba);
   
-  //hjm begin
-  try{
-    auto history_infos=plan->getHistoryInfo();
-    if(history_infos->first!=0){
-      // std::cout<<"0123456789 history_infos:"<<history_infos->first<<" "<<parsed_query.parameters.AtTokenPosition(history_infos->first).ValueInt()<<"\n";
-      interpreter_context->addition=parsed_query.parameters.AtTokenPosition(history_infos->first).ValueInt();
-      interpreter_context->addition_right=parsed_query.parameters.AtTokenPosition(history_infos->second).ValueInt();
-    }
-  }catch(...){
-
-  }
-  //hjm end
   summary->insert_or_assign("cost_estimate", plan->cost());
   auto rw_type_checker = plan::ReadWriteTypeChecker();
   rw_type_checker.InferRWType(const_cast<plan::LogicalOperator &>(plan->plan()));
@@ -1148,11 +1150,6 @@ PreparedQuery PrepareCypherQuery(ParsedQuery parsed_query, std::map<std::string,
         utils::FindOr(parsed_query.stripped_query.named_expressions(), symbol.token_position(), symbol.name()).first);
     
   }
-  //wzy edit
-  // interpreter_context->addition=parsed_query.stripped_query.addition();
-  // interpreter_context->addition_right=parsed_query.stripped_query.addition_r();
-  // std::cout<<"interpreter::1129: "<<*interpreter_context->addition<<std::endl;
-  // std::cout<<"interpreter::1130: "<<*interpreter_context->addition_right<<std::endl;
   auto pull_plan = std::make_shared<PullPlan>(plan, parsed_query.parameters, false, dba, interpreter_context,
                                               execution_memory, trigger_context_collector, memory_limit);
   return PreparedQuery{std::move(header), std::move(parsed_query.required_privileges),
@@ -1298,9 +1295,25 @@ PreparedQuery PrepareProfileQuery(ParsedQuery parsed_query, bool in_explicit_tra
 
 PreparedQuery PrepareDumpQuery(ParsedQuery parsed_query, std::map<std::string, TypedValue> *summary, DbAccessor *dba,
                                utils::MemoryResource *execution_memory) {
+  auto *dump_query = utils::Downcast<DumpQuery>(parsed_query.query);
+  std::optional<uint64_t> as_of;
+  if (dump_query->as_of_) {
+    if (!dba->GetHistoryDelta()) throw QueryRuntimeException("DUMP DATABASE TT AS requires the history store.");
+    Frame frame(0);
+    SymbolTable symbol_table;
+    EvaluationContext evaluation_context;
+    evaluation_context.timestamp = QueryTimestamp();
+    evaluation_context.parameters = parsed_query.parameters;
+    ExpressionEvaluator evaluator(&frame, symbol_table, evaluation_context, dba, storage::View::OLD);
+    auto value = dump_query->as_of_->Accept(evaluator);
+    if (!value.IsInt() || value.ValueInt() < 0) {
+      throw QueryRuntimeException("The timestamp of DUMP DATABASE TT AS has to be a non-negative integer.");
+    }
+    as_of = value.ValueInt();
+  }
   return PreparedQuery{{"QUERY"},
                        std::move(parsed_query.required_privileges),
-                       [pull_plan = std::make_shared<PullPlanDump>(dba)](
+                       [pull_plan = std::make_shared<PullPlanDump>(dba, as_of)](
                            AnyStream *stream, std::optional<int> n) -> std::optional<QueryHandlerResult> {
                          if (pull_plan->Pull(stream, n)) {
                            return QueryHandlerResult::COMMIT;
@@ -1672,6 +1685,164 @@ PreparedQuery PrepareTriggerQuery(ParsedQuery parsed_query, const bool in_explic
   // NOLINTNEXTLINE(clang-analyzer-cplusplus.NewDeleteLeaks)
 }
 
+history_delta::TemporalRollup::Aggregate ToRollupAggregate(const TemporalRollupQuery::Aggregate aggregate) {
+  switch (aggregate) {
+    case TemporalRollupQuery::Aggregate::COUNT:
+      return history_delta::TemporalRollup::Aggregate::COUNT;
+    case TemporalRollupQuery::Aggregate::SUM:
+      return history_delta::TemporalRollup::Aggregate::SUM;
+    case TemporalRollupQuery::Aggregate::MIN:
+      return history_delta::TemporalRollup::Aggregate::MIN;
+    case TemporalRollupQuery::Aggregate::MAX:
+      return history_delta::TemporalRollup::Aggregate::MAX;
+    case TemporalRollupQuery::Aggregate::AVG:
+      return history_delta::TemporalRollup::Aggregate::AVG;
+  }
+}
+
+std::string RollupAggregateToString(const history_delta::TemporalRollup::Aggregate aggregate) {
+  switch (aggregate) {
+    case history_delta::TemporalRollup::Aggregate::COUNT:
+      return "COUNT";
+    case history_delta::TemporalRollup::Aggregate::SUM:
+      return "SUM";
+    case history_delta::TemporalRollup::Aggregate::MIN:
+      return "MIN";
+    case history_delta::TemporalRollup::Aggregate::MAX:
+      return "MAX";
+    case history_delta::TemporalRollup::Aggregate::AVG:
+      return "AVG";
+  }
+}
+
+Callback CreateTemporalRollup(TemporalRollupQuery *rollup_query, InterpreterContext *interpreter_context,
+                              ExpressionEvaluator *evaluator) {
+  auto width = rollup_query->width_->Accept(*evaluator);
+  if (!width.IsInt() || width.ValueInt() <= 0) {
+    throw QueryRuntimeException("The width of the rollup buckets must be a positive integer.");
+  }
+  auto *db = interpreter_context->db;
+  return {{},
+          [db, name = std::move(rollup_query->rollup_name_), label = db->NameToLabel(rollup_query->label_.name),
+           property = db->NameToProperty(rollup_query->property_.name),
+           aggregate = ToRollupAggregate(rollup_query->aggregate_),
+           width = static_cast<uint64_t>(width.ValueInt())]() -> std::vector<std::vector<TypedValue>> {
+            if (!db->CreateTemporalRollup(name, label, property, aggregate, width)) {
+              throw QueryRuntimeException("Temporal rollup {} already exists.", name);
+            }
+            return {};
+          }};
+}
+
+Callback DropTemporalRollup(TemporalRollupQuery *rollup_query, InterpreterContext *interpreter_context) {
+  return {{},
+          [db = interpreter_context->db,
+           name = std::move(rollup_query->rollup_name_)]() -> std::vector<std::vector<TypedValue>> {
+            if (!db->DropTemporalRollup(name)) {
+              throw QueryRuntimeException("Temporal rollup {} doesn't exist.", name);
+            }
+            return {};
+          }};
+}
+
+Callback ShowTemporalRollups(InterpreterContext *interpreter_context) {
+  return {{"rollup name", "label", "property", "aggregate", "width", "since"},
+          [db = interpreter_context->db] {
+            std::vector<std::vector<TypedValue>> results;
+            for (const auto &rollup : db->ListTemporalRollups()) {
+              results.push_back({TypedValue(rollup.name), TypedValue(db->LabelToName(rollup.label)),
+                                 TypedValue(db->PropertyToName(rollup.property)),
+                                 TypedValue(RollupAggregateToString(rollup.aggregate)),
+                                 TypedValue(static_cast<int64_t>(rollup.width)),
+                                 TypedValue(static_cast<int64_t>(rollup.since))});
+            }
+            return results;
+          }};
+}
+
+// Reads the buckets of a rollup, which overlap the window of the TT clause if
+// there is one.
+Callback ShowTemporalRollup(TemporalRollupQuery *rollup_query, InterpreterContext *interpreter_context,
+                            ExpressionEvaluator *evaluator) {
+  uint64_t ts = 0;
+  uint64_t te = std::numeric_limits<int64_t>::max();
+  if (rollup_query->tt_) {
+    auto timestamp = [evaluator](Expression *expression) {
+      auto value = expression->Accept(*evaluator);
+      if (!value.IsInt() || value.ValueInt() < 0) {
+        throw QueryRuntimeException("The timestamps of a TT clause have to be non-negative integers.");
+      }
+      return static_cast<uint64_t>(value.ValueInt());
+    };
+    ts = timestamp(rollup_query->tt_->tt_left_);
+    te = rollup_query->tt_->tt_right_ ? timestamp(rollup_query->tt_->tt_right_) : ts;
+  }
+  return {{"start", "end", "count", "value"},
+          [db = interpreter_context->db, name = std::move(rollup_query->rollup_name_), ts, te] {
+            auto rollups = db->ListTemporalRollups();
+            auto rollup = std::find_if(rollups.begin(), rollups.end(), [&](const auto &r) { return r.name == name; });
+            auto buckets = db->TemporalRollupBuckets(name, ts, te);
+            if (rollup == rollups.end() || !buckets) {
+              throw QueryRuntimeException("Temporal rollup {} doesn't exist.", name);
+            }
+            std::vector<std::vector<TypedValue>> results;
+            results.reserve(buckets->size());
+            for (const auto &bucket : *buckets) {
+              results.push_back({TypedValue(static_cast<int64_t>(bucket.start)),
+                                 TypedValue(static_cast<int64_t>(bucket.end)),
+                                 TypedValue(static_cast<int64_t>(bucket.count)),
+                                 TypedValue(bucket.Value(rollup->aggregate))});
+            }
+            return results;
+          }};
+}
+
+PreparedQuery PrepareTemporalRollupQuery(ParsedQuery parsed_query, const bool in_explicit_transaction,
+                                         InterpreterContext *interpreter_context, DbAccessor *dba) {
+  if (in_explicit_transaction) {
+    throw TemporalRollupInMulticommandTxException();
+  }
+
+  auto *rollup_query = utils::Downcast<TemporalRollupQuery>(parsed_query.query);
+  MG_ASSERT(rollup_query);
+
+  Frame frame(0);
+  SymbolTable symbol_table;
+  EvaluationContext evaluation_context;
+  evaluation_context.timestamp = QueryTimestamp();
+  evaluation_context.parameters = parsed_query.parameters;
+  ExpressionEvaluator evaluator(&frame, symbol_table, evaluation_context, dba, storage::View::OLD);
+
+  auto callback = std::invoke([rollup_query, interpreter_context, &evaluator]() {
+    switch (rollup_query->action_) {
+      case TemporalRollupQuery::Action::CREATE_TEMPORAL_ROLLUP:
+        return CreateTemporalRollup(rollup_query, interpreter_context, &evaluator);
+      case TemporalRollupQuery::Action::DROP_TEMPORAL_ROLLUP:
+        return DropTemporalRollup(rollup_query, interpreter_context);
+      case TemporalRollupQuery::Action::SHOW_TEMPORAL_ROLLUPS:
+        return ShowTemporalRollups(interpreter_context);
+      case TemporalRollupQuery::Action::SHOW_TEMPORAL_ROLLUP:
+        return ShowTemporalRollup(rollup_query, interpreter_context, &evaluator);
+    }
+  });
+
+  return PreparedQuery{std::move(callback.header), std::move(parsed_query.required_privileges),
+                       [callback_fn = std::move(callback.fn), pull_plan = std::shared_ptr<PullPlanVector>{nullptr}](
+                           AnyStream *stream, std::optional<int> n) mutable -> std::optional<QueryHandlerResult> {
+                         if (UNLIKELY(!pull_plan)) {
+                           pull_plan = std::make_shared<PullPlanVector>(callback_fn());
+                         }
+
+                         if (pull_plan->Pull(stream, n)) {
+                           return QueryHandlerResult::COMMIT;
+                         }
+                         return std::nullopt;
+                       },
+                       RWType::NONE};
+  // False positive report for the std::make_shared above
+  // NOLINTNEXTLINE(clang-analyzer-cplusplus.NewDeleteLeaks)
+}
+
 PreparedQuery PrepareStreamQuery(ParsedQuery parsed_query, const bool in_explicit_transaction,
                                  std::vector<Notification> *notifications, InterpreterContext *interpreter_context,
                                  DbAccessor *dba,
@@ -1835,6 +2006,20 @@ PreparedQuery PrepareInfoQuery(ParsedQuery parsed_query, bool in_explicit_transa
             {TypedValue("average_degree"), TypedValue(info.average_degree)},
             {TypedValue("memory_usage"), TypedValue(static_cast<int64_t>(info.memory_usage))},
             {TypedValue("disk_usage"), TypedValue(static_cast<int64_t>(info.disk_usage))},
+            {TypedValue("history_migration_queue_depth"),
+             TypedValue(static_cast<int64_t>(info.history_migration_queue_depth))},
+            {TypedValue("history_migration_lag_ms"), TypedValue(static_cast<int64_t>(info.history_migration_lag_ms))},
+            {TypedValue("history_migration_error"),
+             info.history_migration_error.empty() ? TypedValue() : TypedValue(info.history_migration_error)},
+            {TypedValue("history_cache_hits"), TypedValue(static_cast<int64_t>(info.history_cache_hits))},
+            {TypedValue("history_cache_misses"), TypedValue(static_cast<int64_t>(info.history_cache_misses))},
+            {TypedValue("history_cache_evictions"), TypedValue(static_cast<int64_t>(info.history_cache_evictions))},
+            {TypedValue("history_cache_bytes"), TypedValue(static_cast<int64_t>(info.history_cache_bytes))},
+            {TypedValue("history_block_cache_hits"), TypedValue(static_cast<int64_t>(info.history_block_cache_hits))},
+            {TypedValue("history_block_cache_misses"),
+             TypedValue(static_cast<int64_t>(info.history_block_cache_misses))},
+            {TypedValue("history_bloom_filter_useful"),
+             TypedValue(static_cast<int64_t>(info.history_bloom_filter_useful))},
             {TypedValue("memory_allocated"), TypedValue(static_cast<int64_t>(utils::total_memory_tracker.Amount()))},
             {TypedValue("allocation_limit"),
              TypedValue(static_cast<int64_t>(utils::total_memory_tracker.HardLimit()))}};
@@ -2154,7 +2339,8 @@ Interpreter::PrepareResult Interpreter::Prepare(const std::string &query_string,
     if (!in_explicit_transaction_ &&
         (utils::Downcast<CypherQuery>(parsed_query.query) || utils::Downcast<ExplainQuery>(parsed_query.query) ||
          utils::Downcast<ProfileQuery>(parsed_query.query) || utils::Downcast<DumpQuery>(parsed_query.query) ||
-         utils::Downcast<TriggerQuery>(parsed_query.query))) {
+         utils::Downcast<TriggerQuery>(parsed_query.query) ||
+         utils::Downcast<TemporalRollupQuery>(parsed_query.query))) {
       db_accessor_ =
           std::make_unique<storage::Storage::Accessor>(interpreter_context_->db->Access(GetIsolationLevelOverride()));
       execution_db_accessor_.emplace(db_accessor_.get());
@@ -2209,6 +2395,9 @@ Interpreter::PrepareResult Interpreter::Prepare(const std::string &query_string,
       prepared_query =
           PrepareTriggerQuery(std::move(parsed_query), in_explicit_transaction_, &query_execution->notifications,
                               interpreter_context_, &*execution_db_accessor_, params, username);
+    } else if (utils::Downcast<TemporalRollupQuery>(parsed_query.query)) {
+      prepared_query = PrepareTemporalRollupQuery(std::move(parsed_query), in_explicit_transaction_,
+                                                  interpreter_context_, &*execution_db_accessor_);
     } else if (utils::Downcast<StreamQuery>(parsed_query.query)) {
       prepared_query =
           PrepareStreamQuery(std::move(parsed_query), in_explicit_transaction_, &query_execution->notifications,
@@ -169,10 +169,6 @@ struct InterpreterContext {
 
   storage::Storage *db;
 
-  // std::optional<std::string> getaddition(){
-  //   return addition;
-  // }
-
   // ANTLR has singleton instance that is shared between threads. It is
   // protected by locks inside of ANTLR. Unfortunately, they are not protected
   // in a very good way. Once we have ANTLR version without race conditions we
@@ -195,14 +191,6 @@ struct InterpreterContext {
   const InterpreterConfig config;
 
   query::stream::Streams streams;
-  //wzy begin
-  // std::optional<std::string> addition;
-  // std::optional<std::string> addition_right;
-
-  std::optional<int64_t> addition;
-  std::optional<int64_t> addition_right;
-
-  //wzy end
 };
 
 /// Function that is used to tell all active interpreters that they should stop
@@ -11,6 +11,8 @@
 
 #pragma once
 
+#include <algorithm>
+
 #include "query/frontend/ast/ast.hpp"
 #include "query/parameters.hpp"
 #include "query/plan/operator.hpp"
@@ -61,6 +63,10 @@ class CostEstimator : public HierarchicalLogicalOperatorVisitor {
     static constexpr double kFilter{1.5};
     static constexpr double kEdgeUniquenessFilter{1.5};
     static constexpr double kUnwind{1.3};
+    // Reconstructing a version from the history store costs a seek per
+    // object plus the replay of every record of its chain.
+    static constexpr double kHistoryLookup{4.0};
+    static constexpr double kHistoryRecord{0.5};
   };
 
   struct CardParam {
@@ -87,6 +93,49 @@ class CostEstimator : public HierarchicalLogicalOperatorVisitor {
     return true;
   }
 
+  bool PostVisit(ScanAllByTime &) override {
+    // Every current vertex is still visited, but only the ones in the time
+    // index are looked up in the history store. The deleted vertices come on
+    // top, the window isn't known when planning so all of them are counted.
+    temporal_ = true;
+    cardinality_ *= db_accessor_->VerticesCount() + DeletedVertices();
+    IncrementCost(CostParam::kScanAll + VertexHistoryCost());
+    return true;
+  }
+
+  bool PostVisit(ScanAllByLabelByTime &logical_op) override {
+    // The vertices which had the label only in the past come on top, the
+    // filters on the label stay in the plan.
+    temporal_ = true;
+    cardinality_ *= db_accessor_->VerticesCount(logical_op.label_) + DeletedVertices(logical_op.label_);
+    IncrementCost(CostParam::kScanAllByLabel + VertexHistoryCost());
+    return true;
+  }
+
+  bool PostVisit(ScanAllByLabelPropertyValueByTime &logical_op) override {
+    auto property_value = ConstPropertyValue(logical_op.expression_);
+    double factor = 1.0;
+    if (property_value)
+      factor = db_accessor_->VerticesCount(logical_op.label_, logical_op.property_, property_value.value());
+    else
+      factor = db_accessor_->VerticesCount(logical_op.label_, logical_op.property_) * CardParam::kFilter;
+
+    temporal_ = true;
+    cardinality_ *= factor;
+    IncrementCost(CostParam::MakeScanAllByLabelPropertyValue + VertexHistoryCost());
+    return true;
+  }
+
+  bool PostVisit(ScanAllByValidTime &) override {
+    // The window isn't known when planning, it's estimated like a filter over
+    // all the vertices. Whether the history is read depends on a TT clause,
+    // which isn't known here either, so the vertices are costed as versions.
+    temporal_ = true;
+    cardinality_ *= (db_accessor_->VerticesCount() + DeletedVertices()) * CardParam::kFilter;
+    IncrementCost(CostParam::kScanAllByLabel + VertexHistoryCost());
+    return true;
+  }
+
   bool PostVisit(ScanAllByLabel &scan_all_by_label) override {
     cardinality_ *= db_accessor_->VerticesCount(scan_all_by_label.label_);
     // ScanAll performs some work for every element that is produced
@@ -148,12 +197,20 @@ class CostEstimator : public HierarchicalLogicalOperatorVisitor {
 
   // TODO: Cost estimate ScanAllById?
 
-// For the given op first increments the cardinality and then cost.
-#define POST_VISIT_CARD_FIRST(NAME)     \
-  bool PostVisit(NAME &) override {     \
-    cardinality_ *= CardParam::k##NAME; \
-    IncrementCost(CostParam::k##NAME);  \
-    return true;                        \
+// For the given op first increments the cardinality and then cost. Under a
+// temporal clause every expansion also follows the edges removed from the
+// vertex and reconstructs the versions of the edge and of the vertex it
+// reaches.
+#define POST_VISIT_CARD_FIRST(NAME)                                               \
+  bool PostVisit(NAME &) override {                                               \
+    if (!temporal_) {                                                             \
+      cardinality_ *= CardParam::k##NAME;                                         \
+      IncrementCost(CostParam::k##NAME);                                          \
+      return true;                                                                \
+    }                                                                             \
+    cardinality_ *= CardParam::k##NAME + RemovedEdgesPerVertex();                 \
+    IncrementCost(CostParam::k##NAME + EdgeHistoryCost() + VertexHistoryCost()); \
+    return true;                                                                  \
   }
 
   POST_VISIT_CARD_FIRST(Expand);
@@ -211,8 +268,56 @@ class CostEstimator : public HierarchicalLogicalOperatorVisitor {
   TDbAccessor *db_accessor_;
   const Parameters &parameters;
 
+  // set once a scan under a temporal clause is visited, the operators after
+  // it work on versions reconstructed from the history store
+  bool temporal_{false};
+
   void IncrementCost(double param) { cost_ += param * cardinality_; }
 
+  // Expected cost of reconstructing the versions of a vertex, only the
+  // vertices with history are looked up in the history store.
+  double VertexHistoryCost() {
+    const auto &statistics = db_accessor_->HistoryStatistics();
+    if (!statistics || statistics->vertices == 0) return 0;
+    auto vertices = std::max(static_cast<double>(db_accessor_->VerticesCount() + statistics->DeletedVertices()), 1.0);
+    auto share = std::min(statistics->vertices / vertices, 1.0);
+    return share * (CostParam::kHistoryLookup + CostParam::kHistoryRecord * statistics->VertexChainLength());
+  }
+
+  // Expected cost of reconstructing the versions of an edge. The number of
+  // current edges isn't known to the planner, so every edge is assumed to
+  // have history.
+  double EdgeHistoryCost() {
+    const auto &statistics = db_accessor_->HistoryStatistics();
+    if (!statistics || statistics->edges == 0) return 0;
+    return CostParam::kHistoryLookup + CostParam::kHistoryRecord * statistics->EdgeChainLength();
+  }
+
+  // Vertices which exist only in the history store.
+  double DeletedVertices() {
+    const auto &statistics = db_accessor_->HistoryStatistics();
+    return statistics ? statistics->DeletedVertices() : 0;
+  }
+
+  // Deleted vertices which had the label, estimated by the share of the
+  // label among all vertex versions.
+  double DeletedVertices(storage::LabelId label) {
+    const auto &statistics = db_accessor_->HistoryStatistics();
+    if (!statistics || statistics->vertex_versions == 0) return 0;
+    auto it = statistics->label_versions.find(label);
+    if (it == statistics->label_versions.end()) return 0;
+    auto share = std::min(static_cast<double>(it->second) / statistics->vertex_versions, 1.0);
+    return share * statistics->DeletedVertices();
+  }
+
+  // Removed edges an expansion follows per vertex on top of the current ones.
+  double RemovedEdgesPerVertex() {
+    const auto &statistics = db_accessor_->HistoryStatistics();
+    if (!statistics) return 0;
+    auto vertices = std::max(static_cast<double>(db_accessor_->VerticesCount() + statistics->DeletedVertices()), 1.0);
+    return statistics->DeletedEdges() / vertices;
+  }
+
   // converts an optional ScanAll range bound into a property value
   // if the bound is present and is a constant expression convertible to
   // a property value. otherwise returns nullopt
@@ -14,8 +14,11 @@
 #include <algorithm>
 #include <cstdint>
 #include <limits>
+#include <map>
+#include <optional>
 #include <queue>
 #include <random>
+#include <set>
 #include <string>
 #include <tuple>
 #include <type_traits>
@@ -39,6 +42,7 @@
 #include "query/procedure/mg_procedure_impl.hpp"
 #include "query/procedure/module.hpp"
 #include "storage/v2/property_value.hpp"
+#include "storage/v2/valid_time.hpp"
 #include "utils/algorithm.hpp"
 #include "utils/csv_parsing.hpp"
 #include "utils/event_counter.hpp"
@@ -91,6 +95,10 @@ extern const Event ScanAllByLabelPropertyRangeOperator;
 extern const Event ScanAllByLabelPropertyValueOperator;
 extern const Event ScanAllByLabelPropertyOperator;
 extern const Event ScanAllByIdOperator;
+extern const Event ScanAllByTimeOperator;
+extern const Event ScanAllByLabelByTimeOperator;
+extern const Event ScanAllByLabelPropertyValueByTimeOperator;
+extern const Event ScanAllByValidTimeOperator;
 extern const Event ExpandOperator;
 extern const Event ExpandVariableOperator;
 extern const Event ConstructNamedPathOperator;
@@ -105,6 +113,7 @@ extern const Event RemoveLabelsOperator;
 extern const Event EdgeUniquenessFilterOperator;
 extern const Event AccumulateOperator;
 extern const Event AggregateOperator;
+extern const Event AggregateByTimeOperator;
 extern const Event SkipOperator;
 extern const Event LimitOperator;
 extern const Event OrderByOperator;
@@ -145,6 +154,45 @@ bool EvaluateFilter(ExpressionEvaluator &evaluator, Expression *filter) {
   return result.ValueBool();
 }
 
+// Whether the valid time of a matched vertex or edge, or of its version under
+// a TT clause, overlaps the window of the VT clause. Always true without one.
+bool InValidTime(const TypedValue &value, const ExecutionContext &context, storage::View view) {
+  if (!context.valid_bounds) return true;
+  auto from_property = context.db_accessor->NameToProperty(storage::kValidFromProperty);
+  auto to_property = context.db_accessor->NameToProperty(storage::kValidToProperty);
+  storage::PropertyValue from;
+  storage::PropertyValue to;
+  auto read = [&](const auto &object) {
+    auto maybe_from = object.GetProperty(view, from_property);
+    auto maybe_to = object.GetProperty(view, to_property);
+    if (maybe_from.HasError() || maybe_to.HasError()) return;
+    from = std::move(*maybe_from);
+    to = std::move(*maybe_to);
+  };
+  auto read_version = [&](const auto &properties) {
+    if (auto it = properties.find(from_property); it != properties.end()) from = it->second;
+    if (auto it = properties.find(to_property); it != properties.end()) to = it->second;
+  };
+  switch (value.type()) {
+    case TypedValue::Type::Vertex:
+      read(value.ValueVertex());
+      break;
+    case TypedValue::Type::Edge:
+      read(value.ValueEdge());
+      break;
+    case TypedValue::Type::HistoryVertex:
+      read_version(value.ValueHistoryVertex().Properties());
+      break;
+    case TypedValue::Type::HistoryEdge:
+      read_version(value.ValueHistoryEdge().Properties());
+      break;
+    default:
+      return true;
+  }
+  auto interval = storage::MakeValidInterval(from, to);
+  return interval && interval->Overlaps(context.valid_bounds->ts, context.valid_bounds->te);
+}
+
 template <typename T>
 uint64_t ComputeProfilingKey(const T *obj) {
   static_assert(sizeof(T *) == sizeof(uint64_t));
@@ -385,11 +433,13 @@ VertexAccessor &CreateExpand::CreateExpandCursor::OtherVertex(Frame &frame, Exec
   }
 }
 
-bool addHistoryVertex(query::VertexAccessor &current_vertex_,history_delta::historyContext &historyContext_,std::list<TypedValue> &history_add_,ExecutionContext &context,bool edge_expand){
-    auto gid=current_vertex_.Gid().AsUint();
+// Adds the current version of the vertex and its versions that are still in
+// memory. Returns true if its older versions have to be read from the history
+// store, `current_vertex1` holds the version they are applied onto, if any.
+bool addMemoryHistoryVertex(query::VertexAccessor &current_vertex_,history_delta::historyContext &historyContext_,std::list<TypedValue> &history_add_,ExecutionContext &context,std::optional<storage::HistoryVertex> &current_vertex1,bool &delete_flag,bool lookup_history=true){
     auto obj_ts=current_vertex_.transaction_st();
     auto obj_te=current_vertex_.tt_te();
-    bool delete_flag=false;
+    delete_flag=false;
     auto current_Deltas=current_vertex_.getDeltas();
     if(current_Deltas!= nullptr){
         if(current_Deltas->commit_timestamp==0){
@@ -405,35 +455,99 @@ bool addHistoryVertex(query::VertexAccessor &current_vertex_,history_delta::hist
         auto values=TypedValue(current_vertex_);
         history_add_.emplace_back(values);
         if(historyContext_.types=="as of"){
-          return delete_flag;
+          return false;
         }
     }
 
     //加入历史节点的数据
-    storage::HistoryVertex current_vertex1;
-    bool history_flag=false;
     auto [dead_deltas,need_deleted_flag]=history_delta::getDeadInfo2(current_vertex_,historyContext_.c_ts, historyContext_.c_te,historyContext_.types);
     for (auto dead_delta:dead_deltas){
         current_vertex1=context.db_accessor->CreateHistoryVertexFromDelta((current_vertex_).impl_,dead_delta,historyContext_);
-        history_flag=true;
-        auto values=TypedValue(current_vertex1);
+        auto values=TypedValue(*current_vertex1);
         history_add_.emplace_back(values);
     }
-    //delete info
-    auto [gid_history_deltas_,flag]=context.db_accessor->GetHistoryDelta()->GetVertexInfo(current_vertex_.Gid(),historyContext_.c_ts,historyContext_.c_te,historyContext_.types);
-    for(auto gid_delta_:gid_history_deltas_){
-        if(history_flag){
-            current_vertex1=context.db_accessor->CreateHistoryVertexFromKV(current_vertex1,gid_delta_,historyContext_);
+    if(!lookup_history) return false;
+    if(!current_vertex1){
+        if(auto versions=context.db_accessor->FindHistoryVertexVersions(current_vertex_,historyContext_)){
+            for(const auto &version:*versions) history_add_.emplace_back(TypedValue(version));
+            return false;
+        }
+    }
+    return true;
+}
+
+// Adds the versions of the vertex rebuilt from its history records, applied
+// onto the version left by `addMemoryHistoryVertex`.
+void addStoredHistoryVertex(query::VertexAccessor &current_vertex_,history_delta::historyContext &historyContext_,const std::vector<history_delta::HistoryRecord> &gid_history_deltas_,std::optional<storage::HistoryVertex> &current_vertex1,std::list<TypedValue> &history_add_,ExecutionContext &context){
+    for(const auto &gid_delta_:gid_history_deltas_){
+        if(current_vertex1){
+            current_vertex1=context.db_accessor->CreateHistoryVertexFromKV(*current_vertex1,gid_delta_,historyContext_);
         }else {
             current_vertex1=context.db_accessor->CreateHistoryVertexFromKV((current_vertex_).impl_,gid_delta_,historyContext_);
         }
-        history_flag=true;
-        auto values=TypedValue(current_vertex1);
+        context.db_accessor->SaveHistoryVertexVersion(current_vertex_,*current_vertex1);
+        auto values=TypedValue(*current_vertex1);
         history_add_.emplace_back(values);
     }
+}
+
+bool addHistoryVertex(query::VertexAccessor &current_vertex_,history_delta::historyContext &historyContext_,std::list<TypedValue> &history_add_,ExecutionContext &context,bool edge_expand,bool lookup_history=true){
+    std::optional<storage::HistoryVertex> current_vertex1;
+    bool delete_flag;
+    if(!addMemoryHistoryVertex(current_vertex_,historyContext_,history_add_,context,current_vertex1,delete_flag,lookup_history)){
+        return delete_flag;
+    }
+    //delete info
+    current_vertex_.impl_.RecordHistoryRead();
+    auto [gid_history_deltas_,flag]=context.db_accessor->GetHistoryDelta()->GetVertexInfo(current_vertex_.Gid(),historyContext_.c_ts,historyContext_.c_te,historyContext_.types);
+    addStoredHistoryVertex(current_vertex_,historyContext_,gid_history_deltas_,current_vertex1,history_add_,context);
     return delete_flag;
 }
 
+// Same as `addHistoryVertex` for a batch of vertices. The versions in memory
+// are added first, then the history records of all vertices which need them
+// are read in one sweep over the history store. The versions of a vertex stay
+// together in `history_add_`.
+void addHistoryVertices(std::vector<query::VertexAccessor> &vertices_,history_delta::historyContext &historyContext_,std::list<TypedValue> &history_add_,ExecutionContext &context){
+    std::vector<std::list<TypedValue>> versions(vertices_.size());
+    std::vector<std::optional<storage::HistoryVertex>> current_vertices(vertices_.size());
+    std::vector<size_t> lookups;
+    std::vector<storage::Gid> gids;
+    for(size_t i=0;i<vertices_.size();++i){
+        bool delete_flag;
+        if(addMemoryHistoryVertex(vertices_[i],historyContext_,versions[i],context,current_vertices[i],delete_flag)){
+            vertices_[i].impl_.RecordHistoryRead();
+            lookups.push_back(i);
+            gids.push_back(vertices_[i].Gid());
+        }
+    }
+    if(!gids.empty()){
+        auto gid_history_deltas=context.db_accessor->GetHistoryDelta()->GetVerticesInfo(gids,historyContext_.c_ts,historyContext_.c_te,historyContext_.types);
+        for(size_t j=0;j<lookups.size();++j){
+            auto i=lookups[j];
+            addStoredHistoryVertex(vertices_[i],historyContext_,gid_history_deltas[j],current_vertices[i],versions[i],context);
+        }
+    }
+    for(auto &vertex_versions:versions) history_add_.splice(history_add_.end(),vertex_versions);
+}
+
+// Adds the versions of a vertex which was deleted and removed from the storage,
+// all its data is in the history store.
+void addRemovedHistoryVertex(storage::Gid gid,history_delta::historyContext &historyContext_,std::list<TypedValue> &history_add_,ExecutionContext &context){
+    auto &history=context.db_accessor->GetHistoryDelta();
+    auto [gid_history_deltas_,flag]=history->GetVertexInfo(gid,historyContext_.c_ts,historyContext_.c_te,historyContext_.types);
+    if(gid_history_deltas_.empty()) return;
+    // The newest record was written on deletion and holds the whole vertex.
+    storage::HistoryVertex current_vertex1(gid);
+    if(auto latest=history->GetLatestVertexRecord(gid)){
+        current_vertex1=context.db_accessor->CreateHistoryVertexFromKV(current_vertex1,*latest,historyContext_);
+    }
+    for(const auto &gid_delta_:gid_history_deltas_){
+        current_vertex1=context.db_accessor->CreateHistoryVertexFromKV(current_vertex1,gid_delta_,historyContext_);
+        history_add_.emplace_back(TypedValue(current_vertex1));
+    }
+}
+
 bool addHistoryVertex2(query::VertexAccessor &current_vertex_,history_delta::historyContext &historyContext_,history_delta::historyContext &historyContext2,TypedValue current_edge,std::list<std::pair<TypedValue,TypedValue>> &history_add_,ExecutionContext &context,bool edge_expand){
   auto gid=current_vertex_.Gid().AsUint();
   auto obj_ts=current_vertex_.transaction_st();
@@ -450,15 +564,23 @@ bool addHistoryVertex2(query::VertexAccessor &current_vertex_,history_delta::his
     auto values=TypedValue(current_vertex1);
     history_add_.emplace_back(current_edge,values); 
   }
+  if(!history_flag){
+    if(auto versions=context.db_accessor->FindHistoryVertexVersions(current_vertex_,historyContext_)){
+      for(const auto &version:*versions) history_add_.emplace_back(current_edge,TypedValue(version));
+      return delete_flag;
+    }
+  }
   //delete info
+  current_vertex_.impl_.RecordHistoryRead();
   auto [gid_history_deltas_,flag]=context.db_accessor->GetHistoryDelta()->GetVertexInfo(current_vertex_.Gid(),historyContext_.c_ts,historyContext_.c_te,historyContext_.types);
-  for(auto gid_delta_:gid_history_deltas_){
+  for(const auto &gid_delta_:gid_history_deltas_){
     if(history_flag){
       current_vertex1=context.db_accessor->CreateHistoryVertexFromKV(current_vertex1,gid_delta_,historyContext_);
     }else {
       current_vertex1=context.db_accessor->CreateHistoryVertexFromKV((current_vertex_).impl_,gid_delta_,historyContext_);
     }
     history_flag=true;
+    context.db_accessor->SaveHistoryVertexVersion(current_vertex_,current_vertex1);
     auto values=TypedValue(current_vertex1);
     history_add_.emplace_back(current_edge,values); 
   }
@@ -484,12 +606,12 @@ class ScanAllCursor : public Cursor {
 
     if (MustAbort(context)) throw HintedAbortError();
   
-    if(context.addition){
+    if(context.temporal_bounds){
       if(count==0){
         context.scan_op_name=op_name_;
         context.input_symbol=output_symbol_;
-        auto ts=(uint64_t)(*context.addition);
-        auto te=(uint64_t)(*context.addition_right);
+        auto ts=(uint64_t)context.temporal_bounds->ts;
+        auto te=(uint64_t)context.temporal_bounds->te;
         historyContext_.c_ts=ts;//ts
         historyContext_.c_te=te;//ts
         historyContext_.types=ts==te?"as of":"from to";
@@ -517,9 +639,13 @@ class ScanAllCursor : public Cursor {
           vertices_.emplace(std::move(next_vertices.value()));
           vertices_it_.emplace(vertices_.value().begin());
         }
-        auto current_vertex=*vertices_it_.value();
-        addHistoryVertex(current_vertex,historyContext_,history_add,context,false);
-        ++vertices_it_.value();
+        // The history of up to a batch of vertices is looked up at once.
+        auto batch_size=context.db_accessor->GetHistoryDelta()->ScanBatchSize();
+        batch_.clear();
+        for(;vertices_it_.value()!=vertices_.value().end()&&batch_.size()<batch_size;++vertices_it_.value()){
+          batch_.push_back(*vertices_it_.value());
+        }
+        addHistoryVertices(batch_,historyContext_,history_add,context);
       }  
     }else{
       if(count==0){
@@ -567,6 +693,7 @@ class ScanAllCursor : public Cursor {
   history_delta::historyContext historyContext_;
   std::list<storage::HistoryVertex*> history_add_;
   std::list<TypedValue> history_add;
+  std::vector<VertexAccessor> batch_;
 };
 
 ScanAll::ScanAll(const std::shared_ptr<LogicalOperator> &input, Symbol output_symbol, storage::View view)
@@ -751,6 +878,235 @@ UniqueCursorPtr ScanAllById::MakeCursor(utils::MemoryResource *mem) const {
                                                                 std::move(vertices), "ScanAllById");
 }
 
+namespace {
+
+/// Produces the versions of the vertices returned by `get_vertices` and of the
+/// vertices returned by `get_candidates` for the queried window, which may
+/// exist only in the history store.
+template <typename TVerticesFun, typename TCandidatesFun>
+class ScanAllByTimeCursor : public Cursor {
+ public:
+  ScanAllByTimeCursor(Symbol output_symbol, UniqueCursorPtr input_cursor, storage::View view,
+                      TVerticesFun get_vertices, TCandidatesFun get_candidates, const char *op_name)
+      : output_symbol_(output_symbol),
+        input_cursor_(std::move(input_cursor)),
+        view_(view),
+        get_vertices_(std::move(get_vertices)),
+        get_candidates_(std::move(get_candidates)),
+        op_name_(op_name) {}
+
+  bool Pull(Frame &frame, ExecutionContext &context) override {
+    SCOPED_PROFILE_OP(op_name_);
+
+    if (MustAbort(context)) throw HintedAbortError();
+
+    while (true) {
+      if (!history_add_.empty()) {
+        auto version = std::move(history_add_.front());
+        history_add_.pop_front();
+        if (!InValidTime(version, context, view_)) continue;
+        frame[output_symbol_] = std::move(version);
+        return true;
+      }
+      if (vertices_ && vertices_it_.value() != vertices_.value().end()) {
+        auto current_vertex = *vertices_it_.value();
+        ++vertices_it_.value();
+        if (!context.temporal_bounds) {
+          frame[output_symbol_] = current_vertex;
+          return true;
+        }
+        // Vertices missing from the time index have all their versions in
+        // memory, so the history store isn't searched for them.
+        auto in_history = candidates_.erase(current_vertex.Gid().AsUint()) > 0;
+        addHistoryVertex(current_vertex, historyContext_, history_add_, context, false, in_history);
+        continue;
+      }
+      if (!candidates_.empty()) {
+        // The remaining vertices of the index weren't produced by the storage,
+        // they were deleted or don't match in their current version.
+        auto gid = storage::Gid::FromUint(*candidates_.begin());
+        candidates_.erase(candidates_.begin());
+        if (auto deleted_vertex = context.db_accessor->FindDeleteVertex(gid, view_)) {
+          addHistoryVertex(*deleted_vertex, historyContext_, history_add_, context, false);
+        } else {
+          addRemovedHistoryVertex(gid, historyContext_, history_add_, context);
+        }
+        continue;
+      }
+      if (!input_cursor_->Pull(frame, context)) return false;
+      InitVertices(frame, context);
+    }
+  }
+
+  void Shutdown() override { input_cursor_->Shutdown(); }
+
+  void Reset() override {
+    input_cursor_->Reset();
+    vertices_ = std::nullopt;
+    vertices_it_ = std::nullopt;
+    candidates_.clear();
+    history_add_.clear();
+  }
+
+ private:
+  void InitVertices(Frame &frame, ExecutionContext &context) {
+    vertices_ = std::nullopt;
+    vertices_it_ = std::nullopt;
+    candidates_.clear();
+    auto next_vertices = get_vertices_(frame, context);
+    if (!next_vertices) return;
+    vertices_.emplace(std::move(next_vertices.value()));
+    vertices_it_.emplace(vertices_.value().begin());
+    if (!context.temporal_bounds) return;
+    historyContext_.c_ts = (uint64_t)context.temporal_bounds->ts;
+    historyContext_.c_te = (uint64_t)context.temporal_bounds->te;
+    historyContext_.types = historyContext_.c_ts == historyContext_.c_te ? "as of" : "from to";
+    auto &history = context.db_accessor->GetHistoryDelta();
+    if (history) candidates_ = get_candidates_(frame, context, *history, historyContext_);
+  }
+
+  const Symbol output_symbol_;
+  const UniqueCursorPtr input_cursor_;
+  const storage::View view_;
+  TVerticesFun get_vertices_;
+  TCandidatesFun get_candidates_;
+  std::optional<typename std::result_of<TVerticesFun(Frame &, ExecutionContext &)>::type::value_type> vertices_;
+  std::optional<decltype(vertices_.value().begin())> vertices_it_;
+  const char *op_name_;
+  // Vertices with versions in the history store which may overlap the queried
+  // window, erased once they are produced.
+  std::set<uint64_t> candidates_;
+  history_delta::historyContext historyContext_;
+  std::list<TypedValue> history_add_;
+};
+
+template <typename TVerticesFun, typename TCandidatesFun>
+UniqueCursorPtr MakeScanAllByTimeCursor(utils::MemoryResource *mem, const ScanAll &self, TVerticesFun get_vertices,
+                                        TCandidatesFun get_candidates, const char *op_name) {
+  return MakeUniqueCursorPtr<ScanAllByTimeCursor<TVerticesFun, TCandidatesFun>>(
+      mem, self.output_symbol_, self.input_->MakeCursor(mem), self.view_, std::move(get_vertices),
+      std::move(get_candidates), op_name);
+}
+
+}  // namespace
+
+ScanAllByTime::ScanAllByTime(const std::shared_ptr<LogicalOperator> &input, Symbol output_symbol, storage::View view)
+    : ScanAll(input, output_symbol, view) {}
+
+ACCEPT_WITH_INPUT(ScanAllByTime)
+
+UniqueCursorPtr ScanAllByTime::MakeCursor(utils::MemoryResource *mem) const {
+  EventCounter::IncrementCounter(EventCounter::ScanAllByTimeOperator);
+
+  auto vertices = [this](Frame &, ExecutionContext &context) {
+    return std::make_optional(context.db_accessor->Vertices(view_));
+  };
+  auto candidates = [](Frame &, ExecutionContext &, history_delta::History_delta &history,
+                       const history_delta::historyContext &window) {
+    return history.GetVerticesInWindow(window.c_ts, window.c_te);
+  };
+  return MakeScanAllByTimeCursor(mem, *this, std::move(vertices), std::move(candidates), "ScanAllByTime");
+}
+
+ScanAllByLabelByTime::ScanAllByLabelByTime(const std::shared_ptr<LogicalOperator> &input, Symbol output_symbol,
+                                           storage::LabelId label, storage::View view)
+    : ScanAll(input, output_symbol, view), label_(label) {}
+
+ACCEPT_WITH_INPUT(ScanAllByLabelByTime)
+
+UniqueCursorPtr ScanAllByLabelByTime::MakeCursor(utils::MemoryResource *mem) const {
+  EventCounter::IncrementCounter(EventCounter::ScanAllByLabelByTimeOperator);
+
+  auto vertices = [this](Frame &, ExecutionContext &context) {
+    return std::make_optional(context.db_accessor->HistoryVertices(view_, label_));
+  };
+  auto candidates = [this](Frame &, ExecutionContext &, history_delta::History_delta &history,
+                           const history_delta::historyContext &window) {
+    // Windows older than the temporal label index fall back to the time index.
+    auto found = history.GetVerticesWithLabel(label_, window.c_ts, window.c_te);
+    if (!found) return history.GetVerticesInWindow(window.c_ts, window.c_te);
+    return std::move(*found);
+  };
+  return MakeScanAllByTimeCursor(mem, *this, std::move(vertices), std::move(candidates), "ScanAllByLabelByTime");
+}
+
+ScanAllByLabelPropertyValueByTime::ScanAllByLabelPropertyValueByTime(const std::shared_ptr<LogicalOperator> &input,
+                                                                     Symbol output_symbol, storage::LabelId label,
+                                                                     storage::PropertyId property,
+                                                                     const std::string &property_name,
+                                                                     Expression *expression, storage::View view)
+    : ScanAll(input, output_symbol, view),
+      label_(label),
+      property_(property),
+      property_name_(property_name),
+      expression_(expression) {
+  DMG_ASSERT(expression, "Expression is not optional.");
+}
+
+ACCEPT_WITH_INPUT(ScanAllByLabelPropertyValueByTime)
+
+UniqueCursorPtr ScanAllByLabelPropertyValueByTime::MakeCursor(utils::MemoryResource *mem) const {
+  EventCounter::IncrementCounter(EventCounter::ScanAllByLabelPropertyValueByTimeOperator);
+
+  auto evaluate = [this](Frame &frame, ExecutionContext &context) -> std::optional<storage::PropertyValue> {
+    ExpressionEvaluator evaluator(&frame, context.symbol_table, context.evaluation_context, context.db_accessor, view_);
+    auto value = expression_->Accept(evaluator);
+    if (value.IsNull()) return std::nullopt;
+    if (!value.IsPropertyValue()) {
+      throw QueryRuntimeException("'{}' cannot be used as a property value.", value.type());
+    }
+    return storage::PropertyValue(value);
+  };
+  auto vertices = [this, evaluate](Frame &frame, ExecutionContext &context)
+      -> std::optional<decltype(context.db_accessor->HistoryVertices(view_, label_, property_,
+                                                                     storage::PropertyValue()))> {
+    auto value = evaluate(frame, context);
+    if (!value) return std::nullopt;
+    return std::make_optional(context.db_accessor->HistoryVertices(view_, label_, property_, *value));
+  };
+  auto candidates = [this, evaluate](Frame &frame, ExecutionContext &context, history_delta::History_delta &history,
+                                     const history_delta::historyContext &window) {
+    // Only called when the value isn't null.
+    auto found = history.GetVerticesWithLabelProperty(label_, property_, *evaluate(frame, context), window.c_ts,
+                                                      window.c_te);
+    if (!found) found = history.GetVerticesWithLabel(label_, window.c_ts, window.c_te);
+    if (!found) return history.GetVerticesInWindow(window.c_ts, window.c_te);
+    return std::move(*found);
+  };
+  return MakeScanAllByTimeCursor(mem, *this, std::move(vertices), std::move(candidates),
+                                 "ScanAllByLabelPropertyValueByTime");
+}
+
+ScanAllByValidTime::ScanAllByValidTime(const std::shared_ptr<LogicalOperator> &input, Symbol output_symbol,
+                                       storage::View view)
+    : ScanAll(input, output_symbol, view) {}
+
+ACCEPT_WITH_INPUT(ScanAllByValidTime)
+
+UniqueCursorPtr ScanAllByValidTime::MakeCursor(utils::MemoryResource *mem) const {
+  EventCounter::IncrementCounter(EventCounter::ScanAllByValidTimeOperator);
+
+  auto vertices = [this](Frame &, ExecutionContext &context) {
+    auto ts = (uint64_t)context.valid_bounds->ts;
+    auto te = (uint64_t)context.valid_bounds->te;
+    // Under a TT clause the past versions of the vertices count too, so the
+    // vertices whose valid time only overlapped the window before are kept.
+    if (context.temporal_bounds) {
+      return std::make_optional(context.db_accessor->HistoryValidTimeVertices(view_, ts, te));
+    }
+    return std::make_optional(context.db_accessor->ValidTimeVertices(view_, ts, te));
+  };
+  auto candidates = [](Frame &, ExecutionContext &context, history_delta::History_delta &history,
+                       const history_delta::historyContext &window) {
+    // Windows older than the valid time index fall back to the time index.
+    auto found = history.GetVerticesInValidTime((uint64_t)context.valid_bounds->ts,
+                                                (uint64_t)context.valid_bounds->te, window.c_ts, window.c_te);
+    if (!found) return history.GetVerticesInWindow(window.c_ts, window.c_te);
+    return std::move(*found);
+  };
+  return MakeScanAllByTimeCursor(mem, *this, std::move(vertices), std::move(candidates), "ScanAllByValidTime");
+}
+
 namespace {
 bool CheckExistingNode(const VertexAccessor &new_node, const Symbol &existing_node_sym, Frame &frame) {
   const TypedValue &existing_node = frame[existing_node_sym];
@@ -831,11 +1187,17 @@ bool Expand::ExpandCursor::Pull(Frame &frame, ExecutionContext &context) {
         LOG_FATAL("Must indicate exact expansion direction here");
     }
   };
+  // Under a VT clause the expanded edge and node have to be valid in the
+  // window too.
+  auto valid_time_matches = [this, &frame, &context] {
+    return InValidTime(frame[self_.common_.edge_symbol], context, self_.view_) &&
+           (self_.common_.existing_node || InValidTime(frame[self_.common_.node_symbol], context, self_.view_));
+  };
 
-  if(context.addition){
+  if(context.temporal_bounds){
     if(count==0){
-      auto ts=(uint64_t)(*context.addition);
-      auto te=(uint64_t)(*context.addition_right);
+      auto ts=(uint64_t)context.temporal_bounds->ts;
+      auto te=(uint64_t)context.temporal_bounds->te;
       historyContext_.c_ts=ts;//ts
       historyContext_.c_te=te;//ts
       historyContext_.types=(ts==te?"as of":"from to");
@@ -845,9 +1207,13 @@ bool Expand::ExpandCursor::Pull(Frame &frame, ExecutionContext &context) {
       if (MustAbort(context)) throw HintedAbortError();
       if(!history_add_.empty()){
         auto [maybe_edge,maybe_vertex]= history_add_.front();
+        history_add_.pop_front();
+        if (!InValidTime(maybe_edge, context, self_.view_) ||
+            (!self_.common_.existing_node && !InValidTime(maybe_vertex, context, self_.view_))) {
+          continue;
+        }
         frame[self_.common_.edge_symbol] = maybe_edge;
         frame[self_.common_.node_symbol] = maybe_vertex;
-        history_add_.pop_front();
         return true;
       }
       if (!InitHistoryEdges(frame, context)) return false;  
@@ -863,6 +1229,7 @@ bool Expand::ExpandCursor::Pull(Frame &frame, ExecutionContext &context) {
         auto edge = *(*in_edges_it_)++;
         frame[self_.common_.edge_symbol] = edge;
         pull_node(edge, EdgeAtom::Direction::IN);
+        if (!valid_time_matches()) continue;
         return true;
       }
 
@@ -875,6 +1242,7 @@ bool Expand::ExpandCursor::Pull(Frame &frame, ExecutionContext &context) {
         if (self_.common_.direction == EdgeAtom::Direction::BOTH && edge.IsCycle()) continue;
         frame[self_.common_.edge_symbol] = edge;
         pull_node(edge, EdgeAtom::Direction::OUT);
+        if (!valid_time_matches()) continue;
         return true;
       }
 
@@ -1012,13 +1380,6 @@ void addHistoryEdge(EdgeAccessor current_edge_,uint64_t current_v_ts,uint64_t cu
   }
   
   //如果不需要删除当前节点，并且类型是as of,则直接返回 不需要遍历历史数据
-  if(!delete_flag&historyContext_.types=="as of"){
-    context.db_accessor->saveHistoryEdgeFlag(gid,historyContext_.c_ts,historyContext_.c_te);
-    return ;
-  }
-
-  context.db_accessor->saveHistoryEdgeFlag(gid,historyContext_.c_ts,historyContext_.c_te);
-  
   return ;
 }
 
@@ -1037,64 +1398,35 @@ void addHistoryEdge(EdgeAccessor current_edge_,uint64_t current_v_ts,uint64_t cu
 
 void addHistoryDeleteEdges(uint64_t vertex_gid,std::vector<storage::EdgeTypeId> edge_types,uint64_t current_v_ts,uint64_t current_v_te,history_delta::historyContext &historyContext_,ExecutionContext &context,EdgeAtom::Direction direction,std::list<std::pair<TypedValue,TypedValue>> &history_add_){
   //数据库中未被删除的边 TODO unwrite egdes
-  //获取kv中被删除的所有边 ve:
-  auto deleted_edges_vec=context.db_accessor->GetHistoryDelta()->GetDeleteEdgeInfo(historyContext_.c_ts,historyContext_.c_te,historyContext_.types,vertex_gid);
+  //获取kv中被删除的边 ve: 只读取需要的方向和边的类型
+  auto deleted_edges=context.db_accessor->GetHistoryDelta()->GetRemovedEdges(vertex_gid,direction==EdgeAtom::Direction::OUT,edge_types,historyContext_.c_ts,historyContext_.c_te);
 
   //还原kv中那些被删除的边
-  for(auto &deleted_edges:deleted_edges_vec){
-    for (auto it = deleted_edges.begin(); it != deleted_edges.end(); ++it) {
-      auto edge_id = it.key();
-      if(edge_id=="TT_TS" || edge_id=="TT_TE" ||edge_id=="Type"||edge_id=="Fid"||edge_id=="Tid") continue;
-      auto edge_jsons=it.value();
-      auto edge_type = context.db_accessor->NameToEdgeType(edge_jsons["edgeType"].get<std::string_view>());
-      auto ie_type=edge_jsons["Type"];
-      auto from_gid=context.db_accessor->IdToGid((uint64_t)edge_jsons["fromGid"]);
-      auto to_gid=context.db_accessor->IdToGid((uint64_t)edge_jsons["toGid"]);
-
-      auto edge_ie_flag=direction == EdgeAtom::Direction::IN?ie_type=="AIE":ie_type=="AOE";//判断是否是需要的入边或者出边
-      if(!edge_ie_flag)continue;
-      if(!check_edges(edge_types,edge_type)) continue;//判断边的类型是否是需要的
-
-      //加入数据库中的顶点
-      auto expand_vid = direction==EdgeAtom::Direction::IN?from_gid:to_gid;//需要expand的节点，判断历史数据
-      storage::View view = storage::View::OLD;
-      auto expand_vertex=context.db_accessor->FindVertex(expand_vid, view);
-      // VertexAccessor expand_vertex;
-      if(!expand_vertex)return;
-      //还原边 只需要还原kv中被删除的边即可
-      std::string tmp(edge_id);
-      auto gid=(uint64_t)std::stoi(tmp);
-      auto current_edge1=storage::HistoryEdge(context.db_accessor->IdToGid(gid),from_gid,to_gid,edge_type,nullptr);//hjm edit new 
-      bool history_flag=false;
-      auto before_flag=context.db_accessor->FindHistoryEdgeFlag(gid,historyContext_.c_ts,historyContext_.c_te);
-      auto edge_vector=context.db_accessor->FindHistoryEdge(gid,historyContext_.c_ts,historyContext_.c_te);
-      if(before_flag){
-        // std::cout<<"do not need get edge info\n";
-        if(edge_vector){
-          for(auto[edge,ts,te]:*edge_vector){
-            auto edge1=*edge;
-            pull_nodes_current_history(context,*expand_vertex, ts, te,TypedValue(edge1),history_add_,historyContext_);
-            history_flag=true;
-          }
-        }
-      }else{
-        //delete info
-        auto [gid_history_deltas_,flag]=context.db_accessor->GetHistoryDelta()->GetEdgeInfo(historyContext_.c_ts,historyContext_.c_te,historyContext_.types,gid);
-        if(!flag){//不能直接从kv中得到数据
-          for(auto gid_delta_:gid_history_deltas_){
-            current_edge1=context.db_accessor->CreateHistoryEdgeFromKV(current_edge1,gid_delta_);
-            pull_nodes_current_history(context,*expand_vertex, current_edge1.tt_ts, current_edge1.tt_te,TypedValue(current_edge1),history_add_,historyContext_);
-            if(!history_add_.empty())context.db_accessor->saveHistoryEdge(gid,historyContext_.c_ts,historyContext_.c_te,&current_edge1,current_edge1.tt_ts, current_edge1.tt_te);
-          }
-        }else{//可以直接从kv中恢复数据
-          for(int i=0;i<gid_history_deltas_.size();i++){
-            auto gid_delta_=gid_history_deltas_[i];
-            current_edge1=context.db_accessor->CreateHistoryEdgeFromKV(current_edge1,gid_delta_);
-            pull_nodes_current_history(context,*expand_vertex, current_edge1.tt_ts, current_edge1.tt_te,TypedValue(current_edge1),history_add_,historyContext_);
-            if(!history_add_.empty())context.db_accessor->saveHistoryEdge(gid,historyContext_.c_ts,historyContext_.c_te,&current_edge1,current_edge1.tt_ts, current_edge1.tt_te);
-          }
-        }
+  for (const auto &[gid,deleted_edge] : deleted_edges) {
+    auto edge_type = deleted_edge.edge_type;
+    auto from_gid=deleted_edge.from_gid;
+    auto to_gid=deleted_edge.to_gid;
+
+    //加入数据库中的顶点
+    auto expand_vid = direction==EdgeAtom::Direction::IN?from_gid:to_gid;//需要expand的节点，判断历史数据
+    storage::View view = storage::View::OLD;
+    auto expand_vertex=context.db_accessor->FindVertex(expand_vid, view);
+    // VertexAccessor expand_vertex;
+    if(!expand_vertex)continue;
+    //还原边 只需要还原kv中被删除的边即可
+    auto current_edge1=storage::HistoryEdge(context.db_accessor->IdToGid(gid),from_gid,to_gid,edge_type,nullptr);//hjm edit new 
+    if(auto versions=context.db_accessor->FindHistoryEdgeVersions(context.db_accessor->IdToGid(gid),historyContext_)){
+      for(const auto &version:*versions){
+        pull_nodes_current_history(context,*expand_vertex, version.tt_ts, version.tt_te,TypedValue(version),history_add_,historyContext_);
       }
+      continue;
+    }
+    //delete info
+    auto [gid_history_deltas_,flag]=context.db_accessor->GetHistoryDelta()->GetEdgeInfo(historyContext_.c_ts,historyContext_.c_te,historyContext_.types,gid);
+    for(const auto &gid_delta_:gid_history_deltas_){
+      current_edge1=context.db_accessor->CreateHistoryEdgeFromKV(current_edge1,gid_delta_);
+      context.db_accessor->SaveHistoryEdgeVersion(current_edge1);
+      pull_nodes_current_history(context,*expand_vertex, current_edge1.tt_ts, current_edge1.tt_te,TypedValue(current_edge1),history_add_,historyContext_);
     }
   }
   return ;
@@ -1140,6 +1472,9 @@ void Expand::ExpandCursor::InitHistoryEdgesByCurrentVertex(Frame &frame,Executio
         break;
       }
     }
+    // Edges removed from the vertex, only those of the direction and edge
+    // types of the expansion are read.
+    addHistoryDeleteEdges(vertex.Gid().AsUint(),self_.common_.edge_types,vertex_ts,vertex_te,historyContext_,context,EdgeAtom::Direction::IN,history_add_);
   }
 
   if (direction == EdgeAtom::Direction::OUT || direction == EdgeAtom::Direction::BOTH) {
@@ -1177,6 +1512,7 @@ void Expand::ExpandCursor::InitHistoryEdgesByCurrentVertex(Frame &frame,Executio
         break;
       }
     }
+    addHistoryDeleteEdges(vertex.Gid().AsUint(),self_.common_.edge_types,vertex_ts,vertex_te,historyContext_,context,EdgeAtom::Direction::OUT,history_add_);
   }
   
 }
@@ -1206,7 +1542,7 @@ void Expand::ExpandCursor::InitHistoryEdgesByHistoryVertex(Frame &frame,Executio
       }else{
         std::optional<storage::Gid> existing_gid;
         in_edges_.emplace(
-          UnwrapEdgesResult(context.db_accessor->Edges(vertex.in_edges,self_.common_.edge_types,vertex.gid,true,existing_gid)));
+          UnwrapEdgesResult(context.db_accessor->Edges(vertex.InEdges(),self_.common_.edge_types,vertex.gid,true,existing_gid)));
       }
       if (in_edges_) {
         in_edges_it_.emplace(in_edges_->begin());
@@ -1230,7 +1566,7 @@ void Expand::ExpandCursor::InitHistoryEdgesByHistoryVertex(Frame &frame,Executio
       }else{
         std::optional<storage::Gid> existing_gid;
         out_edges_.emplace(
-          UnwrapEdgesResult(context.db_accessor->Edges(vertex.out_edges,self_.common_.edge_types,vertex.gid,false,existing_gid)));
+          UnwrapEdgesResult(context.db_accessor->Edges(vertex.OutEdges(),self_.common_.edge_types,vertex.gid,false,existing_gid)));
       }
       if (out_edges_) {
         out_edges_it_.emplace(out_edges_->begin());
@@ -1371,16 +1707,16 @@ auto ExpandFromHistoryVertex( storage::HistoryVertex &vertex, EdgeAtom::Directio
                       const std::vector<storage::EdgeTypeId> &edge_types, utils::MemoryResource *memory,ExecutionContext &context) {
   storage::View view = storage::View::OLD;
   std::optional<storage::Gid> existing_gid;
-  utils::pmr::vector<decltype(wrapper(direction, *context.db_accessor->Edges(vertex.in_edges,edge_types,vertex.gid,true,existing_gid)))> chain_elements(memory);
+  utils::pmr::vector<decltype(wrapper(direction, *context.db_accessor->Edges(vertex.InEdges(),edge_types,vertex.gid,true,existing_gid)))> chain_elements(memory);
 
   if (direction != EdgeAtom::Direction::OUT) {
-    auto edges = UnwrapEdgesResult(context.db_accessor->Edges(vertex.in_edges,edge_types,vertex.gid,false,existing_gid));
+    auto edges = UnwrapEdgesResult(context.db_accessor->Edges(vertex.InEdges(),edge_types,vertex.gid,false,existing_gid));
     if (edges.begin() != edges.end()) {
       chain_elements.emplace_back(wrapper(EdgeAtom::Direction::IN, std::move(edges)));
     }
   }
   if (direction != EdgeAtom::Direction::IN) {
-    auto edges = UnwrapEdgesResult(context.db_accessor->Edges(vertex.out_edges,edge_types,vertex.gid,true,existing_gid));
+    auto edges = UnwrapEdgesResult(context.db_accessor->Edges(vertex.OutEdges(),edge_types,vertex.gid,true,existing_gid));
     if (edges.begin() != edges.end()) {
       chain_elements.emplace_back(wrapper(EdgeAtom::Direction::OUT, std::move(edges)));
     }
@@ -1401,10 +1737,10 @@ class ExpandVariableCursor : public Cursor {
     SCOPED_PROFILE_OP("ExpandVariable");
     ExpressionEvaluator evaluator(&frame, context.symbol_table, context.evaluation_context, context.db_accessor,
                                   storage::View::OLD);
-    if(context.addition){
+    if(context.temporal_bounds){
       if(count==0){
-        auto ts=(uint64_t)(*context.addition);
-        auto te=(uint64_t)(*context.addition_right);
+        auto ts=(uint64_t)context.temporal_bounds->ts;
+        auto te=(uint64_t)context.temporal_bounds->te;
         historyContext_.c_ts=ts;//ts
         historyContext_.c_te=te;//ts
         historyContext_.types=(ts==te?"as of":"from to");
@@ -1744,6 +2080,11 @@ class ExpandVariableCursor : public Cursor {
       // std::cout<<"edges_on_frame size:"<<edges_on_frame.size()<<"\n";
       frame[self_.filter_lambda_.inner_node_symbol] = current_vertex;
       if (self_.filter_lambda_.expression && !EvaluateFilter(evaluator, self_.filter_lambda_.expression)) continue;
+      // Under a VT clause the path only goes through edges and vertices which
+      // are valid in the window.
+      if (!InValidTime(TypedValue(current_edge.first), context, storage::View::OLD) ||
+          !InValidTime(TypedValue(current_vertex), context, storage::View::OLD))
+        continue;
 
       // we are doing depth-first search, so place the current
       // edge's expansions onto the stack, if we should continue to expand
@@ -1854,6 +2195,11 @@ class ExpandVariableCursor : public Cursor {
       // std::cout<<"========edges_on_frame size:"<<edges_on_frame.size()<<"\n";
       frame[self_.filter_lambda_.inner_node_symbol] = current_vertex;
       if (self_.filter_lambda_.expression && !EvaluateFilter(evaluator, self_.filter_lambda_.expression)) continue;
+      // the versions of the path have to be valid in the window of a VT
+      // clause as well
+      if (!InValidTime(current_edge, context, storage::View::OLD) ||
+          !InValidTime(current_vertex, context, storage::View::OLD))
+        continue;
 
       // we are doing depth-first search, so place the current
       // edge's expansions onto the stack, if we should continue to expand
@@ -1981,7 +2327,12 @@ class STShortestPathCursor : public query::plan::Cursor {
   }
 
   bool ShouldExpand(const VertexAccessor &vertex, const EdgeAccessor &edge, Frame *frame,
-                    ExpressionEvaluator *evaluator) {
+                    ExpressionEvaluator *evaluator, const ExecutionContext &context) {
+    // a path valid in the window of a VT clause takes only valid edges and
+    // vertices
+    if (!InValidTime(TypedValue(edge), context, storage::View::OLD) ||
+        !InValidTime(TypedValue(vertex), context, storage::View::OLD))
+      return false;
     if (!self_.filter_lambda_.expression) return true;
 
     frame->at(self_.filter_lambda_.inner_node_symbol) = vertex;
@@ -2038,7 +2389,7 @@ class STShortestPathCursor : public query::plan::Cursor {
         if (self_.common_.direction != EdgeAtom::Direction::IN) {
           auto out_edges = UnwrapEdgesResult(vertex.OutEdges(storage::View::OLD, self_.common_.edge_types));
           for (const auto &edge : out_edges) {
-            if (ShouldExpand(edge.To(), edge, frame, evaluator) && !Contains(in_edge, edge.To())) {
+            if (ShouldExpand(edge.To(), edge, frame, evaluator, context) && !Contains(in_edge, edge.To())) {
               in_edge.emplace(edge.To(), edge);
               if (Contains(out_edge, edge.To())) {
                 if (current_length >= lower_bound) {
@@ -2055,7 +2406,7 @@ class STShortestPathCursor : public query::plan::Cursor {
         if (self_.common_.direction != EdgeAtom::Direction::OUT) {
           auto in_edges = UnwrapEdgesResult(vertex.InEdges(storage::View::OLD, self_.common_.edge_types));
           for (const auto &edge : in_edges) {
-            if (ShouldExpand(edge.From(), edge, frame, evaluator) && !Contains(in_edge, edge.From())) {
+            if (ShouldExpand(edge.From(), edge, frame, evaluator, context) && !Contains(in_edge, edge.From())) {
               in_edge.emplace(edge.From(), edge);
               if (Contains(out_edge, edge.From())) {
                 if (current_length >= lower_bound) {
@@ -2086,7 +2437,7 @@ class STShortestPathCursor : public query::plan::Cursor {
         if (self_.common_.direction != EdgeAtom::Direction::OUT) {
           auto out_edges = UnwrapEdgesResult(vertex.OutEdges(storage::View::OLD, self_.common_.edge_types));
           for (const auto &edge : out_edges) {
-            if (ShouldExpand(vertex, edge, frame, evaluator) && !Contains(out_edge, edge.To())) {
+            if (ShouldExpand(vertex, edge, frame, evaluator, context) && !Contains(out_edge, edge.To())) {
               out_edge.emplace(edge.To(), edge);
               if (Contains(in_edge, edge.To())) {
                 if (current_length >= lower_bound) {
@@ -2103,7 +2454,7 @@ class STShortestPathCursor : public query::plan::Cursor {
         if (self_.common_.direction != EdgeAtom::Direction::IN) {
           auto in_edges = UnwrapEdgesResult(vertex.InEdges(storage::View::OLD, self_.common_.edge_types));
           for (const auto &edge : in_edges) {
-            if (ShouldExpand(vertex, edge, frame, evaluator) && !Contains(out_edge, edge.From())) {
+            if (ShouldExpand(vertex, edge, frame, evaluator, context) && !Contains(out_edge, edge.From())) {
               out_edge.emplace(edge.From(), edge);
               if (Contains(in_edge, edge.From())) {
                 if (current_length >= lower_bound) {
@@ -2150,9 +2501,14 @@ class SingleSourceShortestPathCursor : public query::plan::Cursor {
 
     // for the given (edge, vertex) pair checks if they satisfy the
     // "where" condition. if so, places them in the to_visit_ structure.
-    auto expand_pair = [this, &evaluator, &frame](EdgeAccessor edge, VertexAccessor vertex) {
+    auto expand_pair = [this, &evaluator, &frame, &context](EdgeAccessor edge, VertexAccessor vertex) {
       // if we already processed the given vertex it doesn't get expanded
       if (processed_.find(vertex) != processed_.end()) return;
+      // neither does an edge or a vertex which isn't valid in the window of
+      // a VT clause
+      if (!InValidTime(TypedValue(edge), context, storage::View::OLD) ||
+          !InValidTime(TypedValue(vertex), context, storage::View::OLD))
+        return;
 
       frame[self_.filter_lambda_.inner_edge_symbol] = edge;
       frame[self_.filter_lambda_.inner_node_symbol] = vertex;
@@ -2306,9 +2662,15 @@ class ExpandWeightedShortestPathCursor : public query::plan::Cursor {
     // For the given (edge, vertex, weight, depth) tuple checks if they
     // satisfy the "where" condition. if so, places them in the priority
     // queue.
-    auto expand_pair = [this, &evaluator, &frame, &create_state](const EdgeAccessor &edge, const VertexAccessor &vertex,
-                                                                 const TypedValue &total_weight, int64_t depth) {
+    auto expand_pair = [this, &evaluator, &frame, &create_state, &context](
+                           const EdgeAccessor &edge, const VertexAccessor &vertex, const TypedValue &total_weight,
+                           int64_t depth) {
       auto *memory = evaluator.GetMemoryResource();
+      // Under a VT clause the paths only take edges and vertices valid in
+      // the window.
+      if (!InValidTime(TypedValue(edge), context, storage::View::OLD) ||
+          !InValidTime(TypedValue(vertex), context, storage::View::OLD))
+        return;
       if (self_.filter_lambda_.expression) {
         frame[self_.filter_lambda_.inner_edge_symbol] = edge;
         frame[self_.filter_lambda_.inner_node_symbol] = vertex;
@@ -3470,17 +3832,59 @@ TypedValue DefaultAggregationOpValue(const Aggregate::Element &element, utils::M
       return TypedValue(TypedValue::TVector(memory));
     case Aggregation::Op::COLLECT_MAP:
       return TypedValue(TypedValue::TMap(memory));
+    case Aggregation::Op::TT_WINDOW:
+      return TypedValue(TypedValue::TVector(memory));
   }
 }
+
+/// Largest number of windows a TT_WINDOW aggregation may add one value to.
+constexpr uint64_t kMaxTtWindows = 1000000;
+
+/// Transaction time interval [tt_ts, tt_te) of a vertex or an edge, or of one
+/// of their versions. std::nullopt for other values.
+std::optional<std::pair<uint64_t, uint64_t>> TransactionInterval(const TypedValue &value) {
+  switch (value.type()) {
+    case TypedValue::Type::Vertex: {
+      auto vertex = value.ValueVertex();
+      return std::make_pair(vertex.transaction_st(), vertex.tt_te());
+    }
+    case TypedValue::Type::Edge: {
+      auto edge = value.ValueEdge();
+      return std::make_pair(edge.transaction_st(), edge.tt_te());
+    }
+    case TypedValue::Type::HistoryVertex:
+      return std::make_pair(value.ValueHistoryVertex().tt_ts, value.ValueHistoryVertex().tt_te);
+    case TypedValue::Type::HistoryEdge:
+      return std::make_pair(value.ValueHistoryEdge().tt_ts, value.ValueHistoryEdge().tt_te);
+    default:
+      return std::nullopt;
+  }
+}
+
+/// Gid of a vertex or of one of its versions, std::nullopt for other values.
+std::optional<uint64_t> VertexGid(const TypedValue &value) {
+  if (value.IsVertex()) return value.ValueVertex().Gid().AsUint();
+  if (value.IsHistoryVertex()) return value.ValueHistoryVertex().gid.AsUint();
+  return std::nullopt;
+}
 }  // namespace
 
 class AggregateCursor : public Cursor {
  public:
-  AggregateCursor(const Aggregate &self, utils::MemoryResource *mem)
-      : self_(self), input_cursor_(self_.input_->MakeCursor(mem)), aggregation_(mem) {}
+  /// With an `object_symbol` the input is expected to produce the rows of a
+  /// vertex together, and the groups of a vertex are produced once its rows
+  /// are read. Used by AggregateByTime.
+  AggregateCursor(const Aggregate &self, utils::MemoryResource *mem, std::optional<Symbol> object_symbol = std::nullopt)
+      : self_(self),
+        object_symbol_(std::move(object_symbol)),
+        input_cursor_(self_.input_->MakeCursor(mem)),
+        aggregation_(mem),
+        finished_(mem) {}
 
   bool Pull(Frame &frame, ExecutionContext &context) override {
-    SCOPED_PROFILE_OP("Aggregate");
+    SCOPED_PROFILE_OP(object_symbol_ ? "AggregateByTime" : "Aggregate");
+
+    if (object_symbol_) return PullByObject(frame, context);
 
     if (!pulled_all_input_) {
       ProcessAll(&frame, &context);
@@ -3502,15 +3906,7 @@ class AggregateCursor : public Cursor {
 
     if (aggregation_it_ == aggregation_.end()) return false;
 
-    // place aggregation values on the frame
-    auto aggregation_values_it = aggregation_it_->second.values_.begin();
-    for (const auto &aggregation_elem : self_.aggregations_)
-      frame[aggregation_elem.output_sym] = *aggregation_values_it++;
-
-    // place remember values on the frame
-    auto remember_values_it = aggregation_it_->second.remember_.begin();
-    for (const Symbol &remember_sym : self_.remember_) frame[remember_sym] = *remember_values_it++;
-
+    PlaceOnFrame(frame, aggregation_it_->second);
     aggregation_it_++;
     return true;
   }
@@ -3522,6 +3918,9 @@ class AggregateCursor : public Cursor {
     aggregation_.clear();
     aggregation_it_ = aggregation_.begin();
     pulled_all_input_ = false;
+    finished_.clear();
+    finished_it_ = finished_.begin();
+    object_ = std::nullopt;
   }
 
  private:
@@ -3529,6 +3928,15 @@ class AggregateCursor : public Cursor {
   // Does NOT include the group-by values since those are a key in the
   // aggregation map. The vectors in an AggregationValue contain one element for
   // each aggregation in this LogicalOp.
+  // Partial aggregates of the values in one window of TT_WINDOW.
+  struct WindowPartial {
+    uint64_t end{0};
+    int64_t count{0};
+    TypedValue sum;
+    TypedValue min;
+    TypedValue max;
+  };
+
   struct AggregationValue {
     explicit AggregationValue(utils::MemoryResource *mem) : counts_(mem), values_(mem), remember_(mem) {}
 
@@ -3543,25 +3951,91 @@ class AggregateCursor : public Cursor {
     utils::pmr::vector<TypedValue> values_;
     // remember values.
     utils::pmr::vector<TypedValue> remember_;
+    // partial aggregates of TT_WINDOW aggregations keyed by the start of their
+    // window, empty for the other aggregations.
+    std::vector<std::map<uint64_t, WindowPartial>> windows_;
   };
 
+  using AggregationMap =
+      utils::pmr::unordered_map<utils::pmr::vector<TypedValue>, AggregationValue,
+                                // use FNV collection hashing specialized for a
+                                // vector of TypedValues
+                                utils::FnvCollection<utils::pmr::vector<TypedValue>, TypedValue, TypedValue::Hash>,
+                                // custom equality
+                                TypedValueVectorEqual>;
+
   const Aggregate &self_;
+  // set when aggregating the rows of one vertex at a time
+  const std::optional<Symbol> object_symbol_;
   const UniqueCursorPtr input_cursor_;
   // storage for aggregated data
   // map key is the vector of group-by values
   // map value is an AggregationValue struct
-  utils::pmr::unordered_map<utils::pmr::vector<TypedValue>, AggregationValue,
-                            // use FNV collection hashing specialized for a
-                            // vector of TypedValues
-                            utils::FnvCollection<utils::pmr::vector<TypedValue>, TypedValue, TypedValue::Hash>,
-                            // custom equality
-                            TypedValueVectorEqual>
-      aggregation_;
+  AggregationMap aggregation_;
   // iterator over the accumulated cache
   decltype(aggregation_.begin()) aggregation_it_ = aggregation_.begin();
   // this LogicalOp pulls all from the input on it's first pull
   // this switch tracks if this has been performed
   bool pulled_all_input_{false};
+  // groups of the last vertex whose rows were all read, when aggregating one
+  // vertex at a time, while `aggregation_` holds those of the current vertex
+  AggregationMap finished_;
+  decltype(finished_.begin()) finished_it_ = finished_.begin();
+  // gid of the vertex whose rows are in `aggregation_`
+  std::optional<std::optional<uint64_t>> object_;
+  // window of the TT clause, read by TT_WINDOW
+  std::optional<TemporalBounds> temporal_bounds_;
+  // start timestamp of the reading transaction, no version outlives it
+  uint64_t now_{std::numeric_limits<uint64_t>::max() - 1};
+
+  /** Places the aggregated and the remember values of a group on the frame. */
+  void PlaceOnFrame(Frame &frame, const AggregationValue &agg_value) const {
+    auto aggregation_values_it = agg_value.values_.begin();
+    for (const auto &aggregation_elem : self_.aggregations_)
+      frame[aggregation_elem.output_sym] = *aggregation_values_it++;
+
+    auto remember_values_it = agg_value.remember_.begin();
+    for (const Symbol &remember_sym : self_.remember_) frame[remember_sym] = *remember_values_it++;
+  }
+
+  /**
+   * Pulls the rows of the next vertex and produces its groups. A row is
+   * aggregated before the groups of the previous vertex are placed on the
+   * frame, since those overwrite the remember values of the row.
+   */
+  bool PullByObject(Frame &frame, ExecutionContext &context) {
+    ExpressionEvaluator evaluator(&frame, context.symbol_table, context.evaluation_context, context.db_accessor,
+                                  storage::View::NEW);
+    temporal_bounds_ = context.temporal_bounds;
+    if (context.db_accessor) now_ = context.db_accessor->StartTimestamp();
+    while (finished_it_ == finished_.end()) {
+      // the vertex is grouped by, so there are no groups without input
+      if (pulled_all_input_) return false;
+      finished_.clear();
+      while (true) {
+        if (!input_cursor_->Pull(frame, context)) {
+          pulled_all_input_ = true;
+          Finish(aggregation_, context.evaluation_context.memory);
+          std::swap(finished_, aggregation_);
+          break;
+        }
+        auto object = VertexGid(frame[*object_symbol_]);
+        if (object_ && *object_ != object) {
+          Finish(aggregation_, context.evaluation_context.memory);
+          std::swap(finished_, aggregation_);
+          object_ = object;
+          ProcessOne(frame, &evaluator, aggregation_);
+          break;
+        }
+        object_ = object;
+        ProcessOne(frame, &evaluator, aggregation_);
+      }
+      finished_it_ = finished_.begin();
+    }
+    PlaceOnFrame(frame, finished_it_->second);
+    finished_it_++;
+    return true;
+  }
 
   /**
    * Pulls from the input operator until exhausted and aggregates the
@@ -3575,17 +4049,28 @@ class AggregateCursor : public Cursor {
   void ProcessAll(Frame *frame, ExecutionContext *context) {
     ExpressionEvaluator evaluator(frame, context->symbol_table, context->evaluation_context, context->db_accessor,
                                   storage::View::NEW);
+    temporal_bounds_ = context->temporal_bounds;
+    if (context->db_accessor) now_ = context->db_accessor->StartTimestamp();
     while (input_cursor_->Pull(*frame, *context)) {
-      ProcessOne(*frame, &evaluator);
+      ProcessOne(*frame, &evaluator, aggregation_);
     }
+    Finish(aggregation_, context->evaluation_context.memory);
+  }
 
-    // calculate AVG aggregations (so far they have only been summed)
+  /**
+   * Calculates AVG aggregations, which so far have only been summed, and
+   * turns the partial aggregates of TT_WINDOW into lists of windows.
+   */
+  void Finish(AggregationMap &aggregation, utils::MemoryResource *pull_memory) const {
     for (size_t pos = 0; pos < self_.aggregations_.size(); ++pos) {
+      if (self_.aggregations_[pos].op == Aggregation::Op::TT_WINDOW) {
+        for (auto &kv : aggregation) FinishWindows(kv.second, pos, pull_memory);
+        continue;
+      }
       if (self_.aggregations_[pos].op != Aggregation::Op::AVG) continue;
-      for (auto &kv : aggregation_) {
+      for (auto &kv : aggregation) {
         AggregationValue &agg_value = kv.second;
         auto count = agg_value.counts_[pos];
-        auto *pull_memory = context->evaluation_context.memory;
         if (count > 0) {
           agg_value.values_[pos] = agg_value.values_[pos] / TypedValue(static_cast<double>(count), pull_memory);
         }
@@ -3593,17 +4078,38 @@ class AggregateCursor : public Cursor {
     }
   }
 
+  /**
+   * Places the windows of a TT_WINDOW aggregation in its value, ordered by
+   * their start. Windows without values are left out.
+   */
+  void FinishWindows(AggregationValue &agg_value, size_t pos, utils::MemoryResource *pull_memory) const {
+    auto &windows = agg_value.values_[pos].ValueList();
+    auto *mem = windows.get_allocator().GetMemoryResource();
+    for (const auto &[start, partial] : agg_value.windows_[pos]) {
+      TypedValue::TMap window(mem);
+      window.emplace("start", TypedValue(static_cast<int64_t>(start), mem));
+      window.emplace("end", TypedValue(static_cast<int64_t>(partial.end), mem));
+      window.emplace("count", TypedValue(partial.count, mem));
+      window.emplace("sum", TypedValue(partial.sum, mem));
+      window.emplace("min", TypedValue(partial.min, mem));
+      window.emplace("max", TypedValue(partial.max, mem));
+      window.emplace("avg", partial.sum / TypedValue(static_cast<double>(partial.count), pull_memory));
+      windows.emplace_back(std::move(window));
+    }
+    agg_value.windows_[pos].clear();
+  }
+
   /**
    * Performs a single accumulation.
    */
-  void ProcessOne(const Frame &frame, ExpressionEvaluator *evaluator) {
-    auto *mem = aggregation_.get_allocator().GetMemoryResource();
+  void ProcessOne(const Frame &frame, ExpressionEvaluator *evaluator, AggregationMap &aggregation) {
+    auto *mem = aggregation.get_allocator().GetMemoryResource();
     utils::pmr::vector<TypedValue> group_by(mem);
     group_by.reserve(self_.group_by_.size());
     for (Expression *expression : self_.group_by_) {
       group_by.emplace_back(expression->Accept(*evaluator));
     }
-    auto &agg_value = aggregation_.try_emplace(std::move(group_by), mem).first->second;
+    auto &agg_value = aggregation.try_emplace(std::move(group_by), mem).first->second;
     EnsureInitialized(frame, &agg_value);
     Update(evaluator, &agg_value);
   }
@@ -3620,6 +4126,7 @@ class AggregateCursor : public Cursor {
       agg_value->values_.emplace_back(DefaultAggregationOpValue(agg_elem, mem));
     }
     agg_value->counts_.resize(self_.aggregations_.size(), 0);
+    agg_value->windows_.resize(self_.aggregations_.size());
 
     for (const Symbol &remember_sym : self_.remember_) agg_value->remember_.push_back(frame[remember_sym]);
   }
@@ -3654,6 +4161,11 @@ class AggregateCursor : public Cursor {
       if (input_value.IsNull()) continue;
       const auto &agg_op = agg_elem_it->op;
       *count_it += 1;
+      if (agg_op == Aggregation::Op::TT_WINDOW) {
+        UpdateWindows(evaluator, *agg_elem_it, input_value,
+                      &agg_value->windows_[agg_elem_it - self_.aggregations_.begin()]);
+        continue;
+      }
       if (*count_it == 1) {
         // first value, nothing to aggregate. check type, set and continue.
         switch (agg_op) {
@@ -3673,6 +4185,9 @@ class AggregateCursor : public Cursor {
           case Aggregation::Op::COLLECT_LIST:
             value_it->ValueList().push_back(input_value);
             break;
+          case Aggregation::Op::TT_WINDOW:
+            // aggregated per window above
+            break;
           case Aggregation::Op::COLLECT_MAP:
             auto key = agg_elem_it->key->Accept(*evaluator);
             if (key.type() != TypedValue::Type::String) throw QueryRuntimeException("Map key must be a string.");
@@ -3721,6 +4236,9 @@ class AggregateCursor : public Cursor {
         case Aggregation::Op::COLLECT_LIST:
           value_it->ValueList().push_back(input_value);
           break;
+        case Aggregation::Op::TT_WINDOW:
+          // aggregated per window above
+          break;
         case Aggregation::Op::COLLECT_MAP:
           auto key = agg_elem_it->key->Accept(*evaluator);
           if (key.type() != TypedValue::Type::String) throw QueryRuntimeException("Map key must be a string.");
@@ -3730,6 +4248,52 @@ class AggregateCursor : public Cursor {
     }    // end loop over all aggregations
   }
 
+  /** Adds a value to the windows of TT_WINDOW which overlap the transaction
+   * time interval of the version it was read from. */
+  void UpdateWindows(ExpressionEvaluator *evaluator, const Aggregate::Element &agg_elem, const TypedValue &input_value,
+                     std::map<uint64_t, WindowPartial> *windows) const {
+    if (!temporal_bounds_) throw QueryRuntimeException("TT_WINDOW can only be used in queries with a TT clause.");
+    EnsureOkForAvgSum(input_value);
+    auto width = WindowWidth(agg_elem, evaluator);
+    // the frontend allows only a property of a variable
+    auto *property_lookup = utils::Downcast<PropertyLookup>(agg_elem.value);
+    MG_ASSERT(property_lookup, "TT_WINDOW expects a property lookup.");
+    auto interval = TransactionInterval(property_lookup->expression_->Accept(*evaluator));
+    if (!interval) throw QueryRuntimeException("TT_WINDOW takes a property of a vertex or an edge.");
+    const uint64_t ts = temporal_bounds_->ts;
+    const uint64_t te = static_cast<uint64_t>(temporal_bounds_->te) + 1;
+    const auto from = std::max(interval->first, ts);
+    // the current version ends at the largest timestamp, it is only known up
+    // to now
+    const auto to = std::min({interval->second, te, now_ + 1});
+    if (from >= to) return;
+    if ((to - from) / width > kMaxTtWindows)
+      throw QueryRuntimeException(
+          "TT_WINDOW would create more than {} windows, use wider windows or a shorter TT clause.", kMaxTtWindows);
+    for (auto start = ts + (from - ts) / width * width; start < to; start += width) {
+      auto &partial = (*windows)[start];
+      partial.count++;
+      if (partial.count == 1) {
+        // the last window ends with the window of the TT clause
+        partial.end = std::min(start + width, te);
+        partial.sum = partial.min = partial.max = input_value;
+        continue;
+      }
+      partial.sum = partial.sum + input_value;
+      if ((input_value < partial.min).ValueBool()) partial.min = input_value;
+      if ((input_value > partial.max).ValueBool()) partial.max = input_value;
+    }
+  }
+
+  /** The width of the windows of a TT_WINDOW aggregation, which must be a
+   * positive integer. */
+  uint64_t WindowWidth(const Aggregate::Element &agg_elem, ExpressionEvaluator *evaluator) const {
+    auto width = agg_elem.key->Accept(*evaluator);
+    if (width.type() != TypedValue::Type::Int || width.ValueInt() <= 0)
+      throw QueryRuntimeException("The width of TT_WINDOW windows must be a positive integer.");
+    return width.ValueInt();
+  }
+
   /** Checks if the given TypedValue is legal in MIN and MAX. If not
    * an appropriate exception is thrown. */
   void EnsureOkForMinMax(const TypedValue &value) const {
@@ -3765,6 +4329,20 @@ UniqueCursorPtr Aggregate::MakeCursor(utils::MemoryResource *mem) const {
   return MakeUniqueCursorPtr<AggregateCursor>(mem, *this, mem);
 }
 
+AggregateByTime::AggregateByTime(const std::shared_ptr<LogicalOperator> &input,
+                                 const std::vector<Aggregate::Element> &aggregations,
+                                 const std::vector<Expression *> &group_by, const std::vector<Symbol> &remember,
+                                 Symbol object_symbol)
+    : Aggregate(input, aggregations, group_by, remember), object_symbol_(object_symbol) {}
+
+ACCEPT_WITH_INPUT(AggregateByTime)
+
+UniqueCursorPtr AggregateByTime::MakeCursor(utils::MemoryResource *mem) const {
+  EventCounter::IncrementCounter(EventCounter::AggregateByTimeOperator);
+
+  return MakeUniqueCursorPtr<AggregateCursor>(mem, *this, mem, object_symbol_);
+}
+
 Skip::Skip(const std::shared_ptr<LogicalOperator> &input, Expression *expression)
     : input_(input), expression_(expression) {}
 
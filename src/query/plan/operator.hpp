@@ -94,6 +94,10 @@ class ScanAllByLabelPropertyRange;
 class ScanAllByLabelPropertyValue;
 class ScanAllByLabelProperty;
 class ScanAllById;
+class ScanAllByTime;
+class ScanAllByLabelByTime;
+class ScanAllByLabelPropertyValueByTime;
+class ScanAllByValidTime;
 class Expand;
 class ExpandVariable;
 class ConstructNamedPath;
@@ -108,6 +112,7 @@ class RemoveLabels;
 class EdgeUniquenessFilter;
 class Accumulate;
 class Aggregate;
+class AggregateByTime;
 class Skip;
 class Limit;
 class OrderBy;
@@ -123,10 +128,11 @@ class LoadCsv;
 using LogicalOperatorCompositeVisitor = ::utils::CompositeVisitor<
     Once, CreateNode, CreateExpand, ScanAll, ScanAllByLabel,
     ScanAllByLabelPropertyRange, ScanAllByLabelPropertyValue,
-    ScanAllByLabelProperty, ScanAllById, Expand, ExpandVariable,
+    ScanAllByLabelProperty, ScanAllById, ScanAllByTime, ScanAllByLabelByTime,
+    ScanAllByLabelPropertyValueByTime, ScanAllByValidTime, Expand, ExpandVariable,
     ConstructNamedPath, Filter, Produce, Delete, SetProperty, SetProperties,
     SetLabels, RemoveProperty, RemoveLabels, EdgeUniquenessFilter, Accumulate,
-    Aggregate, Skip, Limit, OrderBy, Merge, Optional, Unwind, Distinct, Union,
+    Aggregate, AggregateByTime, Skip, Limit, OrderBy, Merge, Optional, Unwind, Distinct, Union,
     Cartesian, CallProcedure, LoadCsv>;
 
 using LogicalOperatorLeafVisitor = ::utils::LeafVisitor<Once>;
@@ -780,6 +786,132 @@ public:
   }
 };
 
+/// Behaves like @c ScanAll under a temporal clause, but looks up the vertices
+/// with versions in the queried window in the time index of the history store
+/// instead of searching the history of every vertex. Also produces the
+/// versions of vertices which were deleted and exist only in the history
+/// store.
+///
+/// @sa ScanAll
+class ScanAllByTime : public query::plan::ScanAll {
+public:
+  static const utils::TypeInfo kType;
+  const utils::TypeInfo &GetTypeInfo() const override { return kType; }
+
+  ScanAllByTime() {}
+  ScanAllByTime(const std::shared_ptr<LogicalOperator> &input,
+                Symbol output_symbol,
+                storage::View view = storage::View::OLD);
+  bool Accept(HierarchicalLogicalOperatorVisitor &visitor) override;
+  UniqueCursorPtr MakeCursor(utils::MemoryResource *) const override;
+
+  std::unique_ptr<LogicalOperator> Clone(AstStorage *storage) const override {
+    auto object = std::make_unique<ScanAllByTime>();
+    object->input_ = input_ ? input_->Clone(storage) : nullptr;
+    object->output_symbol_ = output_symbol_;
+    object->view_ = view_;
+    return object;
+  }
+};
+
+/// Behaves like @c ScanAllByTime, but produces only vertices which had the
+/// given label in one of their versions. The vertices are looked up in the
+/// label index and the temporal label index of the history store, the label
+/// still has to be checked on the produced versions.
+///
+/// @sa ScanAllByTime
+/// @sa ScanAllByLabel
+class ScanAllByLabelByTime : public query::plan::ScanAll {
+public:
+  static const utils::TypeInfo kType;
+  const utils::TypeInfo &GetTypeInfo() const override { return kType; }
+
+  ScanAllByLabelByTime() {}
+  ScanAllByLabelByTime(const std::shared_ptr<LogicalOperator> &input,
+                       Symbol output_symbol, storage::LabelId label,
+                       storage::View view = storage::View::OLD);
+  bool Accept(HierarchicalLogicalOperatorVisitor &visitor) override;
+  UniqueCursorPtr MakeCursor(utils::MemoryResource *) const override;
+
+  storage::LabelId label_;
+
+  std::unique_ptr<LogicalOperator> Clone(AstStorage *storage) const override {
+    auto object = std::make_unique<ScanAllByLabelByTime>();
+    object->input_ = input_ ? input_->Clone(storage) : nullptr;
+    object->output_symbol_ = output_symbol_;
+    object->view_ = view_;
+    object->label_ = label_;
+    return object;
+  }
+};
+
+/// Behaves like @c ScanAllByTime, but produces only vertices which had the
+/// given label and property value in one of their versions. The label and the
+/// value still have to be checked on the produced versions.
+///
+/// @sa ScanAllByTime
+/// @sa ScanAllByLabelPropertyValue
+class ScanAllByLabelPropertyValueByTime : public query::plan::ScanAll {
+public:
+  static const utils::TypeInfo kType;
+  const utils::TypeInfo &GetTypeInfo() const override { return kType; }
+
+  ScanAllByLabelPropertyValueByTime() {}
+  ScanAllByLabelPropertyValueByTime(const std::shared_ptr<LogicalOperator> &input,
+                                    Symbol output_symbol, storage::LabelId label,
+                                    storage::PropertyId property,
+                                    const std::string &property_name,
+                                    Expression *expression,
+                                    storage::View view = storage::View::OLD);
+  bool Accept(HierarchicalLogicalOperatorVisitor &visitor) override;
+  UniqueCursorPtr MakeCursor(utils::MemoryResource *) const override;
+
+  storage::LabelId label_;
+  storage::PropertyId property_;
+  std::string property_name_;
+  Expression *expression_;
+
+  std::unique_ptr<LogicalOperator> Clone(AstStorage *storage) const override {
+    auto object = std::make_unique<ScanAllByLabelPropertyValueByTime>();
+    object->input_ = input_ ? input_->Clone(storage) : nullptr;
+    object->output_symbol_ = output_symbol_;
+    object->view_ = view_;
+    object->label_ = label_;
+    object->property_ = property_;
+    object->property_name_ = property_name_;
+    object->expression_ = expression_ ? expression_->Clone(storage) : nullptr;
+    return object;
+  }
+};
+
+/// Behaves like @c ScanAll under a VT clause, but looks up the vertices whose
+/// valid time overlaps the queried window in the valid time index. Under a TT
+/// clause too it behaves like @c ScanAllByTime and the vertices are looked up
+/// in the valid time index of the history store. Only vertices whose valid time
+/// overlaps the window are produced.
+///
+/// @sa ScanAllByTime
+class ScanAllByValidTime : public query::plan::ScanAll {
+public:
+  static const utils::TypeInfo kType;
+  const utils::TypeInfo &GetTypeInfo() const override { return kType; }
+
+  ScanAllByValidTime() {}
+  ScanAllByValidTime(const std::shared_ptr<LogicalOperator> &input,
+                     Symbol output_symbol,
+                     storage::View view = storage::View::OLD);
+  bool Accept(HierarchicalLogicalOperatorVisitor &visitor) override;
+  UniqueCursorPtr MakeCursor(utils::MemoryResource *) const override;
+
+  std::unique_ptr<LogicalOperator> Clone(AstStorage *storage) const override {
+    auto object = std::make_unique<ScanAllByValidTime>();
+    object->input_ = input_ ? input_->Clone(storage) : nullptr;
+    object->output_symbol_ = output_symbol_;
+    object->view_ = view_;
+    return object;
+  }
+};
+
 struct ExpandCommon {
   static const utils::TypeInfo kType;
   const utils::TypeInfo &GetTypeInfo() const { return kType; }
@@ -1693,6 +1825,48 @@ public:
   }
 };
 
+/// Behaves like @c Aggregate over the versions read by a temporal scan whose
+/// output symbol is one of the group-by values. The versions of an object come
+/// out of the scan together and never share a group with another object, so
+/// the groups of an object are produced as soon as its versions are read,
+/// instead of keeping the groups of all objects until the input is exhausted.
+///
+/// @sa Aggregate
+/// @sa ScanAllByTime
+class AggregateByTime : public query::plan::Aggregate {
+public:
+  static const utils::TypeInfo kType;
+  const utils::TypeInfo &GetTypeInfo() const override { return kType; }
+
+  AggregateByTime() = default;
+  AggregateByTime(const std::shared_ptr<LogicalOperator> &input,
+                  const std::vector<Element> &aggregations,
+                  const std::vector<Expression *> &group_by,
+                  const std::vector<Symbol> &remember, Symbol object_symbol);
+  bool Accept(HierarchicalLogicalOperatorVisitor &visitor) override;
+  UniqueCursorPtr MakeCursor(utils::MemoryResource *) const override;
+
+  /// Output symbol of the temporal scan, its versions are grouped.
+  Symbol object_symbol_;
+
+  std::unique_ptr<LogicalOperator> Clone(AstStorage *storage) const override {
+    auto object = std::make_unique<AggregateByTime>();
+    object->input_ = input_ ? input_->Clone(storage) : nullptr;
+    object->aggregations_.resize(aggregations_.size());
+    for (auto i3 = 0; i3 < aggregations_.size(); ++i3) {
+      object->aggregations_[i3] = aggregations_[i3].Clone(storage);
+    }
+    object->group_by_.resize(group_by_.size());
+    for (auto i4 = 0; i4 < group_by_.size(); ++i4) {
+      object->group_by_[i4] =
+          group_by_[i4] ? group_by_[i4]->Clone(storage) : nullptr;
+    }
+    object->remember_ = remember_;
+    object->object_symbol_ = object_symbol_;
+    return object;
+  }
+};
+
 /// Skips a number of Pulls from the input op.
 ///
 /// The given expression determines how many Pulls from the input
@@ -45,6 +45,20 @@ const utils::TypeInfo query::plan::ScanAllByLabelProperty::kType{
 const utils::TypeInfo query::plan::ScanAllById::kType{
     0x871151815F9E2E20ULL, "ScanAllById", &query::plan::ScanAll::kType};
 
+const utils::TypeInfo query::plan::ScanAllByTime::kType{
+    0x3A6C0E5D29B47F18ULL, "ScanAllByTime", &query::plan::ScanAll::kType};
+
+const utils::TypeInfo query::plan::ScanAllByLabelByTime::kType{
+    0x5E1B93C7A04D2F61ULL, "ScanAllByLabelByTime",
+    &query::plan::ScanAll::kType};
+
+const utils::TypeInfo query::plan::ScanAllByLabelPropertyValueByTime::kType{
+    0x7C24D8F1B3A95E06ULL, "ScanAllByLabelPropertyValueByTime",
+    &query::plan::ScanAll::kType};
+
+const utils::TypeInfo query::plan::ScanAllByValidTime::kType{
+    0x2D8F4B17E6C35A90ULL, "ScanAllByValidTime", &query::plan::ScanAll::kType};
+
 const utils::TypeInfo query::plan::ExpandCommon::kType{0xB464AF347ACE04F9ULL,
                                                        "ExpandCommon", nullptr};
 
@@ -102,6 +116,9 @@ const utils::TypeInfo query::plan::Aggregate::Element::kType{
 const utils::TypeInfo query::plan::Aggregate::kType{
     0xEA3F371351E8B31BULL, "Aggregate", &query::plan::LogicalOperator::kType};
 
+const utils::TypeInfo query::plan::AggregateByTime::kType{
+    0x4B7E19C2A6D8F035ULL, "AggregateByTime", &query::plan::Aggregate::kType};
+
 const utils::TypeInfo query::plan::Skip::kType{
     0xFB8DB85D475B3D5FULL, "Skip", &query::plan::LogicalOperator::kType};
 
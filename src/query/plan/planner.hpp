@@ -150,21 +150,6 @@ auto MakeLogicalPlan(TPlanningContext *context, TPlanPostProcess *post_process,
   if (query_parts.distinct) {
     last_plan = post_process->MakeDistinct(std::move(last_plan), context);
   }
-  
-  //hjm begin
-  auto history_infos=context->history_infos_;
-  if(history_infos){
-    auto *param_lookup = dynamic_cast<ParameterLookup *>((*history_infos).first);
-    auto left_value=param_lookup->token_position_;//post_process->getParameters().AtTokenPosition(param_lookup->token_position_).ValueInt();
-    
-    auto *param_lookup2 = dynamic_cast<ParameterLookup *>((*history_infos).second);
-    auto right_value=param_lookup2->token_position_;//post_process->getParameters().AtTokenPosition(param_lookup2->token_position_).ValueInt();
-    
-    auto &history_info = *context->history_info_;
-    history_info=std::make_pair(left_value,right_value);
-    // std::cout<<"here hjm 12345:"<<value.ValueInt()<<"\n";
-  }
-  //hjm end
 
   return std::make_pair(std::move(last_plan), total_cost);
 }
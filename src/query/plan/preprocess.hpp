@@ -288,10 +288,11 @@ struct Matching {
 
   //hjm begin
   // std::pair<Expression*,Expression*> history_info_;
-  std::optional<std::pair<int,int>> history_info_;
   std::optional<std::pair<Expression*,Expression*>> history_infos_;
   // std::pair<storage::PropertyValue,storage::PropertyValue> history_infos_;
   //PrimitiveLiteral
+  /// Bounds of the VT clause of the match, the second isn't set for `VT AS`.
+  std::optional<std::pair<Expression*,Expression*>> valid_infos_;
 
   //hjm end
 };
@@ -92,6 +92,39 @@ bool PlanPrinter::PreVisit(ScanAllById &op) {
   return true;
 }
 
+bool PlanPrinter::PreVisit(ScanAllByTime &op) {
+  WithPrintLn([&](auto &out) {
+    out << "* ScanAllByTime"
+        << " (" << op.output_symbol_.name() << ")";
+  });
+  return true;
+}
+
+bool PlanPrinter::PreVisit(ScanAllByLabelByTime &op) {
+  WithPrintLn([&](auto &out) {
+    out << "* ScanAllByLabelByTime"
+        << " (" << op.output_symbol_.name() << " :" << dba_->LabelToName(op.label_) << ")";
+  });
+  return true;
+}
+
+bool PlanPrinter::PreVisit(ScanAllByLabelPropertyValueByTime &op) {
+  WithPrintLn([&](auto &out) {
+    out << "* ScanAllByLabelPropertyValueByTime"
+        << " (" << op.output_symbol_.name() << " :" << dba_->LabelToName(op.label_) << " {"
+        << dba_->PropertyToName(op.property_) << "})";
+  });
+  return true;
+}
+
+bool PlanPrinter::PreVisit(ScanAllByValidTime &op) {
+  WithPrintLn([&](auto &out) {
+    out << "* ScanAllByValidTime"
+        << " (" << op.output_symbol_.name() << ")";
+  });
+  return true;
+}
+
 bool PlanPrinter::PreVisit(query::plan::Expand &op) {
   WithPrintLn([&](auto &out) {
     *out_ << "* Expand (" << op.input_symbol_.name() << ")"
@@ -166,6 +199,18 @@ bool PlanPrinter::PreVisit(query::plan::Aggregate &op) {
   return true;
 }
 
+bool PlanPrinter::PreVisit(query::plan::AggregateByTime &op) {
+  WithPrintLn([&](auto &out) {
+    out << "* AggregateByTime (" << op.object_symbol_.name() << ") {";
+    utils::PrintIterable(out, op.aggregations_, ", ",
+                         [](auto &out, const auto &aggr) { out << aggr.output_sym.name(); });
+    out << "} {";
+    utils::PrintIterable(out, op.remember_, ", ", [](auto &out, const auto &sym) { out << sym.name(); });
+    out << "}";
+  });
+  return true;
+}
+
 PRE_VISIT(Skip);
 PRE_VISIT(Limit);
 
@@ -482,6 +527,54 @@ bool PlanToJsonVisitor::PreVisit(ScanAllById &op) {
   return false;
 }
 
+bool PlanToJsonVisitor::PreVisit(ScanAllByTime &op) {
+  json self;
+  self["name"] = "ScanAllByTime";
+  self["output_symbol"] = ToJson(op.output_symbol_);
+  op.input_->Accept(*this);
+  self["input"] = PopOutput();
+  output_ = std::move(self);
+  return false;
+}
+
+bool PlanToJsonVisitor::PreVisit(ScanAllByLabelByTime &op) {
+  json self;
+  self["name"] = "ScanAllByLabelByTime";
+  self["label"] = ToJson(op.label_, *dba_);
+  self["output_symbol"] = ToJson(op.output_symbol_);
+
+  op.input_->Accept(*this);
+  self["input"] = PopOutput();
+
+  output_ = std::move(self);
+  return false;
+}
+
+bool PlanToJsonVisitor::PreVisit(ScanAllByLabelPropertyValueByTime &op) {
+  json self;
+  self["name"] = "ScanAllByLabelPropertyValueByTime";
+  self["label"] = ToJson(op.label_, *dba_);
+  self["property"] = ToJson(op.property_, *dba_);
+  self["expression"] = ToJson(op.expression_);
+  self["output_symbol"] = ToJson(op.output_symbol_);
+
+  op.input_->Accept(*this);
+  self["input"] = PopOutput();
+
+  output_ = std::move(self);
+  return false;
+}
+
+bool PlanToJsonVisitor::PreVisit(ScanAllByValidTime &op) {
+  json self;
+  self["name"] = "ScanAllByValidTime";
+  self["output_symbol"] = ToJson(op.output_symbol_);
+  op.input_->Accept(*this);
+  self["input"] = PopOutput();
+  output_ = std::move(self);
+  return false;
+}
+
 bool PlanToJsonVisitor::PreVisit(CreateNode &op) {
   json self;
   self["name"] = "CreateNode";
@@ -719,6 +812,21 @@ bool PlanToJsonVisitor::PreVisit(Aggregate &op) {
   return false;
 }
 
+bool PlanToJsonVisitor::PreVisit(AggregateByTime &op) {
+  json self;
+  self["name"] = "AggregateByTime";
+  self["aggregations"] = ToJson(op.aggregations_);
+  self["group_by"] = ToJson(op.group_by_);
+  self["remember"] = ToJson(op.remember_);
+  self["object_symbol"] = ToJson(op.object_symbol_);
+
+  op.input_->Accept(*this);
+  self["input"] = PopOutput();
+
+  output_ = std::move(self);
+  return false;
+}
+
 bool PlanToJsonVisitor::PreVisit(Skip &op) {
   json self;
   self["name"] = "Skip";
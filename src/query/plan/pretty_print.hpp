@@ -68,6 +68,10 @@ class PlanPrinter : public virtual HierarchicalLogicalOperatorVisitor {
   bool PreVisit(ScanAllByLabelPropertyRange &) override;
   bool PreVisit(ScanAllByLabelProperty &) override;
   bool PreVisit(ScanAllById &) override;
+  bool PreVisit(ScanAllByTime &) override;
+  bool PreVisit(ScanAllByLabelByTime &) override;
+  bool PreVisit(ScanAllByLabelPropertyValueByTime &) override;
+  bool PreVisit(ScanAllByValidTime &) override;
 
   bool PreVisit(Expand &) override;
   bool PreVisit(ExpandVariable &) override;
@@ -84,6 +88,7 @@ class PlanPrinter : public virtual HierarchicalLogicalOperatorVisitor {
   bool PreVisit(Produce &) override;
   bool PreVisit(Accumulate &) override;
   bool PreVisit(Aggregate &) override;
+  bool PreVisit(AggregateByTime &) override;
   bool PreVisit(Skip &) override;
   bool PreVisit(Limit &) override;
   bool PreVisit(OrderBy &) override;
@@ -194,10 +199,15 @@ class PlanToJsonVisitor : public virtual HierarchicalLogicalOperatorVisitor {
   bool PreVisit(ScanAllByLabelPropertyValue &) override;
   bool PreVisit(ScanAllByLabelProperty &) override;
   bool PreVisit(ScanAllById &) override;
+  bool PreVisit(ScanAllByTime &) override;
+  bool PreVisit(ScanAllByLabelByTime &) override;
+  bool PreVisit(ScanAllByLabelPropertyValueByTime &) override;
+  bool PreVisit(ScanAllByValidTime &) override;
 
   bool PreVisit(Produce &) override;
   bool PreVisit(Accumulate &) override;
   bool PreVisit(Aggregate &) override;
+  bool PreVisit(AggregateByTime &) override;
   bool PreVisit(Skip &) override;
   bool PreVisit(Limit &) override;
   bool PreVisit(OrderBy &) override;
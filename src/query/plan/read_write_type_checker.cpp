@@ -36,6 +36,10 @@ PRE_VISIT(ScanAllByLabelPropertyRange, RWType::R, true)
 PRE_VISIT(ScanAllByLabelPropertyValue, RWType::R, true)
 PRE_VISIT(ScanAllByLabelProperty, RWType::R, true)
 PRE_VISIT(ScanAllById, RWType::R, true)
+PRE_VISIT(ScanAllByTime, RWType::R, true)
+PRE_VISIT(ScanAllByLabelByTime, RWType::R, true)
+PRE_VISIT(ScanAllByLabelPropertyValueByTime, RWType::R, true)
+PRE_VISIT(ScanAllByValidTime, RWType::R, true)
 
 PRE_VISIT(Expand, RWType::R, true)
 PRE_VISIT(ExpandVariable, RWType::R, true)
@@ -57,6 +61,7 @@ bool ReadWriteTypeChecker::PreVisit(Cartesian &op) {
 PRE_VISIT(Produce, RWType::NONE, true)
 PRE_VISIT(Accumulate, RWType::NONE, true)
 PRE_VISIT(Aggregate, RWType::NONE, true)
+PRE_VISIT(AggregateByTime, RWType::NONE, true)
 PRE_VISIT(Skip, RWType::NONE, true)
 PRE_VISIT(Limit, RWType::NONE, true)
 PRE_VISIT(OrderBy, RWType::NONE, true)
@@ -280,6 +280,48 @@ class IndexLookupRewriter final : public HierarchicalLogicalOperatorVisitor {
     return true;
   }
 
+  bool PreVisit(ScanAllByTime &op) override {
+    prev_ops_.push_back(&op);
+    return true;
+  }
+  // Under a temporal clause the versions of the vertices are produced by the
+  // scan itself, so it's replaced by its variant over the temporal indexes.
+  bool PostVisit(ScanAllByTime &scan) override {
+    prev_ops_.pop_back();
+    auto indexed_scan = GenScanByTimeIndex(scan);
+    if (indexed_scan) {
+      SetOnParent(std::move(indexed_scan));
+    }
+    return true;
+  }
+
+  bool PreVisit(ScanAllByLabelByTime &op) override {
+    prev_ops_.push_back(&op);
+    return true;
+  }
+  bool PostVisit(ScanAllByLabelByTime &) override {
+    prev_ops_.pop_back();
+    return true;
+  }
+
+  bool PreVisit(ScanAllByLabelPropertyValueByTime &op) override {
+    prev_ops_.push_back(&op);
+    return true;
+  }
+  bool PostVisit(ScanAllByLabelPropertyValueByTime &) override {
+    prev_ops_.pop_back();
+    return true;
+  }
+
+  bool PreVisit(ScanAllByValidTime &op) override {
+    prev_ops_.push_back(&op);
+    return true;
+  }
+  bool PostVisit(ScanAllByValidTime &) override {
+    prev_ops_.pop_back();
+    return true;
+  }
+
   bool PreVisit(ConstructNamedPath &op) override {
     prev_ops_.push_back(&op);
     return true;
@@ -379,6 +421,15 @@ class IndexLookupRewriter final : public HierarchicalLogicalOperatorVisitor {
     return true;
   }
 
+  bool PreVisit(AggregateByTime &op) override {
+    prev_ops_.push_back(&op);
+    return true;
+  }
+  bool PostVisit(AggregateByTime &) override {
+    prev_ops_.pop_back();
+    return true;
+  }
+
   bool PreVisit(Skip &op) override {
     prev_ops_.push_back(&op);
     return true;
@@ -635,6 +686,52 @@ class IndexLookupRewriter final : public HierarchicalLogicalOperatorVisitor {
     filter_exprs_for_removal_.insert(removed_expressions.begin(), removed_expressions.end());
     return std::make_unique<ScanAllByLabel>(input, node_symbol, GetLabel(label), view);
   }
+
+  // Creates the temporal variant of ScanAll by the best possible index for the
+  // scanned symbol. Label+property indexes are only used for equality. The
+  // filters are kept, since the indexes return every vertex which matched in
+  // any of its versions and the filters pick the versions which match.
+  std::unique_ptr<ScanAll> GenScanByTimeIndex(const ScanAllByTime &scan) {
+    const auto &input = scan.input();
+    const auto &node_symbol = scan.output_symbol_;
+    const auto &view = scan.view_;
+    const auto labels = filters_.FilteredLabels(node_symbol);
+    if (labels.empty()) return nullptr;
+    const auto &modified_symbols = scan.ModifiedSymbols(*symbol_table_);
+    std::unordered_set<Symbol> bound_symbols(modified_symbols.begin(), modified_symbols.end());
+    auto are_bound = [&bound_symbols](const auto &used_symbols) {
+      for (const auto &used_symbol : used_symbols) {
+        if (!utils::Contains(bound_symbols, used_symbol)) {
+          return false;
+        }
+      }
+      return true;
+    };
+    std::optional<LabelPropertyIndex> found;
+    for (const auto &label : labels) {
+      for (const auto &filter : filters_.PropertyFilters(node_symbol)) {
+        const auto &prop_filter = *filter.property_filter;
+        if (prop_filter.type_ != PropertyFilter::Type::EQUAL || prop_filter.is_symbol_in_value_ ||
+            !are_bound(filter.used_symbols)) {
+          continue;
+        }
+        if (!db_->LabelPropertyIndexExists(GetLabel(label), GetProperty(prop_filter.property_))) continue;
+        int64_t vertex_count = db_->VerticesCount(GetLabel(label), GetProperty(prop_filter.property_));
+        if (!found || vertex_count < found->vertex_count) {
+          found = LabelPropertyIndex{label, filter, vertex_count};
+        }
+      }
+    }
+    if (found) {
+      const auto &prop_filter = *found->filter.property_filter;
+      return std::make_unique<ScanAllByLabelPropertyValueByTime>(input, node_symbol, GetLabel(found->label),
+                                                                 GetProperty(prop_filter.property_),
+                                                                 prop_filter.property_.name, prop_filter.value_, view);
+    }
+    auto maybe_label = FindBestLabelIndex(labels);
+    if (!maybe_label) return nullptr;
+    return std::make_unique<ScanAllByLabelByTime>(input, node_symbol, GetLabel(*maybe_label), view);
+  }
 };
 
 }  // namespace impl
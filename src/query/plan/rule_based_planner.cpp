@@ -345,10 +345,10 @@ class ReturnBodyContext : public HierarchicalTreeVisitor {
     // Aggregation contains a virtual symbol, where the result will be stored.
     const auto &symbol = symbol_table_.at(aggr);
     aggregations_.emplace_back(Aggregate::Element{aggr.expression1_, aggr.expression2_, aggr.op_, symbol});
-    // Aggregation expression1_ is optional in COUNT(*), and COLLECT_MAP uses
-    // two expressions, so we can have 0, 1 or 2 elements on the
+    // Aggregation expression1_ is optional in COUNT(*), and COLLECT_MAP and
+    // TT_WINDOW use two expressions, so we can have 0, 1 or 2 elements on the
     // has_aggregation_stack for this Aggregation expression.
-    if (aggr.op_ == Aggregation::Op::COLLECT_MAP) has_aggregation_.pop_back();
+    if (aggr.expression2_) has_aggregation_.pop_back();
     if (aggr.expression1_)
       has_aggregation_.back() = true;
     else
@@ -434,6 +434,7 @@ class ReturnBodyContext : public HierarchicalTreeVisitor {
   // All symbols generated by named expressions. They are collected in order of
   // named_expressions.
   const auto &output_symbols() const { return output_symbols_; }
+  const auto &symbol_table() const { return symbol_table_; }
 
  private:
   const ReturnBody &body_;
@@ -458,6 +459,26 @@ class ReturnBodyContext : public HierarchicalTreeVisitor {
   std::vector<NamedExpression *> named_expressions_;
 };
 
+// Returns the output symbol of the temporal scan which `input_op` filters, if
+// the aggregation groups by it. The versions of a vertex are produced by the
+// scan together, so its groups can be aggregated one vertex at a time.
+std::optional<Symbol> GroupedTemporalScan(const LogicalOperator &input_op, const ReturnBodyContext &body) {
+  const auto *op = &input_op;
+  while (op->GetTypeInfo() == Filter::kType) op = static_cast<const Filter *>(op)->input_.get();
+  const auto &type = op->GetTypeInfo();
+  if (type != ScanAllByTime::kType && type != ScanAllByLabelByTime::kType &&
+      type != ScanAllByLabelPropertyValueByTime::kType && type != ScanAllByValidTime::kType) {
+    return std::nullopt;
+  }
+  const auto *scan = static_cast<const ScanAll *>(op);
+  if (scan->input_->GetTypeInfo() != Once::kType) return std::nullopt;
+  for (auto *expression : body.group_by()) {
+    auto *identifier = utils::Downcast<Identifier>(expression);
+    if (identifier && body.symbol_table().at(*identifier) == scan->output_symbol_) return scan->output_symbol_;
+  }
+  return std::nullopt;
+}
+
 std::unique_ptr<LogicalOperator> GenReturnBody(std::unique_ptr<LogicalOperator> input_op, bool advance_command,
                                                const ReturnBodyContext &body, bool accumulate = false) {
   std::vector<Symbol> used_symbols(body.used_symbols().begin(), body.used_symbols().end());
@@ -471,7 +492,12 @@ std::unique_ptr<LogicalOperator> GenReturnBody(std::unique_ptr<LogicalOperator>
   if (!body.aggregations().empty()) {
     // When we have aggregation, SKIP/LIMIT should always come after it.
     std::vector<Symbol> remember(body.group_by_used_symbols().begin(), body.group_by_used_symbols().end());
-    last_op = std::make_unique<Aggregate>(std::move(last_op), body.aggregations(), body.group_by(), remember);
+    if (auto object_symbol = accumulate ? std::nullopt : GroupedTemporalScan(*last_op, body)) {
+      last_op = std::make_unique<AggregateByTime>(std::move(last_op), body.aggregations(), body.group_by(), remember,
+                                                  *object_symbol);
+    } else {
+      last_op = std::make_unique<Aggregate>(std::move(last_op), body.aggregations(), body.group_by(), remember);
+    }
   }
   last_op = std::make_unique<Produce>(std::move(last_op), body.named_expressions());
   // Distinct in ReturnBody only makes Produce values unique, so plan after it.
@@ -51,10 +51,10 @@ struct PlanningContext {
 
   //hjm begin
   // std::pair<Expression*,Expression*> history_info_;
-  std::optional<std::pair<int,int>> history_info_;
   std::optional<std::pair<Expression*,Expression*>> history_infos_;
   // std::pair<storage::PropertyValue,storage::PropertyValue> history_infos_;
   //hjm end
+  std::optional<std::pair<Expression*,Expression*>> valid_infos_;
 };
 
 template <class TDbAccessor>
@@ -389,6 +389,7 @@ class RuleBasedPlanner {
     // auto left=matching.history_infos_.first.ValueInt();
     // std::cout<<"left here2 hjm:"<<left<<"\n";
     if(matching.history_infos_)context_->history_infos_=matching.history_infos_;
+    if(matching.valid_infos_)context_->valid_infos_=matching.valid_infos_;
     // context_->history_info_=matching.history_info_;
 
     //hjm end
@@ -405,7 +406,15 @@ class RuleBasedPlanner {
       const auto &node1_symbol = symbol_table.at(*expansion.node1->identifier_);
       if (bound_symbols.insert(node1_symbol).second) {
         // We have just bound this symbol, so generate ScanAll which fills it.
-        last_op = std::make_unique<ScanAll>(std::move(last_op), node1_symbol, match_context.view);
+        // Under a temporal clause the vertices are looked up in the time index,
+        // under a VT clause in the valid time index.
+        if (matching.valid_infos_) {
+          last_op = std::make_unique<ScanAllByValidTime>(std::move(last_op), node1_symbol, match_context.view);
+        } else if (matching.history_infos_) {
+          last_op = std::make_unique<ScanAllByTime>(std::move(last_op), node1_symbol, match_context.view);
+        } else {
+          last_op = std::make_unique<ScanAll>(std::move(last_op), node1_symbol, match_context.view);
+        }
         match_context.new_symbols.emplace_back(node1_symbol);
         last_op = impl::GenFilters(std::move(last_op), bound_symbols, filters, storage);
         last_op = impl::GenNamedPaths(std::move(last_op), bound_symbols, named_paths);
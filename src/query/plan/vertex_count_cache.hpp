@@ -15,6 +15,7 @@
 #include <optional>
 
 #include "query/typed_value.hpp"
+#include "storage/v2/history_delta.hpp"
 #include "storage/v2/id_types.hpp"
 #include "storage/v2/property_value.hpp"
 #include "utils/bound.hpp"
@@ -23,7 +24,7 @@
 namespace query::plan {
 
 /// A stand in class for `TDbAccessor` which provides memoized calls to
-/// `VerticesCount`.
+/// `VerticesCount` and `HistoryStatistics`.
 template <class TDbAccessor>
 class VertexCountCache {
  public:
@@ -72,6 +73,11 @@ class VertexCountCache {
     return bounds_vertex_count.at(bounds);
   }
 
+  const std::optional<history_delta::HistoryStatistics> &HistoryStatistics() {
+    if (!history_statistics_) history_statistics_.emplace(db_->HistoryStatistics());
+    return *history_statistics_;
+  }
+
   bool LabelIndexExists(storage::LabelId label) { return db_->LabelIndexExists(label); }
 
   bool LabelPropertyIndexExists(storage::LabelId label, storage::PropertyId property) {
@@ -120,6 +126,7 @@ class VertexCountCache {
 
   TDbAccessor *db_;
   std::optional<int64_t> vertices_count_;
+  std::optional<std::optional<history_delta::HistoryStatistics>> history_statistics_;
   std::unordered_map<storage::LabelId, int64_t> label_vertex_count_;
   std::unordered_map<LabelPropertyKey, int64_t, LabelPropertyHash> label_property_vertex_count_;
   std::unordered_map<
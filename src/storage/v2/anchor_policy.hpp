@@ -0,0 +1,89 @@
+// Copyright 2021 Memgraph Ltd.
+//
+// Use of this software is governed by the Business Source License
+// included in the file licenses/BSL.txt; by using this file, you agree to be bound by the terms of the Business Source
+// License, and you may not use this file except in compliance with the Business Source License.
+//
+// As of the Change Date specified in that file, in accordance with
+// the Business Source License, use of this software will be governed
+// by the Apache License, Version 2.0, included in the file
+// licenses/APL.txt.
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+
+namespace storage {
+
+/// Bookkeeping used to decide when a vertex or an edge gets a new anchor. It
+/// lives in the object itself and is guarded by the object's lock.
+struct AnchorStats {
+  /// Committed versions written since the last anchor.
+  uint32_t since_anchor{0};
+  /// Interval used when the last anchor decision was taken.
+  uint32_t interval{0};
+  /// Committed versions seen since the object was created or loaded.
+  uint32_t versions{0};
+  /// Historical reconstructions of the object requested by queries.
+  uint32_t history_reads{0};
+  /// Running average of the payload of a single delta, in bytes.
+  uint32_t delta_bytes{0};
+  /// Anchors written for the object.
+  uint32_t anchors{0};
+};
+
+namespace detail {
+inline void SaturatingIncrement(uint32_t &value) {
+  if (value != std::numeric_limits<uint32_t>::max()) ++value;
+}
+}  // namespace detail
+
+/// Accounts for a delta with the given payload size.
+inline void RecordAnchorDelta(AnchorStats &stats, uint64_t bytes) {
+  // An exponential moving average keeps the estimate cheap and lets it follow
+  // the object when its properties change shape.
+  auto current = static_cast<int64_t>(stats.delta_bytes);
+  auto sample = static_cast<int64_t>(std::min<uint64_t>(bytes, std::numeric_limits<uint32_t>::max()));
+  stats.delta_bytes = static_cast<uint32_t>(current == 0 ? sample : current + (sample - current) / 8);
+}
+
+/// Accounts for a historical read of the object.
+inline void RecordAnchorRead(AnchorStats &stats) { detail::SaturatingIncrement(stats.history_reads); }
+
+/// Returns the anchor interval which minimizes the bytes written for anchors
+/// plus the bytes replayed by historical reads, per committed version.
+///
+/// Writing an anchor of `state_bytes` every `k` versions costs `S / k` per
+/// version, while each of the `R / W` reads per version replays `k / 2` deltas
+/// of `d` bytes on average. The sum is minimal for `k = sqrt(2 * S * W / (R * d))`.
+/// The result is clamped to `[1, max_interval]`, so a read never replays more
+/// than `max_interval` deltas, which is also the interval of objects that were
+/// never read.
+inline uint32_t AdaptiveAnchorInterval(const AnchorStats &stats, uint64_t state_bytes, uint32_t max_interval) {
+  max_interval = std::max<uint32_t>(max_interval, 1);
+  if (stats.history_reads == 0) return max_interval;
+  double writes = std::max<uint32_t>(stats.versions, 1);
+  double delta_bytes = std::max<uint32_t>(stats.delta_bytes, 1);
+  double interval = std::sqrt(2.0 * static_cast<double>(state_bytes) * writes / (stats.history_reads * delta_bytes));
+  if (!(interval < max_interval)) return max_interval;
+  return std::max<uint32_t>(static_cast<uint32_t>(interval), 1);
+}
+
+/// Accounts for a new committed version of the object and returns true if an
+/// anchor holding the object's current state has to be written for it. With
+/// `adaptive` unset the fixed `anchor_num` interval is used.
+inline bool AnchorDue(AnchorStats &stats, uint64_t state_bytes, bool adaptive, uint32_t anchor_num,
+                      uint32_t max_anchor_num) {
+  detail::SaturatingIncrement(stats.versions);
+  detail::SaturatingIncrement(stats.since_anchor);
+  stats.interval = adaptive ? AdaptiveAnchorInterval(stats, state_bytes, max_anchor_num) : anchor_num;
+  if (stats.since_anchor <= stats.interval) return false;
+  stats.since_anchor = 1;
+  detail::SaturatingIncrement(stats.anchors);
+  return true;
+}
+
+}  // namespace storage
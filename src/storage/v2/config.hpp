@@ -14,6 +14,7 @@
 #include <chrono>
 #include <cstdint>
 #include <filesystem>
+#include "kvstore/kvstore.hpp"
 #include "storage/v2/isolation_level.hpp"
 #include "storage/v2/transaction.hpp"
 
@@ -33,10 +34,13 @@ struct Config {
     bool properties_on_edges{true};
     int AnchorNum {11};
     bool realTimeFlag{false};
-    //for multiple anchor nums
-    // std::vector<int> AnchorNumLists{10,100,1000};
-    // std::vector<int> HotNumLists{1000,10000,100000};
-    
+    // Chooses the anchor interval per object from its update rate, delta
+    // size and historical reads, see `AdaptiveAnchorInterval`. `AnchorNum`
+    // is used as the fixed interval when it's unset.
+    bool adaptiveAnchorFlag{false};
+    // Upper bound on the deltas replayed by a historical read of an object
+    // when the anchor interval is adaptive.
+    int MaxAnchorNum{64};
   } items;
 
   struct Durability {
@@ -70,5 +74,46 @@ struct Config {
     // const int NUM{11};
   } rocksdb_retention;
 
+  struct History {
+    // Number of threads that encode history records, the records are
+    // partitioned by object gid. 0 encodes and writes them synchronously from
+    // the GC.
+    uint64_t migration_threads{1};
+    // Maximum number of GC cycles waiting to be written, the GC blocks once
+    // the queue is full.
+    uint64_t migration_queue_size{16};
+    // Memory budget of the cache of versions rebuilt from the history store,
+    // 0 disables the cache.
+    uint64_t cache_bytes{256ULL * 1024 * 1024};
+    // Stores every kind of history record in its own RocksDB column family.
+    bool column_families{true};
+    // Bits per key of the bloom filters on the record keys and on their
+    // `<kind>:<gid>:` prefixes, 0 disables the filters.
+    uint32_t bloom_bits_per_key{10};
+    // Size of the block cache shared by all column families of the history
+    // store.
+    uint64_t block_cache_bytes{512ULL * 1024 * 1024};
+    kvstore::Compression compression{kvstore::Compression::LZ4};
+    // Compression of the last level, which holds the oldest history.
+    kvstore::Compression bottommost_compression{kvstore::Compression::ZSTD};
+    // Collects the read counters of the history store reported by SHOW
+    // STORAGE INFO.
+    bool statistics{false};
+    // Number of vertices whose history a temporal scan looks up together,
+    // 1 looks up every vertex on its own.
+    uint64_t scan_batch_size{256};
+    // Number of threads that rebuild the versions of a batch, each one a
+    // contiguous gid range of it. 1 rebuilds them on the scanning thread.
+    uint64_t scan_threads{1};
+    // Directory of the cold tier, which keeps old history in immutable
+    // segment files. Empty keeps all history in the history store.
+    std::filesystem::path cold_directory;
+    // History moves to the cold tier once it ended longer ago than
+    // `cold_after`, checked every `cold_interval`. Requires real time
+    // timestamps.
+    std::chrono::milliseconds cold_after{std::chrono::hours(24 * 30)};
+    std::chrono::milliseconds cold_interval{std::chrono::hours(1)};
+  } history;
+
 };
 }  // namespace storage
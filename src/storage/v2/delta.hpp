@@ -12,12 +12,13 @@
 #pragma once
 
 #include <atomic>
+#include <memory>
 
 #include "storage/v2/edge_ref.hpp"
+#include "storage/v2/history_record.hpp"
 #include "storage/v2/id_types.hpp"
 #include "storage/v2/property_value.hpp"
 #include "utils/logging.hpp"
-#include <json/json.hpp>
 namespace storage {
 
 // Forward declarations because we only store pointers here.
@@ -230,7 +231,8 @@ struct Delta {
 	uint64_t transaction_st;
   // uint64_t start_timestamp;
 	uint64_t commit_timestamp;
-  nlohmann::json add_info;
+  // State of the deleted object, only set for RECREATE_OBJECT deltas.
+  std::unique_ptr<history_delta::HistoryRecord> add_info;
   //hjm end
 
   union {
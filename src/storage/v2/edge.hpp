@@ -13,6 +13,7 @@
 
 #include <limits>
 
+#include "storage/v2/anchor_policy.hpp"
 #include "storage/v2/delta.hpp"
 #include "storage/v2/id_types.hpp"
 #include "storage/v2/property_store.hpp"
@@ -27,14 +28,12 @@ struct Edge {
   Edge(Gid gid, Delta *delta) : gid(gid), deleted(false), delta(delta) {
     transaction_st=0;
     // tt_te=(uint64_t)std::numeric_limits<int64_t>::max();
-    num=0;
     MG_ASSERT(delta == nullptr || delta->action == Delta::Action::DELETE_OBJECT,
               "Edge must be created with an initial DELETE_OBJECT delta!");
   }
 
   Edge(Gid gid, Delta *delta,uint64_t transaction_st,Gid from_gid,Gid to_gid) : gid(gid),deleted(false),transaction_st(transaction_st),from_gid(from_gid),to_gid(to_gid),delta(delta){
     transaction_st=0;
-    num=0;
     // tt_te=(uint64_t)std::numeric_limits<int64_t>::max();
   }
 
@@ -53,7 +52,7 @@ struct Edge {
   // uint64_t tt_te;
   Gid from_gid;
   Gid to_gid;
-  int num;
+  AnchorStats anchor;
   //hjm end
 
   Delta *delta;
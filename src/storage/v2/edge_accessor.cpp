@@ -21,6 +21,15 @@
 
 namespace storage {
 
+namespace {
+// Accounts for a new committed version of `edge` and returns true if an
+// anchor holding its current properties has to be stored.
+bool EdgeAnchorDue(Edge *edge, const Config::Items &config) {
+  return AnchorDue(edge->anchor, edge->properties.Size(), config.adaptiveAnchorFlag, config.AnchorNum,
+                   config.MaxAnchorNum);
+}
+}  // namespace
+
 bool EdgeAccessor::IsVisible(const View view) const {
   bool deleted = true;
   bool exists = true;
@@ -91,6 +100,18 @@ uint64_t get_transaction_st(Vertex*vertex_ ){
 }
 //hjm end
 
+void EdgeAccessor::RecordHistoryRead() {
+  if (!config_.properties_on_edges) return;
+  std::lock_guard<utils::SpinLock> guard(edge_.ptr->lock);
+  RecordAnchorRead(edge_.ptr->anchor);
+}
+
+AnchorStats EdgeAccessor::GetAnchorStats() const {
+  if (!config_.properties_on_edges) return {};
+  std::lock_guard<utils::SpinLock> guard(edge_.ptr->lock);
+  return edge_.ptr->anchor;
+}
+
 Result<storage::PropertyValue> EdgeAccessor::SetProperty(PropertyId property, const PropertyValue &value) {
   utils::MemoryTracker::OutOfMemoryExceptionEnabler oom_exception;
   if (!config_.properties_on_edges) return Error::PROPERTIES_DISABLED;
@@ -114,10 +135,7 @@ Result<storage::PropertyValue> EdgeAccessor::SetProperty(PropertyId property, co
         return Error::SERIALIZATION_ERROR;
       }
     }else{//前一个delta提交了 全量提交
-      // std::cout<<"edge commit:"<<ts<<" "<<edge_.ptr->num<<"\n";
-      edge_.ptr->num+=1;
-      if(edge_.ptr->num>config_.AnchorNum){
-        edge_.ptr->num=1;
+      if(EdgeAnchorDue(edge_.ptr,config_)){
         // save edge to restore properties
         if(AnchorFlag){
           auto maybe_properties = edge_.ptr->properties.Properties();
@@ -147,6 +165,7 @@ Result<storage::PropertyValue> EdgeAccessor::SetProperty(PropertyId property, co
   // "modify in-place". Additionally, the created delta will make other
   // transactions get a SERIALIZATION_ERROR.
   auto delta=CreateAndLinkDelta(transaction_, edge_.ptr, Delta::SetPropertyTag(), property, current_value);
+  RecordAnchorDelta(edge_.ptr->anchor,EncodedPropertySize(property,current_value));
   //hjm begin
   delta->from_gid=edge_.ptr->from_gid;
   delta->to_gid=edge_.ptr->to_gid;
@@ -178,10 +197,7 @@ Result<std::map<PropertyId, PropertyValue>> EdgeAccessor::ClearProperties() {
         return Error::SERIALIZATION_ERROR;
       }
     }else{//前一个delta提交了 全量提交
-      // std::cout<<"edge commit:"<<ts<<" "<<edge_.ptr->num<<"\n";
-      edge_.ptr->num+=1;
-      if(edge_.ptr->num>config_.AnchorNum){
-        edge_.ptr->num=1;
+      if(EdgeAnchorDue(edge_.ptr,config_)){
         // save edge to restore properties
         if(AnchorFlag){
           auto maybe_properties = edge_.ptr->properties.Properties();
@@ -206,6 +222,7 @@ Result<std::map<PropertyId, PropertyValue>> EdgeAccessor::ClearProperties() {
   auto properties = edge_.ptr->properties.Properties();
   for (const auto &property : properties) {
     auto delta=CreateAndLinkDelta(transaction_, edge_.ptr, Delta::SetPropertyTag(), property.first, property.second);
+    RecordAnchorDelta(edge_.ptr->anchor,EncodedPropertySize(property.first,property.second));
     //hjm begin
     delta->from_gid=edge_.ptr->from_gid;
     delta->to_gid=edge_.ptr->to_gid;
@@ -109,6 +109,13 @@ class EdgeAccessor final {
   Delta *getDeltas(){
   return edge_.ptr->delta;
   }
+
+  /// Accounts for a historical read of the edge, used to place its anchors.
+  /// Edges without properties have no anchors, so nothing is recorded.
+  void RecordHistoryRead();
+
+  /// Returns the statistics used to place the anchors of the edge.
+  AnchorStats GetAnchorStats() const;
   //hjm end
 
   bool IsCycle() const { return from_vertex_ == to_vertex_; }
@@ -0,0 +1,129 @@
+// Copyright 2021 Memgraph Ltd.
+//
+// Use of this software is governed by the Business Source License
+// included in the file licenses/BSL.txt; by using this file, you agree to be bound by the terms of the Business Source
+// License, and you may not use this file except in compliance with the Business Source License.
+//
+// As of the Change Date specified in that file, in accordance with
+// the Business Source License, use of this software will be governed
+// by the Apache License, Version 2.0, included in the file
+// licenses/APL.txt.
+
+#include "storage/v2/history_cache.hpp"
+
+#include <algorithm>
+
+#include "storage/v2/property_store.hpp"
+#include "utils/event_counter.hpp"
+
+namespace EventCounter {
+extern const Event HistoryCacheHits;
+extern const Event HistoryCacheMisses;
+extern const Event HistoryCacheEvictions;
+}  // namespace EventCounter
+
+namespace history_delta {
+extern bool TemporalCheck(uint64_t object_ts, uint64_t object_te, uint64_t c_ts, uint64_t c_te, std::string type);
+}  // namespace history_delta
+
+namespace storage {
+
+namespace {
+constexpr size_t kHistoryCacheShards = 16;
+// Rough cost of a node of the property map, on top of the encoded value.
+constexpr uint64_t kPropertyNodeBytes = 48;
+
+uint64_t PropertiesBytes(const std::map<PropertyId, PropertyValue> &properties) {
+  uint64_t bytes = 0;
+  for (const auto &[property, value] : properties) {
+    bytes += kPropertyNodeBytes + EncodedPropertySize(property, value);
+  }
+  return bytes;
+}
+}  // namespace
+
+HistoryCache::HistoryCache(uint64_t byte_budget)
+    : enabled_(byte_budget != 0),
+      vertices_(kHistoryCacheShards, byte_budget / 2),
+      edges_(kHistoryCacheShards, byte_budget / 2) {}
+
+template <typename TValue>
+std::optional<std::vector<TValue>> HistoryCache::FindVersions(VersionCache<TValue> &cache, uint64_t gid,
+                                                              uint64_t c_ts, uint64_t c_te, const std::string &types,
+                                                              std::optional<uint64_t> history_end) {
+  if (!enabled_) return std::nullopt;
+  auto miss = [] {
+    EventCounter::IncrementCounter(EventCounter::HistoryCacheMisses);
+    return std::nullopt;
+  };
+  // Versions of an object are contiguous, so the window is covered when the
+  // walk starts at the version holding `c_ts` and follows each version to
+  // the one starting where it ends.
+  auto first = cache.FindFloor({gid, c_ts});
+  if (!first || first->first.gid != gid || first->second.tt_te <= c_ts) return miss();
+  std::vector<TValue> versions;
+  auto version = std::move(first->second);
+  while (true) {
+    auto end = version.tt_te;
+    if (history_delta::TemporalCheck(version.tt_ts, version.tt_te, c_ts, c_te, types)) {
+      versions.push_back(std::move(version));
+    }
+    // Only the version holding `c_ts` can be visible as of a point in time,
+    // and versions starting after `c_te` aren't visible in any window.
+    if (types == "as of" || end > c_te) break;
+    if (history_end && end >= *history_end) break;
+    auto next = cache.Find({gid, end});
+    if (!next) return miss();
+    version = std::move(*next);
+  }
+  std::reverse(versions.begin(), versions.end());
+  EventCounter::IncrementCounter(EventCounter::HistoryCacheHits);
+  return versions;
+}
+
+std::optional<std::vector<HistoryVertex>> HistoryCache::FindVertexVersions(uint64_t gid, uint64_t c_ts,
+                                                                           uint64_t c_te, const std::string &types,
+                                                                           std::optional<uint64_t> history_end) {
+  return FindVersions(vertices_, gid, c_ts, c_te, types, history_end);
+}
+
+std::optional<std::vector<HistoryEdge>> HistoryCache::FindEdgeVersions(uint64_t gid, uint64_t c_ts, uint64_t c_te,
+                                                                       const std::string &types,
+                                                                       std::optional<uint64_t> history_end) {
+  return FindVersions(edges_, gid, c_ts, c_te, types, history_end);
+}
+
+void HistoryCache::InsertVertexVersion(const HistoryVertex &vertex) {
+  if (!enabled_) return;
+  // The adjacency points into the live storage and is taken from the live
+  // vertex on every read, it isn't cached.
+  HistoryVertex version(vertex.gid);
+  version.tt_ts = vertex.tt_ts;
+  version.tt_te = vertex.tt_te;
+  version.labels = vertex.labels;
+  version.properties = vertex.properties;
+  auto bytes = sizeof(HistoryVertex) + version.labels.size() * sizeof(LabelId) + PropertiesBytes(version.Properties());
+  auto evicted = vertices_.Insert({vertex.gid.AsUint(), vertex.tt_ts}, version, bytes);
+  if (evicted) EventCounter::IncrementCounter(EventCounter::HistoryCacheEvictions, evicted);
+}
+
+void HistoryCache::InsertEdgeVersion(const HistoryEdge &edge) {
+  if (!enabled_) return;
+  auto bytes = sizeof(HistoryEdge) + PropertiesBytes(edge.Properties());
+  auto evicted = edges_.Insert({edge.gid.AsUint(), edge.tt_ts}, edge, bytes);
+  if (evicted) EventCounter::IncrementCounter(EventCounter::HistoryCacheEvictions, evicted);
+}
+
+void HistoryCache::Clear() {
+  vertices_.Clear();
+  edges_.Clear();
+}
+
+HistoryCache::Stats HistoryCache::GetStats() const {
+  auto vertices = vertices_.GetStats();
+  auto edges = edges_.GetStats();
+  return {vertices.hits + edges.hits, vertices.misses + edges.misses, vertices.evictions + edges.evictions,
+          vertices.bytes + edges.bytes};
+}
+
+}  // namespace storage
@@ -0,0 +1,110 @@
+// Copyright 2021 Memgraph Ltd.
+//
+// Use of this software is governed by the Business Source License
+// included in the file licenses/BSL.txt; by using this file, you agree to be bound by the terms of the Business Source
+// License, and you may not use this file except in compliance with the Business Source License.
+//
+// As of the Change Date specified in that file, in accordance with
+// the Business Source License, use of this software will be governed
+// by the Apache License, Version 2.0, included in the file
+// licenses/APL.txt.
+
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <optional>
+#include <string>
+#include <vector>
+
+// Also defines `HistoryEdge`, the two headers have to be included in this order.
+#include "storage/v2/history_vertex.hpp"
+#include "utils/cache.hpp"
+
+namespace storage {
+
+/// Identifies one version of a vertex or an edge by the object and the start
+/// of the version.
+struct HistoryVersionKey {
+  uint64_t gid;
+  uint64_t tt_ts;
+};
+
+inline bool operator==(const HistoryVersionKey &first, const HistoryVersionKey &second) {
+  return first.gid == second.gid && first.tt_ts == second.tt_ts;
+}
+inline bool operator<(const HistoryVersionKey &first, const HistoryVersionKey &second) {
+  return first.gid < second.gid || (first.gid == second.gid && first.tt_ts < second.tt_ts);
+}
+
+}  // namespace storage
+
+namespace std {
+template <>
+struct hash<storage::HistoryVersionKey> {
+  size_t operator()(const storage::HistoryVersionKey &key) const {
+    return hash<uint64_t>{}(key.gid) ^ (hash<uint64_t>{}(key.tt_ts) * 0x9E3779B97F4A7C15ULL);
+  }
+};
+}  // namespace std
+
+namespace storage {
+
+/// Memory bounded cache of vertex and edge versions rebuilt from the history
+/// store. Versions are keyed by object and version start, so every query
+/// window reading a version shares the entry. All versions of an object live
+/// in the same shard, which lets a window be answered by walking the versions
+/// from the one covering its start.
+class HistoryCache {
+ public:
+  using Stats = utils::ShardedLruCache<HistoryVersionKey, HistoryVertex>::Stats;
+
+  /// A budget of 0 disables the cache.
+  explicit HistoryCache(uint64_t byte_budget);
+
+  /// Returns the versions of the vertex kept in the history store which are
+  /// visible in the window, newest first like `History_delta::GetVertexInfo`.
+  /// nullopt is returned if the cache can't prove it holds all of them. The
+  /// history store versions end at `history_end`, if it's known. The returned
+  /// versions have no adjacency, it is taken from the live vertex.
+  std::optional<std::vector<HistoryVertex>> FindVertexVersions(uint64_t gid, uint64_t c_ts, uint64_t c_te,
+                                                               const std::string &types,
+                                                               std::optional<uint64_t> history_end);
+
+  /// Same as `FindVertexVersions`, for the versions of an edge.
+  std::optional<std::vector<HistoryEdge>> FindEdgeVersions(uint64_t gid, uint64_t c_ts, uint64_t c_te,
+                                                           const std::string &types,
+                                                           std::optional<uint64_t> history_end);
+
+  void InsertVertexVersion(const HistoryVertex &vertex);
+
+  void InsertEdgeVersion(const HistoryEdge &edge);
+
+  /// Drops every version, used when the history store forgets versions.
+  void Clear();
+
+  /// Returns the counters of the version lookups, summed over vertices and
+  /// edges.
+  Stats GetStats() const;
+
+ private:
+  // Keeps all versions of an object in one shard.
+  struct ShardOfObject {
+    size_t operator()(const HistoryVersionKey &key) const { return std::hash<uint64_t>{}(key.gid); }
+  };
+
+  template <typename TValue>
+  using VersionCache = utils::ShardedLruCache<HistoryVersionKey, TValue, ShardOfObject>;
+
+  template <typename TValue>
+  std::optional<std::vector<TValue>> FindVersions(VersionCache<TValue> &cache, uint64_t gid, uint64_t c_ts,
+                                                  uint64_t c_te, const std::string &types,
+                                                  std::optional<uint64_t> history_end);
+
+  bool enabled_;
+  VersionCache<HistoryVertex> vertices_;
+  VersionCache<HistoryEdge> edges_;
+};
+
+}  // namespace storage
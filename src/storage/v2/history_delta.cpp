@@ -1,70 +1,32 @@
 #include "storage/v2/history_delta.hpp"
 #include "query/db_accessor.hpp"
+#include <algorithm>
+#include <array>
+#include <charconv>
 #include <cstring>
+#include <shared_mutex>
+#include <system_error>
+#include <thread>
 #include <fmt/format.h>
+#include <spdlog/spdlog.h>
 
 #include <stdlib.h>
+#include "storage/v2/property_store.hpp"
+#include "storage/v2/valid_time.hpp"
 #include "utils/flag_validation.hpp"
+#include "utils/event_counter.hpp"
+#include "utils/exceptions.hpp"
+#include "utils/file.hpp"
+#include "utils/fnv.hpp"
+#include "utils/logging.hpp"
 #include "utils/settings.hpp"
-#include <json/json.hpp>
-#include "query/serialization/property_value.hpp"
-namespace history_delta {
-
-namespace {
-enum class ObjectType : uint8_t { MAP, TEMPORAL_DATA };
-}  // namespace
-
-nlohmann::json SerializePropertyValueVector(const std::vector<storage::PropertyValue> &values);
-
-nlohmann::json SerializePropertyValueMap(const std::map<std::string, storage::PropertyValue> &parameters);
-
-nlohmann::json SerializePropertyValue(const storage::PropertyValue &property_value) {
-  using Type = storage::PropertyValue::Type;
-  switch (property_value.type()) {
-    case Type::Null:
-      return {};
-    case Type::Bool:
-      return property_value.ValueBool();
-    case Type::Int:
-      return property_value.ValueInt();
-    case Type::Double:
-      return property_value.ValueDouble();
-    case Type::String:
-      return property_value.ValueString();
-    case Type::List:
-      return SerializePropertyValueVector(property_value.ValueList());
-    case Type::Map:
-      return SerializePropertyValueMap(property_value.ValueMap());
-    case Type::TemporalData:
-      const auto temporal_data = property_value.ValueTemporalData();
-      auto data = nlohmann::json::object();
-      data.emplace("type", static_cast<uint64_t>(ObjectType::TEMPORAL_DATA));
-      data.emplace("value", nlohmann::json::object({{"type", static_cast<uint64_t>(temporal_data.type)},
-                                                    {"microseconds", temporal_data.microseconds}}));
-      return data;
-  }
-}
-
-nlohmann::json SerializePropertyValueVector(const std::vector<storage::PropertyValue> &values) {
-  nlohmann::json array = nlohmann::json::array();
-  for (const auto &value : values) {
-    array.push_back(SerializePropertyValue(value));
-  }
-  return array;
-}
-
-nlohmann::json SerializePropertyValueMap(const std::map<std::string, storage::PropertyValue> &parameters) {
-  nlohmann::json data = nlohmann::json::object();
-  data.emplace("type", static_cast<uint64_t>(ObjectType::MAP));
-  data.emplace("value", nlohmann::json::object());
-
-  for (const auto &[key, value] : parameters) {
-    data["value"][key] = SerializePropertyValue(value);
-  }
-
-  return data;
-};
+#include "utils/thread.hpp"
+namespace EventCounter {
+extern const Event HistoryProbes;
+extern const Event HistoryProbesAvoided;
+}  // namespace EventCounter
 
+namespace history_delta {
 
 //help functions
  bool TemporalCheck(uint64_t object_ts,uint64_t object_te,uint64_t c_ts,uint64_t c_te,std::string type){
@@ -125,222 +87,1251 @@ std::string uint_convert_to_string(const int64_t time,bool realTimeFlagConstant)
     return start_str;
 }
 
-std::tuple<uint64_t,int64_t,int64_t> string_convert_to_uint(std::string res,bool realTimeFlagConstant){
-    auto size=sizeof(int64_t);
-    auto length=res.length();
-    //获取gid
-    size_t pos = res.find(":");
-    auto get_size=length-2*size-3-pos;
-    auto gid_str=res.substr(pos+1,get_size);//3:4 12 20-2*8
-    auto gid=(uint64_t)std::stoi(gid_str);
-    //处理时间
-    auto redo_str1=res.substr(length-size);//12:
-    auto redo_str2=res.substr(length-2*size-1,size);//3:12
-    char redo[size];
-    char redo2[size];
-    for(int i=0;i<size;i++){
-        redo[i]=redo_str1[i];
-        redo2[i]=redo_str2[i];
-    }
-    auto ts = *(int64_t*) redo2;// redo_str;
-    auto te = *(int64_t*) redo;
-    ts=swap64(ts);
-    te=swap64(te);
-    return std::make_tuple(gid,ts,te);
-}
-
-void combineVertex(nlohmann::json before_data,nlohmann::json &current_data){
-  for (auto it = before_data.begin(); it != before_data.end(); ++it) {
-    auto it_key = it.key();
-    auto it_value=it.value();
-    auto it_iter=current_data.find(it_key);
-    if(it_iter==current_data.end()){//如果当前数据没有这种类型，则直接添加
-      current_data.emplace(it_key,it_value);
-    }else{//否则，需要合并value的json
-      if(it_key=="SP"){
-        auto now_prop_value = current_data["SP"];
-        auto before_prop_value=it_value;
-        for(auto before_iter= before_prop_value.begin(); before_iter != before_prop_value.end(); ++before_iter){
-          auto before_iter_key = before_iter.key();
-          auto before_iter_value=before_iter.value();
-          auto bb=now_prop_value.find(before_iter_key);
-          if(bb==now_prop_value.end()){
-            current_data["SP"].emplace(before_iter_key,before_iter_value);
-          }
-        }
-      }
-      else if(it_key=="L"){
-        auto &current_info=current_data[it_key];
-        for(auto before_label:before_data[it_key]){
-          current_info.emplace_back(before_label);
-        }  
-      }
-    }
-  }
+// Record keys are a 1 byte kind followed by the gid and two timestamps, all 8
+// byte big endian, so the records of an object are contiguous and objects are
+// ordered by gid. Delta keys hold the negated start and end of the version,
+// which puts the newest version first, anchor keys hold their start twice.
+// Kind and gid, the prefix shared by all records of an object.
+const size_t kRecordGroupSize=1+sizeof(int64_t);
+const size_t kRecordKeySize=kRecordGroupSize+2*sizeof(int64_t);
+// The removed edges of a vertex are kept one per key: kind, gid, direction (1
+// byte), edge type, negated commit timestamp of the removal and edge gid. The
+// removals of one direction and edge type are contiguous and the newest come
+// first, so an expansion only reads the edges it can follow.
+const size_t kVertexEdgeKeySize=kRecordGroupSize+1+3*sizeof(int64_t);
+
+// Parses a record key in place.
+std::tuple<uint64_t,int64_t,int64_t> ParseRecordKey(std::string_view key){
+  int64_t fields[3];
+  std::memcpy(fields,key.data()+1,sizeof(fields));
+  return std::make_tuple((uint64_t)swap64(fields[0]),swap64(fields[1]),swap64(fields[2]));
 }
 
-void combineEdge(nlohmann::json before_data,nlohmann::json &current_data){
-  for (auto it = before_data.begin(); it != before_data.end(); ++it) {
-     auto edge_id = it.key();
-     if(edge_id=="TT_TS" || edge_id=="TT_TE" ||edge_id=="Type" ||edge_id=="Fid"||edge_id=="Tid") continue;
-     auto edge_jsons=it.value();
-     auto it_iter=current_data.find(edge_id);
-    if(it_iter==current_data.end()){//如果当前数据没有这个节点的信息，则直接添加
-      current_data.emplace(edge_id,edge_jsons);
-    }else{
-      combineVertex(before_data[edge_id],current_data[edge_id]);
-    }
-  }
+// Parses a record key of the text layout `<kind>:<gid>:<ts>:<te>` used before
+// the binary one, the gid is decimal and the timestamps 8 byte big endian.
+std::optional<std::tuple<uint64_t,int64_t,int64_t>> ParseLegacyRecordKey(std::string_view key){
+  constexpr auto size=sizeof(int64_t);
+  auto gid_begin=key.find(':');
+  if(gid_begin==std::string_view::npos || key.size()<gid_begin+2*size+3) return std::nullopt;
+  auto gid_end=key.size()-2*size-2;
+  uint64_t gid=0;
+  auto [end,error]=std::from_chars(key.data()+gid_begin+1,key.data()+gid_end,gid);
+  if(error!=std::errc() || end!=key.data()+gid_end) return std::nullopt;
+  int64_t ts;
+  int64_t te;
+  std::memcpy(&ts,key.data()+gid_end+1,size);
+  std::memcpy(&te,key.data()+key.size()-size,size);
+  return std::make_tuple(gid,swap64(ts),swap64(te));
 }
 
+// Parses a removed edge key in place into the gid, direction, edge type,
+// commit timestamp and edge gid.
+std::tuple<uint64_t,bool,uint64_t,uint64_t,uint64_t> ParseVertexEdgeKey(std::string_view key){
+  int64_t gid;
+  int64_t fields[3];
+  std::memcpy(&gid,key.data()+1,sizeof(gid));
+  std::memcpy(fields,key.data()+kRecordGroupSize+1,sizeof(fields));
+  return std::make_tuple((uint64_t)swap64(gid),key[kRecordGroupSize]!=0,(uint64_t)swap64(fields[0]),
+                         (uint64_t)-swap64(fields[1]),(uint64_t)swap64(fields[2]));
+}
 
 const std::string kDeltaPrefix = "D:";
 const std::string kRecreatePrefix = "R:";
 
-const std::string kVertexDeltaPrefix = "VD:";
-const std::string kVertexAnchorPrefix = "VA:";
-const std::string kEdgeDeltaPrefix = "ED:";
-const std::string kEdgeAnchorPrefix = "EA:";
-const std::string kVertexEdgePrefix = "VE:";
+// Kinds of the record keys. They don't collide with the text prefixes of the
+// other keys of the history store.
+const std::string kVertexDeltaPrefix("\x01",1);
+const std::string kVertexAnchorPrefix("\x02",1);
+const std::string kEdgeDeltaPrefix("\x03",1);
+const std::string kEdgeAnchorPrefix("\x04",1);
+const std::string kVertexEdgePrefix("\x05",1);
 
 const std::string kVertexTimePrefix="VT:";
 const std::string kEdgeTimePrefix="ET:";
 
+// Time index over the versions of the vertices, a segment tree whose node
+// (level, bucket) covers the timestamps [bucket << level, (bucket + 1) <<
+// level). A posting key is prefix + level (1 byte) + bucket + gid, both 8 byte
+// big endian, so the postings of a level are ordered by bucket.
+const std::string kTimeIndexPrefix="TI:";
+// Written once the versions stored before the time index existed are posted.
+const std::string kTimeIndexKey="TIX:";
+// The lowest level buckets span 2^kTimeIndexMinLevel timestamps, which keeps
+// the number of postings per version small.
+const uint64_t kTimeIndexMinLevel=8;
+const uint64_t kTimeIndexMaxLevel=63;
+// Highest level holding a transaction time posting, a decimal number. Stores
+// posted before it was kept are scanned on all levels, as is the valid time
+// index, whose open intervals reach the top level anyway.
+const std::string kTimeIndexLevelKey="TIL:";
+// Temporal indexes over the labels and the label+property values of vertex
+// versions. The scope of a label is prefix + label, the scope of a value is
+// prefix + label + property + hash of the value.
+const std::string kLabelIndexPrefix="TL:";
+const std::string kLabelPropertyIndexPrefix="TP:";
+// Timestamp from which on a temporal index is complete, keyed by prefix +
+// label [+ property]. Empty once the index is dropped.
+const std::string kTemporalIndexSincePrefix="TC:";
+// Valid time index, the valid time [vt_from, vt_to) of a vertex version is
+// posted in the buckets covering it, which hold the same gid postings as the
+// transaction time index. The bound it is complete from is kept on its own.
+const std::string kValidTimeIndexPrefix="TV:";
+const std::string kValidTimeSinceKey="TVX:";
+// Statistics of the history store, the value is a decimal count. "VV" and
+// "EV" hold the number of vertex and edge versions, "L:<label>" the vertex
+// versions of a label and "DV:<bucket>" and "DE:<bucket>" the vertices and
+// edges deleted in a time bucket.
+const std::string kStatisticsPrefix="HS:";
+const std::string kVertexVersionsKey=kStatisticsPrefix+"VV";
+const std::string kEdgeVersionsKey=kStatisticsPrefix+"EV";
+// Temporal rollups, keyed by prefix + name. The value holds the label and the
+// property, both disk IDs, the aggregate (1 byte), the width and the since
+// bound, all 8 byte big endian. The buckets are the leaves of a segment tree
+// whose node (level, n) covers the buckets [n << level, (n + 1) << level). A
+// node is keyed by prefix + length of the name + name + level (1 byte) +
+// start of its first bucket, its value is the count followed by the sum, the
+// minimum and the maximum of the versions covering all of its buckets,
+// encoded as properties 0, 1 and 2.
+const std::string kRollupPrefix="TR:";
+const std::string kRollupBucketPrefix="TRB:";
+// Written nodes kept in memory per rollup, the oldest buckets are evicted
+// first.
+const size_t kRollupCachedBuckets=4096;
+
+
+// Dictionary of the label, property and edge type names used by the records,
+// keyed by the ID persisted in the records.
+const std::string kNameIdPrefix="NM:";
+// Written once all records are stored in the binary format.
+const std::string kFormatKey="FMT:";
 
-History_delta::History_delta(const std::string &storage_directory) : storage_(storage_directory) {}
+// Written once all record keys are stored in the binary layout.
+const std::string kKeyFormatKey="KFMT:";
+// Written once the removed edges are stored one per key.
+const std::string kVertexEdgeFormatKey="VEFMT:";
+// Retention cutoff, a decimal timestamp. The versions which ended at it or
+// earlier expired.
+const std::string kRetentionCutoffKey="RC:";
 
-History_delta::History_delta(const std::string &storage_directory,bool realTimeFlag) : storage_(storage_directory) {
-  realTimeFlagConstant=realTimeFlag;
+const std::array<std::string,5> kRecordPrefixes={kVertexDeltaPrefix,kVertexAnchorPrefix,kEdgeDeltaPrefix,kEdgeAnchorPrefix,kVertexEdgePrefix};
+// Prefixes of the text record keys, in the order of `kRecordPrefixes`.
+const std::array<std::string,5> kLegacyRecordPrefixes={"VD:","VA:","ED:","EA:","VE:"};
+
+// Every kind of record and the time tables get a column family of their own.
+// Keys are grouped by kind and gid, so the lookups of an object skip the files
+// which hold no version of it.
+// End of the version kept by a record, the commit of a removed edge and the
+// start of an anchor. Only record keys carry it.
+std::optional<uint64_t> RecordEnd(std::string_view key){
+  int64_t te;
+  if(key.size()==kVertexEdgeKeySize && key[0]==kVertexEdgePrefix[0]){
+    te=(int64_t)std::get<3>(ParseVertexEdgeKey(key));
+  }else if(key.size()==kRecordKeySize && key[0]>=kVertexDeltaPrefix[0] && key[0]<=kEdgeAnchorPrefix[0]){
+    te=std::get<2>(ParseRecordKey(key));
+  }else{
+    return std::nullopt;
+  }
+  return (uint64_t)(te>0?te:-te);
 }
 
+// A record expires once the version it keeps ended at the retention cutoff or
+// earlier, all other keys are kept.
+bool ExpiredRecord(std::string_view key,int64_t cutoff){
+  auto te=RecordEnd(key);
+  return te && (int64_t)*te<=cutoff;
+}
 
+kvstore::KVStore::Options HistoryStoreOptions(const storage::Config::History &config,
+                                              const std::atomic<int64_t> *retention_cutoff){
+  kvstore::KVStore::Options options;
+  if(config.column_families){
+    options.column_families={{"vertex_deltas",kVertexDeltaPrefix},{"vertex_anchors",kVertexAnchorPrefix},
+                             {"edge_deltas",kEdgeDeltaPrefix},{"edge_anchors",kEdgeAnchorPrefix},
+                             {"vertex_edges",kVertexEdgePrefix},{"vertex_times",kVertexTimePrefix},
+                             {"edge_times",kEdgeTimePrefix}};
+  }
+  options.prefix_length=kRecordGroupSize;
+  options.bloom_bits_per_key=config.bloom_bits_per_key;
+  options.block_cache_bytes=config.block_cache_bytes;
+  options.compression=config.compression;
+  options.bottommost_compression=config.bottommost_compression;
+  options.statistics=config.statistics;
+  options.compaction_filter=[retention_cutoff](std::string_view key){
+    return ExpiredRecord(key,retention_cutoff->load(std::memory_order_relaxed));
+  };
+  return options;
+}
 
-std::pair<std::vector<nlohmann::json>,bool> History_delta::GetEdgeInfo(uint64_t c_ts,uint64_t c_te,std::string type,uint64_t gid){
-  std::vector<nlohmann::json> history_Delta;
-  bool anchor_flag=false;
-  auto tmp_info=nlohmann::json::object();
-  //1、在VA段查找最邻近的record
-  auto anchor_prefix=kEdgeAnchorPrefix+std::to_string(gid)+":"+uint_convert_to_string((int64_t)c_te,realTimeFlagConstant);
-  auto iter_begin=storage_.starts(anchor_prefix);
-  auto iter_end=storage_.last(anchor_prefix);
+// Last key of every cold tier segment, its footer holds the bounds of the
+// segment and the span of the ends of its records.
+const std::string kSegmentFooterKey=std::string("\xff",1)+"FOOTER";
+const std::string kSegmentExtension=".seg";
 
-  auto prefixs=kEdgeDeltaPrefix+std::to_string(gid);
-  auto vd_iter_begin=storage_.starts(prefixs);
-  auto vd_iter_end=storage_.last(prefixs);//null
-  bool need_combine=true;
+// Number of migrated records written in a single batch.
+const uint64_t kMigrationBatchSize=10000;
 
-  while(iter_begin!=iter_end){//1.2. VA中找到了，筛选VD数据段
-    auto key=iter_begin->first;
-    auto parts = splits(key, ":");
-    if(parts[1] != std::to_string(gid)){
-      ++iter_begin;
-      break;
+// A failed write of a migration batch is retried with exponential backoff,
+// about 2.5 seconds in total.
+const uint64_t kMigrationWriteAttempts=8;
+const std::chrono::milliseconds kMigrationRetryDelay{10};
+
+std::string BigEndian(uint64_t value){
+  return uint_convert_to_string((int64_t)value,false);
+}
+
+std::string TimeIndexKey(const std::string &scope,uint64_t level,uint64_t bucket,uint64_t gid){
+  auto key=scope;
+  key.push_back(static_cast<char>(level));
+  key+=BigEndian(bucket);
+  key+=BigEndian(gid);
+  return key;
+}
+
+uint64_t ReadBigEndian(std::string_view data,size_t pos){
+  int64_t value;
+  std::memcpy(&value,data.data()+pos,sizeof(value));
+  return (uint64_t)swap64(value);
+}
+
+// Prefix of the records of an object, optionally followed by a timestamp to
+// seek to.
+std::string RecordGroup(const std::string &kind,uint64_t gid){
+  return kind+BigEndian(gid);
+}
+
+std::string RecordKey(const std::string &kind,uint64_t gid,int64_t ts,int64_t te){
+  auto key=RecordGroup(kind,gid);
+  key+=BigEndian((uint64_t)ts);
+  key+=BigEndian((uint64_t)te);
+  return key;
+}
+
+// Prefix of the removed edges of a vertex in one direction, optionally of a
+// single edge type.
+std::string VertexEdgeGroup(uint64_t gid,bool out,std::optional<uint64_t> edge_type=std::nullopt){
+  auto key=RecordGroup(kVertexEdgePrefix,gid);
+  key.push_back(out?1:0);
+  if(edge_type) key+=BigEndian(*edge_type);
+  return key;
+}
+
+std::string VertexEdgeKey(uint64_t gid,bool out,uint64_t edge_type,uint64_t commit,uint64_t edge_gid){
+  auto key=VertexEdgeGroup(gid,out,edge_type);
+  key+=BigEndian(-commit);
+  key+=BigEndian(edge_gid);
+  return key;
+}
+
+// Highest level `ForEachTimeBucket` may reach for a span ending at `last`,
+// from there on the buckets of both ends are 0.
+uint64_t TimeIndexTopLevel(uint64_t last){
+  auto width=last==0?0:64-(uint64_t)__builtin_clzll(last);
+  return std::clamp(width,kTimeIndexMinLevel,kTimeIndexMaxLevel);
+}
+
+// Calls `func(level, node)` for the minimal set of segment tree nodes
+// covering the nodes [lo, hi] of `level`.
+template <class TFunc>
+void ForEachTreeNode(uint64_t lo,uint64_t hi,uint64_t level,const TFunc &func){
+  while(lo<=hi){
+    if(lo==hi || level==kTimeIndexMaxLevel){
+      for(auto node=lo;node<=hi;++node) func(level,node);
+      return;
     }
-    anchor_flag=true;
-    tmp_info=nlohmann::json::parse(iter_begin->second);
-    auto va_ts=(int64_t)(std::get<1>(string_convert_to_uint(key,realTimeFlagConstant)));
-    if(va_ts>=c_te){
-      va_ts=va_ts>0?-va_ts:va_ts;
-      auto va_ts_str=uint_convert_to_string(va_ts,realTimeFlagConstant);
-      auto delta_prefix=kEdgeDeltaPrefix+std::to_string(gid)+":"+va_ts_str;
-      vd_iter_begin=storage_.starts(delta_prefix);
-      vd_iter_end=storage_.last(delta_prefix);
-      break;
-    }else  anchor_flag=false;
-    ++iter_begin;
+    if(lo&1) func(level,lo++);
+    if(!(hi&1)) func(level,hi--);
+    if(lo>hi) return;
+    lo>>=1;
+    hi>>=1;
+    ++level;
   }
+}
 
-  for(;vd_iter_begin!=vd_iter_end;++vd_iter_begin){
-    auto [egde_gid,ts,te]=string_convert_to_uint(vd_iter_begin->first,realTimeFlagConstant);
+// Calls `func(level, bucket)` for the minimal set of time index nodes
+// covering [start, commit].
+template <class TFunc>
+void ForEachTimeBucket(uint64_t start,uint64_t commit,const TFunc &func){
+  ForEachTreeNode(start>>kTimeIndexMinLevel,commit>>kTimeIndexMinLevel,kTimeIndexMinLevel,func);
+}
+
+// Values which compare equal have the same hash, integers are hashed as the
+// doubles they are equal to.
+uint64_t ValueHash(const storage::PropertyValue &value){
+  std::string encoded;
+  if(value.IsInt()){
+    storage::EncodeProperties({{storage::PropertyId::FromUint(0),storage::PropertyValue((double)value.ValueInt())}},&encoded);
+  }else{
+    storage::EncodeProperties({{storage::PropertyId::FromUint(0),value}},&encoded);
+  }
+  return utils::Fnv(encoded);
+}
+
+History_delta::History_delta(const std::string &storage_directory,storage::NameIdMapper *name_id_mapper,
+                             const storage::Config::History &config)
+    : History_delta(storage_directory,false,name_id_mapper,config) {}
+
+History_delta::History_delta(const std::string &storage_directory,bool realTimeFlag,storage::NameIdMapper *name_id_mapper,
+                             const storage::Config::History &config)
+    : realTimeFlagConstant(realTimeFlag), name_id_mapper_(name_id_mapper), storage_(storage_directory,HistoryStoreOptions(config,&retention_cutoff_)),
+      pending_records_(std::max<uint64_t>(config.migration_threads,1)),
+      migration_queue_size_(std::max<uint64_t>(config.migration_queue_size,1)),
+      scan_batch_size_(std::max<uint64_t>(config.scan_batch_size,1)),
+      scan_threads_(std::max<uint64_t>(config.scan_threads,1)),
+      cold_directory_(config.cold_directory),
+      cold_options_{.prefix_length=(uint32_t)kRecordGroupSize,.bloom_bits_per_key=config.bloom_bits_per_key} {
+  valid_from_property_=storage::PropertyId::FromUint(name_id_mapper_->NameToId(storage::kValidFromProperty));
+  valid_to_property_=storage::PropertyId::FromUint(name_id_mapper_->NameToId(storage::kValidToProperty));
+  if(auto cutoff=storage_.Get(kRetentionCutoffKey)) retention_cutoff_=std::stoll(*cutoff);
+  LoadNameIds();
+  ConvertLegacyKeys();
+  MigrateLegacyRecords();
+  SplitVertexEdgeRecords();
+  LoadTimeIndexLevel();
+  BuildTimeIndex();
+  GetTimeTableAll();
+  LoadTemporalIndices();
+  LoadRollups();
+  LoadHistoryStatistics();
+  LoadColdTier();
+  if(config.migration_threads>1) encoding_pool_.emplace(config.migration_threads);
+  if(scan_threads_>1) scan_pool_.emplace(scan_threads_);
+  if(config.migration_threads>0){
+    migration_thread_.emplace([this]{
+      utils::ThreadSetName("HistMigration");
+      MigrationLoop();
+    });
+  }
+}
+
+History_delta::~History_delta(){
+  if(migration_thread_){
+    {
+      std::lock_guard<std::mutex> guard(migration_lock_);
+      migration_shutdown_=true;
+    }
+    migration_cv_.notify_all();
+    migration_thread_->join();
+  }
+  // Only left once a batch couldn't be written.
+  if(!migration_queue_.empty()){
+    spdlog::error("The history records of {} GC cycles weren't written to the history store.",migration_queue_.size());
+  }
+}
+
+void History_delta::LoadNameIds(){
+  std::lock_guard<utils::RWLock> guard(name_ids_lock_);
+  for(auto it=storage_.begin(kNameIdPrefix);it!=storage_.end(kNameIdPrefix);++it){
+    auto disk_id=(uint64_t)std::stoull(it->first.substr(kNameIdPrefix.size()));
+    auto storage_id=name_id_mapper_->NameToId(it->second);
+    storage_to_disk_id_[storage_id]=disk_id;
+    disk_to_storage_id_[disk_id]=storage_id;
+    if(storage_id!=disk_id) identity_name_ids_=false;
+  }
+}
+
+uint64_t History_delta::ToDiskId(uint64_t storage_id){
+  {
+    std::shared_lock<utils::RWLock> guard(name_ids_lock_);
+    auto found=storage_to_disk_id_.find(storage_id);
+    if(found!=storage_to_disk_id_.end()) return found->second;
+  }
+  std::lock_guard<utils::RWLock> guard(name_ids_lock_);
+  auto found=storage_to_disk_id_.find(storage_id);
+  if(found!=storage_to_disk_id_.end()) return found->second;
+  auto disk_id=storage_id;
+  if(disk_to_storage_id_.count(disk_id)){
+    // The ID is already taken by another name, fall back to a fresh one.
+    disk_id=0;
+    for(const auto &[used_id,_]:disk_to_storage_id_) disk_id=std::max(disk_id,used_id+1);
+    identity_name_ids_=false;
+  }
+  storage_to_disk_id_[storage_id]=disk_id;
+  disk_to_storage_id_[disk_id]=storage_id;
+  pending_name_ids_[kNameIdPrefix+std::to_string(disk_id)]=name_id_mapper_->IdToName(storage_id);
+  return disk_id;
+}
+
+std::optional<uint64_t> History_delta::FindDiskId(uint64_t storage_id) const{
+  std::shared_lock<utils::RWLock> guard(name_ids_lock_);
+  auto found=storage_to_disk_id_.find(storage_id);
+  if(found==storage_to_disk_id_.end()) return std::nullopt;
+  return found->second;
+}
+
+uint64_t History_delta::ToStorageId(uint64_t disk_id) const{
+  std::shared_lock<utils::RWLock> guard(name_ids_lock_);
+  auto found=disk_to_storage_id_.find(disk_id);
+  if(found==disk_to_storage_id_.end()) return disk_id;
+  return found->second;
+}
+
+std::string History_delta::Encode(const HistoryRecord &record){
+  return EncodeRecord(record,[this](uint64_t id){return ToDiskId(id);});
+}
+
+std::optional<HistoryRecord> History_delta::Decode(std::string_view data) const{
+  if(IsLegacyRecord(data)) return DecodeLegacyRecord(data,name_id_mapper_);
+  bool identity;
+  {
+    std::shared_lock<utils::RWLock> guard(name_ids_lock_);
+    identity=identity_name_ids_;
+  }
+  if(identity) return DecodeRecord(data);
+  return DecodeRecord(data,[this](uint64_t id){return ToStorageId(id);});
+}
+
+void History_delta::MigrateLegacyRecords(){
+  if(storage_.Get(kFormatKey)) return;
+  std::map<std::string,std::string> batch;
+  uint64_t migrated=0;
+  auto flush=[&]{
+    if(batch.empty()) return;
+    for(auto &[key,value]:pending_name_ids_) batch.emplace(key,value);
+    pending_name_ids_.clear();
+    if(!storage_.PutMultiple(batch)){
+      throw utils::BasicException("Couldn't migrate the history records!");
+    }
+    batch.clear();
+  };
+  for(const auto &prefix:kRecordPrefixes){
+    for(auto it=storage_.begin(prefix);it!=storage_.end(prefix);++it){
+      if(!IsLegacyRecord(it->second)) continue;
+      auto record=DecodeLegacyRecord(it->second,name_id_mapper_);
+      if(!record){
+        spdlog::warn("Skipping malformed history record while migrating to the binary format.");
+        continue;
+      }
+      batch[it->first]=Encode(*record);
+      ++migrated;
+      if(batch.size()>=kMigrationBatchSize) flush();
+    }
+  }
+  batch[kFormatKey]=std::to_string(kHistoryRecordVersion);
+  flush();
+  if(migrated>0) spdlog::info("Migrated {} history records to the binary format.",migrated);
+}
+
+void History_delta::ConvertLegacyKeys(){
+  if(storage_.Get(kKeyFormatKey)) return;
+  std::map<std::string,std::string> batch;
+  std::vector<std::string> legacy_keys;
+  uint64_t converted=0;
+  auto flush=[&]{
+    if(!storage_.PutAndDeleteMultiple(batch,legacy_keys)){
+      throw utils::BasicException("Couldn't convert the history record keys!");
+    }
+    batch.clear();
+    legacy_keys.clear();
+  };
+  for(size_t i=0;i<kRecordPrefixes.size();++i){
+    const auto &legacy_prefix=kLegacyRecordPrefixes[i];
+    for(auto it=storage_.begin(legacy_prefix);it!=storage_.end(legacy_prefix);++it){
+      auto key=ParseLegacyRecordKey(it.key());
+      if(!key){
+        spdlog::warn("Skipping malformed history record key while converting to the binary layout.");
+        continue;
+      }
+      auto [gid,ts,te]=*key;
+      batch.emplace(RecordKey(kRecordPrefixes[i],gid,ts,te),std::string(it.value()));
+      legacy_keys.emplace_back(it.key());
+      ++converted;
+      if(batch.size()>=kMigrationBatchSize) flush();
+    }
+  }
+  batch[kKeyFormatKey]="";
+  flush();
+  if(converted>0) spdlog::info("Converted {} history record keys to the binary layout.",converted);
+}
+
+void History_delta::SplitVertexEdgeRecords(){
+  if(storage_.Get(kVertexEdgeFormatKey)) return;
+  std::map<std::string,std::string> batch;
+  std::vector<std::string> split_keys;
+  uint64_t split=0;
+  auto flush=[&]{
+    for(auto &[key,value]:pending_name_ids_) batch.emplace(key,value);
+    pending_name_ids_.clear();
+    if(!storage_.PutAndDeleteMultiple(batch,split_keys)){
+      throw utils::BasicException("Couldn't split the removed edge records!");
+    }
+    batch.clear();
+    split_keys.clear();
+  };
+  for(auto it=storage_.begin(kVertexEdgePrefix);it!=storage_.end(kVertexEdgePrefix);++it){
+    // Records of the version layout hold all edges removed from the vertex by
+    // one version.
+    if(it.key().size()!=kRecordKeySize) continue;
+    auto [gid,ts,te]=ParseRecordKey(it.key());
+    auto record=Decode(it.value());
+    if(!record){
+      spdlog::warn("Skipping malformed history record while splitting the removed edges.");
+      continue;
+    }
+    for(const auto &[edge_gid,edge]:record->edges){
+      HistoryRecord removal;
+      removal.tt_ts=(uint64_t)-ts;
+      removal.tt_te=(uint64_t)-te;
+      removal.edges.emplace(edge_gid,edge);
+      batch.emplace(VertexEdgeKey(gid,edge.out,ToDiskId(edge.edge_type.AsUint()),removal.tt_te,edge_gid),Encode(removal));
+    }
+    split_keys.emplace_back(it.key());
+    ++split;
+    if(batch.size()>=kMigrationBatchSize) flush();
+  }
+  batch[kVertexEdgeFormatKey]="";
+  flush();
+  if(split>0) spdlog::info("Split {} history records of removed edges.",split);
+}
+
+void History_delta::ReplayVersions(kvstore::KVStore::iterator &it,const kvstore::KVStore::iterator &end,
+                                   const std::string &key,uint64_t gid,uint64_t c_ts,uint64_t c_te,
+                                   const std::string &type,VersionReplay replay,const VersionVisitor &on_version) const{
+  bool need_combine=true;
+  // Replays one record, returns false once the replay is done.
+  auto replay_record=[&](std::string_view record_key,std::string_view value){
+    auto [record_gid,ts,te]=ParseRecordKey(record_key);
     auto object_ts=(uint64_t)-ts;//版本的开始时间
     auto object_te=(uint64_t)-te;//版本的结束时间
-    if(gid!=egde_gid) break;
-    if(object_te<c_ts) break;
-    auto current_info=nlohmann::json::parse(vd_iter_begin->second);//当前节点的数据
-    if(need_combine){
-      combineVertex(tmp_info,current_info);
-      tmp_info=current_info;
+    if(record_gid!=gid) return false;
+    if(object_te<c_ts) return false;
+    auto current_info=Decode(value);//当前节点的数据
+    if(!current_info) return true;
+    if(!TemporalCheck(object_ts,object_te,c_ts,c_te,type)){
+      if(need_combine) replay.Apply(std::move(*current_info));
+      return true;
     }
-    if(TemporalCheck(object_ts,object_te,c_ts,c_te,type)){
+    // The first visible version is replayed in full, the later ones are
+    // handed over as they are and applied onto it by the caller.
+    if(need_combine){
+      replay.Apply(std::move(*current_info));
+      current_info=replay.Take();
       need_combine=false;
-      history_Delta.emplace_back(current_info);
-      if(type=="as of") break;
     }
-  } 
-  return std::make_pair(history_Delta,anchor_flag);
+    return on_version(std::move(*current_info))&&type!="as of";
+  };
+  auto cold_until=cold_until_.load();
+  for(;it!=end;++it){
+    // Records left behind by a move to the cold tier, which holds them.
+    if((uint64_t)-std::get<2>(ParseRecordKey(it.key()))<=cold_until) break;
+    if(!replay_record(it.key(),it.value())) return;
+  }
+  // The cold tier holds the older records, newest segment first.
+  for(const auto &segment:ColdSegments(c_ts)){
+    bool done=false;
+    segment->segment.Scan(key,[&](std::string_view record_key,std::string_view value){
+      if(record_key.size()!=kRecordKeySize || record_key.compare(0,kRecordGroupSize,key,0,kRecordGroupSize)!=0) return false;
+      done=!replay_record(record_key,value);
+      return !done;
+    });
+    if(done) return;
+  }
+}
+
+bool History_delta::ForEachEdgeVersion(uint64_t gid,uint64_t c_ts,uint64_t c_te,const std::string &type,
+                                       const VersionVisitor &on_version){
+  if(!ClipToRetention(c_ts,c_te) || !MayHaveHistory(kEdgeTimePrefix,gid,c_ts,c_te)) return false;
+  WaitForMigration();
+  bool anchor_flag=false;
+  VersionReplay replay;
+  auto prefixs=RecordGroup(kEdgeDeltaPrefix,gid);
+  auto use_anchor=[&](std::string_view key,std::string_view value){
+    auto [anchor_gid,va_ts,va_te]=ParseRecordKey(key);
+    if(anchor_gid!=gid) return;
+    anchor_flag=true;
+    if(auto anchor=Decode(value)) replay=VersionReplay(std::move(*anchor));
+    va_ts=va_ts>0?-va_ts:va_ts;
+    prefixs=RecordGroup(kEdgeDeltaPrefix,gid)+BigEndian((uint64_t)va_ts);
+  };
+  //1、在VA段查找最邻近的record
+  auto anchor_prefix=RecordGroup(kEdgeAnchorPrefix,gid)+BigEndian(c_te);
+  if(auto anchor=ColdAnchor(anchor_prefix,c_te)){
+    use_anchor(anchor->first,anchor->second);
+  }else{
+    auto iter_begin=storage_.group_begin(anchor_prefix);
+    if(iter_begin!=storage_.group_end(anchor_prefix)) use_anchor(iter_begin.key(),iter_begin.value());
+  }
+
+  auto vd_iter_begin=storage_.group_begin(prefixs);
+  ReplayVersions(vd_iter_begin,storage_.group_end(prefixs),prefixs,gid,c_ts,c_te,type,std::move(replay),on_version);
+  return anchor_flag;
+}
+
+std::pair<std::vector<HistoryRecord>,bool> History_delta::GetEdgeInfo(uint64_t c_ts,uint64_t c_te,std::string type,uint64_t gid){
+  std::vector<HistoryRecord> history_Delta;
+  auto anchor_flag=ForEachEdgeVersion(gid,c_ts,c_te,type,[&](HistoryRecord &&record){
+    history_Delta.emplace_back(std::move(record));
+    return true;
+  });
+  return std::make_pair(std::move(history_Delta),anchor_flag);
 }
 
 
 void History_delta::GetTimeTableAll(){
-  for(auto it=storage_.starts(kVertexTimePrefix);it!=storage_.last(kVertexTimePrefix);++it){
-    auto gid=(uint64_t)std::stoi(it->first.substr(3));
-    auto split_info=splits(it->second,":");
-    auto min_ts=(uint64_t)std::stoi(split_info[0]);
-    auto max_te=(uint64_t)std::stoi(split_info[1]);
-    vertex_time_table_[gid]=std::make_pair(min_ts,max_te);
+  std::lock_guard<utils::RWLock> guard(time_table_lock_);
+  for(const auto &prefix:{kVertexTimePrefix,kEdgeTimePrefix}){
+    auto &table=prefix==kVertexTimePrefix?vertex_time_table_:edge_time_table_;
+    for(auto it=storage_.begin(prefix);it!=storage_.end(prefix);++it){
+      auto gid=(uint64_t)std::stoull(it->first.substr(prefix.size()));
+      auto split_info=splits(it->second,":");
+      if(split_info.size()!=2) continue;
+      auto min_ts=(uint64_t)std::stoull(split_info[0]);
+      auto max_te=(uint64_t)std::stoull(split_info[1]);
+      table[gid]=std::make_pair(min_ts,max_te);
+    }
   }
-  //save edge time table
-  for(auto it=storage_.starts(kEdgeTimePrefix);it!=storage_.last(kEdgeTimePrefix);++it){
-    auto gid=(uint64_t)std::stoi(it->first.substr(3));
-    auto split_info=splits(it->second,":");
-    auto min_ts=(uint64_t)std::stoi(split_info[0]);
-    auto max_te=(uint64_t)std::stoi(split_info[1]);
-    edge_time_table_[gid]=std::make_pair(min_ts,max_te);
+}
+
+void History_delta::UpdateTimeTable(const std::string &prefix,uint64_t gid,uint64_t start,uint64_t commit){
+  std::pair<uint64_t,uint64_t> span;
+  {
+    std::lock_guard<utils::RWLock> guard(time_table_lock_);
+    auto &table=prefix==kVertexTimePrefix?vertex_time_table_:edge_time_table_;
+    auto [iter,inserted]=table.emplace(gid,std::make_pair(start,commit));
+    if(!inserted){
+      iter->second.first=std::min(iter->second.first,start);
+      iter->second.second=std::max(iter->second.second,commit);
+    }
+    span=iter->second;
   }
+  pending_time_entries_[prefix+std::to_string(gid)]=std::to_string(span.first)+":"+std::to_string(span.second);
 }
 
-std::pair<std::vector<nlohmann::json>,bool> History_delta::GetVertexInfo(storage::Gid gid,uint64_t c_ts,uint64_t c_te,std::string type){
-    std::vector<nlohmann::json> history_Delta;
-    bool anchor_flag=false;
-    auto vertx_gid=gid.AsUint();//当前顶点的id
-    auto tmp_info=nlohmann::json::object();
-    auto anchor_prefix=kVertexAnchorPrefix+std::to_string(vertx_gid)+":"+uint_convert_to_string((int64_t)c_te,realTimeFlagConstant);
-    auto iter_begin=storage_.starts(anchor_prefix);//seek 符合时间条件的最开始的record 比当前时间大一个的指针
-    auto iter_end=storage_.last(anchor_prefix);//null
+bool History_delta::MayHaveHistory(const std::string &prefix,uint64_t gid,uint64_t c_ts,uint64_t c_te) const{
+  bool intersects;
+  {
+    std::shared_lock<utils::RWLock> guard(time_table_lock_);
+    const auto &table=prefix==kVertexTimePrefix?vertex_time_table_:edge_time_table_;
+    auto iter=table.find(gid);
+    intersects=iter!=table.end() && iter->second.first<=c_te && iter->second.second>=c_ts;
+  }
+  EventCounter::IncrementCounter(intersects?EventCounter::HistoryProbes:EventCounter::HistoryProbesAvoided);
+  return intersects;
+}
 
-    //1.1. VA中找不到，从最新的VD找到数据
-    auto prefixs=kVertexDeltaPrefix+std::to_string(vertx_gid)+":"+uint_convert_to_string((int64_t)-c_te,realTimeFlagConstant);
-    auto vd_iter_begin=storage_.starts(prefixs);
-    auto vd_iter_end=storage_.last(prefixs);//null
-    bool need_combine=true;
-    if(iter_begin!=iter_end){//1.2. VA中找到了，筛选VD数据段
-        auto key=iter_begin->first;
-        auto parts = splits(key, ":");
-        if(parts[1] != std::to_string(vertx_gid)){
-            anchor_flag=false;
+std::vector<uint64_t> History_delta::GetVerticesWithHistory(uint64_t c_ts,uint64_t c_te,uint64_t from_gid,size_t limit) const{
+  std::vector<uint64_t> gids;
+  if(!ClipToRetention(c_ts,c_te)) return gids;
+  std::shared_lock<utils::RWLock> guard(time_table_lock_);
+  for(auto it=vertex_time_table_.lower_bound(from_gid);it!=vertex_time_table_.end() && gids.size()<limit;++it){
+    if(it->second.first<=c_te && it->second.second>=c_ts) gids.push_back(it->first);
+  }
+  return gids;
+}
+
+void History_delta::UpdateTimeIndex(uint64_t gid,uint64_t start,uint64_t commit){
+  RaiseTimeIndexLevel(commit,pending_time_entries_);
+  ForEachTimeBucket(start,commit,[&](uint64_t level,uint64_t bucket){
+    pending_time_entries_.emplace(TimeIndexKey(kTimeIndexPrefix,level,bucket,gid),"");
+  });
+}
+
+void History_delta::BuildTimeIndex(){
+  if(storage_.Get(kTimeIndexKey)) return;
+  std::map<std::string,std::string> batch;
+  auto flush=[&]{
+    if(batch.empty()) return;
+    if(!storage_.PutMultiple(batch)){
+      throw utils::BasicException("Couldn't build the history time index!");
+    }
+    batch.clear();
+  };
+  auto post=[&](uint64_t gid,uint64_t start,uint64_t commit){
+    RaiseTimeIndexLevel(commit,batch);
+    ForEachTimeBucket(start,commit,[&](uint64_t level,uint64_t bucket){
+      batch.emplace(TimeIndexKey(kTimeIndexPrefix,level,bucket,gid),"");
+    });
+    if(batch.size()>=kMigrationBatchSize) flush();
+  };
+  for(auto it=storage_.begin(kVertexDeltaPrefix);it!=storage_.end(kVertexDeltaPrefix);++it){
+    auto [gid,ts,te]=ParseRecordKey(it.key());
+    post(gid,(uint64_t)-ts,(uint64_t)-te);
+  }
+  // The start of the version which removed an edge is only kept in the value.
+  for(auto it=storage_.begin(kVertexEdgePrefix);it!=storage_.end(kVertexEdgePrefix);++it){
+    auto record=Decode(it.value());
+    if(record) post(std::get<0>(ParseVertexEdgeKey(it.key())),record->tt_ts,record->tt_te);
+  }
+  batch[kTimeIndexKey]="";
+  flush();
+}
+
+void History_delta::LoadTimeIndexLevel(){
+  auto level=storage_.Get(kTimeIndexLevelKey);
+  if(level){
+    time_index_level_=std::stoull(*level);
+  }else{
+    time_index_level_=storage_.Get(kTimeIndexKey)?kTimeIndexMaxLevel:kTimeIndexMinLevel;
+  }
+}
+
+void History_delta::RaiseTimeIndexLevel(uint64_t last,std::map<std::string,std::string> &entries){
+  auto level=TimeIndexTopLevel(last);
+  if(level<=time_index_level_.load(std::memory_order_acquire)) return;
+  time_index_level_.store(level,std::memory_order_release);
+  entries[kTimeIndexLevelKey]=std::to_string(level);
+}
+
+std::set<uint64_t> History_delta::ScanTimeIndex(const std::string &scope,uint64_t c_ts,uint64_t c_te){
+  std::set<uint64_t> gids;
+  // The valid time index is queried by valid time, which doesn't expire.
+  if(scope!=kValidTimeIndexPrefix && !ClipToRetention(c_ts,c_te)) return gids;
+  // A version overlaps the window iff one of the nodes covering it does, on
+  // every level those are the buckets between the ones of c_ts and c_te.
+  auto top_level=scope==kValidTimeIndexPrefix?kTimeIndexMaxLevel:time_index_level_.load(std::memory_order_acquire);
+  for(auto level=kTimeIndexMinLevel;level<=top_level;++level){
+    auto last_bucket=c_te>>level;
+    auto seek_key=TimeIndexKey(scope,level,c_ts>>level,0);
+    auto level_size=scope.size()+1;
+    auto iter_end=storage_.last(seek_key);
+    for(auto iter=storage_.starts(seek_key);iter!=iter_end;++iter){
+      auto key=iter.key();
+      if(key.size()!=level_size+16 || key.compare(0,level_size,seek_key,0,level_size)!=0) break;
+      if(ReadBigEndian(key,level_size)>last_bucket) break;
+      gids.insert(ReadBigEndian(key,level_size+8));
+    }
+  }
+  return gids;
+}
+
+std::set<uint64_t> History_delta::GetVerticesInWindow(uint64_t c_ts,uint64_t c_te){
+  WaitForMigration();
+  return ScanTimeIndex(kTimeIndexPrefix,c_ts,c_te);
+}
+
+void History_delta::LoadTemporalIndices(){
+  std::lock_guard<utils::RWLock> guard(temporal_indices_lock_);
+  for(auto it=storage_.begin(kTemporalIndexSincePrefix);it!=storage_.end(kTemporalIndexSincePrefix);++it){
+    const auto &key=it->first;
+    if(it->second.empty()) continue;
+    auto since=(uint64_t)std::stoull(it->second);
+    auto label=storage::LabelId::FromUint(ToStorageId(ReadBigEndian(key,kTemporalIndexSincePrefix.size())));
+    if(key.size()==kTemporalIndexSincePrefix.size()+8){
+      label_indices_since_.emplace(label,since);
+    }else{
+      auto property=storage::PropertyId::FromUint(ToStorageId(ReadBigEndian(key,kTemporalIndexSincePrefix.size()+8)));
+      label_property_indices_since_.emplace(std::make_pair(label,property),since);
+    }
+  }
+  auto valid_time_since=storage_.Get(kValidTimeSinceKey);
+  if(valid_time_since && !valid_time_since->empty()) valid_time_since_=(uint64_t)std::stoull(*valid_time_since);
+}
+
+std::string History_delta::LabelScope(storage::LabelId label){
+  return kLabelIndexPrefix+BigEndian(ToDiskId(label.AsUint()));
+}
+
+std::string History_delta::LabelPropertyScope(storage::LabelId label,storage::PropertyId property){
+  return kLabelPropertyIndexPrefix+BigEndian(ToDiskId(label.AsUint()))+BigEndian(ToDiskId(property.AsUint()));
+}
+
+void History_delta::SetTemporalIndices(const std::vector<storage::LabelId> &labels,
+                                       const std::vector<std::pair<storage::LabelId,storage::PropertyId>> &label_properties,
+                                       uint64_t now){
+  std::map<std::string,std::string> changes;
+  auto update=[&](auto &indices,const auto &current,const auto &since_key){
+    for(auto it=indices.begin();it!=indices.end();){
+      if(std::find(current.begin(),current.end(),it->first)!=current.end()){
+        ++it;
+        continue;
+      }
+      changes[since_key(it->first)]="";
+      it=indices.erase(it);
+    }
+    for(const auto &index:current){
+      if(indices.emplace(index,now).second) changes[since_key(index)]=std::to_string(now);
+    }
+  };
+  {
+    std::lock_guard<utils::RWLock> guard(temporal_indices_lock_);
+    update(label_indices_since_,labels,[&](storage::LabelId label){
+      return kTemporalIndexSincePrefix+BigEndian(ToDiskId(label.AsUint()));
+    });
+    update(label_property_indices_since_,label_properties,[&](const std::pair<storage::LabelId,storage::PropertyId> &index){
+      return kTemporalIndexSincePrefix+BigEndian(ToDiskId(index.first.AsUint()))+BigEndian(ToDiskId(index.second.AsUint()));
+    });
+  }
+  if(changes.empty()) return;
+  {
+    std::lock_guard<utils::RWLock> guard(name_ids_lock_);
+    changes.merge(pending_name_ids_);
+    pending_name_ids_.clear();
+  }
+  if(!storage_.PutMultiple(changes)){
+    throw utils::BasicException("Couldn't save the temporal indexes!");
+  }
+}
+
+bool History_delta::HasTemporalIndices() const{
+  std::shared_lock<utils::RWLock> guard(temporal_indices_lock_);
+  return !label_indices_since_.empty() || !label_property_indices_since_.empty() || valid_time_since_ ||
+         has_rollups_.load(std::memory_order_acquire);
+}
+
+void History_delta::EnableValidTimeIndex(uint64_t now){
+  {
+    std::lock_guard<utils::RWLock> guard(temporal_indices_lock_);
+    if(valid_time_since_) return;
+    valid_time_since_=now;
+  }
+  if(!storage_.Put(kValidTimeSinceKey,std::to_string(now))){
+    throw utils::BasicException("Couldn't save the valid time index!");
+  }
+}
+
+void History_delta::SaveVertexVersion(storage::Gid gid,uint64_t start,uint64_t commit,const std::vector<storage::LabelId> &labels,
+                                      const std::map<storage::PropertyId,storage::PropertyValue> &properties){
+  if(start>commit) return;
+  std::vector<std::string> scopes;
+  std::optional<storage::ValidInterval> valid;
+  {
+    std::shared_lock<utils::RWLock> guard(temporal_indices_lock_);
+    for(const auto &label:labels){
+      if(label_indices_since_.count(label)) scopes.push_back(LabelScope(label));
+    }
+    for(const auto &[index,_]:label_property_indices_since_){
+      if(std::find(labels.begin(),labels.end(),index.first)==labels.end()) continue;
+      auto value=properties.find(index.second);
+      if(value==properties.end()) continue;
+      scopes.push_back(LabelPropertyScope(index.first,index.second)+BigEndian(ValueHash(value->second)));
+    }
+    if(valid_time_since_){
+      auto from=properties.find(valid_from_property_);
+      auto to=properties.find(valid_to_property_);
+      if(from!=properties.end()) valid=storage::MakeValidInterval(from->second,to!=properties.end()?to->second:storage::PropertyValue());
+    }
+  }
+  if(!scopes.empty()) RaiseTimeIndexLevel(commit,pending_time_entries_);
+  for(const auto &scope:scopes){
+    ForEachTimeBucket(start,commit,[&](uint64_t level,uint64_t bucket){
+      pending_time_entries_.emplace(TimeIndexKey(scope,level,bucket,gid.AsUint()),"");
+    });
+  }
+  if(valid){
+    ForEachTimeBucket(valid->from,valid->to-1,[&](uint64_t level,uint64_t bucket){
+      pending_time_entries_.emplace(TimeIndexKey(kValidTimeIndexPrefix,level,bucket,gid.AsUint()),"");
+    });
+  }
+  if(has_rollups_.load(std::memory_order_acquire)) UpdateRollups(start,commit,labels,properties);
+}
+
+std::optional<std::set<uint64_t>> History_delta::GetVerticesWithLabel(storage::LabelId label,uint64_t c_ts,uint64_t c_te){
+  {
+    std::shared_lock<utils::RWLock> guard(temporal_indices_lock_);
+    auto found=label_indices_since_.find(label);
+    if(found==label_indices_since_.end() || c_ts<found->second) return std::nullopt;
+  }
+  WaitForMigration();
+  return ScanTimeIndex(LabelScope(label),c_ts,c_te);
+}
+
+std::optional<std::set<uint64_t>> History_delta::GetVerticesWithLabelProperty(storage::LabelId label,storage::PropertyId property,
+                                                                              const storage::PropertyValue &value,uint64_t c_ts,
+                                                                              uint64_t c_te){
+  {
+    std::shared_lock<utils::RWLock> guard(temporal_indices_lock_);
+    auto found=label_property_indices_since_.find({label,property});
+    if(found==label_property_indices_since_.end() || c_ts<found->second) return std::nullopt;
+  }
+  WaitForMigration();
+  return ScanTimeIndex(LabelPropertyScope(label,property)+BigEndian(ValueHash(value)),c_ts,c_te);
+}
+
+std::optional<std::set<uint64_t>> History_delta::GetVerticesInValidTime(uint64_t vt_ts,uint64_t vt_te,uint64_t c_ts,
+                                                                        uint64_t c_te){
+  {
+    std::shared_lock<utils::RWLock> guard(temporal_indices_lock_);
+    if(!valid_time_since_ || c_ts<*valid_time_since_) return std::nullopt;
+  }
+  WaitForMigration();
+  auto valid=ScanTimeIndex(kValidTimeIndexPrefix,vt_ts,vt_te);
+  if(valid.empty()) return valid;
+  auto in_window=ScanTimeIndex(kTimeIndexPrefix,c_ts,c_te);
+  std::set<uint64_t> gids;
+  std::set_intersection(valid.begin(),valid.end(),in_window.begin(),in_window.end(),std::inserter(gids,gids.end()));
+  return gids;
+}
+
+double RollupNumber(const storage::PropertyValue &value){
+  return value.IsInt()?(double)value.ValueInt():value.ValueDouble();
+}
+
+std::string RollupBucketPrefix(const std::string &name){
+  return kRollupBucketPrefix+BigEndian(name.size())+name;
+}
+
+std::string RollupNodeKey(const std::string &name,uint64_t level,uint64_t start){
+  auto key=RollupBucketPrefix(name);
+  key.push_back(static_cast<char>(level));
+  return key+BigEndian(start);
+}
+
+// The name of the rollup, the level and the start of a node key.
+std::optional<std::tuple<std::string,uint64_t,uint64_t>> ParseRollupNodeKey(std::string_view key){
+  auto name_pos=kRollupBucketPrefix.size()+8;
+  if(key.size()<name_pos+9 || key.compare(0,kRollupBucketPrefix.size(),kRollupBucketPrefix)!=0) return std::nullopt;
+  auto name_size=ReadBigEndian(key,kRollupBucketPrefix.size());
+  if(key.size()!=name_pos+name_size+9) return std::nullopt;
+  return std::make_tuple(std::string(key.substr(name_pos,name_size)),(uint64_t)(uint8_t)key[name_pos+name_size],
+                         ReadBigEndian(key,name_pos+name_size+1));
+}
+
+// The first timestamp after the buckets of a node, saturated.
+uint64_t RollupNodeEnd(const TemporalRollup &rollup,uint64_t level,uint64_t start){
+  auto buckets=uint64_t{1}<<level;
+  if(rollup.width>(std::numeric_limits<uint64_t>::max()-start)/buckets) return std::numeric_limits<uint64_t>::max();
+  return start+buckets*rollup.width;
+}
+
+std::string EncodeRollupBucket(const RollupBucket &bucket){
+  auto encoded=BigEndian(bucket.count);
+  storage::EncodeProperties({{storage::PropertyId::FromUint(0),bucket.sum},{storage::PropertyId::FromUint(1),bucket.min},
+                             {storage::PropertyId::FromUint(2),bucket.max}},&encoded);
+  return encoded;
+}
+
+std::optional<RollupBucket> DecodeRollupBucket(std::string_view data,uint64_t start,uint64_t end){
+  if(data.size()<8) return std::nullopt;
+  std::map<storage::PropertyId,storage::PropertyValue> values;
+  if(!storage::DecodeProperties(reinterpret_cast<const uint8_t *>(data.data())+8,data.size()-8,3,&values)) return std::nullopt;
+  RollupBucket bucket{start,end,ReadBigEndian(data,0)};
+  bucket.sum=values[storage::PropertyId::FromUint(0)];
+  bucket.min=values[storage::PropertyId::FromUint(1)];
+  bucket.max=values[storage::PropertyId::FromUint(2)];
+  return bucket;
+}
+
+// Adds the values of `other` to a bucket, the sum of two integers is an
+// integer.
+void MergeRollupBucket(RollupBucket &bucket,const RollupBucket &other){
+  if(other.count==0) return;
+  if(bucket.count==0){
+    bucket.count=other.count;
+    bucket.sum=other.sum;
+    bucket.min=other.min;
+    bucket.max=other.max;
+    return;
+  }
+  bucket.count+=other.count;
+  if(bucket.sum.IsInt() && other.sum.IsInt()){
+    bucket.sum=storage::PropertyValue(bucket.sum.ValueInt()+other.sum.ValueInt());
+  }else{
+    bucket.sum=storage::PropertyValue(RollupNumber(bucket.sum)+RollupNumber(other.sum));
+  }
+  if(RollupNumber(other.min)<RollupNumber(bucket.min)) bucket.min=other.min;
+  if(RollupNumber(other.max)>RollupNumber(bucket.max)) bucket.max=other.max;
+}
+
+storage::PropertyValue RollupBucket::Value(TemporalRollup::Aggregate aggregate) const{
+  switch(aggregate){
+    case TemporalRollup::Aggregate::COUNT:
+      return storage::PropertyValue((int64_t)count);
+    case TemporalRollup::Aggregate::SUM:
+      return sum;
+    case TemporalRollup::Aggregate::MIN:
+      return min;
+    case TemporalRollup::Aggregate::MAX:
+      return max;
+    case TemporalRollup::Aggregate::AVG:
+      if(count==0) return storage::PropertyValue();
+      return storage::PropertyValue(RollupNumber(sum)/count);
+  }
+  return storage::PropertyValue();
+}
+
+void History_delta::LoadRollups(){
+  std::lock_guard<std::mutex> guard(rollups_lock_);
+  for(auto it=storage_.begin(kRollupPrefix);it!=storage_.end(kRollupPrefix);++it){
+    const auto &value=it->second;
+    if(value.size()!=33) continue;
+    TemporalRollup rollup{it->first.substr(kRollupPrefix.size()),
+                          storage::LabelId::FromUint(ToStorageId(ReadBigEndian(value,0))),
+                          storage::PropertyId::FromUint(ToStorageId(ReadBigEndian(value,8))),
+                          static_cast<TemporalRollup::Aggregate>(value[16]),ReadBigEndian(value,17),
+                          ReadBigEndian(value,25)};
+    rollups_.emplace(rollup.name,RollupState{rollup,{},{}});
+  }
+  has_rollups_.store(!rollups_.empty(),std::memory_order_release);
+}
+
+bool History_delta::CreateRollup(const TemporalRollup &rollup){
+  auto definition=BigEndian(ToDiskId(rollup.label.AsUint()))+BigEndian(ToDiskId(rollup.property.AsUint()));
+  definition.push_back(static_cast<char>(rollup.aggregate));
+  definition+=BigEndian(rollup.width)+BigEndian(rollup.since);
+  std::lock_guard<std::mutex> guard(rollups_lock_);
+  if(rollups_.count(rollup.name)) return false;
+  // Buckets left behind by a dropped rollup of the same name.
+  if(!storage_.DeletePrefix(RollupBucketPrefix(rollup.name))){
+    throw utils::BasicException("Couldn't save the temporal rollup!");
+  }
+  std::map<std::string,std::string> changes{{kRollupPrefix+rollup.name,definition}};
+  {
+    std::lock_guard<utils::RWLock> name_guard(name_ids_lock_);
+    changes.merge(pending_name_ids_);
+    pending_name_ids_.clear();
+  }
+  if(!storage_.PutMultiple(changes)){
+    throw utils::BasicException("Couldn't save the temporal rollup!");
+  }
+  rollups_.emplace(rollup.name,RollupState{rollup,{},{}});
+  has_rollups_.store(true,std::memory_order_release);
+  return true;
+}
+
+bool History_delta::DropRollup(const std::string &name){
+  {
+    std::lock_guard<std::mutex> guard(rollups_lock_);
+    if(!rollups_.erase(name)) return false;
+    has_rollups_.store(!rollups_.empty(),std::memory_order_release);
+  }
+  // Buckets of the last GC cycle may still be queued. The ones of a batch
+  // which couldn't be written aren't written later on, the rollup is dropped
+  // all the same.
+  try{
+    WaitForMigration();
+  }catch(const utils::BasicException &){
+  }
+  if(!storage_.Delete(kRollupPrefix+name) || !storage_.DeletePrefix(RollupBucketPrefix(name))){
+    throw utils::BasicException("Couldn't drop the temporal rollup!");
+  }
+  return true;
+}
+
+std::vector<TemporalRollup> History_delta::ListRollups() const{
+  std::vector<TemporalRollup> rollups;
+  std::lock_guard<std::mutex> guard(rollups_lock_);
+  rollups.reserve(rollups_.size());
+  for(const auto &[_,state]:rollups_) rollups.push_back(state.rollup);
+  return rollups;
+}
+
+std::optional<std::vector<RollupBucket>> History_delta::GetRollupBuckets(const std::string &name,uint64_t c_ts,
+                                                                         uint64_t c_te) const{
+  std::lock_guard<std::mutex> guard(rollups_lock_);
+  auto found=rollups_.find(name);
+  if(found==rollups_.end()) return std::nullopt;
+  const auto &state=found->second;
+  const auto &rollup=state.rollup;
+  std::vector<RollupBucket> result;
+  if(!ClipToRetention(c_ts,c_te) || c_te<rollup.since) return result;
+  // The buckets c_ts and c_te fall into.
+  auto first=c_ts<rollup.since?0:(c_ts-rollup.since)/rollup.width;
+  auto last=(c_te-rollup.since)/rollup.width;
+  std::map<uint64_t,RollupBucket> buckets;
+  auto prefix=RollupBucketPrefix(name);
+  for(uint64_t level=0;level<=kTimeIndexMaxLevel;++level){
+    // On every level the nodes between the ones of the first and the last
+    // bucket are read from the history store, the unwritten ones replace
+    // them.
+    auto first_start=rollup.since+(first>>level<<level)*rollup.width;
+    auto last_start=rollup.since+(last>>level<<level)*rollup.width;
+    std::map<uint64_t,RollupBucket> nodes;
+    auto seek_key=RollupNodeKey(name,level,first_start);
+    auto iter_end=storage_.last(seek_key);
+    for(auto iter=storage_.starts(seek_key);iter!=iter_end;++iter){
+      auto key=iter.key();
+      if(key.size()!=prefix.size()+9 || key.compare(0,prefix.size()+1,seek_key,0,prefix.size()+1)!=0) break;
+      auto start=ReadBigEndian(key,prefix.size()+1);
+      if(start>last_start) break;
+      if(auto node=DecodeRollupBucket(iter.value(),start,RollupNodeEnd(rollup,level,start))){
+        nodes.emplace(start,std::move(*node));
+      }
+    }
+    for(auto it=state.unwritten.lower_bound({level,first_start});
+        it!=state.unwritten.end() && it->first.first==level && it->first.second<=last_start;++it){
+      nodes.insert_or_assign(it->first.second,it->second.first);
+    }
+    // A node adds its values to each of its buckets in the window.
+    for(const auto &[start,node]:nodes){
+      auto bucket=(start-rollup.since)/rollup.width;
+      auto until=std::min(last,bucket+((uint64_t{1}<<level)-1));
+      for(bucket=std::max(bucket,first);bucket<=until;++bucket){
+        auto bucket_start=rollup.since+bucket*rollup.width;
+        auto &merged=buckets.try_emplace(bucket_start,RollupBucket{bucket_start,bucket_start+rollup.width})
+                         .first->second;
+        MergeRollupBucket(merged,node);
+        if(bucket==until) break;
+      }
+    }
+  }
+  result.reserve(buckets.size());
+  for(auto &[_,bucket]:buckets) result.push_back(std::move(bucket));
+  return result;
+}
+
+void History_delta::UpdateRollups(uint64_t start,uint64_t commit,const std::vector<storage::LabelId> &labels,
+                                  const std::map<storage::PropertyId,storage::PropertyValue> &properties){
+  std::lock_guard<std::mutex> guard(rollups_lock_);
+  auto retained_from=RetainedFrom();
+  for(auto &[name,state]:rollups_){
+    const auto &rollup=state.rollup;
+    if(std::find(labels.begin(),labels.end(),rollup.label)==labels.end()) continue;
+    auto value=properties.find(rollup.property);
+    if(value==properties.end() || !(value->second.IsInt() || value->second.IsDouble())) continue;
+    // Only the part of the version from `since` on is summarized.
+    auto from=std::max(start,rollup.since);
+    if(from>=commit) continue;
+    auto first=(from-rollup.since)/rollup.width;
+    auto last=(commit-1-rollup.since)/rollup.width;
+    // Expired already, a late version mustn't bring those buckets back.
+    if(retained_from>rollup.since) first=std::max(first,(retained_from-rollup.since)/rollup.width);
+    if(first>last) continue;
+    RollupBucket version{0,0,1,value->second,value->second,value->second};
+    // The version is added to the nodes covering its buckets, which are at
+    // most two per level however long it is.
+    ForEachTreeNode(first,last,0,[&](uint64_t level,uint64_t node){
+      auto node_start=rollup.since+(node<<level)*rollup.width;
+      auto key=RollupNodeKey(name,level,node_start);
+      auto [pending,inserted]=state.unwritten.try_emplace({level,node_start});
+      auto &bucket=pending->second.first;
+      if(inserted){
+        auto cached=state.cached.find({level,node_start});
+        std::optional<std::string> stored;
+        auto node_end=RollupNodeEnd(rollup,level,node_start);
+        if(cached!=state.cached.end()){
+          bucket=std::move(cached->second);
+          state.cached.erase(cached);
+        }else if((stored=storage_.Get(key))){
+          bucket=DecodeRollupBucket(*stored,node_start,node_end).value_or(RollupBucket{node_start,node_end});
         }else{
-            anchor_flag=true;
-            auto va_ts=(int64_t)(std::get<1>(string_convert_to_uint(key,realTimeFlagConstant)));
-            if(va_ts>=c_te){
-                tmp_info=nlohmann::json::parse(iter_begin->second);
-                va_ts=va_ts>0?-va_ts:va_ts;
-                auto va_ts_str=uint_convert_to_string(va_ts,realTimeFlagConstant);
-                auto delta_prefix=kVertexDeltaPrefix+std::to_string(vertx_gid)+":"+va_ts_str;
-                vd_iter_begin=storage_.starts(delta_prefix);
-                vd_iter_end=storage_.last(delta_prefix);//null
-            }
+          bucket=RollupBucket{node_start,node_end};
         }
+      }
+      MergeRollupBucket(bucket,version);
+      // The node is in one more batch, unless this GC cycle updated it
+      // already.
+      if(pending_time_entries_.insert_or_assign(key,EncodeRollupBucket(bucket)).second) ++pending->second.second;
+    });
+  }
+}
+
+void History_delta::RollupBucketsWritten(const std::map<std::string,std::string> &time_entries){
+  std::lock_guard<std::mutex> guard(rollups_lock_);
+  for(auto it=time_entries.lower_bound(kRollupBucketPrefix);it!=time_entries.end();++it){
+    if(it->first.compare(0,kRollupBucketPrefix.size(),kRollupBucketPrefix)!=0) break;
+    auto key=ParseRollupNodeKey(it->first);
+    if(!key) continue;
+    const auto &[name,level,start]=*key;
+    // The rollup may be dropped in the meantime.
+    auto state=rollups_.find(name);
+    if(state==rollups_.end()) continue;
+    auto &unwritten=state->second.unwritten;
+    auto pending=unwritten.find({level,start});
+    if(pending==unwritten.end() || pending->second.second==0 || --pending->second.second>0) continue;
+    auto &cached=state->second.cached;
+    cached.insert_or_assign(pending->first,std::move(pending->second.first));
+    unwritten.erase(pending);
+    // The buckets are the most numerous nodes, the oldest ones are the least
+    // likely to be updated again.
+    while(cached.size()>kRollupCachedBuckets) cached.erase(cached.begin());
+  }
+}
+
+std::optional<HistoryRecord> History_delta::GetLatestVertexRecord(storage::Gid gid){
+  WaitForMigration();
+  auto prefix=RecordGroup(kVertexDeltaPrefix,gid.AsUint());
+  auto iter=storage_.group_begin(prefix);
+  if(iter!=storage_.group_end(prefix)) return Decode(iter.value());
+  // All records of the vertex were moved to the cold tier.
+  for(const auto &segment:ColdSegments(0)){
+    std::optional<HistoryRecord> record;
+    segment->segment.Scan(prefix,[&](std::string_view key,std::string_view value){
+      if(key.size()==kRecordKeySize && key.compare(0,kRecordGroupSize,prefix)==0) record=Decode(value);
+      return false;
+    });
+    if(record) return record;
+  }
+  return std::nullopt;
+}
+
+bool History_delta::ReplayVertex(std::optional<kvstore::KVStore::iterator> &anchors,
+                                 std::optional<kvstore::KVStore::iterator> &deltas,uint64_t vertx_gid,uint64_t c_ts,
+                                 uint64_t c_te,const std::string &type,const VersionVisitor &on_version){
+    auto seek=[this](std::optional<kvstore::KVStore::iterator> &iter,const std::string &key){
+        if(iter) iter->Seek(key);
+        else iter.emplace(storage_.group_begin(key));
+    };
+    bool anchor_flag=false;
+    VersionReplay replay;
+    //1.1. VA中找不到，从最新的VD找到数据
+    auto prefixs=RecordGroup(kVertexDeltaPrefix,vertx_gid)+BigEndian(-c_te);
+    auto use_anchor=[&](std::string_view key,std::string_view value){//1.2. VA中找到了，筛选VD数据段
+        auto [anchor_gid,va_ts,va_te]=ParseRecordKey(key);
+        if(anchor_gid!=vertx_gid) return;
+        anchor_flag=true;
+        if(va_ts>=c_te){
+            if(auto anchor=Decode(value)) replay=VersionReplay(std::move(*anchor));
+            va_ts=va_ts>0?-va_ts:va_ts;
+            prefixs=RecordGroup(kVertexDeltaPrefix,vertx_gid)+BigEndian((uint64_t)va_ts);
+        }
+    };
+    auto anchor_prefix=RecordGroup(kVertexAnchorPrefix,vertx_gid)+BigEndian(c_te);
+    // An anchor in the cold tier is closer to the window than any anchor in
+    // the history store.
+    if(auto anchor=ColdAnchor(anchor_prefix,c_te)){
+        use_anchor(anchor->first,anchor->second);
+    }else{
+        seek(anchors,anchor_prefix);//seek 符合时间条件的最开始的record 比当前时间大一个的指针
+        if(anchors->IsValid()) use_anchor(anchors->key(),anchors->value());
     }
 
     //2、获取delta数据
-    for(;vd_iter_begin!=vd_iter_end;++vd_iter_begin){
-        auto [gid,ts,te]=string_convert_to_uint(vd_iter_begin->first,realTimeFlagConstant);
-        auto object_ts=(uint64_t)-ts;//版本的开始时间
-        auto object_te=(uint64_t)-te;//版本的结束时间
-        if(gid!=vertx_gid) break;
-        if(object_te<c_ts) break;
-        auto current_info=nlohmann::json::parse(vd_iter_begin->second);//当前节点的数据
-        if(need_combine){
-            combineVertex(tmp_info,current_info);
-            tmp_info=current_info;
-        }
-        if(TemporalCheck(object_ts,object_te,c_ts,c_te,type)){
-            need_combine=false;
-            history_Delta.emplace_back(current_info);
-            if(type=="as of") break;
+    seek(deltas,prefixs);
+    ReplayVersions(*deltas,storage_.group_end(prefixs),prefixs,vertx_gid,c_ts,c_te,type,std::move(replay),on_version);
+    return anchor_flag;
+}
+
+bool History_delta::ForEachVertexVersion(storage::Gid gid,uint64_t c_ts,uint64_t c_te,const std::string &type,
+                                         const VersionVisitor &on_version){
+    if(!ClipToRetention(c_ts,c_te) || !MayHaveHistory(kVertexTimePrefix,gid.AsUint(),c_ts,c_te)) return false;
+    WaitForMigration();
+    std::optional<kvstore::KVStore::iterator> anchors;
+    std::optional<kvstore::KVStore::iterator> deltas;
+    return ReplayVertex(anchors,deltas,gid.AsUint(),c_ts,c_te,type,on_version);
+}
+
+std::vector<std::vector<HistoryRecord>> History_delta::GetVerticesInfo(const std::vector<storage::Gid> &gids,uint64_t c_ts,
+                                                                       uint64_t c_te,const std::string &type){
+    std::vector<std::vector<HistoryRecord>> history_Deltas(gids.size());
+    if(!ClipToRetention(c_ts,c_te)) return history_Deltas;
+    std::vector<size_t> order;
+    order.reserve(gids.size());
+    for(size_t i=0;i<gids.size();++i){
+        if(MayHaveHistory(kVertexTimePrefix,gids[i].AsUint(),c_ts,c_te)) order.push_back(i);
+    }
+    if(order.empty()) return history_Deltas;
+    // Sorted by gid the seeks of both iterators only move forward.
+    std::sort(order.begin(),order.end(),[&](size_t lhs,size_t rhs){return gids[lhs]<gids[rhs];});
+    WaitForMigration();
+    auto lookup=[&](size_t begin,size_t end){
+        std::optional<kvstore::KVStore::iterator> anchors;
+        std::optional<kvstore::KVStore::iterator> deltas;
+        for(auto k=begin;k<end;++k){
+            auto i=order[k];
+            auto &history_Delta=history_Deltas[i];
+            ReplayVertex(anchors,deltas,gids[i].AsUint(),c_ts,c_te,type,[&](HistoryRecord &&record){
+                history_Delta.emplace_back(std::move(record));
+                return true;
+            });
         }
+    };
+    if(!scan_pool_||order.size()<2){
+        lookup(0,order.size());
+        return history_Deltas;
     }
-    return std::make_pair(history_Delta,anchor_flag);
+    // Only the lookups are split, the vertices of the batch come from the
+    // scan of the current store on the query thread. Every range writes only
+    // the results of its own vertices.
+    utils::RunRanges(&*scan_pool_,order.size(),scan_threads_,lookup);
+    return history_Deltas;
+}
+
+std::pair<std::vector<HistoryRecord>,bool> History_delta::GetVertexInfo(storage::Gid gid,uint64_t c_ts,uint64_t c_te,std::string type){
+    std::vector<HistoryRecord> history_Delta;
+    auto anchor_flag=ForEachVertexVersion(gid,c_ts,c_te,type,[&](HistoryRecord &&record){
+        history_Delta.emplace_back(std::move(record));
+        return true;
+    });
+    return std::make_pair(std::move(history_Delta),anchor_flag);
 }
 
 
@@ -397,189 +1388,705 @@ std::pair<std::vector< std::tuple< std::map<storage::PropertyId,storage::Propert
   return std::make_pair(res,need_deleted_flag);
 }
 
-std::vector<nlohmann::json> History_delta::GetDeleteEdgeInfo(uint64_t c_ts,uint64_t c_te,std::string type,uint64_t vertex_gid){
-    std::vector<nlohmann::json> history_Delta;
-    bool anchor_flag=false;
-    //1. VD找到数据
-    auto prefixs=kVertexEdgePrefix+std::to_string(vertex_gid);
-    auto vd_iter_begin=storage_.starts(prefixs);
-    auto vd_iter_end=storage_.last(prefixs);//null
-    bool need_combine=true;
-    auto tmp_info=nlohmann::json::object();
-
-    //2、获取数据
-    for(;vd_iter_begin!=vd_iter_end;++vd_iter_begin){
-        auto [gid,ts,te]=string_convert_to_uint(vd_iter_begin->first,realTimeFlagConstant);
-        auto object_ts=(uint64_t)-ts;//版本的开始时间
-        auto object_te=(uint64_t)-te;//版本的结束时间
-        if(gid!=vertex_gid) break;
-        if(object_te<c_ts) break;
-        auto current_info=nlohmann::json::parse(vd_iter_begin->second);//当前节点的数据
-        if(need_combine){
-            combineEdge(tmp_info,current_info);
-            tmp_info=current_info;
-        }
-        if(TemporalCheck(object_ts,object_te,c_ts,c_te,type)){
-            need_combine=false;
-            history_Delta.emplace_back(current_info);
-            if(type=="as of") break;
-        }
+std::vector<std::pair<uint64_t,HistoryEdgeEntry>> History_delta::GetRemovedEdges(uint64_t vertex_gid,bool out,
+                                                                                const std::vector<storage::EdgeTypeId> &edge_types,
+                                                                                uint64_t c_ts,uint64_t c_te){
+  if(!ClipToRetention(c_ts,c_te) || !MayHaveHistory(kVertexTimePrefix,vertex_gid,c_ts,c_te)) return {};
+  WaitForMigration();
+  std::vector<std::pair<uint64_t,HistoryEdgeEntry>> edges;
+  auto cold_until=cold_until_.load();
+  auto segments=ColdSegments(c_ts);
+  // Reads the removals under `prefix` which happened at c_ts or later from the
+  // history store and the cold tier. Without an edge type the older removals
+  // of a type are skipped by seeking to the next type.
+  auto scan=[&](const std::string &prefix,bool all_types){
+    auto scan_tier=[&](const auto &read,uint64_t moved_until){
+      auto seek_key=prefix;
+      while(true){
+        std::optional<uint64_t> next_type;
+        read(seek_key,[&](std::string_view key,std::string_view value){
+          if(key.size()!=kVertexEdgeKeySize || key.substr(0,prefix.size())!=prefix) return false;
+          auto [gid,edge_out,edge_type,commit,edge_gid]=ParseVertexEdgeKey(key);
+          if(commit<c_ts){
+            if(all_types && edge_type!=std::numeric_limits<uint64_t>::max()) next_type=edge_type+1;
+            return false;
+          }
+          // Left behind by a move to the cold tier, which holds it.
+          if(commit<=moved_until) return true;
+          auto record=Decode(value);
+          if(!record) return true;
+          for(auto &edge:record->edges) edges.emplace_back(std::move(edge));
+          return true;
+        });
+        if(!next_type) return;
+        seek_key=VertexEdgeGroup(vertex_gid,out,*next_type);
+      }
+    };
+    scan_tier([&](const std::string &seek_key,const auto &visit){
+      auto iter_end=storage_.group_end(seek_key);
+      for(auto iter=storage_.group_begin(seek_key);iter!=iter_end;++iter){
+        if(!visit(iter.key(),iter.value())) return;
+      }
+    },cold_until);
+    for(const auto &segment:segments){
+      scan_tier([&](const std::string &seek_key,const auto &visit){ segment->segment.Scan(seek_key,visit); },0);
     }
+  };
+  if(edge_types.empty()){
+    scan(VertexEdgeGroup(vertex_gid,out),true);
+  }else{
+    for(const auto &edge_type:edge_types){
+      // A type without a disk ID was never written.
+      if(auto disk_id=FindDiskId(edge_type.AsUint())) scan(VertexEdgeGroup(vertex_gid,out,*disk_id),false);
+    }
+  }
+  return edges;
+}
 
-    return history_Delta;
+std::map<std::string, HistoryRecord> &History_delta::PendingRecords(storage::Gid gid){
+  if(!pending_sequence_){
+    // Readers have to wait for the records from the moment the GC starts
+    // collecting them, the deltas are unlinked before the batch is queued.
+    std::lock_guard<std::mutex> guard(in_flight_lock_);
+    pending_sequence_=next_sequence_++;
+    in_flight_.emplace(*pending_sequence_,std::chrono::steady_clock::now());
+    in_flight_count_.fetch_add(1,std::memory_order_acq_rel);
+  }
+  return pending_records_[gid.AsUint()%pending_records_.size()];
+}
+
+bool History_delta::WriteMigrationBatch(MigrationBatch &batch){
+  std::vector<std::map<std::string,std::string>> encoded(batch.partitions.size());
+  auto encode_partition=[&](size_t i){
+    for(const auto &[key,value]:batch.partitions[i]){
+      encoded[i].emplace(key,Encode(value));
+    }
+  };
+  if(encoding_pool_){
+    utils::RunRanges(&*encoding_pool_,batch.partitions.size(),batch.partitions.size(),[&](size_t begin,size_t end){
+      for(auto i=begin;i<end;++i) encode_partition(i);
+    });
+  }else{
+    for(size_t i=0;i<batch.partitions.size();++i) encode_partition(i);
+  }
+  // The time tables, time index postings, statistics and rollup buckets
+  // collected with the records, and the names they all use, are written in
+  // the same batch as the records, so a crash loses all of them or none.
+  auto time_entries=encoded.size();
+  encoded.emplace_back(std::move(batch.time_entries));
+  {
+    std::lock_guard<utils::RWLock> guard(name_ids_lock_);
+    encoded.emplace_back(std::move(pending_name_ids_));
+    pending_name_ids_.clear();
+  }
+  // The deltas of the batch are unlinked already, so it stays in flight until
+  // it is written.
+  for(uint64_t attempt=1;!storage_.PutMultiple(encoded);++attempt){
+    if(attempt>=kMigrationWriteAttempts){
+      // The batch is kept as it was handed over, with the names it uses.
+      batch.time_entries=std::move(encoded[time_entries]);
+      {
+        std::lock_guard<utils::RWLock> guard(name_ids_lock_);
+        pending_name_ids_.merge(encoded.back());
+      }
+      auto error=fmt::format("Couldn't write the history records of GC cycle {} in {} attempts, the history isn't "
+                             "migrated anymore and the deltas are kept in memory until a restart.",
+                             batch.sequence,attempt);
+      spdlog::error("{}",error);
+      std::lock_guard<std::mutex> guard(in_flight_lock_);
+      migration_error_=std::move(error);
+      migration_failed_.store(true,std::memory_order_release);
+      // Readers waiting for the batch fail instead.
+      in_flight_cv_.notify_all();
+      return false;
+    }
+    spdlog::warn("Couldn't write the history records of GC cycle {}, retrying.",batch.sequence);
+    std::this_thread::sleep_for(kMigrationRetryDelay*(1<<attempt));
+  }
+  RollupBucketsWritten(encoded[time_entries]);
+  return true;
 }
 
 void History_delta::SaveDeltaAll() {
-  bool success = false;
-  if(gid_delta_.empty()) return;
-  std::map<std::string,std::string> gid_data_tmp;
-  for(auto [key,value]:gid_delta_){
-    gid_data_tmp[key]=value.dump();
+  if(!pending_sequence_) return;
+  MigrationBatch batch{*pending_sequence_,std::move(pending_records_),std::move(pending_time_entries_)};
+  pending_sequence_.reset();
+  pending_time_entries_.clear();
+  pending_records_.clear();
+  pending_records_.resize(batch.partitions.size());
+
+  if(!migration_thread_){
+    // Once a batch couldn't be written, the later ones are only kept.
+    if(!MigrationFailed() && WriteMigrationBatch(batch)){
+      FinishBatch(batch.sequence);
+      return;
+    }
+    std::lock_guard<std::mutex> guard(migration_lock_);
+    migration_queue_.push_back(std::move(batch));
+    return;
+  }
+  {
+    std::unique_lock<std::mutex> guard(migration_lock_);
+    // Backpressure, the GC waits for the migration thread to catch up. The
+    // queue isn't drained anymore once a batch couldn't be written.
+    migration_cv_.wait(guard,[&]{return migration_queue_.size()<migration_queue_size_ || MigrationFailed();});
+    migration_queue_.push_back(std::move(batch));
+  }
+  migration_cv_.notify_all();
+}
+
+void History_delta::MigrationLoop(){
+  while(true){
+    MigrationBatch batch;
+    {
+      std::unique_lock<std::mutex> guard(migration_lock_);
+      migration_cv_.wait(guard,[&]{return (!migration_queue_.empty() && !MigrationFailed()) || migration_shutdown_;});
+      // The queue is drained before shutting down, unless a batch couldn't
+      // be written.
+      if(migration_queue_.empty() || MigrationFailed()) return;
+      batch=std::move(migration_queue_.front());
+      migration_queue_.pop_front();
+    }
+    migration_cv_.notify_all();
+    if(!WriteMigrationBatch(batch)){
+      // The batch stays queued, and in flight, with the ones after it.
+      {
+        std::lock_guard<std::mutex> guard(migration_lock_);
+        migration_queue_.push_front(std::move(batch));
+      }
+      migration_cv_.notify_all();
+      continue;
+    }
+    FinishBatch(batch.sequence);
   }
-  success=storage_.PutMultiple(gid_data_tmp);
-  if (!success) {
-    std::cout<<"Couldn't save delta!"<<std::endl;
+}
+
+void History_delta::FinishBatch(uint64_t sequence){
+  std::lock_guard<std::mutex> guard(in_flight_lock_);
+  in_flight_.erase(sequence);
+  in_flight_count_.fetch_sub(1,std::memory_order_acq_rel);
+  in_flight_cv_.notify_all();
+}
+
+uint64_t HistoryStatistics::DeletedVertices(uint64_t since) const{
+  uint64_t count=0;
+  for(auto it=deleted_vertices.lower_bound(since>>kBucketBits);it!=deleted_vertices.end();++it) count+=it->second;
+  return count;
+}
+
+uint64_t HistoryStatistics::DeletedEdges(uint64_t since) const{
+  uint64_t count=0;
+  for(auto it=deleted_edges.lower_bound(since>>kBucketBits);it!=deleted_edges.end();++it) count+=it->second;
+  return count;
+}
+
+void History_delta::LoadHistoryStatistics(){
+  std::lock_guard<std::mutex> guard(statistics_lock_);
+  if(storage_.Get(kVertexVersionsKey)){
+    for(auto it=storage_.begin(kStatisticsPrefix);it!=storage_.end(kStatisticsPrefix);++it){
+      auto name=it->first.substr(kStatisticsPrefix.size());
+      auto count=(uint64_t)std::stoull(it->second);
+      if(name=="VV"){
+        statistics_.vertex_versions=count;
+      }else if(name=="EV"){
+        statistics_.edge_versions=count;
+      }else if(name.rfind("L:",0)==0){
+        auto label=storage::LabelId::FromUint(ToStorageId(std::stoull(name.substr(2))));
+        statistics_.label_versions[label]=count;
+      }else if(name.rfind("DV:",0)==0){
+        statistics_.deleted_vertices[std::stoull(name.substr(3))]=count;
+      }else if(name.rfind("DE:",0)==0){
+        statistics_.deleted_edges[std::stoull(name.substr(3))]=count;
+      }
+    }
+    return;
+  }
+  // A vertex was deleted by the version whose record recreates it.
+  for(auto it=storage_.begin(kVertexDeltaPrefix);it!=storage_.end(kVertexDeltaPrefix);++it){
+    ++statistics_.vertex_versions;
+    auto record=Decode(it.value());
+    if(record && record->recreate){
+      auto commit=(uint64_t)-std::get<2>(ParseRecordKey(it.key()));
+      ++statistics_.deleted_vertices[commit>>HistoryStatistics::kBucketBits];
+    }
+  }
+  for(auto it=storage_.begin(kEdgeDeltaPrefix);it!=storage_.end(kEdgeDeltaPrefix);++it){
+    ++statistics_.edge_versions;
+  }
+  std::map<std::string,std::string> batch;
+  batch[kVertexVersionsKey]=std::to_string(statistics_.vertex_versions);
+  batch[kEdgeVersionsKey]=std::to_string(statistics_.edge_versions);
+  for(const auto &[bucket,count]:statistics_.deleted_vertices){
+    batch[kStatisticsPrefix+"DV:"+std::to_string(bucket)]=std::to_string(count);
+  }
+  if(!storage_.PutMultiple(batch)){
+    throw utils::BasicException("Couldn't save the history statistics!");
   }
-  gid_delta_.clear();
 }
 
+void History_delta::CountDelta(const std::string &prefix,bool new_version,bool deleted,uint64_t commit){
+  if(prefix==kVertexEdgePrefix) return;
+  bool vertex=prefix==kVertexDeltaPrefix;
+  std::lock_guard<std::mutex> guard(statistics_lock_);
+  if(new_version){
+    auto &versions=vertex?statistics_.vertex_versions:statistics_.edge_versions;
+    ++versions;
+    pending_time_entries_[vertex?kVertexVersionsKey:kEdgeVersionsKey]=std::to_string(versions);
+  }
+  if(deleted){
+    auto bucket=commit>>HistoryStatistics::kBucketBits;
+    auto &count=(vertex?statistics_.deleted_vertices:statistics_.deleted_edges)[bucket];
+    ++count;
+    pending_time_entries_[kStatisticsPrefix+(vertex?"DV:":"DE:")+std::to_string(bucket)]=std::to_string(count);
+  }
+}
 
-void History_delta::SaveAnchorAll(std::map<std::string, std::string> &value){
-  bool success=storage_.PutMultiple(value);
-  if (!success) {
-    std::cout<<"Couldn't save delta!"<<std::endl;
+void History_delta::CountVertexVersion(const std::vector<storage::LabelId> &labels){
+  std::vector<uint64_t> disk_ids;
+  disk_ids.reserve(labels.size());
+  for(const auto &label:labels) disk_ids.push_back(ToDiskId(label.AsUint()));
+  std::lock_guard<std::mutex> guard(statistics_lock_);
+  for(size_t i=0;i<labels.size();++i){
+    auto &count=statistics_.label_versions[labels[i]];
+    ++count;
+    pending_time_entries_[kStatisticsPrefix+"L:"+std::to_string(disk_ids[i])]=std::to_string(count);
   }
 }
 
+HistoryStatistics History_delta::GetHistoryStatistics() const{
+  HistoryStatistics statistics;
+  {
+    std::lock_guard<std::mutex> guard(statistics_lock_);
+    statistics=statistics_;
+  }
+  std::shared_lock<utils::RWLock> guard(time_table_lock_);
+  statistics.vertices=vertex_time_table_.size();
+  statistics.edges=edge_time_table_.size();
+  return statistics;
+}
 
-void History_delta::SaveEdgeAnchorAll(uint64_t tid,std::map<std::string, std::string>& data){
-  if(!data.empty())edge_anchor_.emplace_back(data);
+void History_delta::WaitForMigration(){
+  if(in_flight_count_.load(std::memory_order_acquire)==0) return;
+  std::unique_lock<std::mutex> guard(in_flight_lock_);
+  auto last=next_sequence_;
+  in_flight_cv_.wait(guard,[&]{
+    return in_flight_.empty() || in_flight_.begin()->first>=last || MigrationFailed();
+  });
+  // The records of the batch which couldn't be written are missing.
+  if(!in_flight_.empty() && in_flight_.begin()->first<last) throw utils::BasicException(migration_error_);
+}
+
+bool History_delta::MigrationFailed() const{
+  return migration_failed_.load(std::memory_order_acquire);
+}
+
+MigrationInfo History_delta::GetMigrationInfo() const{
+  std::lock_guard<std::mutex> guard(in_flight_lock_);
+  if(in_flight_.empty()) return {0,std::chrono::milliseconds(0),migration_error_};
+  auto lag=std::chrono::steady_clock::now()-in_flight_.begin()->second;
+  return {in_flight_.size(),std::chrono::duration_cast<std::chrono::milliseconds>(lag),migration_error_};
+}
+
+void History_delta::SaveVertexAnchor(storage::Gid gid,const uint64_t start,const std::vector<storage::LabelId> &labels,const std::map<storage::PropertyId, storage::PropertyValue> &maybe_properties){
+  HistoryRecord data;
+  data.properties=maybe_properties;
+  data.labels.reserve(labels.size());
+  for(const auto &label:labels){
+    data.labels.emplace_back(LabelAction::ADD,label);
+  }
+  PendingRecords(gid)[getPrefix(gid,start,true)]=std::move(data);
+}
+
+void History_delta::SaveEdgeAnchor(storage::Gid gid,const uint64_t start,const std::map<storage::PropertyId, storage::PropertyValue> &maybe_properties){
+  HistoryRecord data;
+  data.properties=maybe_properties;
+  PendingRecords(gid)[getPrefix(gid,start,false)]=std::move(data);
 }
 
 void History_delta::SaveDelta(storage::Gid gid,const std::optional<storage::Gid> to_gid,const uint64_t start,const uint64_t commit,storage::Delta& delta,storage::NameIdMapper &name_id_mapper) {
   if(start>commit) return;
   bool edge_flag=false;
-  //get delta infomation encode delta to string
-  nlohmann::json data = nlohmann::json::object();
+  bool deleted=false;
+  //get delta infomation
+  HistoryRecord data;
   switch (delta.action) {
     case storage::Delta::Action::RECREATE_OBJECT: {
-      data= delta.add_info;
-      if(!to_gid)data["R"]="R";//排除边
+      if(delta.add_info) data=*delta.add_info;
+      if(!to_gid)data.recreate=true;//排除边
+      deleted=true;
       break;
     }
     case storage::Delta::Action::SET_PROPERTY: {
-      auto property_name = name_id_mapper.IdToName(delta.property.key.AsUint());//delta.property.key.AsUint();//
-      auto property_value = SerializePropertyValue(delta.property.value);//query::serialization::
-      nlohmann::json data2 = nlohmann::json::object();
-      data2[property_name] = property_value;
-      data["SP"]=data2;
+      data.properties.emplace(delta.property.key,delta.property.value);
       break;
     }
     case storage::Delta::Action::ADD_LABEL:{
-      auto add_label=std::vector<std::pair<std::string,std::string>>();
-      add_label.emplace_back("AL",name_id_mapper.IdToName(delta.label.AsUint()));
-      data["L"] = add_label;//"ADD:"+name_id_mapper.IdToName(delta.label.AsUint());
+      data.labels.emplace_back(LabelAction::ADD,delta.label);
       break;
     }
     case storage::Delta::Action::REMOVE_LABEL: {
-      auto remove_labels=std::vector<std::pair<std::string,std::string>>();
-      // auto labels=std::vector<uint64_t>();
-      // labels.emplace_back(delta.label.AsUint());
-      remove_labels.emplace_back("RL",name_id_mapper.IdToName(delta.label.AsUint()));
-      data["L"] = remove_labels;//"REMOVE:"+name_id_mapper.IdToName(delta.label.AsUint());
+      data.labels.emplace_back(LabelAction::REMOVE,delta.label);
       break;
     }
     case storage::Delta::Action::ADD_OUT_EDGE:
     case storage::Delta::Action::ADD_IN_EDGE:{
+      // The edge was removed by the version ending at `commit`.
       edge_flag=true;
-      auto edge_id=std::to_string((delta.vertex_edge.edge.ptr->gid).AsUint());
-      nlohmann::json edge_data = nlohmann::json::object();
-      edge_data["Type"]=delta.action==storage::Delta::Action::ADD_OUT_EDGE?"AOE":"AIE";//ADD IN EDGE
-      edge_data["edgeType"]=name_id_mapper.IdToName((delta.vertex_edge.edge_type).AsUint());
-      edge_data["edgeId"]=(delta.vertex_edge.edge.ptr->gid).AsUint();
-      edge_data["fromGid"]=(delta.vertex_edge.edge.ptr->from_gid).AsUint();
-      edge_data["toGid"]=(delta.vertex_edge.edge.ptr->to_gid).AsUint();
-      data[edge_id]=edge_data;
+      auto *edge=delta.vertex_edge.edge.ptr;
+      data.edges.emplace(edge->gid.AsUint(),
+                         HistoryEdgeEntry{delta.action==storage::Delta::Action::ADD_OUT_EDGE,delta.vertex_edge.edge_type,
+                                          edge->from_gid,edge->to_gid});
       break;
     }
     default:
       return;
   }
   if(to_gid) {
-    data["Fid"]=(delta.from_gid)->AsUint();
-    data["Tid"]=(delta.to_gid)->AsUint();
+    data.endpoints.emplace(*delta.from_gid,*delta.to_gid);
   }
   auto prefix=(to_gid)?kEdgeDeltaPrefix:(edge_flag?kVertexEdgePrefix:kVertexDeltaPrefix);
   //save hash index
-  auto vertex_gid=gid.AsUint();
-  if(prefix=="VD:"){
-    auto iter=vertex_time_table_.find(vertex_gid);
-    if(iter==vertex_time_table_.end()){
-      vertex_time_table_[vertex_gid]=std::make_pair(start,commit);
-    }else{
-      auto &value=vertex_time_table_[vertex_gid];
-      value.second=commit;
-      if(value.first==0){
-        value.first=start;
-      }
+  UpdateTimeTable(prefix==kEdgeDeltaPrefix?kEdgeTimePrefix:kVertexTimePrefix,gid.AsUint(),start,commit);
+  if(prefix!=kEdgeDeltaPrefix) UpdateTimeIndex(gid.AsUint(),start,commit);
+
+  std::string put_key;
+  if(edge_flag){
+    const auto &[edge_gid,edge]=*data.edges.begin();
+    put_key=VertexEdgeKey(gid.AsUint(),edge.out,ToDiskId(edge.edge_type.AsUint()),commit,edge_gid);
+  }else{
+    put_key=RecordKey(prefix,gid.AsUint(),-(int64_t)start,-(int64_t)commit);
+  }
+  // union something
+  data.tt_ts=start;
+  data.tt_te=commit;
+  auto &pending=PendingRecords(gid);
+  auto iter =  pending.find(put_key);
+  CountDelta(prefix,iter==pending.end(),deleted,commit);
+  if(iter !=  pending.end()){ 
+    MergeRecord(iter->second,&data);
+  }
+   pending[put_key]=std::move(data);
+}
+
+std::string History_delta::getPrefix(storage::Gid gid,const uint64_t start,bool vertex){
+  auto prefix=vertex?kVertexAnchorPrefix:kEdgeAnchorPrefix;
+  return RecordKey(prefix,gid.AsUint(),(int64_t)start,(int64_t)start);
+}
+bool History_delta::HasDeltas() const { return storage_.begin(kDeltaPrefix) != storage_.end(kDeltaPrefix); }
+
+
+void History_delta::LoadColdTier(){
+  if(cold_directory_.empty()) return;
+  utils::EnsureDirOrDie(cold_directory_);
+  std::vector<std::shared_ptr<const ColdSegment>> segments;
+  for(const auto &entry:std::filesystem::directory_iterator(cold_directory_)){
+    const auto &path=entry.path();
+    if(path.extension()!=kSegmentExtension){
+      // Segments which weren't finished when the database stopped.
+      if(path.extension()==".tmp") std::filesystem::remove(path);
+      continue;
     }
-  }   
-  // //save hash index
-  if(prefix=="ED:"){
-    auto iter=edge_time_table_.find(vertex_gid);
-    if(iter==edge_time_table_.end()){
-      edge_time_table_[vertex_gid]=std::make_pair(start,commit);
-    }else{
-      auto &value=edge_time_table_[vertex_gid];
-      value.second=commit;
-      if(value.first==0){
-        value.first=start;
+    auto segment=std::make_shared<ColdSegment>(0,0,path,cold_options_);
+    auto footer=segment->segment.Get(kSegmentFooterKey);
+    if(!footer || footer->size()<2*sizeof(uint64_t)){
+      throw utils::BasicException("The cold tier segment {} has no footer!",path.string());
+    }
+    segment->from=ReadBigEndian(*footer,0);
+    segment->until=ReadBigEndian(*footer,sizeof(uint64_t));
+    segment->max_end=footer->size()>=4*sizeof(uint64_t)?ReadBigEndian(*footer,3*sizeof(uint64_t)):segment->until;
+    segments.push_back(std::move(segment));
+  }
+  std::sort(segments.begin(),segments.end(),[](const auto &lhs,const auto &rhs){ return lhs->until>rhs->until; });
+  std::lock_guard<utils::RWLock> guard(cold_lock_);
+  if(!segments.empty()) cold_until_=segments.front()->until;
+  cold_segments_=std::move(segments);
+  if(!cold_segments_.empty()) spdlog::info("Opened {} cold tier segments of history.",cold_segments_.size());
+}
+
+std::vector<std::shared_ptr<const History_delta::ColdSegment>> History_delta::ColdSegments(uint64_t c_ts) const{
+  if(c_ts>cold_until_.load()) return {};
+  std::shared_lock<utils::RWLock> guard(cold_lock_);
+  std::vector<std::shared_ptr<const ColdSegment>> segments;
+  for(const auto &segment:cold_segments_){
+    if(segment->until<c_ts) break;
+    segments.push_back(segment);
+  }
+  return segments;
+}
+
+std::optional<std::pair<std::string,std::string>> History_delta::ColdAnchor(const std::string &key,uint64_t c_te) const{
+  auto segments=ColdSegments(c_te);
+  // Anchors are keyed by their start, the oldest segment holds the closest.
+  for(auto it=segments.rbegin();it!=segments.rend();++it){
+    std::optional<std::pair<std::string,std::string>> anchor;
+    (*it)->segment.Scan(key,[&](std::string_view anchor_key,std::string_view value){
+      if(anchor_key.size()==kRecordKeySize && anchor_key.compare(0,kRecordGroupSize,key,0,kRecordGroupSize)==0){
+        anchor.emplace(anchor_key,value);
       }
+      return false;
+    });
+    if(anchor) return anchor;
+  }
+  return std::nullopt;
+}
+
+bool History_delta::MoveColdHistory(uint64_t until){
+  if(cold_directory_.empty()) return false;
+  std::lock_guard<std::mutex> move_guard(cold_move_lock_);
+  auto from=cold_until_.load();
+  if(until<=from) return false;
+  // Nothing is moved while the records of a batch which couldn't be written
+  // are missing.
+  try{
+    WaitForMigration();
+  }catch(const utils::BasicException &){
+    return false;
+  }
+  // The history of an object starts at the start of its oldest version, the
+  // objects whose history starts after `until` have nothing to move.
+  std::vector<uint64_t> vertices;
+  std::vector<uint64_t> edges;
+  {
+    std::shared_lock<utils::RWLock> guard(time_table_lock_);
+    for(const auto &[gid,span]:vertex_time_table_){
+      if(span.first<=until) vertices.push_back(gid);
+    }
+    for(const auto &[gid,span]:edge_time_table_){
+      if(span.first<=until) edges.push_back(gid);
     }
   }
+  // Calls `func` with every record which ended at `until` or earlier. Kinds
+  // and gids are walked in ascending order, so the keys come sorted.
+  auto for_each_record=[&](const auto &func){
+    for(const auto &prefix:kRecordPrefixes){
+      const auto &gids=prefix==kEdgeDeltaPrefix||prefix==kEdgeAnchorPrefix?edges:vertices;
+      // Iterators don't seek across column families.
+      std::optional<kvstore::KVStore::iterator> iter;
+      for(auto gid:gids){
+        auto group=RecordGroup(prefix,gid);
+        // Deltas are keyed by their negated start, the ones which started
+        // after `until` are skipped.
+        if(prefix==kVertexDeltaPrefix||prefix==kEdgeDeltaPrefix) group+=BigEndian(-until);
+        if(iter) iter->Seek(group);
+        else iter.emplace(storage_.group_begin(group));
+        for(auto iter_end=storage_.group_end(group);*iter!=iter_end;++*iter){
+          auto end=RecordEnd(iter->key());
+          if(!end) continue;
+          if(*end>until){
+            // Anchors are keyed by their start, the later ones are newer.
+            if(prefix==kVertexAnchorPrefix||prefix==kEdgeAnchorPrefix) break;
+            continue;
+          }
+          func(iter->key(),iter->value(),*end);
+        }
+      }
+    }
+  };
 
-  std::string start_str=uint_convert_to_string((int64_t)-start,realTimeFlagConstant);
-  std::string commit_str=uint_convert_to_string((int64_t)-commit,realTimeFlagConstant);
-  auto put_key=prefix + std::to_string(gid.AsUint()) +":"+(start_str)+":"+(commit_str); //std::to_string  std::to_string
-  // union something
-  data["TT_TS"]=start;
-  data["TT_TE"]=commit;
-  auto iter =  gid_delta_.find(put_key);
-  if(iter !=  gid_delta_.end()){ 
-    auto before_value= gid_delta_[put_key];
-    if(edge_flag){//VE
-      combineEdge(before_value,data);
-    }else{//ED+VD
-      combineVertex(before_value,data);
+  auto path=cold_directory_/fmt::format("{:020}{}",until,kSegmentExtension);
+  auto tmp_path=path;
+  tmp_path+=".tmp";
+  uint64_t records=0;
+  uint64_t min_end=std::numeric_limits<uint64_t>::max();
+  uint64_t max_end=0;
+  {
+    kvstore::SegmentWriter writer(tmp_path,cold_options_);
+    auto retained_from=RetainedFrom();
+    for_each_record([&](std::string_view key,std::string_view value,uint64_t end){
+      // Left behind by an earlier move, or expired and only dropped.
+      if(end<=from || end<retained_from) return;
+      writer.Put(key,value);
+      ++records;
+      min_end=std::min(min_end,end);
+      max_end=std::max(max_end,end);
+    });
+    if(records==0){
+      std::filesystem::remove(tmp_path);
+      return false;
+    }
+    writer.Put(kSegmentFooterKey,BigEndian(from)+BigEndian(until)+BigEndian(min_end)+BigEndian(max_end));
+    writer.Finish();
+  }
+  std::filesystem::rename(tmp_path,path);
+  auto new_segment=std::make_shared<ColdSegment>(from,until,path,cold_options_);
+  new_segment->max_end=max_end;
+  std::shared_ptr<const ColdSegment> segment=std::move(new_segment);
+  // The segment and the bound are published before the records are dropped,
+  // lookups skip the records in the history store from now on and would
+  // otherwise find them in both tiers or in neither.
+  {
+    std::lock_guard<utils::RWLock> guard(cold_lock_);
+    cold_segments_.insert(cold_segments_.begin(),segment);
+    cold_until_=until;
+  }
+  auto drop=[&](const std::vector<std::string> &keys){
+    for(uint64_t attempt=1;!storage_.DeleteMultiple(keys);++attempt){
+      if(attempt>=kMigrationWriteAttempts) return false;
+      std::this_thread::sleep_for(kMigrationRetryDelay*(1<<attempt));
+    }
+    return true;
+  };
+  std::vector<std::string> moved;
+  uint64_t dropped=0;
+  bool failed=false;
+  for_each_record([&](std::string_view key,std::string_view,uint64_t){
+    if(failed) return;
+    moved.emplace_back(key);
+    if(moved.size()<kMigrationBatchSize) return;
+    failed=!drop(moved);
+    if(!failed) dropped+=moved.size();
+    moved.clear();
+  });
+  if(!failed && !moved.empty()) failed=!drop(moved);
+  if(failed && dropped==0){
+    // The history store still holds all records, the move is undone.
+    {
+      std::lock_guard<utils::RWLock> guard(cold_lock_);
+      cold_segments_.erase(std::find(cold_segments_.begin(),cold_segments_.end(),segment));
+      cold_until_=from;
     }
+    std::filesystem::remove(path);
+    spdlog::warn("Couldn't drop the history records moved to the cold tier segment {}, the move is undone.",path.string());
+    return false;
+  }
+  if(failed){
+    // Lookups skip the records left behind, the next move drops them.
+    spdlog::warn("Couldn't drop all history records moved to the cold tier segment {}.",path.string());
   }
-   gid_delta_[put_key]=data;
+  spdlog::info("Moved {} history records to the cold tier segment {}.",records,path.string());
+  return true;
 }
 
-std::string History_delta::getPrefix(storage::Gid gid,const uint64_t start,bool vertex){
-  std::string start_str=uint_convert_to_string((int64_t)start,realTimeFlagConstant);
-  auto prefix=vertex?kVertexAnchorPrefix:kEdgeAnchorPrefix;
-  auto key=prefix + std::to_string(gid.AsUint()) +":"+(start_str)+":"+(start_str); //std::to_string  std::to_string
-  return key;
+uint64_t History_delta::RetainedFrom() const{
+  auto cutoff=retention_cutoff_.load(std::memory_order_acquire);
+  return cutoff<0?0:(uint64_t)cutoff+1;
+}
+
+bool History_delta::ClipToRetention(uint64_t &c_ts,uint64_t c_te) const{
+  auto retained_from=RetainedFrom();
+  if(c_te<retained_from) return false;
+  c_ts=std::max(c_ts,retained_from);
+  return true;
 }
-bool History_delta::HasDeltas() const { return storage_.begin(kDeltaPrefix) != storage_.end(kDeltaPrefix); }
 
+void History_delta::CollectExpiredTimeIndex(uint64_t retained_from,std::vector<std::pair<std::string,std::string>> &ranges){
+  auto top_level=time_index_level_.load(std::memory_order_acquire);
+  // The buckets of a level are ordered by time, the nodes which end before
+  // `retained_from` are a single range per scope and level. The valid time
+  // postings are ordered by valid time and stay, their candidates are
+  // checked against the transaction time index.
+  for(const auto &prefix:{kTimeIndexPrefix,kLabelIndexPrefix,kLabelPropertyIndexPrefix}){
+    auto seek_key=prefix;
+    while(true){
+      auto iter=storage_.starts(seek_key);
+      if(iter==storage_.last(seek_key)) break;
+      auto key=iter.key();
+      if(key.size()<prefix.size()+17) break;
+      auto scope=std::string(key.substr(0,key.size()-16-1));
+      for(auto level=kTimeIndexMinLevel;level<=top_level && (retained_from>>level)>0;++level){
+        auto level_key=scope;
+        level_key.push_back(static_cast<char>(level));
+        ranges.emplace_back(level_key,level_key+BigEndian(retained_from>>level));
+      }
+      // Past all levels of the scope, which are below 64.
+      seek_key=scope+'\x40';
+    }
+  }
+}
 
 bool History_delta::RemoveOldHistory(const std::chrono::milliseconds &retention_period) {
-  //TODO find old history and delete them
   auto now_time = std::chrono::system_clock::now();
   auto now_time_milliseconds = std::chrono::duration_cast<std::chrono::milliseconds>(now_time.time_since_epoch()).count();
   int64_t clean_timestamp = now_time_milliseconds-retention_period.count() ;
-  std::vector<std::string> delete_keys;
-  for (auto it = storage_.begin(); it != storage_.end(); ++it) {
-    auto [gid,ts,te]=string_convert_to_uint(it->first,realTimeFlagConstant);
-    te=te>0?te:-te;
-    if(te<=clean_timestamp){
-      delete_keys.push_back(it->first);
+  if(clean_timestamp<=retention_cutoff_.load()) return true;
+  auto retained_from=(uint64_t)clean_timestamp+1;
+  // Compactions drop the records which ended before the cutoff while they
+  // rewrite their files and reads skip them until then, so the records are
+  // never scanned here. The time ordered keys of the time index and the
+  // rollups expire by range, the time tables and deletion statistics by the
+  // entries which ended before the cutoff. All of it is written together
+  // with the cutoff.
+  std::map<std::string,std::string> items{{kRetentionCutoffKey,std::to_string(clean_timestamp)}};
+  std::vector<std::string> keys;
+  std::vector<std::pair<std::string,std::string>> ranges;
+  CollectExpiredTimeIndex(retained_from,ranges);
+  auto index_ranges=ranges.size();
+  {
+    // Held until the entries are deleted, a GC cycle which extends one of
+    // them in the meantime would otherwise lose it.
+    std::lock_guard<utils::RWLock> time_table_guard(time_table_lock_);
+    std::lock_guard<std::mutex> statistics_guard(statistics_lock_);
+    std::lock_guard<std::mutex> rollups_guard(rollups_lock_);
+    for(const auto &[gid,span]:vertex_time_table_){
+      if(span.second<retained_from) keys.push_back(kVertexTimePrefix+std::to_string(gid));
+    }
+    for(const auto &[gid,span]:edge_time_table_){
+      if(span.second<retained_from) keys.push_back(kEdgeTimePrefix+std::to_string(gid));
+    }
+    // Deletion buckets which ended before the cutoff.
+    auto expired_buckets=retained_from>>HistoryStatistics::kBucketBits;
+    auto &deleted_vertices=statistics_.deleted_vertices;
+    auto &deleted_edges=statistics_.deleted_edges;
+    for(auto it=deleted_vertices.begin();it!=deleted_vertices.lower_bound(expired_buckets);++it){
+      keys.push_back(kStatisticsPrefix+"DV:"+std::to_string(it->first));
+    }
+    for(auto it=deleted_edges.begin();it!=deleted_edges.lower_bound(expired_buckets);++it){
+      keys.push_back(kStatisticsPrefix+"DE:"+std::to_string(it->first));
+    }
+    // A rollup node expires once all of its buckets ended before the cutoff,
+    // on every level those are the nodes starting before a bound.
+    auto expired_nodes=[&](const TemporalRollup &rollup,const auto &func){
+      for(uint64_t level=0;level<=kTimeIndexMaxLevel && (retained_from>>level)>=rollup.width;++level){
+        func(level,retained_from-(rollup.width<<level)+1);
+      }
+    };
+    for(const auto &[name,state]:rollups_){
+      expired_nodes(state.rollup,[&](uint64_t level,uint64_t live){
+        ranges.emplace_back(RollupNodeKey(name,level,0),RollupNodeKey(name,level,live));
+      });
+    }
+    if(!storage_.PutAndDeleteRanges(items,keys,ranges)) return false;
+    retention_cutoff_.store(clean_timestamp,std::memory_order_release);
+    for(auto *table:{&vertex_time_table_,&edge_time_table_}){
+      for(auto it=table->begin();it!=table->end();){
+        it=it->second.second<retained_from?table->erase(it):std::next(it);
+      }
+    }
+    deleted_vertices.erase(deleted_vertices.begin(),deleted_vertices.lower_bound(expired_buckets));
+    deleted_edges.erase(deleted_edges.begin(),deleted_edges.lower_bound(expired_buckets));
+    for(auto &[name,state]:rollups_){
+      expired_nodes(state.rollup,[&](uint64_t level,uint64_t live){
+        state.unwritten.erase(state.unwritten.lower_bound({level,0}),state.unwritten.lower_bound({level,live}));
+        state.cached.erase(state.cached.lower_bound({level,0}),state.cached.lower_bound({level,live}));
+      });
+    }
+  }
+  // Segments of the cold tier whose records all expired are dropped whole.
+  std::vector<std::shared_ptr<const ColdSegment>> expired_segments;
+  {
+    std::lock_guard<utils::RWLock> guard(cold_lock_);
+    for(auto it=cold_segments_.begin();it!=cold_segments_.end();){
+      if((*it)->max_end>=retained_from){
+        ++it;
+        continue;
+      }
+      expired_segments.push_back(*it);
+      it=cold_segments_.erase(it);
+    }
+  }
+  for(const auto &segment:expired_segments){
+    // Lookups which still hold the segment keep reading the open file.
+    std::error_code error;
+    if(!std::filesystem::remove(segment->segment.Path(),error)){
+      spdlog::warn("Couldn't remove the expired cold tier segment {}.",segment->segment.Path().string());
     }
   }
-  if (!storage_.DeleteMultiple(delete_keys)) {
-    std::cout<<"Couldn't Remove Old History!\n";
+  // The files of the transaction time index and the rollups are rewritten
+  // without the expired ranges. The label and value scopes may be many, their
+  // ranges are left to the background compactions.
+  for(size_t i=0;i<ranges.size();++i){
+    if(i<index_ranges && ranges[i].first.compare(0,kTimeIndexPrefix.size(),kTimeIndexPrefix)!=0) continue;
+    storage_.CompactRange(ranges[i].first,ranges[i].second);
   }
   return true;
 }
@@ -1,23 +1,36 @@
 #pragma once
 
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <filesystem>
+#include <functional>
+#include <limits>
 #include <mutex>
 #include <optional>
+#include <set>
+#include <thread>
 #include <vector>
 #include "utils/visitor.hpp"
 #include <list>
+#include <memory>
 
 #include "kvstore/kvstore.hpp"
+#include "kvstore/segment.hpp"
 #include "utils/settings.hpp"
+#include "storage/v2/config.hpp"
 #include "storage/v2/name_id_mapper.hpp"
 #include "storage/v2/delta.hpp"
-#include <json/json.hpp>
+#include "storage/v2/history_record.hpp"
+#include "utils/rw_lock.hpp"
+#include "utils/thread_pool.hpp"
+#include <unordered_map>
 
 namespace history_delta {
 
 
 struct historyContext{
-  std::map<uint64_t,std::vector<nlohmann::json>> fiter_history_datas_;//kv store中筛选的历史数据
-  std::map<uint64_t,nlohmann::json> fiter_history_delete;//kv store中筛选的被删除的节点信息
   std::map<std::pair<uint64_t,uint64_t>,storage::Vertex*> all_vertex_;//历史数据+现有数据的集合map gid,transaction_ts vertex
   uint64_t c_ts;//约束事务开始时间
   uint64_t c_te;//约束事务结束时间
@@ -31,50 +44,466 @@ struct historyContextOnce{
     std::vector<storage::LabelId> remove_labels;
 };
 
+/// State of the pipeline that moves history records from the GC to the
+/// history store.
+struct MigrationInfo {
+  // Number of GC cycles whose records aren't written yet.
+  uint64_t queue_depth;
+  // Age of the oldest batch that isn't written yet.
+  std::chrono::milliseconds lag;
+  // Why the records aren't migrated anymore, empty while they are.
+  std::string error;
+};
+
+/// Statistics of the history store, maintained while records are migrated.
+/// The planner uses them to cost the lookups of temporal queries.
+struct HistoryStatistics {
+  // Objects with at least one version in the history store.
+  uint64_t vertices{0};
+  uint64_t edges{0};
+  // Versions stored as delta records.
+  uint64_t vertex_versions{0};
+  uint64_t edge_versions{0};
+  // Vertex versions by the labels the vertex had when they were migrated.
+  std::unordered_map<storage::LabelId,uint64_t> label_versions;
+  // Deleted objects by the time bucket of their deletion, a bucket spans
+  // 2^kBucketBits timestamps.
+  static constexpr uint64_t kBucketBits=16;
+  std::map<uint64_t,uint64_t> deleted_vertices;
+  std::map<uint64_t,uint64_t> deleted_edges;
+
+  /// Average number of versions of an object with history, the number of
+  /// records a lookup replays when it reads the whole chain.
+  double VertexChainLength() const { return vertices==0?0.0:(double)vertex_versions/vertices; }
+  double EdgeChainLength() const { return edges==0?0.0:(double)edge_versions/edges; }
+
+  /// Number of objects deleted at `since` or later.
+  uint64_t DeletedVertices(uint64_t since=0) const;
+  uint64_t DeletedEdges(uint64_t since=0) const;
+};
+
+/// A summary of the history of a numeric property of the vertices with a
+/// label, maintained while their versions are migrated. The transaction time
+/// from `since` on is split into buckets of `width` timestamps, every version
+/// which had the label adds the value of the property to each bucket it
+/// overlaps.
+struct TemporalRollup {
+  enum class Aggregate : uint8_t { COUNT, SUM, MIN, MAX, AVG };
+
+  std::string name;
+  storage::LabelId label;
+  storage::PropertyId property;
+  Aggregate aggregate;
+  uint64_t width;
+  uint64_t since;
+};
+
+/// The values of the versions overlapping [start, end) of a rollup. Integer
+/// sums stay integers until a double is added, like in Cypher.
+struct RollupBucket {
+  uint64_t start;
+  uint64_t end;
+  uint64_t count{0};
+  storage::PropertyValue sum;
+  storage::PropertyValue min;
+  storage::PropertyValue max;
+
+  /// The aggregate of the rollup over the bucket.
+  storage::PropertyValue Value(TemporalRollup::Aggregate aggregate) const;
+};
+
 class History_delta final {
  public:
 
-   explicit History_delta(const std::string &storage_directory);
+   explicit History_delta(const std::string &storage_directory,storage::NameIdMapper *name_id_mapper,
+                          const storage::Config::History &config = {});
+
+   explicit History_delta(const std::string &storage_directory,bool realTimeFlag,storage::NameIdMapper *name_id_mapper,
+                          const storage::Config::History &config = {});
+
+   History_delta(const History_delta &) = delete;
+   History_delta &operator=(const History_delta &) = delete;
+   History_delta(History_delta &&) = delete;
+   History_delta &operator=(History_delta &&) = delete;
 
-   explicit History_delta(const std::string &storage_directory,bool realTimeFlag);
+   /// Writes all queued records before closing the history store.
+   ~History_delta();
 
-  void GetDelta(const std::string &gid_name) const;
+  /// Called with every version visible in a window, newest first. The first
+  /// version is complete, every later one only holds what changed and has to
+  /// be applied onto the previous one. Returning false stops the lookup.
+  using VersionVisitor = std::function<bool(HistoryRecord &&)>;
 
-  std::pair<std::vector<nlohmann::json>,bool> GetVertexInfo(storage::Gid gid,uint64_t c_ts,uint64_t c_te,std::string type);
-  std::pair<std::vector<nlohmann::json>,bool> GetEdgeInfo(uint64_t c_ts,uint64_t c_te,std::string type,uint64_t gid);
-  std::vector<nlohmann::json> GetDeleteEdgeInfo(uint64_t c_ts,uint64_t c_te,std::string type,uint64_t gid);
+  /// Reconstructs the versions of the vertex visible in [c_ts, c_te] and
+  /// hands them to `on_version` while the delta records are read, without
+  /// collecting them first. Returns true if the replay started at an anchor.
+  bool ForEachVertexVersion(storage::Gid gid,uint64_t c_ts,uint64_t c_te,const std::string &type,
+                            const VersionVisitor &on_version);
+  /// Same as `ForEachVertexVersion` for an edge.
+  bool ForEachEdgeVersion(uint64_t gid,uint64_t c_ts,uint64_t c_te,const std::string &type,
+                          const VersionVisitor &on_version);
+
+  std::pair<std::vector<HistoryRecord>,bool> GetVertexInfo(storage::Gid gid,uint64_t c_ts,uint64_t c_te,std::string type);
+  /// Same as `GetVertexInfo` for a batch of vertices, the result holds the
+  /// versions of `gids[i]` at index i. The vertices are looked up in gid order
+  /// and share one iterator over the anchors and one over the deltas, which
+  /// are seeked forward instead of opened for every vertex. With more than
+  /// one scan thread the batch is split into contiguous gid ranges which are
+  /// looked up in parallel, each with its own iterators. The scan of the
+  /// current store and the operators above it stay on the query thread.
+  std::vector<std::vector<HistoryRecord>> GetVerticesInfo(const std::vector<storage::Gid> &gids,uint64_t c_ts,
+                                                          uint64_t c_te,const std::string &type);
+  /// Number of vertices temporal scans pass to `GetVerticesInfo` at once.
+  uint64_t ScanBatchSize() const { return scan_batch_size_; }
+  std::pair<std::vector<HistoryRecord>,bool> GetEdgeInfo(uint64_t c_ts,uint64_t c_te,std::string type,uint64_t gid);
+  /// Returns the edges removed from the vertex in the given direction at c_ts
+  /// or later, restricted to `edge_types` unless it is empty. Only the keys of
+  /// the requested direction and types are read. The versions of the returned
+  /// edges still have to be checked against the window.
+  std::vector<std::pair<uint64_t,HistoryEdgeEntry>> GetRemovedEdges(uint64_t gid,bool out,
+                                                                   const std::vector<storage::EdgeTypeId> &edge_types,
+                                                                   uint64_t c_ts,uint64_t c_te);
   void GetTimeTableAll();
+
+  /// Returns the gids of all vertices with a record in the history store whose
+  /// version may overlap [c_ts, c_te], including the vertices that don't exist
+  /// in the storage anymore. The time index is coarse, the versions of the
+  /// returned vertices still have to be checked.
+  std::set<uint64_t> GetVerticesInWindow(uint64_t c_ts,uint64_t c_te);
+
+  /// Returns up to `limit` gids of vertices from `from_gid` on, in ascending
+  /// order, whose records may overlap [c_ts, c_te]. Only the time table is
+  /// read, callers walk all vertices with history in batches with it.
+  std::vector<uint64_t> GetVerticesWithHistory(uint64_t c_ts,uint64_t c_te,uint64_t from_gid,size_t limit) const;
+
+  /// Returns the newest delta record of the vertex. For a deleted vertex it is
+  /// the record written on deletion, which keeps all its labels and
+  /// properties.
+  std::optional<HistoryRecord> GetLatestVertexRecord(storage::Gid gid);
+
+  /// Sets the labels and label+property pairs which are indexed in the
+  /// storage. The versions of their vertices are posted in temporal indexes
+  /// from now on, the indexes of dropped entries are abandoned. A new index
+  /// answers windows starting at `now` or later.
+  void SetTemporalIndices(const std::vector<storage::LabelId> &labels,
+                          const std::vector<std::pair<storage::LabelId,storage::PropertyId>> &label_properties,
+                          uint64_t now);
+  /// Whether the GC has to pass the vertex versions to `SaveVertexVersion`,
+  /// which is the case once there is a temporal index or a rollup.
+  bool HasTemporalIndices() const;
+
+  /// Posts the version [start, commit) of a vertex in the temporal indexes of
+  /// its labels and properties, and in the valid time index, and adds it to
+  /// the rollups of its labels.
+  void SaveVertexVersion(storage::Gid gid,uint64_t start,uint64_t commit,const std::vector<storage::LabelId> &labels,
+                         const std::map<storage::PropertyId,storage::PropertyValue> &properties);
+
+  /// Returns the gids of the vertices which had the label in a version stored
+  /// in the history store that may overlap [c_ts, c_te]. Returns `std::nullopt`
+  /// when the window starts before the label's temporal index does.
+  std::optional<std::set<uint64_t>> GetVerticesWithLabel(storage::LabelId label,uint64_t c_ts,uint64_t c_te);
+  /// Same as `GetVerticesWithLabel`, for the vertices which had the label and
+  /// the property value. Values are posted by their hash, so the versions of
+  /// the returned vertices still have to be checked.
+  std::optional<std::set<uint64_t>> GetVerticesWithLabelProperty(storage::LabelId label,storage::PropertyId property,
+                                                                 const storage::PropertyValue &value,uint64_t c_ts,
+                                                                 uint64_t c_te);
+
+  /// Starts posting the valid time of the vertex versions in the valid time
+  /// index, which answers windows starting at `now` or later. Called once
+  /// valid times are used, the index is kept from then on.
+  void EnableValidTimeIndex(uint64_t now);
+  /// Returns the gids of the vertices with a version stored in the history
+  /// store whose valid time may overlap [vt_ts, vt_te] and whose transaction
+  /// time may overlap [c_ts, c_te]. Both indexes are coarse and a vertex may
+  /// match them with different versions, the versions of the returned
+  /// vertices still have to be checked. Returns `std::nullopt` when the
+  /// transaction time window starts before the valid time index does.
+  std::optional<std::set<uint64_t>> GetVerticesInValidTime(uint64_t vt_ts,uint64_t vt_te,uint64_t c_ts,uint64_t c_te);
+
+  /// Creates a rollup, which is maintained by `SaveVertexVersion` from then on.
+  /// Like a temporal index it isn't built from the stored history, it answers
+  /// windows starting at `rollup.since` or later. Returns false if a rollup
+  /// with the same name exists.
+  bool CreateRollup(const TemporalRollup &rollup);
+  /// Drops the rollup and its buckets, returns false if it doesn't exist.
+  bool DropRollup(const std::string &name);
+  std::vector<TemporalRollup> ListRollups() const;
+  /// Returns the buckets of the rollup overlapping [c_ts, c_te] which hold at
+  /// least one value, in the order of their start, including the versions
+  /// which aren't written yet. Returns `std::nullopt` if there's no such
+  /// rollup.
+  std::optional<std::vector<RollupBucket>> GetRollupBuckets(const std::string &name,uint64_t c_ts,uint64_t c_te) const;
+
+  /// Hands the records collected by `SaveDelta` and the anchor functions
+  /// since the last call over to the migration thread, which encodes them in
+  /// parallel and writes them in a single batch. Batches are written in the
+  /// order they were handed over. Blocks while the queue is full, unless
+  /// migration stopped.
   void SaveDeltaAll();
-  void SaveAnchorAll(std::map<std::string, std::string> &value);
+
+  /// Blocks until all records handed over before the call are written.
+  /// Every read of the history store waits on this, so records of unlinked
+  /// deltas are visible as soon as the deltas leave the version chains.
+  /// @throw utils::BasicException if some of them couldn't be written.
+  void WaitForMigration();
+
+  /// Whether a batch couldn't be written after all of its retries. No batch
+  /// is written from then on, they stay in memory, and the GC has to keep
+  /// the deltas in the version chains instead of migrating them.
+  bool MigrationFailed() const;
+
+  MigrationInfo GetMigrationInfo() const;
+
+  /// Returns a snapshot of the statistics of the history store, including
+  /// the records which aren't written yet.
+  HistoryStatistics GetHistoryStatistics() const;
+
+  /// Counts a version of a vertex with the given labels, called by the GC
+  /// once per vertex and transaction next to `SaveDelta`.
+  void CountVertexVersion(const std::vector<storage::LabelId> &labels);
+
+  /// Read counters of the history store, zero unless
+  /// `storage::Config::History::statistics` is set.
+  kvstore::KVStore::Statistics GetStoreStatistics() const { return storage_.GetStatistics(); }
 
   void SaveDelta(storage::Gid gid,const std::optional<storage::Gid> to_gid,const uint64_t start,const uint64_t commit,storage::Delta& delta,storage::NameIdMapper &name_id_mapper);
-  void SaveVertexAnchor(storage::Gid gid,const uint64_t start,std::vector<storage::LabelId> &labels,std::map<storage::PropertyId, storage::PropertyValue> &maybe_properties,storage::NameIdMapper &name_id_mapper);
-  void SaveEdgeAnchor(storage::Gid gid,const uint64_t start,std::map<storage::PropertyId, storage::PropertyValue> &maybe_properties,storage::NameIdMapper &name_id_mapper);
-  void SaveVertexAnchor(storage::Gid gid,const uint64_t start,nlohmann::json data);
-  void SaveEdgeAnchor(storage::Gid gid,const uint64_t start,nlohmann::json data);
-  void SaveEdgeAnchorAll(uint64_t tid,std::map<std::string, std::string>& data);
+  void SaveVertexAnchor(storage::Gid gid,const uint64_t start,const std::vector<storage::LabelId> &labels,const std::map<storage::PropertyId, storage::PropertyValue> &maybe_properties);
+  void SaveEdgeAnchor(storage::Gid gid,const uint64_t start,const std::map<storage::PropertyId, storage::PropertyValue> &maybe_properties);
 
   bool HasDeltas() const;
 
   std::string getPrefix(storage::Gid gid,const uint64_t start,bool vertex);
 
+  /// Moves the records of versions which ended at `until` or earlier, and
+  /// after the records already moved, into a new segment file of the cold
+  /// tier. Only objects whose history starts at `until` or earlier are read.
+  /// Returns false if there is no cold tier or nothing to move.
+  bool MoveColdHistory(uint64_t until);
+
+  /// Expires the versions which ended more than `retention_period` ago.
+  /// Lookups skip them from then on and their records are dropped by the
+  /// compactions of the history store. The expired ranges of the time index
+  /// and the rollup buckets, the time tables and the deletion statistics are
+  /// deleted together with the persisted cutoff. Cold tier segments are
+  /// dropped once all their records expired.
   bool RemoveOldHistory(const std::chrono::milliseconds &retention_period);
 
+  /// Rewrites all records stored in the legacy JSON format into the binary
+  /// format. The conversion runs only once per store, a marker key is written
+  /// when it finishes.
+  void MigrateLegacyRecords();
+
+  /// Rewrites all record keys stored in the text layout `<kind>:<gid>:...`
+  /// into the binary layout. Like `MigrateLegacyRecords`, the conversion runs
+  /// only once per store.
+  void ConvertLegacyKeys();
+
+  /// Rewrites the records of removed edges, which hold all edges removed by a
+  /// version of a vertex, into one key per edge keyed by direction and edge
+  /// type. Like `MigrateLegacyRecords`, the conversion runs only once per
+  /// store.
+  void SplitVertexEdgeRecords();
+
  private:
+  std::optional<HistoryRecord> Decode(std::string_view data) const;
+  std::string Encode(const HistoryRecord &record);
+
+  // Replays the delta records of one object between `it` and `end` onto
+  // `replay`, which holds the anchor the replay starts from, if any. The
+  // replay continues with the records from `key` on in the cold tier, if the
+  // window reaches it.
+  void ReplayVersions(kvstore::KVStore::iterator &it,const kvstore::KVStore::iterator &end,const std::string &key,
+                      uint64_t gid,uint64_t c_ts,uint64_t c_te,const std::string &type,VersionReplay replay,
+                      const VersionVisitor &on_version) const;
+
+  // The cold tier keeps the records of old versions in immutable segment
+  // files, one per move. A segment holds the records which ended after `from`
+  // and at `until` or earlier, its footer keeps both bounds and the span of
+  // its records.
+  struct ColdSegment {
+    ColdSegment(uint64_t from,uint64_t until,const std::filesystem::path &path,const kvstore::SegmentOptions &options)
+        : from(from),until(until),segment(path,options) {}
+
+    uint64_t from;
+    uint64_t until;
+    // End of the newest record, the retention drops the segment once it
+    // expired.
+    uint64_t max_end{until};
+    kvstore::Segment segment;
+  };
+  void LoadColdTier();
+  // Segments which may hold records that ended at c_ts or later, newest
+  // first. Windows starting after the cold tier get no segment, so their
+  // lookups never read it.
+  std::vector<std::shared_ptr<const ColdSegment>> ColdSegments(uint64_t c_ts) const;
+  // The anchor at or after `key` in its group, if the cold tier has one.
+  std::optional<std::pair<std::string,std::string>> ColdAnchor(const std::string &key,uint64_t c_te) const;
+
+  // Replays the records of a vertex, seeking `anchors` and `deltas` to them.
+  // Empty iterators are opened, batched lookups pass the iterators of the
+  // previous vertex.
+  bool ReplayVertex(std::optional<kvstore::KVStore::iterator> &anchors,
+                    std::optional<kvstore::KVStore::iterator> &deltas,uint64_t gid,uint64_t c_ts,uint64_t c_te,
+                    const std::string &type,const VersionVisitor &on_version);
+
+  // Records collected during one GC cycle, partitioned by object gid.
+  struct MigrationBatch {
+    uint64_t sequence;
+    std::vector<std::map<std::string, HistoryRecord>> partitions;
+    std::map<std::string, std::string> time_entries;
+  };
+
+  // The time tables keep the span [min start, max commit] of all records of
+  // an object. The vertex table covers both its delta and its edge records.
+  // Lookups of objects whose span doesn't intersect the queried window are
+  // skipped without touching the history store.
+  void UpdateTimeTable(const std::string &prefix,uint64_t gid,uint64_t start,uint64_t commit);
+  bool MayHaveHistory(const std::string &prefix,uint64_t gid,uint64_t c_ts,uint64_t c_te) const;
+
+  // The time index posts the gid of a vertex under every node of the segment
+  // tree over time which is needed to cover the span of one of its versions.
+  void UpdateTimeIndex(uint64_t gid,uint64_t start,uint64_t commit);
+  // Posts the versions of stores written before the time index existed.
+  void BuildTimeIndex();
+  // Keeps the highest level of the segment tree holding a transaction time
+  // posting, written with the postings in `entries`.
+  void LoadTimeIndexLevel();
+  void RaiseTimeIndexLevel(uint64_t last,std::map<std::string,std::string> &entries);
+  // Collects the ranges of the transaction time index postings whose nodes
+  // ended before `retained_from`.
+  void CollectExpiredTimeIndex(uint64_t retained_from,std::vector<std::pair<std::string,std::string>> &ranges);
+  // Returns the gids posted under `scope` whose nodes overlap [c_ts, c_te].
+  std::set<uint64_t> ScanTimeIndex(const std::string &scope,uint64_t c_ts,uint64_t c_te);
+
+  // The temporal indexes of labels and label+property values use the same
+  // segment tree as the time index, each under its own scope.
+  void LoadTemporalIndices();
+  std::string LabelScope(storage::LabelId label);
+  std::string LabelPropertyScope(storage::LabelId label,storage::PropertyId property);
+
+  // The buckets of a rollup are the leaves of a segment tree kept in the
+  // history store, a version updates the nodes covering its buckets and a
+  // bucket is read as the sum of the nodes above it. The nodes updated by
+  // batches which aren't written yet stay in memory, with the number of those
+  // batches, and a bounded number of written ones is cached. Both are keyed
+  // by level and start.
+  struct RollupState {
+    TemporalRollup rollup;
+    std::map<std::pair<uint64_t,uint64_t>,std::pair<RollupBucket,uint64_t>> unwritten;
+    std::map<std::pair<uint64_t,uint64_t>,RollupBucket> cached;
+  };
+  void LoadRollups();
+  void UpdateRollups(uint64_t start,uint64_t commit,const std::vector<storage::LabelId> &labels,
+                     const std::map<storage::PropertyId,storage::PropertyValue> &properties);
+  // Moves the nodes written with `time_entries` to the cache.
+  void RollupBucketsWritten(const std::map<std::string,std::string> &time_entries);
+
+  // Stores written before the statistics existed are counted once when
+  // opened, the labels of their versions and their deleted edges are unknown.
+  void LoadHistoryStatistics();
+  void CountDelta(const std::string &prefix,bool new_version,bool deleted,uint64_t commit);
+
+  std::map<std::string, HistoryRecord> &PendingRecords(storage::Gid gid);
+  // Returns true once the batch is written, failed writes are retried. Only
+  // then may the batch be finished. Returns false if the retries run out,
+  // the batch is left as it was handed over and migration stops.
+  bool WriteMigrationBatch(MigrationBatch &batch);
+  void MigrationLoop();
+  void FinishBatch(uint64_t sequence);
+
+  // Label, property and edge type IDs are persisted in the history store's own
+  // ID space so that the records stay valid even when the `NameIdMapper`
+  // assigns different IDs after a restart. The two spaces are identical unless
+  // a collision happened, in which case the IDs are translated.
+  void LoadNameIds();
+  uint64_t ToDiskId(uint64_t storage_id);
+  // Disk ID of a name, std::nullopt if no record uses it yet.
+  std::optional<uint64_t> FindDiskId(uint64_t storage_id) const;
+  uint64_t ToStorageId(uint64_t disk_id) const;
+
   bool realTimeFlagConstant=false;
+  storage::NameIdMapper *name_id_mapper_;
+  mutable utils::RWLock name_ids_lock_{utils::RWLock::Priority::WRITE};
+  bool identity_name_ids_{true};
+  std::unordered_map<uint64_t,uint64_t> storage_to_disk_id_;
+  std::unordered_map<uint64_t,uint64_t> disk_to_storage_id_;
+  std::map<std::string, std::string> pending_name_ids_;
   //hash index 用来存储object的min_ts max_te
+  mutable utils::RWLock time_table_lock_{utils::RWLock::Priority::WRITE};
   std::map<uint64_t,std::pair<uint64_t,uint64_t>> vertex_time_table_;//存储顶点的id，历史开始时间，历史结束时间
   std::map<uint64_t,std::pair<uint64_t,uint64_t>> edge_time_table_;//存储边的id，历史开始时间，历史结束时间
   //hash index 只存储当前事务
   std::map<uint64_t,std::pair<uint64_t,uint64_t>> vertex_time_tmp_;//存储顶点的id，历史开始时间，历史结束时间
   std::map<uint64_t,std::pair<uint64_t,uint64_t>> edge_time_tmp_;//存储边的id，历史开始时间，历史结束时间
-  //gid,delta-num: <json>
-  std::map<uint64_t,std::pair<int,nlohmann::json>> vertex_anchor_;
-  std::list<std::map<std::string, std::string>> edge_anchor_;
+
+  // Temporal indexes, the value is the timestamp from which on all versions
+  // of the indexed vertices are posted.
+  mutable utils::RWLock temporal_indices_lock_{utils::RWLock::Priority::WRITE};
+  std::map<storage::LabelId,uint64_t> label_indices_since_;
+  std::map<std::pair<storage::LabelId,storage::PropertyId>,uint64_t> label_property_indices_since_;
+  std::optional<uint64_t> valid_time_since_;
+  // Levels of the segment tree above it hold no posting and aren't scanned.
+  std::atomic<uint64_t> time_index_level_{0};
+  // Properties which keep the valid time, see `storage/v2/valid_time.hpp`.
+  storage::PropertyId valid_from_property_;
+  storage::PropertyId valid_to_property_;
+
+  mutable std::mutex rollups_lock_;
+  std::map<std::string,RollupState> rollups_;
+  // Whether `rollups_` isn't empty, read by every `HasTemporalIndices`.
+  std::atomic<bool> has_rollups_{false};
+
+  mutable std::mutex statistics_lock_;
+  HistoryStatistics statistics_;
+
+  std::filesystem::path cold_directory_;
+  kvstore::SegmentOptions cold_options_;
+  mutable utils::RWLock cold_lock_{utils::RWLock::Priority::WRITE};
+  std::vector<std::shared_ptr<const ColdSegment>> cold_segments_;
+  // All records which ended at this time or earlier are in the cold tier.
+  std::atomic<uint64_t> cold_until_{0};
+  std::mutex cold_move_lock_;
+
+  // Lookups start at `RetainedFrom`, `ClipToRetention` raises c_ts to it and
+  // returns false if the whole window expired.
+  uint64_t RetainedFrom() const;
+  bool ClipToRetention(uint64_t &c_ts,uint64_t c_te) const;
+  // End of the newest versions the retention expired, read by the compaction
+  // filter of `storage_`, which it has to outlive. Persisted under "RC:".
+  std::atomic<int64_t> retention_cutoff_{std::numeric_limits<int64_t>::min()};
 
   kvstore::KVStore storage_;
-  // std::map<uint64_t,uint64_t> before_gid_commit_;
-  std::map<std::tuple<std::string,uint64_t,uint64_t>, nlohmann::json> gid_delta_delta_;//prefix,gid,commit_te
-  std::map<std::string, nlohmann::json> gid_delta_;//save the same actions of one transaction
+  // Records of the GC cycle in progress, one map per partition. Actions of
+  // the same transaction on the same key are merged.
+  std::vector<std::map<std::string, HistoryRecord>> pending_records_;
+  std::optional<uint64_t> pending_sequence_;
+  std::map<std::string, std::string> pending_time_entries_;
+
+  // Encodes the partitions of a batch in parallel, empty when the records are
+  // encoded by the migration thread itself.
+  std::optional<utils::ThreadPool> encoding_pool_;
+  uint64_t migration_queue_size_;
+  uint64_t scan_batch_size_;
+  uint64_t scan_threads_;
+  // Looks up the gid ranges of a batch, empty with a single scan thread.
+  std::optional<utils::ThreadPool> scan_pool_;
+  std::mutex migration_lock_;
+  std::condition_variable migration_cv_;
+  std::deque<MigrationBatch> migration_queue_;
+  bool migration_shutdown_{false};
+
+  // Batches that aren't written yet, keyed by their sequence number. A batch
+  // is registered as soon as the GC collects its first record.
+  mutable std::mutex in_flight_lock_;
+  std::condition_variable in_flight_cv_;
+  std::map<uint64_t, std::chrono::steady_clock::time_point> in_flight_;
+  std::atomic<uint64_t> in_flight_count_{0};
+  // Set, with the error, once a batch couldn't be written.
+  std::atomic<bool> migration_failed_{false};
+  std::string migration_error_;
+  uint64_t next_sequence_{0};
+
+  std::optional<std::thread> migration_thread_;
 };
 }  // namespace auth
@@ -12,6 +12,8 @@
 #pragma once
 
 #include <limits>
+#include <map>
+#include <memory>
 
 #include "storage/v2/delta.hpp"
 #include "storage/v2/id_types.hpp"
@@ -24,7 +26,11 @@ namespace storage {
 
 // struct HistoryVertex;
 
+/// A version of an edge read from the history. Like `HistoryVertex`, the
+/// properties are an immutable snapshot shared by all copies.
 struct HistoryEdge {
+  using PropertyMap = std::map<PropertyId, PropertyValue>;
+
   HistoryEdge(){
   
   }
@@ -55,13 +61,22 @@ struct HistoryEdge {
     tt_ts=0;
     tt_te=(uint64_t)std::numeric_limits<int64_t>::max();
   }
+
+  const PropertyMap &Properties() const {
+    static const PropertyMap kNoProperties;
+    return properties ? *properties : kNoProperties;
+  }
+  void SetProperties(PropertyMap new_properties) {
+    properties = std::make_shared<const PropertyMap>(std::move(new_properties));
+  }
+
   Gid gid;
   uint64_t tt_ts;
   uint64_t tt_te;
   Gid from_gid;
   Gid to_gid;
   storage::EdgeTypeId type;
-  std::map<PropertyId, PropertyValue> properties;
+  std::shared_ptr<const PropertyMap> properties;
 
   Delta *delta;
   // std::map<std::string, nlohmann::json> properties;
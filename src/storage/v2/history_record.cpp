@@ -0,0 +1,290 @@
+// Copyright 2021 Memgraph Ltd.
+//
+// Use of this software is governed by the Business Source License
+// included in the file licenses/BSL.txt; by using this file, you agree to be bound by the terms of the Business Source
+// License, and you may not use this file except in compliance with the Business Source License.
+//
+// As of the Change Date specified in that file, in accordance with
+// the Business Source License, use of this software will be governed
+// by the Apache License, Version 2.0, included in the file
+// licenses/APL.txt.
+
+#include "storage/v2/history_record.hpp"
+
+#include <algorithm>
+
+#include <json/json.hpp>
+
+#include "storage/v2/name_id_mapper.hpp"
+#include "storage/v2/property_store.hpp"
+
+namespace storage {
+// Defined in storage.cpp, uses the same format as the legacy history records.
+PropertyValue DeserializePropertyValue(const nlohmann::json &data);
+}  // namespace storage
+
+namespace history_delta {
+
+namespace {
+
+// Binary record layout (all integers are LEB128 varints unless noted):
+//   * version (1 byte)
+//   * flags (1 byte), see the constants below
+//   * tt_ts, tt_te
+//   * if kHasProperties: property count, properties encoded like in the
+//     `PropertyStore`
+//   * if kHasLabels: label count, (action (1 byte), label id)*
+//   * if kHasEndpoints: from gid, to gid
+//   * if kHasEdges: edge count, (edge gid, direction (1 byte), edge type id,
+//     from gid, to gid)*
+const uint8_t kRecreate = 0x01;
+const uint8_t kHasProperties = 0x02;
+const uint8_t kHasLabels = 0x04;
+const uint8_t kHasEndpoints = 0x08;
+const uint8_t kHasEdges = 0x10;
+
+void WriteVarint(std::string *out, uint64_t value) {
+  while (value >= 0x80) {
+    out->push_back(static_cast<char>((value & 0x7f) | 0x80));
+    value >>= 7;
+  }
+  out->push_back(static_cast<char>(value));
+}
+
+class RecordReader {
+ public:
+  explicit RecordReader(std::string_view data) : data_(data) {}
+
+  std::optional<uint64_t> ReadVarint() {
+    uint64_t value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+      if (pos_ >= data_.size()) return std::nullopt;
+      auto byte = static_cast<uint8_t>(data_[pos_++]);
+      value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+      if (!(byte & 0x80)) return value;
+    }
+    return std::nullopt;
+  }
+
+  std::optional<uint8_t> ReadByte() {
+    if (pos_ >= data_.size()) return std::nullopt;
+    return static_cast<uint8_t>(data_[pos_++]);
+  }
+
+  bool ReadProperties(uint64_t count, std::map<storage::PropertyId, storage::PropertyValue> *properties) {
+    auto consumed = storage::DecodeProperties(reinterpret_cast<const uint8_t *>(data_.data() + pos_),
+                                              data_.size() - pos_, count, properties);
+    if (!consumed) return false;
+    pos_ += *consumed;
+    return true;
+  }
+
+ private:
+  std::string_view data_;
+  size_t pos_{0};
+};
+
+uint64_t Translate(const IdTranslator &translator, uint64_t id) { return translator ? translator(id) : id; }
+
+}  // namespace
+
+void MergeRecord(const HistoryRecord &newer, HistoryRecord *older) {
+  older->recreate = older->recreate || newer.recreate;
+  for (const auto &[property, value] : newer.properties) {
+    older->properties.emplace(property, value);
+  }
+  older->labels.insert(older->labels.end(), newer.labels.begin(), newer.labels.end());
+  if (!older->endpoints) older->endpoints = newer.endpoints;
+  for (const auto &[edge_gid, edge] : newer.edges) {
+    older->edges.emplace(edge_gid, edge);
+  }
+}
+
+VersionReplay::VersionReplay(HistoryRecord base) : state_(std::move(base)) {
+  std::vector<std::pair<LabelAction, storage::LabelId>> labels;
+  labels.swap(state_.labels);
+  for (auto it = labels.rbegin(); it != labels.rend(); ++it) {
+    if (seen_labels_.insert(it->second).second) state_.labels.push_back(*it);
+  }
+}
+
+void VersionReplay::Apply(HistoryRecord older) {
+  state_.tt_ts = older.tt_ts;
+  state_.tt_te = older.tt_te;
+  state_.recreate = state_.recreate || older.recreate;
+  for (auto &[property, value] : older.properties) {
+    state_.properties.insert_or_assign(property, std::move(value));
+  }
+  for (auto it = older.labels.rbegin(); it != older.labels.rend(); ++it) {
+    if (seen_labels_.insert(it->second).second) state_.labels.push_back(*it);
+  }
+  if (older.endpoints) state_.endpoints = older.endpoints;
+  for (auto &[edge_gid, edge] : older.edges) {
+    state_.edges.insert_or_assign(edge_gid, edge);
+  }
+}
+
+HistoryRecord VersionReplay::Take() {
+  auto record = std::move(state_);
+  std::reverse(record.labels.begin(), record.labels.end());
+  state_ = HistoryRecord();
+  seen_labels_.clear();
+  return record;
+}
+
+std::string EncodeRecord(const HistoryRecord &record, const IdTranslator &to_disk_id) {
+  uint8_t flags = 0;
+  if (record.recreate) flags |= kRecreate;
+  if (!record.properties.empty()) flags |= kHasProperties;
+  if (!record.labels.empty()) flags |= kHasLabels;
+  if (record.endpoints) flags |= kHasEndpoints;
+  if (!record.edges.empty()) flags |= kHasEdges;
+
+  std::string out;
+  out.push_back(static_cast<char>(kHistoryRecordVersion));
+  out.push_back(static_cast<char>(flags));
+  WriteVarint(&out, record.tt_ts);
+  WriteVarint(&out, record.tt_te);
+  if (flags & kHasProperties) {
+    WriteVarint(&out, record.properties.size());
+    if (to_disk_id) {
+      std::map<storage::PropertyId, storage::PropertyValue> translated;
+      for (const auto &[property, value] : record.properties) {
+        translated.emplace(storage::PropertyId::FromUint(to_disk_id(property.AsUint())), value);
+      }
+      storage::EncodeProperties(translated, &out);
+    } else {
+      storage::EncodeProperties(record.properties, &out);
+    }
+  }
+  if (flags & kHasLabels) {
+    WriteVarint(&out, record.labels.size());
+    for (const auto &[action, label] : record.labels) {
+      out.push_back(static_cast<char>(action));
+      WriteVarint(&out, Translate(to_disk_id, label.AsUint()));
+    }
+  }
+  if (flags & kHasEndpoints) {
+    WriteVarint(&out, record.endpoints->first.AsUint());
+    WriteVarint(&out, record.endpoints->second.AsUint());
+  }
+  if (flags & kHasEdges) {
+    WriteVarint(&out, record.edges.size());
+    for (const auto &[edge_gid, edge] : record.edges) {
+      WriteVarint(&out, edge_gid);
+      out.push_back(static_cast<char>(edge.out ? 1 : 0));
+      WriteVarint(&out, Translate(to_disk_id, edge.edge_type.AsUint()));
+      WriteVarint(&out, edge.from_gid.AsUint());
+      WriteVarint(&out, edge.to_gid.AsUint());
+    }
+  }
+  return out;
+}
+
+std::optional<HistoryRecord> DecodeRecord(std::string_view data, const IdTranslator &to_storage_id) {
+  RecordReader reader(data);
+  auto version = reader.ReadByte();
+  if (!version || *version != kHistoryRecordVersion) return std::nullopt;
+  auto flags = reader.ReadByte();
+  if (!flags) return std::nullopt;
+
+  HistoryRecord record;
+  record.recreate = *flags & kRecreate;
+  auto tt_ts = reader.ReadVarint();
+  auto tt_te = reader.ReadVarint();
+  if (!tt_ts || !tt_te) return std::nullopt;
+  record.tt_ts = *tt_ts;
+  record.tt_te = *tt_te;
+
+  if (*flags & kHasProperties) {
+    auto count = reader.ReadVarint();
+    if (!count || !reader.ReadProperties(*count, &record.properties)) return std::nullopt;
+    if (to_storage_id) {
+      std::map<storage::PropertyId, storage::PropertyValue> translated;
+      for (auto &[property, value] : record.properties) {
+        translated.emplace(storage::PropertyId::FromUint(to_storage_id(property.AsUint())), std::move(value));
+      }
+      record.properties = std::move(translated);
+    }
+  }
+  if (*flags & kHasLabels) {
+    auto count = reader.ReadVarint();
+    if (!count) return std::nullopt;
+    record.labels.reserve(*count);
+    for (uint64_t i = 0; i < *count; ++i) {
+      auto action = reader.ReadByte();
+      auto label = reader.ReadVarint();
+      if (!action || !label) return std::nullopt;
+      record.labels.emplace_back(static_cast<LabelAction>(*action),
+                                 storage::LabelId::FromUint(Translate(to_storage_id, *label)));
+    }
+  }
+  if (*flags & kHasEndpoints) {
+    auto from_gid = reader.ReadVarint();
+    auto to_gid = reader.ReadVarint();
+    if (!from_gid || !to_gid) return std::nullopt;
+    record.endpoints.emplace(storage::Gid::FromUint(*from_gid), storage::Gid::FromUint(*to_gid));
+  }
+  if (*flags & kHasEdges) {
+    auto count = reader.ReadVarint();
+    if (!count) return std::nullopt;
+    for (uint64_t i = 0; i < *count; ++i) {
+      auto edge_gid = reader.ReadVarint();
+      auto direction = reader.ReadByte();
+      auto edge_type = reader.ReadVarint();
+      auto from_gid = reader.ReadVarint();
+      auto to_gid = reader.ReadVarint();
+      if (!edge_gid || !direction || !edge_type || !from_gid || !to_gid) return std::nullopt;
+      record.edges.emplace(*edge_gid,
+                           HistoryEdgeEntry{*direction == 1,
+                                            storage::EdgeTypeId::FromUint(Translate(to_storage_id, *edge_type)),
+                                            storage::Gid::FromUint(*from_gid), storage::Gid::FromUint(*to_gid)});
+    }
+  }
+  return record;
+}
+
+bool IsLegacyRecord(std::string_view data) { return !data.empty() && data.front() == '{'; }
+
+std::optional<HistoryRecord> DecodeLegacyRecord(std::string_view data, storage::NameIdMapper *name_id_mapper) {
+  auto json = nlohmann::json::parse(data.begin(), data.end(), nullptr, false);
+  if (json.is_discarded() || !json.is_object()) return std::nullopt;
+
+  HistoryRecord record;
+  for (auto it = json.begin(); it != json.end(); ++it) {
+    const auto &key = it.key();
+    const auto &value = it.value();
+    if (key == "TT_TS") {
+      record.tt_ts = value.get<uint64_t>();
+    } else if (key == "TT_TE") {
+      record.tt_te = value.get<uint64_t>();
+    } else if (key == "R") {
+      record.recreate = true;
+    } else if (key == "SP") {
+      for (auto prop = value.begin(); prop != value.end(); ++prop) {
+        record.properties.emplace(storage::PropertyId::FromUint(name_id_mapper->NameToId(prop.key())),
+                                  storage::DeserializePropertyValue(prop.value()));
+      }
+    } else if (key == "L") {
+      for (const auto &label : value) {
+        auto action = label[0].get<std::string>() == "AL" ? LabelAction::ADD : LabelAction::REMOVE;
+        record.labels.emplace_back(action,
+                                   storage::LabelId::FromUint(name_id_mapper->NameToId(label[1].get<std::string>())));
+      }
+    } else if (key == "Fid" || key == "Tid") {
+      // Both are always written together.
+      record.endpoints.emplace(storage::Gid::FromUint(json["Fid"].get<uint64_t>()),
+                               storage::Gid::FromUint(json["Tid"].get<uint64_t>()));
+    } else if (value.is_object() && value.contains("edgeId")) {
+      record.edges.emplace(
+          value["edgeId"].get<uint64_t>(),
+          HistoryEdgeEntry{value["Type"].get<std::string>() == "AOE",
+                           storage::EdgeTypeId::FromUint(name_id_mapper->NameToId(value["edgeType"].get<std::string>())),
+                           storage::Gid::FromUint(value["fromGid"].get<uint64_t>()),
+                           storage::Gid::FromUint(value["toGid"].get<uint64_t>())});
+    }
+  }
+  return record;
+}
+
+}  // namespace history_delta
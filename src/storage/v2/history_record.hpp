@@ -0,0 +1,112 @@
+// Copyright 2021 Memgraph Ltd.
+//
+// Use of this software is governed by the Business Source License
+// included in the file licenses/BSL.txt; by using this file, you agree to be bound by the terms of the Business Source
+// License, and you may not use this file except in compliance with the Business Source License.
+//
+// As of the Change Date specified in that file, in accordance with
+// the Business Source License, use of this software will be governed
+// by the Apache License, Version 2.0, included in the file
+// licenses/APL.txt.
+
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "storage/v2/id_types.hpp"
+#include "storage/v2/property_value.hpp"
+
+namespace storage {
+class NameIdMapper;
+}  // namespace storage
+
+namespace history_delta {
+
+/// Version byte written in front of every binary history record. Records
+/// written by older versions are JSON objects and always start with '{'.
+inline constexpr uint8_t kHistoryRecordVersion = 0x01;
+
+enum class LabelAction : uint8_t { ADD = 0, REMOVE = 1 };
+
+/// A single adjacency change kept in a VE: record.
+struct HistoryEdgeEntry {
+  bool out{false};
+  storage::EdgeTypeId edge_type;
+  storage::Gid from_gid;
+  storage::Gid to_gid;
+};
+
+/// Decoded form of every record kind kept in the history store (VD:, VA:,
+/// ED:, EA: and VE:). Only the members that are relevant for the given kind
+/// are populated. All label, property and edge type IDs are storage IDs, the
+/// mapping to the IDs persisted on disk is done by `History_delta`.
+struct HistoryRecord {
+  uint64_t tt_ts{0};
+  uint64_t tt_te{0};
+  bool recreate{false};
+  std::map<storage::PropertyId, storage::PropertyValue> properties;
+  std::vector<std::pair<LabelAction, storage::LabelId>> labels;
+  std::optional<std::pair<storage::Gid, storage::Gid>> endpoints;
+  std::map<uint64_t, HistoryEdgeEntry> edges;
+};
+
+/// Function used to translate IDs between the storage and the on-disk ID
+/// space. An empty function means that the two spaces are identical.
+using IdTranslator = std::function<uint64_t(uint64_t)>;
+
+/// Merges the data of a newer record into an older one of the same object.
+/// Values already present in `older` take precedence because they are closer
+/// to the version being reconstructed.
+void MergeRecord(const HistoryRecord &newer, HistoryRecord *older);
+
+/// Reconstructs the versions of one object by replaying its records from the
+/// newest to the oldest onto a single mutable state. Replaying N records
+/// costs the size of the records, unlike merging every record into a copy of
+/// the previous result with `MergeRecord`, which copies the state N times.
+class VersionReplay {
+ public:
+  VersionReplay() = default;
+
+  /// Starts the replay from a complete version, e.g. an anchor.
+  explicit VersionReplay(HistoryRecord base);
+
+  /// Applies the next older record. The result is the same as
+  /// `MergeRecord(state, &older)` followed by taking `older` as the new state.
+  void Apply(HistoryRecord older);
+
+  /// Returns the reconstructed version and leaves the replay empty.
+  HistoryRecord Take();
+
+ private:
+  HistoryRecord state_;
+  // Labels of `state_` are kept newest first with one action per label, the
+  // action of the newest record wins like in `MergeRecord`.
+  std::unordered_set<storage::LabelId> seen_labels_;
+};
+
+/// @throw std::bad_alloc
+std::string EncodeRecord(const HistoryRecord &record, const IdTranslator &to_disk_id = {});
+
+/// Decodes a record encoded with `EncodeRecord`. Returns std::nullopt if the
+/// data is malformed or is a legacy JSON record.
+/// @throw std::bad_alloc
+std::optional<HistoryRecord> DecodeRecord(std::string_view data, const IdTranslator &to_storage_id = {});
+
+/// Returns true if `data` was written in the legacy JSON format.
+bool IsLegacyRecord(std::string_view data);
+
+/// Decodes a legacy JSON record, resolving label, property and edge type
+/// names through `name_id_mapper`. Returns std::nullopt if the data can't be
+/// parsed.
+/// @throw std::bad_alloc
+std::optional<HistoryRecord> DecodeLegacyRecord(std::string_view data, storage::NameIdMapper *name_id_mapper);
+
+}  // namespace history_delta
@@ -12,6 +12,9 @@
 #pragma once
 
 #include <limits>
+#include <map>
+#include <memory>
+#include <mutex>
 #include <tuple>
 #include <vector>
 
@@ -19,12 +22,21 @@
 #include "storage/v2/edge_ref.hpp"
 #include "storage/v2/id_types.hpp"
 #include "storage/v2/property_store.hpp"
+#include "storage/v2/vertex.hpp"
 #include "utils/spin_lock.hpp"
 #include <json/json.hpp>
 #include "storage/v2/history_edge.hpp"
 namespace storage {
 
+/// A version of a vertex read from the history. Versions are values which are
+/// copied into frames and results, so they are kept small: the properties are
+/// an immutable snapshot shared by all copies and by the following versions
+/// which don't change them, and the adjacency is taken from the live vertex
+/// only when the version is expanded.
 struct HistoryVertex {
+  using PropertyMap = std::map<PropertyId, PropertyValue>;
+  using Adjacency = std::vector<std::tuple<EdgeTypeId, Vertex *, EdgeRef>>;
+
   HistoryVertex()  {
    
   }
@@ -34,10 +46,7 @@ struct HistoryVertex {
     gid=another->gid;
     labels=another->labels;
     properties=another->properties;
-    in_edges=another->in_edges;
-    out_edges=another->out_edges;
-    in_history_edges=another->in_history_edges;
-    out_history_edges=another->out_history_edges;
+    vertex=another->vertex;
   }
 
   HistoryVertex(Gid gid) : gid(gid) {
@@ -48,22 +57,34 @@ struct HistoryVertex {
     tt_ts=0;
     tt_te=std::numeric_limits<uint64_t>::max();
   }
-  Gid gid;
-  std::vector<LabelId> labels;
-  // std::map<std::string, nlohmann::json> properties;
-  std::map<PropertyId, PropertyValue> properties;
 
-  std::vector<std::tuple<EdgeTypeId, Vertex *, EdgeRef>> in_edges;
-  std::vector<std::tuple<EdgeTypeId, Vertex *, EdgeRef>> out_edges;
+  const PropertyMap &Properties() const {
+    static const PropertyMap kNoProperties;
+    return properties ? *properties : kNoProperties;
+  }
+  void SetProperties(PropertyMap new_properties) {
+    properties = std::make_shared<const PropertyMap>(std::move(new_properties));
+  }
+
+  /// Adjacency of the live vertex at the time of the call. Empty for a vertex
+  /// which was removed from the storage.
+  Adjacency InEdges() const {
+    if (vertex == nullptr) return {};
+    std::lock_guard<utils::SpinLock> guard(vertex->lock);
+    return vertex->in_edges;
+  }
+  Adjacency OutEdges() const {
+    if (vertex == nullptr) return {};
+    std::lock_guard<utils::SpinLock> guard(vertex->lock);
+    return vertex->out_edges;
+  }
 
+  Gid gid;
+  std::vector<LabelId> labels;
+  std::shared_ptr<const PropertyMap> properties;
 
-  // std::vector<std::tuple<EdgeTypeId, Vertex *, uint64_t>> in_edges;// edgetypeid vertex_id edge_id
-  // std::vector<std::tuple<EdgeTypeId, Vertex *, uint64_t>> out_edges;// edgetypeid vertex_id edge_id
-  
-  std::list<storage::HistoryEdge> in_history_edges;
-  std::list<storage::HistoryEdge> out_history_edges;
-  // std::vector<std::tuple<EdgeTypeId, uint64_t, uint64_t>> current_in_edges;// edgetypeid vertex_id edge_id
-  // std::vector<std::tuple<EdgeTypeId, uint64_t, uint64_t>> current_out_edges;
+  // The live vertex, nullptr if the vertex was removed from the storage.
+  Vertex *vertex{nullptr};
 
   uint64_t tt_ts;//transaction start time
   uint64_t tt_te;//transaction end time
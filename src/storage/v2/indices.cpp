@@ -14,6 +14,7 @@
 
 #include "storage/v2/mvcc.hpp"
 #include "storage/v2/property_value.hpp"
+#include "storage/v2/valid_time.hpp"
 #include "utils/bound.hpp"
 #include "utils/logging.hpp"
 #include "utils/memory_tracker.hpp"
@@ -261,6 +262,102 @@ bool CurrentVersionHasLabelProperty(const Vertex &vertex, LabelId label, Propert
   return !deleted && has_label && current_value_equal_to_value;
 }
 
+/// Helper function for valid time index garbage collection. Returns true if
+/// there's a reachable version of the vertex that has the given property value.
+bool AnyVersionHasProperty(const Vertex &vertex, PropertyId key, const PropertyValue &value, uint64_t timestamp) {
+  bool current_value_equal_to_value;
+  bool deleted;
+  const Delta *delta;
+  {
+    std::lock_guard<utils::SpinLock> guard(vertex.lock);
+    current_value_equal_to_value = vertex.properties.IsPropertyEqual(key, value);
+    deleted = vertex.deleted;
+    delta = vertex.delta;
+  }
+
+  if (!deleted && current_value_equal_to_value) {
+    return true;
+  }
+
+  return AnyVersionSatisfiesPredicate(
+      timestamp, delta, [&current_value_equal_to_value, &deleted, key, &value](const Delta &delta) {
+        switch (delta.action) {
+          case Delta::Action::SET_PROPERTY:
+            if (delta.property.key == key) {
+              current_value_equal_to_value = delta.property.value == value;
+            }
+            break;
+          case Delta::Action::RECREATE_OBJECT: {
+            MG_ASSERT(deleted, "Invalid database state!");
+            deleted = false;
+            break;
+          }
+          case Delta::Action::DELETE_OBJECT: {
+            MG_ASSERT(!deleted, "Invalid database state!");
+            deleted = true;
+            break;
+          }
+          case Delta::Action::ADD_LABEL:
+          case Delta::Action::REMOVE_LABEL:
+          case Delta::Action::ADD_IN_EDGE:
+          case Delta::Action::ADD_OUT_EDGE:
+          case Delta::Action::REMOVE_IN_EDGE:
+          case Delta::Action::REMOVE_OUT_EDGE:
+            break;
+        }
+        return !deleted && current_value_equal_to_value;
+      });
+}
+
+// Helper function for iterating through the valid time index. Returns the
+// valid time of the version of the vertex this transaction can see, if it has
+// one.
+std::optional<ValidInterval> CurrentVersionValidInterval(const Vertex &vertex, PropertyId from_key, PropertyId to_key,
+                                                         Transaction *transaction, View view) {
+  bool deleted;
+  PropertyValue from;
+  PropertyValue to;
+  const Delta *delta;
+  {
+    std::lock_guard<utils::SpinLock> guard(vertex.lock);
+    deleted = vertex.deleted;
+    from = vertex.properties.GetProperty(from_key);
+    to = vertex.properties.GetProperty(to_key);
+    delta = vertex.delta;
+  }
+  ApplyDeltasForRead(transaction, delta, view, [&deleted, &from, &to, from_key, to_key](const Delta &delta) {
+    switch (delta.action) {
+      case Delta::Action::SET_PROPERTY: {
+        if (delta.property.key == from_key) {
+          from = delta.property.value;
+        } else if (delta.property.key == to_key) {
+          to = delta.property.value;
+        }
+        break;
+      }
+      case Delta::Action::DELETE_OBJECT: {
+        MG_ASSERT(!deleted, "Invalid database state!");
+        deleted = true;
+        break;
+      }
+      case Delta::Action::RECREATE_OBJECT: {
+        MG_ASSERT(deleted, "Invalid database state!");
+        deleted = false;
+        break;
+      }
+      case Delta::Action::ADD_LABEL:
+      case Delta::Action::REMOVE_LABEL:
+      case Delta::Action::ADD_IN_EDGE:
+      case Delta::Action::ADD_OUT_EDGE:
+      case Delta::Action::REMOVE_IN_EDGE:
+      case Delta::Action::REMOVE_OUT_EDGE:
+        break;
+    }
+  });
+  if (deleted) return std::nullopt;
+  return MakeValidInterval(from, to);
+}
+
 }  // namespace
 
 void LabelIndex::UpdateOnAddLabel(LabelId label, Vertex *vertex, const Transaction &tx) {
@@ -343,7 +440,8 @@ void LabelIndex::Iterable::Iterator::AdvanceUntilValid() {
     if (index_iterator_->vertex == current_vertex_) {
       continue;
     }
-    if (CurrentVersionHasLabel(*index_iterator_->vertex, self_->label_, self_->transaction_, self_->view_)) {
+    if (self_->any_version_ ||
+        CurrentVersionHasLabel(*index_iterator_->vertex, self_->label_, self_->transaction_, self_->view_)) {
       current_vertex_ = index_iterator_->vertex;
       current_vertex_accessor_ =
           VertexAccessor{current_vertex_, self_->transaction_, self_->indices_, self_->constraints_, self_->config_};
@@ -354,14 +452,15 @@ void LabelIndex::Iterable::Iterator::AdvanceUntilValid() {
 
 LabelIndex::Iterable::Iterable(utils::SkipList<Entry>::Accessor index_accessor, LabelId label, View view,
                                Transaction *transaction, Indices *indices, Constraints *constraints,
-                               Config::Items config)
+                               Config::Items config, bool any_version)
     : index_accessor_(std::move(index_accessor)),
       label_(label),
       view_(view),
       transaction_(transaction),
       indices_(indices),
       constraints_(constraints),
-      config_(config) {}
+      config_(config),
+      any_version_(any_version) {}
 
 void LabelIndex::RunGC() {
   for (auto &index_entry : index_) {
@@ -514,7 +613,8 @@ void LabelPropertyIndex::Iterable::Iterator::AdvanceUntilValid() {
       }
     }
 
-    if (CurrentVersionHasLabelProperty(*index_iterator_->vertex, self_->label_, self_->property_,
+    if (self_->any_version_ ||
+        CurrentVersionHasLabelProperty(*index_iterator_->vertex, self_->label_, self_->property_,
                                        index_iterator_->value, self_->transaction_, self_->view_)) {
       current_vertex_ = index_iterator_->vertex;
       current_vertex_accessor_ =
@@ -541,7 +641,7 @@ LabelPropertyIndex::Iterable::Iterable(utils::SkipList<Entry>::Accessor index_ac
                                        const std::optional<utils::Bound<PropertyValue>> &lower_bound,
                                        const std::optional<utils::Bound<PropertyValue>> &upper_bound, View view,
                                        Transaction *transaction, Indices *indices, Constraints *constraints,
-                                       Config::Items config)
+                                       Config::Items config, bool any_version)
     : index_accessor_(std::move(index_accessor)),
       label_(label),
       property_(property),
@@ -551,7 +651,8 @@ LabelPropertyIndex::Iterable::Iterable(utils::SkipList<Entry>::Accessor index_ac
       transaction_(transaction),
       indices_(indices),
       constraints_(constraints),
-      config_(config) {
+      config_(config),
+      any_version_(any_version) {
   // We have to fix the bounds that the user provided to us. If the user
   // provided only one bound we should make sure that only values of that type
   // are returned by the iterator. We ensure this by supplying either an
@@ -694,9 +795,111 @@ void LabelPropertyIndex::RunGC() {
   }
 }
 
+void ValidTimeIndex::UpdateOnSetProperty(PropertyId property, const PropertyValue &value, Vertex *vertex,
+                                         const Transaction &tx) {
+  if (property != from_property_) return;
+  auto from = ToValidTime(value);
+  if (!from) return;
+  auto acc = index_.access();
+  acc.insert(Entry{*from, vertex, tx.start_timestamp});
+}
+
+void ValidTimeIndex::Build(utils::SkipList<Vertex>::Accessor vertices) {
+  MG_ASSERT(from_property_, "The properties of the valid time aren't set");
+  utils::MemoryTracker::OutOfMemoryExceptionEnabler oom_exception;
+  auto acc = index_.access();
+  for (Vertex &vertex : vertices) {
+    if (vertex.deleted) continue;
+    auto from = ToValidTime(vertex.properties.GetProperty(*from_property_));
+    if (!from) continue;
+    acc.insert(Entry{*from, &vertex, 0});
+  }
+}
+
+void ValidTimeIndex::RemoveObsoleteEntries(uint64_t oldest_active_start_timestamp) {
+  if (!from_property_) return;
+  auto index_acc = index_.access();
+  for (auto it = index_acc.begin(); it != index_acc.end();) {
+    auto next_it = it;
+    ++next_it;
+
+    if (it->timestamp >= oldest_active_start_timestamp) {
+      it = next_it;
+      continue;
+    }
+
+    if ((next_it != index_acc.end() && it->vertex == next_it->vertex && it->from == next_it->from) ||
+        !AnyVersionHasProperty(*it->vertex, *from_property_, PropertyValue(static_cast<int64_t>(it->from)),
+                               oldest_active_start_timestamp)) {
+      index_acc.remove(*it);
+    }
+    it = next_it;
+  }
+}
+
+ValidTimeIndex::Iterable::Iterator::Iterator(Iterable *self, utils::SkipList<Entry>::Iterator index_iterator)
+    : self_(self),
+      index_iterator_(index_iterator),
+      current_vertex_accessor_(nullptr, nullptr, nullptr, nullptr, self_->config_) {
+  AdvanceUntilValid();
+}
+
+ValidTimeIndex::Iterable::Iterator &ValidTimeIndex::Iterable::Iterator::operator++() {
+  ++index_iterator_;
+  AdvanceUntilValid();
+  return *this;
+}
+
+void ValidTimeIndex::Iterable::Iterator::AdvanceUntilValid() {
+  for (; index_iterator_ != self_->index_accessor_.end(); ++index_iterator_) {
+    // The entries are ordered by the start of the interval, the remaining
+    // ones start after the window.
+    if (index_iterator_->from > self_->te_) {
+      index_iterator_ = self_->index_accessor_.end();
+      break;
+    }
+    auto *vertex = index_iterator_->vertex;
+    if (self_->produced_.count(vertex)) continue;
+    if (!self_->any_version_) {
+      auto interval = CurrentVersionValidInterval(*vertex, self_->from_property_, self_->to_property_,
+                                                  self_->transaction_, self_->view_);
+      // Only the entry of the visible start produces the vertex.
+      if (!interval || interval->from != index_iterator_->from || !interval->Overlaps(self_->ts_, self_->te_)) {
+        continue;
+      }
+    }
+    self_->produced_.insert(vertex);
+    current_vertex_accessor_ =
+        VertexAccessor(vertex, self_->transaction_, self_->indices_, self_->constraints_, self_->config_);
+    break;
+  }
+}
+
+ValidTimeIndex::Iterable::Iterable(utils::SkipList<Entry>::Accessor index_accessor, PropertyId from_property,
+                                   PropertyId to_property, uint64_t ts, uint64_t te, View view,
+                                   Transaction *transaction, Indices *indices, Constraints *constraints,
+                                   Config::Items config, bool any_version)
+    : index_accessor_(std::move(index_accessor)),
+      from_property_(from_property),
+      to_property_(to_property),
+      ts_(ts),
+      te_(te),
+      view_(view),
+      transaction_(transaction),
+      indices_(indices),
+      constraints_(constraints),
+      config_(config),
+      any_version_(any_version) {}
+
+ValidTimeIndex::Iterable::Iterator ValidTimeIndex::Iterable::begin() {
+  produced_.clear();
+  return Iterator(this, index_accessor_.begin());
+}
+
 void RemoveObsoleteEntries(Indices *indices, uint64_t oldest_active_start_timestamp) {
   indices->label_index.RemoveObsoleteEntries(oldest_active_start_timestamp);
   indices->label_property_index.RemoveObsoleteEntries(oldest_active_start_timestamp);
+  indices->valid_time_index.RemoveObsoleteEntries(oldest_active_start_timestamp);
 }
 
 void UpdateOnAddLabel(Indices *indices, LabelId label, Vertex *vertex, const Transaction &tx) {
@@ -707,6 +910,7 @@ void UpdateOnAddLabel(Indices *indices, LabelId label, Vertex *vertex, const Tra
 void UpdateOnSetProperty(Indices *indices, PropertyId property, const PropertyValue &value, Vertex *vertex,
                          const Transaction &tx) {
   indices->label_property_index.UpdateOnSetProperty(property, value, vertex, tx);
+  indices->valid_time_index.UpdateOnSetProperty(property, value, vertex, tx);
 }
 
 }  // namespace storage
@@ -13,6 +13,7 @@
 
 #include <optional>
 #include <tuple>
+#include <unordered_set>
 #include <utility>
 
 #include "storage/v2/config.hpp"
@@ -72,7 +73,7 @@ class LabelIndex {
   class Iterable {
    public:
     Iterable(utils::SkipList<Entry>::Accessor index_accessor, LabelId label, View view, Transaction *transaction,
-             Indices *indices, Constraints *constraints, Config::Items config);
+             Indices *indices, Constraints *constraints, Config::Items config, bool any_version = false);
 
     class Iterator {
      public:
@@ -105,13 +106,16 @@ class LabelIndex {
     Indices *indices_;
     Constraints *constraints_;
     Config::Items config_;
+    bool any_version_;
   };
 
-  /// Returns an self with vertices visible from the given transaction.
-  Iterable Vertices(LabelId label, View view, Transaction *transaction) {
+  /// Returns an self with vertices visible from the given transaction. With
+  /// `any_version` set it returns all vertices which have the label in a
+  /// version kept in memory, the label has to be checked on their versions.
+  Iterable Vertices(LabelId label, View view, Transaction *transaction, bool any_version = false) {
     auto it = index_.find(label);
     MG_ASSERT(it != index_.end(), "Index for label {} doesn't exist", label.AsUint());
-    return Iterable(it->second.access(), label, view, transaction, indices_, constraints_, config_);
+    return Iterable(it->second.access(), label, view, transaction, indices_, constraints_, config_, any_version);
   }
 
   int64_t ApproximateVertexCount(LabelId label) {
@@ -171,7 +175,7 @@ class LabelPropertyIndex {
     Iterable(utils::SkipList<Entry>::Accessor index_accessor, LabelId label, PropertyId property,
              const std::optional<utils::Bound<PropertyValue>> &lower_bound,
              const std::optional<utils::Bound<PropertyValue>> &upper_bound, View view, Transaction *transaction,
-             Indices *indices, Constraints *constraints, Config::Items config);
+             Indices *indices, Constraints *constraints, Config::Items config, bool any_version = false);
 
     class Iterator {
      public:
@@ -208,16 +212,19 @@ class LabelPropertyIndex {
     Indices *indices_;
     Constraints *constraints_;
     Config::Items config_;
+    bool any_version_;
   };
 
+  /// With `any_version` set all vertices which have the label and a value
+  /// within the bounds in a version kept in memory are returned.
   Iterable Vertices(LabelId label, PropertyId property, const std::optional<utils::Bound<PropertyValue>> &lower_bound,
                     const std::optional<utils::Bound<PropertyValue>> &upper_bound, View view,
-                    Transaction *transaction) {
+                    Transaction *transaction, bool any_version = false) {
     auto it = index_.find({label, property});
     MG_ASSERT(it != index_.end(), "Index for label {} and property {} doesn't exist", label.AsUint(),
               property.AsUint());
     return Iterable(it->second.access(), label, property, lower_bound, upper_bound, view, transaction, indices_,
-                    constraints_, config_);
+                    constraints_, config_, any_version);
   }
 
   int64_t ApproximateVertexCount(LabelId label, PropertyId property) const {
@@ -248,9 +255,119 @@ class LabelPropertyIndex {
   Config::Items config_;
 };
 
+/// Index over the valid time of the vertices, see `storage/v2/valid_time.hpp`.
+/// Like the label-property index it keeps an entry for every start of the
+/// interval a vertex had, ordered by the start, so a window is looked up by
+/// reading the entries which start at its end or earlier. The index always
+/// exists, it stays empty until valid times are used.
+class ValidTimeIndex {
+ private:
+  struct Entry {
+    uint64_t from;
+    Vertex *vertex;
+    uint64_t timestamp;
+
+    bool operator<(const Entry &rhs) {
+      return std::make_tuple(from, vertex, timestamp) < std::make_tuple(rhs.from, rhs.vertex, rhs.timestamp);
+    }
+    bool operator==(const Entry &rhs) { return from == rhs.from && vertex == rhs.vertex && timestamp == rhs.timestamp; }
+  };
+
+ public:
+  ValidTimeIndex(Indices *indices, Constraints *constraints, Config::Items config)
+      : indices_(indices), constraints_(constraints), config_(config) {}
+
+  /// Sets the IDs of the properties which keep the valid time, called by the
+  /// storage before any vertex is indexed.
+  void SetProperties(PropertyId from, PropertyId to) {
+    from_property_ = from;
+    to_property_ = to;
+  }
+
+  /// @throw std::bad_alloc
+  void UpdateOnSetProperty(PropertyId property, const PropertyValue &value, Vertex *vertex, const Transaction &tx);
+
+  /// Indexes the vertices recovered on startup.
+  /// @throw std::bad_alloc
+  void Build(utils::SkipList<Vertex>::Accessor vertices);
+
+  void RemoveObsoleteEntries(uint64_t oldest_active_start_timestamp);
+
+  class Iterable {
+   public:
+    Iterable(utils::SkipList<Entry>::Accessor index_accessor, PropertyId from_property, PropertyId to_property,
+             uint64_t ts, uint64_t te, View view, Transaction *transaction, Indices *indices,
+             Constraints *constraints, Config::Items config, bool any_version = false);
+
+    class Iterator {
+     public:
+      Iterator(Iterable *self, utils::SkipList<Entry>::Iterator index_iterator);
+
+      VertexAccessor operator*() const { return current_vertex_accessor_; }
+
+      bool operator==(const Iterator &other) const { return index_iterator_ == other.index_iterator_; }
+      bool operator!=(const Iterator &other) const { return index_iterator_ != other.index_iterator_; }
+
+      Iterator &operator++();
+
+     private:
+      void AdvanceUntilValid();
+
+      Iterable *self_;
+      utils::SkipList<Entry>::Iterator index_iterator_;
+      VertexAccessor current_vertex_accessor_;
+    };
+
+    Iterator begin();
+    Iterator end() { return Iterator(this, index_accessor_.end()); }
+
+   private:
+    utils::SkipList<Entry>::Accessor index_accessor_;
+    PropertyId from_property_;
+    PropertyId to_property_;
+    uint64_t ts_;
+    uint64_t te_;
+    View view_;
+    Transaction *transaction_;
+    Indices *indices_;
+    Constraints *constraints_;
+    Config::Items config_;
+    bool any_version_;
+    // The entries of a vertex aren't adjacent when its interval started at
+    // different times, every vertex is produced once.
+    std::unordered_set<const Vertex *> produced_;
+  };
+
+  /// Returns the vertices visible from the given transaction whose valid
+  /// time overlaps [ts, te]. With `any_version` set it returns all vertices
+  /// whose interval started at `te` or earlier in a version kept in memory,
+  /// the valid time has to be checked on their versions.
+  Iterable Vertices(uint64_t ts, uint64_t te, View view, Transaction *transaction, bool any_version = false) {
+    MG_ASSERT(from_property_ && to_property_, "The properties of the valid time aren't set");
+    return Iterable(index_.access(), *from_property_, *to_property_, ts, te, view, transaction, indices_,
+                    constraints_, config_, any_version);
+  }
+
+  int64_t ApproximateVertexCount() const { return index_.size(); }
+
+  void Clear() { index_.clear(); }
+
+  void RunGC() { index_.run_gc(); }
+
+ private:
+  std::optional<PropertyId> from_property_;
+  std::optional<PropertyId> to_property_;
+  utils::SkipList<Entry> index_;
+  Indices *indices_;
+  Constraints *constraints_;
+  Config::Items config_;
+};
+
 struct Indices {
   Indices(Constraints *constraints, Config::Items config)
-      : label_index(this, constraints, config), label_property_index(this, constraints, config) {}
+      : label_index(this, constraints, config),
+        label_property_index(this, constraints, config),
+        valid_time_index(this, constraints, config) {}
 
   // Disable copy and move because members hold pointer to `this`.
   Indices(const Indices &) = delete;
@@ -261,6 +378,7 @@ struct Indices {
 
   LabelIndex label_index;
   LabelPropertyIndex label_property_index;
+  ValidTimeIndex valid_time_index;
 };
 
 /// This function should be called from garbage collection to clean-up the
@@ -1021,6 +1021,15 @@ std::map<PropertyId, PropertyValue> PropertyStore::Properties() const {
   return props;
 }
 
+uint64_t PropertyStore::Size() const {
+  uint64_t size;
+  uint8_t *data;
+  std::tie(size, data) = GetSizeData(buffer_);
+  // The local buffer isn't sized, report all of it.
+  if (size % 8 != 0) return sizeof(buffer_) - 1;
+  return size;
+}
+
 bool PropertyStore::SetProperty(PropertyId property, const PropertyValue &value) {
   uint64_t property_size = 0;
   if (!value.IsNull()) {
@@ -1161,4 +1170,35 @@ bool PropertyStore::ClearProperties() {
   return true;
 }
 
+void EncodeProperties(const std::map<PropertyId, PropertyValue> &properties, std::string *out) {
+  Writer size_writer;
+  for (const auto &[property, value] : properties) {
+    EncodeProperty(&size_writer, property, value);
+  }
+  auto offset = out->size();
+  out->resize(offset + size_writer.Written());
+  Writer writer(reinterpret_cast<uint8_t *>(out->data() + offset), size_writer.Written());
+  for (const auto &[property, value] : properties) {
+    MG_ASSERT(EncodeProperty(&writer, property, value), "Couldn't encode properties!");
+  }
+}
+
+uint64_t EncodedPropertySize(PropertyId property, const PropertyValue &value) {
+  Writer size_writer;
+  EncodeProperty(&size_writer, property, value);
+  return size_writer.Written();
+}
+
+std::optional<uint64_t> DecodeProperties(const uint8_t *data, uint64_t size, uint64_t count,
+                                         std::map<PropertyId, PropertyValue> *properties) {
+  Reader reader(data, size);
+  for (uint64_t i = 0; i < count; ++i) {
+    PropertyValue value;
+    auto property = DecodeAnyProperty(&reader, &value);
+    if (!property) return std::nullopt;
+    properties->insert_or_assign(*property, std::move(value));
+  }
+  return reader.GetPosition();
+}
+
 }  // namespace storage
@@ -12,6 +12,8 @@
 #pragma once
 
 #include <map>
+#include <optional>
+#include <string>
 
 #include "storage/v2/id_types.hpp"
 #include "storage/v2/property_value.hpp"
@@ -51,6 +53,10 @@ class PropertyStore {
   /// @throw std::bad_alloc
   std::map<PropertyId, PropertyValue> Properties() const;
 
+  /// Returns the number of bytes used for the encoded properties. The time
+  /// complexity of this function is O(1).
+  uint64_t Size() const;
+
   /// Set a property value and return `true` if insertion took place. `false` is
   /// returned if assignment took place. The time complexity of this function is
   /// O(n).
@@ -72,4 +78,21 @@ class PropertyStore {
   uint8_t buffer_[sizeof(uint64_t) + sizeof(uint8_t *)];
 };
 
+/// Appends the given properties to `out` using the same compact encoding that
+/// the `PropertyStore` uses for its buffer. Unlike the `PropertyStore`, Null
+/// values are encoded explicitly so that callers can record property removals.
+/// No tombstone is written after the last property.
+/// @throw std::bad_alloc
+void EncodeProperties(const std::map<PropertyId, PropertyValue> &properties, std::string *out);
+
+/// Returns the number of bytes `EncodeProperties` uses for a single property.
+uint64_t EncodedPropertySize(PropertyId property, const PropertyValue &value);
+
+/// Decodes exactly `count` properties previously encoded with
+/// `EncodeProperties` from `data` and inserts them into `properties`. Returns
+/// the number of bytes consumed or std::nullopt if the data is malformed.
+/// @throw std::bad_alloc
+std::optional<uint64_t> DecodeProperties(const uint8_t *data, uint64_t size, uint64_t count,
+                                         std::map<PropertyId, PropertyValue> *properties);
+
 }  // namespace storage
@@ -34,6 +34,7 @@
 #include "storage/v2/mvcc.hpp"
 #include "storage/v2/replication/config.hpp"
 #include "storage/v2/transaction.hpp"
+#include "storage/v2/valid_time.hpp"
 #include "storage/v2/vertex_accessor.hpp"
 #include "utils/file.hpp"
 #include "utils/logging.hpp"
@@ -216,6 +217,10 @@ VerticesIterable::VerticesIterable(LabelPropertyIndex::Iterable vertices) : type
   new (&vertices_by_label_property_) LabelPropertyIndex::Iterable(std::move(vertices));
 }
 
+VerticesIterable::VerticesIterable(ValidTimeIndex::Iterable vertices) : type_(Type::BY_VALID_TIME) {
+  new (&vertices_by_valid_time_) ValidTimeIndex::Iterable(std::move(vertices));
+}
+
 VerticesIterable::VerticesIterable(VerticesIterable &&other) noexcept : type_(other.type_) {
   switch (other.type_) {
     case Type::ALL:
@@ -227,6 +232,9 @@ VerticesIterable::VerticesIterable(VerticesIterable &&other) noexcept : type_(ot
     case Type::BY_LABEL_PROPERTY:
       new (&vertices_by_label_property_) LabelPropertyIndex::Iterable(std::move(other.vertices_by_label_property_));
       break;
+    case Type::BY_VALID_TIME:
+      new (&vertices_by_valid_time_) ValidTimeIndex::Iterable(std::move(other.vertices_by_valid_time_));
+      break;
   }
 }
 
@@ -241,6 +249,9 @@ VerticesIterable &VerticesIterable::operator=(VerticesIterable &&other) noexcept
     case Type::BY_LABEL_PROPERTY:
       vertices_by_label_property_.LabelPropertyIndex::Iterable::~Iterable();
       break;
+    case Type::BY_VALID_TIME:
+      vertices_by_valid_time_.ValidTimeIndex::Iterable::~Iterable();
+      break;
   }
   type_ = other.type_;
   switch (other.type_) {
@@ -253,6 +264,9 @@ VerticesIterable &VerticesIterable::operator=(VerticesIterable &&other) noexcept
     case Type::BY_LABEL_PROPERTY:
       new (&vertices_by_label_property_) LabelPropertyIndex::Iterable(std::move(other.vertices_by_label_property_));
       break;
+    case Type::BY_VALID_TIME:
+      new (&vertices_by_valid_time_) ValidTimeIndex::Iterable(std::move(other.vertices_by_valid_time_));
+      break;
   }
   return *this;
 }
@@ -268,6 +282,9 @@ VerticesIterable::~VerticesIterable() {
     case Type::BY_LABEL_PROPERTY:
       vertices_by_label_property_.LabelPropertyIndex::Iterable::~Iterable();
       break;
+    case Type::BY_VALID_TIME:
+      vertices_by_valid_time_.ValidTimeIndex::Iterable::~Iterable();
+      break;
   }
 }
 
@@ -279,6 +296,8 @@ VerticesIterable::Iterator VerticesIterable::begin() {
       return Iterator(vertices_by_label_.begin());
     case Type::BY_LABEL_PROPERTY:
       return Iterator(vertices_by_label_property_.begin());
+    case Type::BY_VALID_TIME:
+      return Iterator(vertices_by_valid_time_.begin());
   }
 }
 
@@ -290,6 +309,8 @@ VerticesIterable::Iterator VerticesIterable::end() {
       return Iterator(vertices_by_label_.end());
     case Type::BY_LABEL_PROPERTY:
       return Iterator(vertices_by_label_property_.end());
+    case Type::BY_VALID_TIME:
+      return Iterator(vertices_by_valid_time_.end());
   }
 }
 
@@ -305,6 +326,10 @@ VerticesIterable::Iterator::Iterator(LabelPropertyIndex::Iterable::Iterator it)
   new (&by_label_property_it_) LabelPropertyIndex::Iterable::Iterator(std::move(it));
 }
 
+VerticesIterable::Iterator::Iterator(ValidTimeIndex::Iterable::Iterator it) : type_(Type::BY_VALID_TIME) {
+  new (&by_valid_time_it_) ValidTimeIndex::Iterable::Iterator(std::move(it));
+}
+
 VerticesIterable::Iterator::Iterator(const VerticesIterable::Iterator &other) : type_(other.type_) {
   switch (other.type_) {
     case Type::ALL:
@@ -316,6 +341,9 @@ VerticesIterable::Iterator::Iterator(const VerticesIterable::Iterator &other) :
     case Type::BY_LABEL_PROPERTY:
       new (&by_label_property_it_) LabelPropertyIndex::Iterable::Iterator(other.by_label_property_it_);
       break;
+    case Type::BY_VALID_TIME:
+      new (&by_valid_time_it_) ValidTimeIndex::Iterable::Iterator(other.by_valid_time_it_);
+      break;
   }
 }
 
@@ -332,6 +360,9 @@ VerticesIterable::Iterator &VerticesIterable::Iterator::operator=(const Vertices
     case Type::BY_LABEL_PROPERTY:
       new (&by_label_property_it_) LabelPropertyIndex::Iterable::Iterator(other.by_label_property_it_);
       break;
+    case Type::BY_VALID_TIME:
+      new (&by_valid_time_it_) ValidTimeIndex::Iterable::Iterator(other.by_valid_time_it_);
+      break;
   }
   return *this;
 }
@@ -347,6 +378,9 @@ VerticesIterable::Iterator::Iterator(VerticesIterable::Iterator &&other) noexcep
     case Type::BY_LABEL_PROPERTY:
       new (&by_label_property_it_) LabelPropertyIndex::Iterable::Iterator(std::move(other.by_label_property_it_));
       break;
+    case Type::BY_VALID_TIME:
+      new (&by_valid_time_it_) ValidTimeIndex::Iterable::Iterator(std::move(other.by_valid_time_it_));
+      break;
   }
 }
 
@@ -363,6 +397,9 @@ VerticesIterable::Iterator &VerticesIterable::Iterator::operator=(VerticesIterab
     case Type::BY_LABEL_PROPERTY:
       new (&by_label_property_it_) LabelPropertyIndex::Iterable::Iterator(std::move(other.by_label_property_it_));
       break;
+    case Type::BY_VALID_TIME:
+      new (&by_valid_time_it_) ValidTimeIndex::Iterable::Iterator(std::move(other.by_valid_time_it_));
+      break;
   }
   return *this;
 }
@@ -380,6 +417,9 @@ void VerticesIterable::Iterator::Destroy() noexcept {
     case Type::BY_LABEL_PROPERTY:
       by_label_property_it_.LabelPropertyIndex::Iterable::Iterator::~Iterator();
       break;
+    case Type::BY_VALID_TIME:
+      by_valid_time_it_.ValidTimeIndex::Iterable::Iterator::~Iterator();
+      break;
   }
 }
 
@@ -391,6 +431,8 @@ VertexAccessor VerticesIterable::Iterator::operator*() const {
       return *by_label_it_;
     case Type::BY_LABEL_PROPERTY:
       return *by_label_property_it_;
+    case Type::BY_VALID_TIME:
+      return *by_valid_time_it_;
   }
 }
 
@@ -405,6 +447,9 @@ VerticesIterable::Iterator &VerticesIterable::Iterator::operator++() {
     case Type::BY_LABEL_PROPERTY:
       ++by_label_property_it_;
       break;
+    case Type::BY_VALID_TIME:
+      ++by_valid_time_it_;
+      break;
   }
   return *this;
 }
@@ -417,11 +462,14 @@ bool VerticesIterable::Iterator::operator==(const Iterator &other) const {
       return by_label_it_ == other.by_label_it_;
     case Type::BY_LABEL_PROPERTY:
       return by_label_property_it_ == other.by_label_property_it_;
+    case Type::BY_VALID_TIME:
+      return by_valid_time_it_ == other.by_valid_time_it_;
   }
 }
 
 Storage::Storage(Config config)
-    : indices_(&constraints_, config.items),
+    : history_cache_(config.history.cache_bytes),
+      indices_(&constraints_, config.items),
       isolation_level_(config.transaction.isolation_level),
       config_(config),
       snapshot_directory_(config_.durability.storage_directory / durability::kSnapshotDirectory),
@@ -432,10 +480,11 @@ Storage::Storage(Config config)
       global_locker_(file_retainer_.AddLocker()) {
         //hjm begin
       // saved_history_deltas_.init(config_.durability.storage_directory/"history_deltas");
-         saved_history_deltas_.emplace(config_.durability.storage_directory/"history_deltas",config_.items.realTimeFlag);
+         saved_history_deltas_.emplace(config_.durability.storage_directory/"history_deltas",config_.items.realTimeFlag,&name_id_mapper_,config_.history);
         //recover kv's time_table index
         // saved_history_deltas_->GetTimeTableAll(); //hjm begin timetable
         //hjm end
+  indices_.valid_time_index.SetProperties(NameToProperty(kValidFromProperty), NameToProperty(kValidToProperty));
   if (config_.durability.snapshot_wal_mode != Config::Durability::SnapshotWalMode::DISABLED ||
       config_.durability.snapshot_on_exit || config_.durability.recover_on_startup) {
     // Create the directory initially to crash the database in case of
@@ -502,10 +551,19 @@ Storage::Storage(Config config)
           "those files into a .backup directory inside the storage directory.");
     }
   }
+  // The recovered vertices aren't indexed by their properties.
+  indices_.valid_time_index.Build(vertices_.access());
   //hjm begin rocksdb retention
   if (config_.rocksdb_retention.retention_on_startup){
     reclaim_rocksdb_runner_.Run("Rocksdb GC", config_.rocksdb_retention.retention_interval, [this] { this->ReclaimHistoryRentention(config_.rocksdb_retention.retention_period); });
   }
+  if (!config_.history.cold_directory.empty()) {
+    if (config_.items.realTimeFlag) {
+      cold_history_runner_.Run("History tier", config_.history.cold_interval, [this] { this->MoveColdHistory(); });
+    } else {
+      spdlog::warn("The cold tier of the history needs real time timestamps, all history stays in the history store.");
+    }
+  }
   //hjm end
   if (config_.durability.snapshot_wal_mode != Config::Durability::SnapshotWalMode::DISABLED) {
     snapshot_runner_.Run("Snapshot", config_.durability.snapshot_interval, [this] {
@@ -588,61 +646,193 @@ Storage::Accessor::~Accessor() {
 }
 
 bool Storage::ReclaimHistoryRentention(const std::chrono::milliseconds &retention_period){
-  return saved_history_deltas_->RemoveOldHistory(retention_period);
+  auto removed=saved_history_deltas_->RemoveOldHistory(retention_period);
+  // Cached versions may be the ones which were just dropped.
+  history_cache_.Clear();
+  return removed;
 }
 
-storage::HistoryVertex Storage::Accessor::CreateHistoryVertexFromKV(const storage::HistoryVertex vertex_,nlohmann::json gid_delta_,history_delta::historyContext &historyContext_){
-  //properties
-  auto maybe_labels= vertex_.labels;
-  auto maybe_properties=vertex_.properties;
+uint64_t Storage::HistoryTimestamp() {
+  if (config_.items.realTimeFlag) {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+               std::chrono::system_clock::now().time_since_epoch())
+        .count();
+  }
+  std::lock_guard<utils::SpinLock> guard(engine_lock_);
+  return timestamp_;
+}
 
-  //deleted info
-  auto property_ids = PropertyId::FromUint(storage_->name_id_mapper_.NameToId("delete_info"));
-  auto property_values = storage::PropertyValue(gid_delta_.dump());
-  maybe_properties[property_ids]=property_values;
+bool Storage::CreateTemporalRollup(const std::string &name, LabelId label, PropertyId property,
+                                   history_delta::TemporalRollup::Aggregate aggregate, uint64_t width) {
+  // Rollups don't change during a GC cycle. The versions the GC migrates
+  // ended before the current timestamp, so none of them is in the new rollup.
+  std::lock_guard<std::mutex> gc_guard(gc_lock_);
+  return saved_history_deltas_->CreateRollup({name, label, property, aggregate, width, HistoryTimestamp()});
+}
 
+bool Storage::DropTemporalRollup(const std::string &name) {
+  // The buckets updated by a GC cycle are only queued once it ends.
+  std::lock_guard<std::mutex> gc_guard(gc_lock_);
+  return saved_history_deltas_->DropRollup(name);
+}
 
-  auto tt_ts=gid_delta_["TT_TS"].get<uint64_t>();
-  auto tt_te=gid_delta_["TT_TE"].get<uint64_t>();
-  //TODO edges
+std::vector<history_delta::TemporalRollup> Storage::ListTemporalRollups() const {
+  return saved_history_deltas_->ListRollups();
+}
 
-  auto new_vertex=HistoryVertex(vertex_.gid,tt_ts,tt_te);
-  new_vertex.labels=maybe_labels;
-  new_vertex.properties=maybe_properties;
+std::optional<std::vector<history_delta::RollupBucket>> Storage::TemporalRollupBuckets(const std::string &name,
+                                                                                      uint64_t ts,
+                                                                                      uint64_t te) const {
+  return saved_history_deltas_->GetRollupBuckets(name, ts, te);
+}
 
-  new_vertex.in_edges=vertex_.in_edges;
-  new_vertex.out_edges=vertex_.out_edges;
-  
-  return new_vertex;
+bool Storage::MoveColdHistory() {
+  auto now = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch());
+  if (now <= config_.history.cold_after) return false;
+  return saved_history_deltas_->MoveColdHistory((now - config_.history.cold_after).count());
 }
 
+namespace {
+// Rolls the given labels and properties back to the state kept in a history
+// record. Null properties didn't exist in that version. The property snapshot
+// is shared with the newer version unless the record changes it.
+void ApplyHistoryRecord(const history_delta::HistoryRecord &record, std::vector<LabelId> *labels,
+                        std::shared_ptr<const HistoryVertex::PropertyMap> *properties) {
+  if (!record.properties.empty()) {
+    auto changed = *properties ? HistoryVertex::PropertyMap(**properties) : HistoryVertex::PropertyMap();
+    for (const auto &[property, value] : record.properties) {
+      if (value.IsNull()) {
+        changed.erase(property);
+      } else {
+        changed[property] = value;
+      }
+    }
+    *properties = std::make_shared<const HistoryVertex::PropertyMap>(std::move(changed));
+  }
+  for (const auto &[action, label] : record.labels) {
+    auto it = std::find(labels->begin(), labels->end(), label);
+    if (action == history_delta::LabelAction::ADD) {
+      if (it == labels->end()) labels->push_back(label);
+    } else if (it != labels->end()) {
+      labels->erase(it);
+    }
+  }
+}
+}  // namespace
 
-storage::HistoryVertex Storage::Accessor::CreateHistoryVertexFromKV(const VertexAccessor &another,nlohmann::json gid_delta_,history_delta::historyContext &historyContext_){
-  //properties
-  auto deltas=another.vertex_->delta;
-  auto maybe_properties=another.vertex_->properties.Properties();
-  auto maybe_labels=another.vertex_->labels;
-  //deleted info
-  auto property_ids = PropertyId::FromUint(storage_->name_id_mapper_.NameToId("delete_info"));
-  auto property_values = storage::PropertyValue(gid_delta_.dump());
-  maybe_properties[property_ids]=property_values;
+storage::HistoryVertex Storage::Accessor::CreateHistoryVertexFromKV(const storage::HistoryVertex vertex_,const history_delta::HistoryRecord &gid_delta_,history_delta::historyContext &historyContext_){
+  auto new_vertex=HistoryVertex(vertex_.gid,gid_delta_.tt_ts,gid_delta_.tt_te);
+  new_vertex.labels=vertex_.labels;
+  new_vertex.properties=vertex_.properties;
+  ApplyHistoryRecord(gid_delta_,&new_vertex.labels,&new_vertex.properties);
 
+  new_vertex.vertex=vertex_.vertex;
+  
+  return new_vertex;
+}
 
-  auto tt_ts=gid_delta_["TT_TS"].get<uint64_t>();
-  auto tt_te=gid_delta_["TT_TE"].get<uint64_t>();
-  //TODO edges
-  auto new_vertex=HistoryVertex(another.vertex_->gid,tt_ts,tt_te);
-  new_vertex.labels=maybe_labels;
-  new_vertex.properties=maybe_properties;
+
+storage::HistoryVertex Storage::Accessor::CreateHistoryVertexFromKV(const VertexAccessor &another,const history_delta::HistoryRecord &gid_delta_,history_delta::historyContext &historyContext_){
+  auto new_vertex=HistoryVertex(another.vertex_->gid,gid_delta_.tt_ts,gid_delta_.tt_te);
+  new_vertex.labels=another.vertex_->labels;
+  new_vertex.SetProperties(another.vertex_->properties.Properties());
+  ApplyHistoryRecord(gid_delta_,&new_vertex.labels,&new_vertex.properties);
 
  //边
-  new_vertex.in_edges=another.vertex_->in_edges;
-  new_vertex.out_edges=another.vertex_->out_edges;
+  new_vertex.vertex=another.vertex_;
 
   return new_vertex;
 }
 
 
+std::optional<std::vector<HistoryVertex>> Storage::Accessor::FindHistoryVertexVersions(
+    const VertexAccessor &vertex, const history_delta::historyContext &context) {
+  uint64_t history_end = 0;
+  {
+    std::lock_guard<utils::SpinLock> guard(vertex.vertex_->lock);
+    // Versions kept in memory are rebuilt on top of the history store ones,
+    // such vertices are read from the history store.
+    if (vertex.vertex_->delta != nullptr) return std::nullopt;
+    history_end = vertex.vertex_->transaction_st;
+  }
+  auto versions = storage_->history_cache_.FindVertexVersions(vertex.vertex_->gid.AsUint(), context.c_ts, context.c_te,
+                                                              context.types, history_end);
+  if (!versions) return std::nullopt;
+  for (auto &version : *versions) version.vertex = vertex.vertex_;
+  return versions;
+}
+
+void Storage::Accessor::SaveHistoryVertexVersion(const VertexAccessor &vertex, const HistoryVertex &version) {
+  {
+    std::lock_guard<utils::SpinLock> guard(vertex.vertex_->lock);
+    if (vertex.vertex_->delta != nullptr) return;
+  }
+  storage_->history_cache_.InsertVertexVersion(version);
+}
+
+bool Storage::Accessor::RollBackVertex(const VertexAccessor &vertex, uint64_t timestamp, std::vector<LabelId> *labels,
+                                       std::map<PropertyId, PropertyValue> *properties) {
+  std::lock_guard<utils::SpinLock> guard(vertex.vertex_->lock);
+  *labels = vertex.vertex_->labels;
+  *properties = vertex.vertex_->properties.Properties();
+  if (!vertex.vertex_->deleted && vertex.vertex_->transaction_st <= timestamp) return true;
+  // Every delta restores the version [transaction_st, commit_timestamp).
+  for (auto *delta = vertex.vertex_->delta; delta != nullptr; delta = delta->next.load(std::memory_order_acquire)) {
+    switch (delta->action) {
+      case Delta::Action::ADD_LABEL: {
+        if (std::find(labels->begin(), labels->end(), delta->label) == labels->end()) labels->push_back(delta->label);
+        break;
+      }
+      case Delta::Action::REMOVE_LABEL: {
+        auto it = std::find(labels->begin(), labels->end(), delta->label);
+        if (it != labels->end()) labels->erase(it);
+        break;
+      }
+      case Delta::Action::SET_PROPERTY: {
+        if (delta->property.value.IsNull()) {
+          properties->erase(delta->property.key);
+        } else {
+          (*properties)[delta->property.key] = delta->property.value;
+        }
+        break;
+      }
+      case Delta::Action::DELETE_OBJECT:
+        // The vertex didn't exist before this delta.
+        return false;
+      default:
+        break;
+    }
+    auto commit = delta->commit_timestamp != 0 ? delta->commit_timestamp : std::numeric_limits<uint64_t>::max();
+    if (delta->transaction_st <= timestamp && timestamp < commit) return true;
+  }
+  return false;
+}
+
+bool Storage::Accessor::RollBackEdge(const EdgeAccessor &edge, uint64_t timestamp,
+                                     std::map<PropertyId, PropertyValue> *properties) {
+  properties->clear();
+  // Without properties on edges nothing about their versions is kept.
+  if (!config_.properties_on_edges) return true;
+  auto *ptr = edge.edge_.ptr;
+  std::lock_guard<utils::SpinLock> guard(ptr->lock);
+  *properties = ptr->properties.Properties();
+  if (!ptr->deleted && ptr->transaction_st <= timestamp) return true;
+  for (auto *delta = ptr->delta; delta != nullptr; delta = delta->next.load(std::memory_order_acquire)) {
+    if (delta->action == Delta::Action::SET_PROPERTY) {
+      if (delta->property.value.IsNull()) {
+        properties->erase(delta->property.key);
+      } else {
+        (*properties)[delta->property.key] = delta->property.value;
+      }
+    } else if (delta->action == Delta::Action::DELETE_OBJECT) {
+      return false;
+    }
+    auto commit = delta->commit_timestamp != 0 ? delta->commit_timestamp : std::numeric_limits<uint64_t>::max();
+    if (delta->transaction_st <= timestamp && timestamp < commit) return true;
+  }
+  return false;
+}
+
 storage::HistoryVertex Storage::Accessor::CreateHistoryVertexFromDelta(const VertexAccessor &another,std::tuple< std::map<storage::PropertyId,storage::PropertyValue>,uint64_t,uint64_t> & maybe_props,history_delta::historyContext& historyContext_){
   auto deltas=another.vertex_->delta;
   //Current info
@@ -660,15 +850,14 @@ storage::HistoryVertex Storage::Accessor::CreateHistoryVertexFromDelta(const Ver
 
   auto new_vertex=HistoryVertex(another.vertex_->gid,tt_ts,tt_te);
   new_vertex.labels=maybe_labels;
-  new_vertex.properties=maybe_properties;
+  new_vertex.SetProperties(std::move(maybe_properties));
   //edges
-  new_vertex.in_edges=another.vertex_->in_edges;
-  new_vertex.out_edges=another.vertex_->out_edges;
+  new_vertex.vertex=another.vertex_;
   return new_vertex;
 }
 
 
-storage::HistoryEdge Storage::Accessor::CreateHistoryEdgeFromKV(const EdgeAccessor &another,nlohmann::json gid_delta_){
+storage::HistoryEdge Storage::Accessor::CreateHistoryEdgeFromKV(const EdgeAccessor &another,const history_delta::HistoryRecord &gid_delta_){
   auto maybe_properties=another.edge_.ptr->properties.Properties();
   auto from_gid=another.FromVertex().Gid();
   auto to_gid=another.ToVertex().Gid();
@@ -693,23 +882,23 @@ storage::HistoryEdge Storage::Accessor::CreateHistoryEdgeFromKV(const EdgeAccess
 
   //TT_TS TT_TE
   auto property_id = PropertyId::FromUint(storage_->name_id_mapper_.NameToId("transaction_ts"));
-  auto property_value = storage::PropertyValue(gid_delta_["TT_TS"].get<int64_t>());
+  auto property_value = storage::PropertyValue((int64_t)gid_delta_.tt_ts);
   maybe_properties[property_id]=property_value;
 
   auto property_id2 = PropertyId::FromUint(storage_->name_id_mapper_.NameToId("transaction_te"));
-  auto property_value2 = storage::PropertyValue(gid_delta_["TT_TE"].get<int64_t>());
+  auto property_value2 = storage::PropertyValue((int64_t)gid_delta_.tt_te);
   maybe_properties[property_id2]=property_value2;
-  auto tt_ts=gid_delta_["TT_TS"].get<uint64_t>();
-  auto tt_te=gid_delta_["TT_TE"].get<uint64_t>();
+  auto tt_ts=gid_delta_.tt_ts;
+  auto tt_te=gid_delta_.tt_te;
   // std::cout<<"CreateHistoryEdgeFromKV1:"<<tt_ts<<" "<<tt_te<<" "<<from_gid.AsUint()<<" "<<to_gid.AsUint()<<" ""\n";
   //TODO edges
   auto history_edge=HistoryEdge(another.edge_.ptr->gid,tt_ts,tt_te,from_gid,to_gid,another.EdgeType(),nullptr); 
-  history_edge.properties=maybe_properties;
+  history_edge.SetProperties(std::move(maybe_properties));
   return history_edge;
 }
 
-storage::HistoryEdge Storage::Accessor::CreateHistoryEdgeFromKV(storage::HistoryEdge edge_,nlohmann::json gid_delta_){
-  auto maybe_properties=edge_.properties;
+storage::HistoryEdge Storage::Accessor::CreateHistoryEdgeFromKV(storage::HistoryEdge edge_,const history_delta::HistoryRecord &gid_delta_){
+  auto maybe_properties=edge_.Properties();
   //properties 
   // wzy begin no-edge-version
   // if(gid_delta_.find("SP")!=gid_delta_.end()){
@@ -729,22 +918,22 @@ storage::HistoryEdge Storage::Accessor::CreateHistoryEdgeFromKV(storage::History
 
   //TT_TS TT_TE
   auto property_id = PropertyId::FromUint(storage_->name_id_mapper_.NameToId("transaction_ts"));
-  auto property_value = storage::PropertyValue(gid_delta_["TT_TS"].get<int64_t>());
+  auto property_value = storage::PropertyValue((int64_t)gid_delta_.tt_ts);
   maybe_properties[property_id]=property_value;
 
   auto property_id2 = PropertyId::FromUint(storage_->name_id_mapper_.NameToId("transaction_te"));
-  auto property_value2 = storage::PropertyValue(gid_delta_["TT_TE"].get<int64_t>());
+  auto property_value2 = storage::PropertyValue((int64_t)gid_delta_.tt_te);
   maybe_properties[property_id2]=property_value2;
-  auto tt_ts=gid_delta_["TT_TS"].get<uint64_t>();
-  auto tt_te=gid_delta_["TT_TE"].get<uint64_t>();
+  auto tt_ts=gid_delta_.tt_ts;
+  auto tt_te=gid_delta_.tt_te;
   // std::cout<<"CreateHistoryEdgeFromKV2:"<<tt_ts<<" "<<tt_te<<" "<<edge_.from_gid.AsUint()<<" "<<edge_.to_gid.AsUint()<<"\n";
   //TODO edges
   auto history_edge=HistoryEdge(edge_.gid,tt_ts,tt_te,edge_.from_gid,edge_.to_gid,edge_.type,nullptr);
-  history_edge.properties=maybe_properties;
+  history_edge.SetProperties(std::move(maybe_properties));
   return history_edge;
 }
 
-Result<std::vector<EdgeAccessor>> Storage::Accessor::Edges(std::vector<std::tuple<EdgeTypeId, Vertex *, EdgeRef>> &edges_,const std::vector<EdgeTypeId> &edge_types,storage::Gid gid,bool from,std::optional<storage::Gid> existing_gid){
+Result<std::vector<EdgeAccessor>> Storage::Accessor::Edges(const std::vector<std::tuple<EdgeTypeId, Vertex *, EdgeRef>> &edges_,const std::vector<EdgeTypeId> &edge_types,storage::Gid gid,bool from,std::optional<storage::Gid> existing_gid){
     std::vector<std::tuple<EdgeTypeId, Vertex *, EdgeRef>> edges;
     {
         if (edge_types.empty() & !existing_gid) {
@@ -872,25 +1061,17 @@ Result<std::optional<VertexAccessor>> Storage::Accessor::DeleteVertex(VertexAcce
   //hjm begin
   delta->transaction_st=ts;
   //save vertex to restore
-  nlohmann::json data = nlohmann::json::object();
+  auto data = std::make_unique<history_delta::HistoryRecord>();
   //labels
   auto maybe_labels = vertex_ptr->labels;
-  auto add_labels=std::vector<std::pair<std::string,std::string>>();
   for (const auto &label : maybe_labels) {
-    add_labels.emplace_back("AL",storage_->name_id_mapper_.IdToName(label.AsUint()));//name_id_mapper_.IdToName(label.AsUint())
+    data->labels.emplace_back(history_delta::LabelAction::ADD, label);
   }
-  data["L"] =add_labels;
 
   //properties
-  auto maybe_properties = vertex_ptr->properties.Properties();;
-  nlohmann::json data2 = nlohmann::json::object();
-  for (const auto &prop : maybe_properties) {
-    auto property_name = storage_->name_id_mapper_.IdToName(prop.first.AsUint());//delta.property.key.AsUint();//
-    auto property_value = SerializePropertyValue(prop.second);//query::serialization::
-    data2[property_name] = property_value;
-  }
-  data["SP"]=data2;
-  delta->add_info=data;
+  auto maybe_properties = vertex_ptr->properties.Properties();
+  data->properties = maybe_properties;
+  delta->add_info = std::move(data);
   if(prinfFlag){
     auto print=prinfVertex(vertex_ptr->gid.AsUint(),ts,maybe_properties,maybe_labels);
     transaction_.prinfVertex_.emplace_back(print);
@@ -1002,24 +1183,16 @@ Result<std::optional<std::pair<VertexAccessor, std::vector<EdgeAccessor>>>> Stor
 
   delta->transaction_st=ts;
   //save vertex to restore
-  nlohmann::json data = nlohmann::json::object();
+  auto data = std::make_unique<history_delta::HistoryRecord>();
   auto maybe_labels = vertex_ptr->labels;
-  auto add_labels=std::vector<std::pair<std::string,std::string>>();
   for (const auto &label : maybe_labels) {
-    add_labels.emplace_back("AL",storage_->name_id_mapper_.IdToName(label.AsUint()));//name_id_mapper_.IdToName(label.AsUint())
+    data->labels.emplace_back(history_delta::LabelAction::ADD, label);
   }
-  data["L"] =add_labels;
 
   //properties
-  auto maybe_properties = vertex_ptr->properties.Properties();;
-  nlohmann::json data2 = nlohmann::json::object();
-  for (const auto &prop : maybe_properties) {
-    auto property_name = storage_->name_id_mapper_.IdToName(prop.first.AsUint());//delta.property.key.AsUint();//
-    auto property_value = SerializePropertyValue(prop.second);//query::serialization::
-    data2[property_name] = property_value;
-  }
-  data["SP"]=data2;
-  delta->add_info=data;
+  auto maybe_properties = vertex_ptr->properties.Properties();
+  data->properties = maybe_properties;
+  delta->add_info = std::move(data);
 
   if(prinfFlag){
     auto print=prinfVertex(vertex_ptr->gid.AsUint(),ts,maybe_properties,maybe_labels);
@@ -1469,16 +1642,9 @@ Result<std::optional<EdgeAccessor>> Storage::Accessor::DeleteEdge(EdgeAccessor *
     delta->from_gid=edge_ptr->from_gid;
     delta->to_gid=edge_ptr->to_gid;
     //properties
-    nlohmann::json data = nlohmann::json::object();
-    auto maybe_properties = edge_ptr->properties.Properties();;
-    nlohmann::json data2 = nlohmann::json::object();
-    for (const auto &prop : maybe_properties) {
-      auto property_name = storage_->name_id_mapper_.IdToName(prop.first.AsUint());//delta.property.key.AsUint();//
-      auto property_value = SerializePropertyValue(prop.second);//query::serialization::
-      data2[property_name] = property_value;
-    }
-    data["SP"]=data2;
-    delta->add_info=data;
+    auto maybe_properties = edge_ptr->properties.Properties();
+    delta->add_info = std::make_unique<history_delta::HistoryRecord>();
+    delta->add_info->properties = maybe_properties;
     if(prinfFlag){
       auto prinfEdges=prinfEdge(edge_type,edge_ptr->gid.AsUint(),edge_ptr->from_gid.AsUint(),edge_ptr->to_gid.AsUint(),ts,maybe_properties);
       transaction_.prinfEdge_.emplace_back(prinfEdges);
@@ -2069,8 +2235,28 @@ StorageInfo Storage::GetInfo() const {
   if (vertex_count) {
     average_degree = 2.0 * static_cast<double>(edge_count) / vertex_count;
   }
-  return {vertex_count, edge_count, average_degree, utils::GetMemoryUsage(),
-          utils::GetDirDiskUsage(config_.durability.storage_directory)};
+  history_delta::MigrationInfo migration_info{0, std::chrono::milliseconds(0)};
+  kvstore::KVStore::Statistics store_stats{0, 0, 0};
+  if (saved_history_deltas_) {
+    migration_info = saved_history_deltas_->GetMigrationInfo();
+    store_stats = saved_history_deltas_->GetStoreStatistics();
+  }
+  auto cache_stats = history_cache_.GetStats();
+  return {vertex_count,
+          edge_count,
+          average_degree,
+          utils::GetMemoryUsage(),
+          utils::GetDirDiskUsage(config_.durability.storage_directory),
+          migration_info.queue_depth,
+          static_cast<uint64_t>(migration_info.lag.count()),
+          migration_info.error,
+          cache_stats.hits,
+          cache_stats.misses,
+          cache_stats.evictions,
+          cache_stats.bytes,
+          store_stats.block_cache_hits,
+          store_stats.block_cache_misses,
+          store_stats.bloom_filter_useful};
 }
 
 VerticesIterable Storage::Accessor::Vertices(LabelId label, View view) {
@@ -2095,6 +2281,24 @@ VerticesIterable Storage::Accessor::Vertices(LabelId label, PropertyId property,
       storage_->indices_.label_property_index.Vertices(label, property, lower_bound, upper_bound, view, &transaction_));
 }
 
+VerticesIterable Storage::Accessor::HistoryVertices(LabelId label, View view) {
+  return VerticesIterable(storage_->indices_.label_index.Vertices(label, view, &transaction_, true));
+}
+
+VerticesIterable Storage::Accessor::HistoryVertices(LabelId label, PropertyId property, const PropertyValue &value,
+                                                    View view) {
+  return VerticesIterable(storage_->indices_.label_property_index.Vertices(
+      label, property, utils::MakeBoundInclusive(value), utils::MakeBoundInclusive(value), view, &transaction_, true));
+}
+
+VerticesIterable Storage::Accessor::ValidTimeVertices(uint64_t ts, uint64_t te, View view) {
+  return VerticesIterable(storage_->indices_.valid_time_index.Vertices(ts, te, view, &transaction_));
+}
+
+VerticesIterable Storage::Accessor::HistoryValidTimeVertices(uint64_t ts, uint64_t te, View view) {
+  return VerticesIterable(storage_->indices_.valid_time_index.Vertices(ts, te, view, &transaction_, true));
+}
+
 Transaction Storage::CreateTransaction(IsolationLevel isolation_level) {
   // We acquire the transaction engine lock here because we access (and
   // modify) the transaction engine variables (`transaction_id` and
@@ -2119,6 +2323,47 @@ Transaction Storage::CreateTransaction(IsolationLevel isolation_level) {
   return {transaction_id, start_timestamp, isolation_level};
 }
 
+namespace {
+// Returns the labels and properties of the vertex as they were before the
+// transaction which owns the deltas with the given timestamp.
+std::pair<std::vector<LabelId>, std::map<PropertyId, PropertyValue>> VertexStateBefore(
+    Vertex *vertex, const std::atomic<uint64_t> *timestamp) {
+  std::lock_guard<utils::SpinLock> guard(vertex->lock);
+  auto labels = vertex->labels;
+  auto properties = vertex->properties.Properties();
+  bool found = false;
+  for (auto *delta = vertex->delta; delta != nullptr; delta = delta->next.load(std::memory_order_acquire)) {
+    if (delta->timestamp == timestamp) {
+      found = true;
+    } else if (found) {
+      break;
+    }
+    switch (delta->action) {
+      case Delta::Action::ADD_LABEL: {
+        if (std::find(labels.begin(), labels.end(), delta->label) == labels.end()) labels.push_back(delta->label);
+        break;
+      }
+      case Delta::Action::REMOVE_LABEL: {
+        auto it = std::find(labels.begin(), labels.end(), delta->label);
+        if (it != labels.end()) labels.erase(it);
+        break;
+      }
+      case Delta::Action::SET_PROPERTY: {
+        if (delta->property.value.IsNull()) {
+          properties.erase(delta->property.key);
+        } else {
+          properties[delta->property.key] = delta->property.value;
+        }
+        break;
+      }
+      default:
+        break;
+    }
+  }
+  return {std::move(labels), std::move(properties)};
+}
+}  // namespace
+
 template <bool force>
 void Storage::CollectGarbage() {
   if constexpr (force) {
@@ -2176,6 +2421,18 @@ void Storage::CollectGarbage() {
   // eliminates high CPU usage when the GC doesn't have to clean up anything.
   bool run_index_cleanup = !committed_transactions_->empty() || !garbage_undo_buffers_->empty();
 
+  // The versions of vertices with an indexed label, or with a valid time, are
+  // also posted in the temporal indexes of the history store.
+  {
+    auto now = HistoryTimestamp();
+    saved_history_deltas_->SetTemporalIndices(indices_.label_index.ListIndices(),
+                                              indices_.label_property_index.ListIndices(), now);
+    // The valid time of the versions is posted from the first use of valid
+    // times on.
+    if (indices_.valid_time_index.ApproximateVertexCount() > 0) saved_history_deltas_->EnableValidTimeIndex(now);
+  }
+  bool post_versions = saved_history_deltas_->HasTemporalIndices();
+
   //hjm add begin;
   std::list<std::pair<Gid, LabelId>> saved_deltas;
   std::list<std::pair<Gid, Delta>> saved_deltas2;
@@ -2184,7 +2441,10 @@ void Storage::CollectGarbage() {
   std::ofstream ofs_vertex;
   ofs_edge.open("/home/hjm/history_info/history_edge.txt",std::ios::out|std::ios::app);
   ofs_vertex.open("/home/hjm/history_info/history_vertex.txt",std::ios::out|std::ios::app);
-  while (true) {
+  // Once history records couldn't be written, the committed transactions
+  // keep their deltas linked, so no history is lost until a restart.
+  bool migrate = !saved_history_deltas_->MigrationFailed();
+  while (migrate) {
     // We don't want to hold the lock on commited transactions for too long,
     // because that prevents other transactions from committing.
     Transaction *transaction;
@@ -2211,44 +2471,47 @@ void Storage::CollectGarbage() {
       }
     }
 
-    std::map<std::string, std::string> gid_anchor_all_;
-    // std::cout<<"commit after:"<<transaction->transaction_id<<" "<<transaction->gid_anchor_edge_.size()<<" "<<transaction->gid_anchor_all_.size()<<"\n";
-    for(auto [key,maybe_properties]:transaction->gid_anchor_edge_){
-      auto gid=key.first;
-      auto ts=key.second;
-      nlohmann::json data = nlohmann::json::object();
-      nlohmann::json data2 = nlohmann::json::object();
-      for (const auto &prop : maybe_properties) {
-        auto property_name = name_id_mapper_.IdToName(prop.first.AsUint());//delta.property.key.AsUint();//
-        auto property_value = SerializePropertyValue(prop.second);//query::serialization::
-        data2[property_name] = property_value;
+    {
+      // The version of a vertex ends with the first of its label or property
+      // deltas in the transaction, the deltas are still linked.
+      std::map<Vertex *, std::pair<uint64_t, uint64_t>> versions;
+      for (Delta &a : transaction->deltas) {
+        if (a.transaction_st >= a.commit_timestamp) continue;
+        if (a.action != Delta::Action::ADD_LABEL && a.action != Delta::Action::REMOVE_LABEL &&
+            a.action != Delta::Action::SET_PROPERTY && a.action != Delta::Action::RECREATE_OBJECT) {
+          continue;
+        }
+        auto parent = a.prev.Get();
+        while (parent.type == PreviousPtr::Type::DELTA) {
+          parent = parent.delta->prev.Get();
+        }
+        if (parent.type != PreviousPtr::Type::VERTEX) continue;
+        versions.emplace(parent.vertex, std::make_pair(a.transaction_st, a.commit_timestamp));
       }
-      data["SP"]=data2;
-      auto prefix=saved_history_deltas_->getPrefix(gid,ts,false);
-      gid_anchor_all_[prefix]=data.dump();
-    }
-
-    for(auto [key,values]:transaction->gid_anchor_vertex_){
-      auto gid=key.first;
-      auto ts=key.second;
-      nlohmann::json data = nlohmann::json::object();
-      auto maybe_properties=values.first;
-      auto maybe_labels=values.second;
-      nlohmann::json data2 = nlohmann::json::object();
-      for (const auto &prop : maybe_properties) {
-        auto property_name = name_id_mapper_.IdToName(prop.first.AsUint());//delta.property.key.AsUint();//
-        auto property_value = SerializePropertyValue(prop.second);//query::serialization::
-        data2[property_name] = property_value;
+      for (const auto &[vertex, span] : versions) {
+        if (post_versions) {
+          auto [labels, properties] = VertexStateBefore(vertex, transaction->commit_timestamp.get());
+          saved_history_deltas_->SaveVertexVersion(vertex->gid, span.first, span.second, labels, properties);
+          saved_history_deltas_->CountVertexVersion(labels);
+        } else {
+          // Without temporal indexes the current labels are close enough for
+          // the statistics.
+          std::vector<LabelId> labels;
+          {
+            std::lock_guard<utils::SpinLock> guard(vertex->lock);
+            labels = vertex->labels;
+          }
+          saved_history_deltas_->CountVertexVersion(labels);
+        }
       }
-      data["SP"]=data2;
+    }
 
-      auto add_labels=std::vector<std::pair<std::string,std::string>>();
-      for (const auto &label : maybe_labels) {
-        add_labels.emplace_back("AL",name_id_mapper_.IdToName(label.AsUint()));//name_id_mapper_.IdToName(label.AsUint())
-      }
-      data["L"] =add_labels;
-      auto prefix=saved_history_deltas_->getPrefix(gid,ts,true);
-      gid_anchor_all_[prefix]=data.dump();
+    for(const auto &[key,maybe_properties]:transaction->gid_anchor_edge_){
+      saved_history_deltas_->SaveEdgeAnchor(key.first,key.second,maybe_properties);
+    }
+
+    for(const auto &[key,values]:transaction->gid_anchor_vertex_){
+      saved_history_deltas_->SaveVertexAnchor(key.first,key.second,values.second,values.first);
     }
     
     //hjm begin prinf edge
@@ -2300,8 +2563,6 @@ void Storage::CollectGarbage() {
     
     //hjm end
     // saved_history_deltas_->GetAll();
-    saved_history_deltas_->SaveDeltaAll();
-    saved_history_deltas_->SaveAnchorAll(gid_anchor_all_);
 
     // saved_history_deltas_->SaveTimeTableAll();
     std::list<Gid> current_deleted_edges1;
@@ -2442,6 +2703,9 @@ void Storage::CollectGarbage() {
   ofs_vertex.close();
   //hjm end
 
+  // All history records of this GC cycle are written as one group.
+  saved_history_deltas_->SaveDeltaAll();
+
   // After unlinking deltas from vertices, we refresh the indices. That way
   // we're sure that none of the vertices from `current_deleted_vertices`
   // appears in an index, and we can safely remove the from the main storage
@@ -2808,6 +3072,7 @@ void Storage::FreeMemory() {
   edges_.run_gc();
   indices_.label_index.RunGC();
   indices_.label_property_index.RunGC();
+  indices_.valid_time_index.RunGC();
 }
 
 uint64_t Storage::CommitTimestamp(const std::optional<uint64_t> desired_commit_timestamp) {
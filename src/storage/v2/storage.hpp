@@ -27,6 +27,7 @@
 #include "storage/v2/durability/wal.hpp"
 #include "storage/v2/edge.hpp"
 #include "storage/v2/edge_accessor.hpp"
+#include "storage/v2/history_cache.hpp"
 #include "storage/v2/indices.hpp"
 #include "storage/v2/isolation_level.hpp"
 #include "storage/v2/mvcc.hpp"
@@ -110,19 +111,21 @@ class AllVerticesIterable final {
 /// This class should be the primary type used by the client code to iterate
 /// over vertices inside a Storage instance.
 class VerticesIterable final {
-  enum class Type { ALL, BY_LABEL, BY_LABEL_PROPERTY };
+  enum class Type { ALL, BY_LABEL, BY_LABEL_PROPERTY, BY_VALID_TIME };
 
   Type type_;
   union {
     AllVerticesIterable all_vertices_;
     LabelIndex::Iterable vertices_by_label_;
     LabelPropertyIndex::Iterable vertices_by_label_property_;
+    ValidTimeIndex::Iterable vertices_by_valid_time_;
   };
 
  public:
   explicit VerticesIterable(AllVerticesIterable);
   explicit VerticesIterable(LabelIndex::Iterable);
   explicit VerticesIterable(LabelPropertyIndex::Iterable);
+  explicit VerticesIterable(ValidTimeIndex::Iterable);
 
   VerticesIterable(const VerticesIterable &) = delete;
   VerticesIterable &operator=(const VerticesIterable &) = delete;
@@ -138,6 +141,7 @@ class VerticesIterable final {
       AllVerticesIterable::Iterator all_it_;
       LabelIndex::Iterable::Iterator by_label_it_;
       LabelPropertyIndex::Iterable::Iterator by_label_property_it_;
+      ValidTimeIndex::Iterable::Iterator by_valid_time_it_;
     };
 
     void Destroy() noexcept;
@@ -146,6 +150,7 @@ class VerticesIterable final {
     explicit Iterator(AllVerticesIterable::Iterator);
     explicit Iterator(LabelIndex::Iterable::Iterator);
     explicit Iterator(LabelPropertyIndex::Iterable::Iterator);
+    explicit Iterator(ValidTimeIndex::Iterable::Iterator);
 
     Iterator(const Iterator &);
     Iterator &operator=(const Iterator &);
@@ -187,6 +192,16 @@ struct StorageInfo {
   double average_degree;
   uint64_t memory_usage;
   uint64_t disk_usage;
+  uint64_t history_migration_queue_depth;
+  uint64_t history_migration_lag_ms;
+  std::string history_migration_error;
+  uint64_t history_cache_hits;
+  uint64_t history_cache_misses;
+  uint64_t history_cache_evictions;
+  uint64_t history_cache_bytes;
+  uint64_t history_block_cache_hits;
+  uint64_t history_block_cache_misses;
+  uint64_t history_bloom_filter_useful;
 };
 
 enum class ReplicationRole : uint8_t { MAIN, REPLICA };
@@ -224,73 +239,44 @@ class Storage final {
       return storage_->saved_history_deltas_;
     }
     storage::HistoryVertex CreateHistoryVertexFromDelta(const VertexAccessor &another,std::tuple< std::map<storage::PropertyId,storage::PropertyValue>,uint64_t,uint64_t> & may_props,history_delta::historyContext& historyContext_);
-    storage::HistoryVertex CreateHistoryVertexFromKV(const storage::HistoryVertex ,nlohmann::json gid_delta_,history_delta::historyContext &historyContext_);
-    storage::HistoryVertex CreateHistoryVertexFromKV(const VertexAccessor &another,nlohmann::json gid_delta_,history_delta::historyContext &historyContext_);
-    storage::HistoryEdge CreateHistoryEdgeFromKV(const EdgeAccessor &another,nlohmann::json gid_delta_);
-    storage::HistoryEdge CreateHistoryEdgeFromKV(storage::HistoryEdge edge_,nlohmann::json gid_delta_);
-    Result<std::vector<EdgeAccessor>> Edges(std::vector<std::tuple<EdgeTypeId, Vertex *, EdgeRef>> &edges_,const std::vector<EdgeTypeId> &edge_types,storage::Gid gid,bool from,std::optional<storage::Gid> existing_gid);
+    storage::HistoryVertex CreateHistoryVertexFromKV(const storage::HistoryVertex ,const history_delta::HistoryRecord &gid_delta_,history_delta::historyContext &historyContext_);
+    storage::HistoryVertex CreateHistoryVertexFromKV(const VertexAccessor &another,const history_delta::HistoryRecord &gid_delta_,history_delta::historyContext &historyContext_);
+    storage::HistoryEdge CreateHistoryEdgeFromKV(const EdgeAccessor &another,const history_delta::HistoryRecord &gid_delta_);
+    storage::HistoryEdge CreateHistoryEdgeFromKV(storage::HistoryEdge edge_,const history_delta::HistoryRecord &gid_delta_);
+    Result<std::vector<EdgeAccessor>> Edges(const std::vector<std::tuple<EdgeTypeId, Vertex *, EdgeRef>> &edges_,const std::vector<EdgeTypeId> &edge_types,storage::Gid gid,bool from,std::optional<storage::Gid> existing_gid);
     Gid IdToGid(const uint64_t key);
     std::optional<VertexAccessor> FindDeleteVertex(Gid gid, View view);
 
-    std::optional<std::vector<std::tuple<storage::HistoryEdge*,uint64_t,uint64_t>>> FindHistoryEdge(uint64_t gid,uint64_t c_ts,uint64_t c_te){
-      // std::map<uint64_t,std::vector<std::tuple<storage::HistoryEdge*,uint64_t,uint64_t>>> all_edge;
-      std::vector<std::tuple<storage::HistoryEdge*,uint64_t,uint64_t>> edges;
-      auto key=std::make_tuple(gid,c_ts,c_te);
-      if(storage_->all_edge.find(key)!=storage_->all_edge.end()){
-        return storage_->all_edge[key];
-      }
-      return std::nullopt;
+    /// Returns the history store versions of the vertex visible in the
+    /// window from the history cache, newest first, or nullopt if they have to
+    /// be read from the history store. Vertices with versions still kept in
+    /// memory aren't cached.
+    std::optional<std::vector<HistoryVertex>> FindHistoryVertexVersions(const VertexAccessor &vertex,
+                                                                        const history_delta::historyContext &context);
+
+    /// Caches a version of the vertex rebuilt from the history store.
+    void SaveHistoryVertexVersion(const VertexAccessor &vertex, const HistoryVertex &version);
+
+    /// Same as `FindHistoryVertexVersions`, for an edge which was removed from
+    /// the storage.
+    std::optional<std::vector<HistoryEdge>> FindHistoryEdgeVersions(Gid gid,
+                                                                    const history_delta::historyContext &context) {
+      return storage_->history_cache_.FindEdgeVersions(gid.AsUint(), context.c_ts, context.c_te, context.types,
+                                                       std::nullopt);
     }
 
-    void ClearHistory(){
-      storage_->all_vertex.clear();
-      storage_->all_vertex_flag.clear();
-      storage_->all_edge_flag.clear();
-      storage_->all_edge_flag.clear();
-    }
-
-    void saveHistoryEdge(uint64_t gid,uint64_t c_ts,uint64_t c_te,storage::HistoryEdge* edge,uint64_t tt_ts,uint64_t tt_te){
-      auto key=std::make_tuple(gid,c_ts,c_te);
-      storage_->all_edge[key].emplace_back(new HistoryEdge(edge),tt_ts, tt_te);
-    }
-    bool FindHistoryEdgeFlag(uint64_t gid,uint64_t c_ts,uint64_t c_te){
-      auto key=std::make_tuple(gid,c_ts,c_te);
-      if(storage_->all_edge_flag.count(key)==0){
-        return false;
-      }
-      return true;
-    }
-    void saveHistoryEdgeFlag(uint64_t gid,uint64_t c_ts,uint64_t c_te){
-      auto key=std::make_tuple(gid,c_ts,c_te);
-      storage_->all_edge_flag.insert(key);
-    }
+    /// Caches a version of a removed edge rebuilt from the history store.
+    void SaveHistoryEdgeVersion(const HistoryEdge &version) { storage_->history_cache_.InsertEdgeVersion(version); }
 
-    
-    std::optional<std::list<storage::HistoryVertex*>> FindHistoryVertex(uint64_t gid,uint64_t c_ts,uint64_t c_te){
-      std::list<std::tuple<storage::HistoryVertex*,uint64_t,uint64_t>> vertices;
-      auto key=std::make_tuple(gid,c_ts,c_te);
-      if(storage_->all_vertex.find(key)!=storage_->all_vertex.end()){
-        return storage_->all_vertex[key];
-      }
-      return std::nullopt;
-    }
+    /// Rolls the vertex back to its version visible at `timestamp` with the
+    /// deltas kept in memory. Returns false if that version isn't kept in
+    /// memory, `labels` and `properties` then hold the oldest version which
+    /// is, the history store records of the vertex apply onto it.
+    bool RollBackVertex(const VertexAccessor &vertex, uint64_t timestamp, std::vector<LabelId> *labels,
+                        std::map<PropertyId, PropertyValue> *properties);
 
-    void saveHistoryVertex(uint64_t gid,uint64_t c_ts,uint64_t c_te,storage::HistoryVertex* vertex,uint64_t tt_ts,uint64_t tt_te){
-      auto key=std::make_tuple(gid,c_ts,c_te);
-      storage_->all_vertex[key].emplace_back(new HistoryVertex(vertex));
-    }
-    
-    bool FindHistoryVertexFlag(uint64_t gid,uint64_t c_ts,uint64_t c_te){
-      auto key=std::make_tuple(gid,c_ts,c_te);
-      if(storage_->all_vertex_flag.count(key)==0){
-        return false;
-      }
-      return true;
-    }
-    void saveHistoryVertexFlag(uint64_t gid,uint64_t c_ts,uint64_t c_te){
-      auto key=std::make_tuple(gid,c_ts,c_te);
-      storage_->all_vertex_flag.insert(key);
-    }
+    /// Same as `RollBackVertex` for the properties of an edge.
+    bool RollBackEdge(const EdgeAccessor &edge, uint64_t timestamp, std::map<PropertyId, PropertyValue> *properties);
 
     std::optional<VertexAccessor> FindVertex(Gid gid, View view);
 
@@ -310,6 +296,24 @@ class Storage final {
                               const std::optional<utils::Bound<PropertyValue>> &lower_bound,
                               const std::optional<utils::Bound<PropertyValue>> &upper_bound, View view);
 
+    /// Return the vertices which have the label in any version kept in memory,
+    /// used by temporal queries which check the versions themselves.
+    VerticesIterable HistoryVertices(LabelId label, View view);
+
+    /// The start timestamp of the transaction, the versions it reads end
+    /// before it.
+    uint64_t StartTimestamp() const { return transaction_.start_timestamp; }
+
+    VerticesIterable HistoryVertices(LabelId label, PropertyId property, const PropertyValue &value, View view);
+
+    /// Return the vertices whose valid time overlaps [ts, te], looked up in
+    /// the valid time index.
+    VerticesIterable ValidTimeVertices(uint64_t ts, uint64_t te, View view);
+
+    /// Return the vertices whose valid time started at `te` or earlier in any
+    /// version kept in memory, used by bitemporal queries.
+    VerticesIterable HistoryValidTimeVertices(uint64_t ts, uint64_t te, View view);
+
     /// Return approximate number of all vertices in the database.
     /// Note that this is always an over-estimate and never an under-estimate.
     int64_t ApproximateVertexCount() const { return storage_->vertices_.size(); }
@@ -443,6 +447,22 @@ class Storage final {
 
   IndicesInfo ListAllIndices() const;
 
+  /// Creates a rollup of the history of the property of the vertices with the
+  /// label, see `history_delta::TemporalRollup`. Its buckets start at the
+  /// current timestamp. Returns false if a rollup with the name exists.
+  bool CreateTemporalRollup(const std::string &name, LabelId label, PropertyId property,
+                            history_delta::TemporalRollup::Aggregate aggregate, uint64_t width);
+
+  /// Returns false if there is no rollup with the name.
+  bool DropTemporalRollup(const std::string &name);
+
+  std::vector<history_delta::TemporalRollup> ListTemporalRollups() const;
+
+  /// Returns the buckets of the rollup overlapping [ts, te] which hold at
+  /// least one value, std::nullopt if there is no rollup with the name.
+  std::optional<std::vector<history_delta::RollupBucket>> TemporalRollupBuckets(const std::string &name, uint64_t ts,
+                                                                               uint64_t te) const;
+
   /// Creates an existence constraint. Returns true if the constraint was
   /// successfuly added, false if it already exists and a `ConstraintViolation`
   /// if there is an existing vertex violating the constraint.
@@ -528,6 +548,10 @@ class Storage final {
   //use for aeong retention period clean
   bool ReclaimHistoryRentention(const std::chrono::milliseconds &retention_period);
 
+  /// Moves the history which ended longer ago than
+  /// `Config::History::cold_after` to the cold tier.
+  bool MoveColdHistory();
+
  private:
   Transaction CreateTransaction(IsolationLevel isolation_level);
 
@@ -554,6 +578,10 @@ class Storage final {
 
   uint64_t CommitTimestamp(std::optional<uint64_t> desired_commit_timestamp = {});
 
+  // Timestamp from which on new temporal indexes and rollups of the history
+  // store are complete.
+  uint64_t HistoryTimestamp();
+
   // Main storage lock.
   //
   // Accessors take a shared lock when starting, so it is possible to block
@@ -568,11 +596,8 @@ class Storage final {
   std::atomic<uint64_t> vertex_id_{0};
   std::atomic<uint64_t> edge_id_{0};
 
-  //aeong store updated vertices (optional)
-  std::map<std::tuple<uint64_t,uint64_t,uint64_t>,std::vector<std::tuple<storage::HistoryEdge*,uint64_t,uint64_t>>> all_edge;
-  std::map<std::tuple<uint64_t,uint64_t,uint64_t>,std::list<storage::HistoryVertex*>> all_vertex;
-  std::set<std::tuple<uint64_t,uint64_t,uint64_t>> all_vertex_flag;
-  std::set<std::tuple<uint64_t,uint64_t,uint64_t>> all_edge_flag;
+  // Versions rebuilt from the history store, shared by all queries.
+  HistoryCache history_cache_;
 
   // Even though the edge count is already kept in the `edges_` SkipList, the
   // list is used only when properties are enabled for edges. Because of that we
@@ -636,6 +661,7 @@ class Storage final {
 
   //aeong reclaim rocksdb runner
   utils::Scheduler reclaim_rocksdb_runner_;
+  utils::Scheduler cold_history_runner_;
 
   // UUID used to distinguish snapshots and to link snapshots to WALs
   std::string uuid_;
@@ -29,9 +29,6 @@ namespace storage {
 
 const uint64_t kTimestampInitialId = 0;
 const uint64_t kTransactionInitialId = 1ULL << 63U;
-const std::vector<int> AnchorNumLists{10,100,1000};//{2,4,7};//{10,100,1000};
-const std::vector<int> HotNumLists{1000,10000,100000};//{1k 10k 100k 2*2+2+1,32,62};//{1000,10000,100000}; (num+1)*anchor_num+1
-const bool MultipleAnchorFlag=false;//false;//true
 const bool AnchorFlag=true;//true;
 const bool prinfFlag=false;//true
 
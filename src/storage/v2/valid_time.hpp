@@ -0,0 +1,62 @@
+// Copyright 2021 Memgraph Ltd.
+//
+// Use of this software is governed by the Business Source License
+// included in the file licenses/BSL.txt; by using this file, you agree to be bound by the terms of the Business Source
+// License, and you may not use this file except in compliance with the Business Source License.
+//
+// As of the Change Date specified in that file, in accordance with
+// the Business Source License, use of this software will be governed
+// by the Apache License, Version 2.0, included in the file
+// licenses/APL.txt.
+
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <optional>
+
+#include "storage/v2/property_value.hpp"
+
+namespace storage {
+
+// The valid time of a vertex or an edge is the interval [vt_from, vt_to) in
+// which the fact it models holds, set by the user, as opposed to the
+// transaction time kept by the storage. It is kept in two reserved properties,
+// so it is set through Cypher like any other property and every change of it
+// is versioned in the history store next to the transaction time.
+//
+// An object without `vt_from` has no valid time and isn't matched by a `VT`
+// clause. An object without `vt_to` is valid from `vt_from` on.
+inline constexpr char kValidFromProperty[] = "vt_from";
+inline constexpr char kValidToProperty[] = "vt_to";
+
+// End of an interval without `vt_to`, the same as the end of the current
+// versions in transaction time.
+inline constexpr uint64_t kValidForever = std::numeric_limits<int64_t>::max();
+
+struct ValidInterval {
+  uint64_t from;
+  // Exclusive.
+  uint64_t to;
+
+  /// Whether the interval overlaps the window [ts, te] of a `VT` clause.
+  bool Overlaps(uint64_t ts, uint64_t te) const { return from <= te && ts < to; }
+};
+
+/// Valid times are non-negative integers, like the transaction timestamps.
+inline std::optional<uint64_t> ToValidTime(const PropertyValue &value) {
+  if (!value.IsInt() || value.ValueInt() < 0) return std::nullopt;
+  return value.ValueInt();
+}
+
+/// The interval kept in the values of `vt_from` and `vt_to`, std::nullopt if
+/// they don't form a non-empty interval.
+inline std::optional<ValidInterval> MakeValidInterval(const PropertyValue &from, const PropertyValue &to) {
+  auto start = ToValidTime(from);
+  if (!start) return std::nullopt;
+  auto end = to.IsNull() ? std::make_optional(kValidForever) : ToValidTime(to);
+  if (!end || *end <= *start) return std::nullopt;
+  return ValidInterval{*start, *end};
+}
+
+}  // namespace storage
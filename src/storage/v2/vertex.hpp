@@ -15,6 +15,7 @@
 #include <tuple>
 #include <vector>
 
+#include "storage/v2/anchor_policy.hpp"
 #include "storage/v2/delta.hpp"
 #include "storage/v2/edge_ref.hpp"
 #include "storage/v2/id_types.hpp"
@@ -27,13 +28,11 @@ struct Vertex {
   Vertex(Gid gid, Delta *delta) : gid(gid), deleted(false), delta(delta) {
     transaction_st=0;
     ve_tt_ts=0;
-    num=0;
     MG_ASSERT(delta == nullptr || delta->action == Delta::Action::DELETE_OBJECT,
               "Vertex must be created with an initial DELETE_OBJECT delta!");
   }
   Vertex(Gid gid, Delta *delta,uint64_t transaction_st) : gid(gid),deleted(false),transaction_st(transaction_st),delta(delta){
     transaction_st=0;
-    num=0;
     ve_tt_ts=0;
   }
   Gid gid;
@@ -46,7 +45,7 @@ struct Vertex {
 
   mutable utils::SpinLock lock;
   bool deleted;
-  int num;
+  AnchorStats anchor;
   uint64_t transaction_st;
   uint64_t ve_tt_ts;
   Delta *delta;
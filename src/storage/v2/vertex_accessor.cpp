@@ -61,19 +61,14 @@ std::pair<bool, bool> IsVisible(Vertex *vertex, Transaction *transaction, View v
 }  // namespace
 }  // namespace detail
 
-namespace help {
 namespace {
-  int FindPosition(const std::vector<int>& NumLists, int number) {
-    for (int i = 0; i < NumLists.size(); ++i) {
-        if (number <= NumLists[i]) {
-            // int pos = i!=0 ? i - 1 : i;
-            return i ;
-        }
-    }
-    return NumLists.size() - 1;
-  }
+// Accounts for a new committed version of `vertex` and returns true if an
+// anchor holding its current state has to be stored.
+bool VertexAnchorDue(Vertex *vertex, const Config::Items &config) {
+  auto state_bytes = vertex->properties.Size() + vertex->labels.size() * sizeof(LabelId);
+  return AnchorDue(vertex->anchor, state_bytes, config.adaptiveAnchorFlag, config.AnchorNum, config.MaxAnchorNum);
+}
 }  // namespace
-}  // namespace help
 
 std::optional<VertexAccessor> VertexAccessor::Creates(Vertex *vertex, Transaction *transaction, Indices *indices,
                                                      Constraints *constraints, Config::Items config, View view){
@@ -134,19 +129,14 @@ Result<bool> VertexAccessor::AddLabel(LabelId label) {
         return Error::SERIALIZATION_ERROR;
       }
     }else{
-      vertex_->num+=1;
-      if(!MultipleAnchorFlag){//constant anchor num
-        if(vertex_->num>config_.AnchorNum){
-          vertex_->num=1;
-          // save edge to restore properties
-          if(AnchorFlag){
-            auto maybe_labels = vertex_->labels;
-            auto maybe_properties = vertex_->properties.Properties();
-            ts = before_delta->commit_timestamp;
-            transaction_->gid_anchor_vertex_[std::make_pair(vertex_->gid,ts)]=std::make_pair(maybe_properties,maybe_labels);
-          }
+      if(VertexAnchorDue(vertex_,config_)){
+        // save edge to restore properties
+        if(AnchorFlag){
+          auto maybe_labels = vertex_->labels;
+          auto maybe_properties = vertex_->properties.Properties();
+          ts = before_delta->commit_timestamp;
+          transaction_->gid_anchor_vertex_[std::make_pair(vertex_->gid,ts)]=std::make_pair(maybe_properties,maybe_labels);
         }
-      }else{
       }
       printf=true;
     }
@@ -162,6 +152,7 @@ Result<bool> VertexAccessor::AddLabel(LabelId label) {
   if (std::find(vertex_->labels.begin(), vertex_->labels.end(), label) != vertex_->labels.end()) return false;
 
   auto delta=CreateAndLinkDelta(transaction_, vertex_, Delta::RemoveLabelTag(), label);
+  RecordAnchorDelta(vertex_->anchor,sizeof(LabelId));
 
   vertex_->labels.push_back(label);
 
@@ -209,13 +200,11 @@ Result<bool> VertexAccessor::RemoveLabel(LabelId label) {
         return Error::SERIALIZATION_ERROR;
       }
     }else{
-      vertex_->num+=1;
-      if(vertex_->num>config_.AnchorNum){
-        vertex_->num=1;
+      if(VertexAnchorDue(vertex_,config_)){
         if(AnchorFlag){
           auto maybe_labels = vertex_->labels;
           auto maybe_properties = vertex_->properties.Properties();
-           ts = before_delta->commit_timestamp;
+          ts = before_delta->commit_timestamp;
           transaction_->gid_anchor_vertex_[std::make_pair(vertex_->gid,ts)]=std::make_pair(maybe_properties,maybe_labels);
         }
       }
@@ -235,6 +224,7 @@ Result<bool> VertexAccessor::RemoveLabel(LabelId label) {
   if (it == vertex_->labels.end()) return false;
 
   auto delta=CreateAndLinkDelta(transaction_, vertex_, Delta::AddLabelTag(), label);
+  RecordAnchorDelta(vertex_->anchor,sizeof(LabelId));
 
   //aeong set for transaction
   transaction_->v_changed.insert(vertex_->gid);
@@ -377,17 +367,13 @@ Result<PropertyValue> VertexAccessor::SetProperty(PropertyId property, const Pro
         return Error::SERIALIZATION_ERROR;
       }
     }else{
-      if(!MultipleAnchorFlag){//constant anchor num
-        if(vertex_->num>config_.AnchorNum){
-          vertex_->num=1;
-          if(AnchorFlag){
-            auto maybe_labels = vertex_->labels;
-            auto maybe_properties = vertex_->properties.Properties();
-            ts = before_delta->commit_timestamp;
-            transaction_->gid_anchor_vertex_[std::make_pair(vertex_->gid,ts)]=std::make_pair(maybe_properties,maybe_labels);
-          }
+      if(VertexAnchorDue(vertex_,config_)){
+        if(AnchorFlag){
+          auto maybe_labels = vertex_->labels;
+          auto maybe_properties = vertex_->properties.Properties();
+          ts = before_delta->commit_timestamp;
+          transaction_->gid_anchor_vertex_[std::make_pair(vertex_->gid,ts)]=std::make_pair(maybe_properties,maybe_labels);
         }
-      }else{
       }
       printf=true;
     }
@@ -409,7 +395,7 @@ Result<PropertyValue> VertexAccessor::SetProperty(PropertyId property, const Pro
   // transactions get a SERIALIZATION_ERROR.
   auto delta=CreateAndLinkDelta(transaction_, vertex_, Delta::SetPropertyTag(), property, current_value);
   vertex_->properties.SetProperty(property, value);
-  vertex_->num+=1;
+  RecordAnchorDelta(vertex_->anchor,EncodedPropertySize(property,current_value));
 
   //aeong set for transaction
   transaction_->v_changed.insert(vertex_->gid);
@@ -454,9 +440,7 @@ Result<std::map<PropertyId, PropertyValue>> VertexAccessor::ClearProperties() {
         return Error::SERIALIZATION_ERROR;
       }
     }else{
-        vertex_->num+=1;
-      if(vertex_->num>config_.AnchorNum){
-        vertex_->num=1;
+      if(VertexAnchorDue(vertex_,config_)){
         // save edge to restore properties
         if(AnchorFlag){
           auto maybe_labels = vertex_->labels;
@@ -479,6 +463,7 @@ Result<std::map<PropertyId, PropertyValue>> VertexAccessor::ClearProperties() {
   auto properties = vertex_->properties.Properties();
   for (const auto &property : properties) {
     auto delta=CreateAndLinkDelta(transaction_, vertex_, Delta::SetPropertyTag(), property.first, property.second);
+    RecordAnchorDelta(vertex_->anchor,EncodedPropertySize(property.first,property.second));
     //set for aeong
     delta->transaction_st = ts;
     UpdateOnSetProperty(indices_, property.first, PropertyValue(), vertex_, *transaction_);
@@ -518,6 +503,16 @@ Delta *VertexAccessor::getDeltas(){
   return vertex_->delta;
 }
 
+void VertexAccessor::RecordHistoryRead() {
+  std::lock_guard<utils::SpinLock> guard(vertex_->lock);
+  RecordAnchorRead(vertex_->anchor);
+}
+
+AnchorStats VertexAccessor::GetAnchorStats() const {
+  std::lock_guard<utils::SpinLock> guard(vertex_->lock);
+  return vertex_->anchor;
+}
+
 
 Result<PropertyValue> VertexAccessor::GetProperty(PropertyId property, View view) const {
   bool exists = true;
@@ -80,6 +80,13 @@ class VertexAccessor final {
   bool haslabels();
   void propsizes();
   Delta *getDeltas();
+
+  /// Accounts for a historical read of the vertex, used to place its anchors.
+  void RecordHistoryRead();
+
+  /// Returns the statistics used to place the anchors of the vertex.
+  AnchorStats GetAnchorStats() const;
+
   std::map<PropertyId, PropertyValue> getProperties(){return vertex_->properties.Properties();}
   uint64_t transaction_st() const noexcept{return vertex_->transaction_st;}
   uint64_t tt_te(){return (uint64_t)std::numeric_limits<int64_t>::max();}
@@ -13,10 +13,20 @@
 
 #pragma once
 
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <mutex>
 #include <optional>
+#include <set>
 #include <unordered_map>
+#include <utility>
+#include <vector>
 
 #include "utils/logging.hpp"
+#include "utils/spin_lock.hpp"
 
 namespace utils {
 namespace impl {
@@ -153,6 +163,19 @@ class LruCache {
     access_map_.emplace(key, page);
   }
 
+  /// Removes the least recently used element and returns it, or nullopt if
+  /// the cache is empty.
+  std::optional<std::pair<TKey, TValue>> PopLeastRecent() {
+    auto *rear = lru_order_.Rear();
+    if (!rear) return std::nullopt;
+    std::pair<TKey, TValue> result{rear->key, std::move(rear->value)};
+    access_map_.erase(result.first);
+    lru_order_.RemoveRearPage();
+    return result;
+  }
+
+  size_t Size() const { return access_map_.size(); }
+
   void Clear() {
     access_map_.clear();
     lru_order_.Clear();
@@ -164,6 +187,132 @@ class LruCache {
   std::unordered_map<TKey, impl::Node<TKey, TValue> *> access_map_;
 };
 
+/// Thread safe cache bounded by the total size of its values. Keys are spread
+/// over shards, each guarded by its own lock and holding an equal share of the
+/// byte budget, and every shard evicts its least recently used elements once
+/// its share is exceeded. Each shard also keeps its keys ordered, so the
+/// closest key not greater than a given one can be looked up.
+///
+/// @tparam TKey - any object that has hash() and operator< defined
+/// @tparam TValue - any copyable object, values are returned by copy
+/// @tparam TShardHash - hash used to pick the shard of a key, keys which should
+///                      be ordered with respect to each other must share it
+template <typename TKey, typename TValue, typename TShardHash = std::hash<TKey>>
+class ShardedLruCache {
+ public:
+  struct Stats {
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t evictions;
+    uint64_t bytes;
+  };
+
+  ShardedLruCache(size_t shard_count, uint64_t byte_budget)
+      : shards_(std::max<size_t>(shard_count, 1)), shard_budget_(byte_budget / shards_.size()) {}
+
+  ShardedLruCache(const ShardedLruCache &) = delete;
+  ShardedLruCache(ShardedLruCache &&) = delete;
+  ShardedLruCache &operator=(const ShardedLruCache &) = delete;
+  ShardedLruCache &operator=(ShardedLruCache &&) = delete;
+  ~ShardedLruCache() = default;
+
+  std::optional<TValue> Find(const TKey &key) {
+    auto &shard = ShardOf(key);
+    std::lock_guard<utils::SpinLock> guard(shard.lock);
+    auto found = shard.elements.Find(key);
+    CountLookup(found.has_value());
+    if (!found) return std::nullopt;
+    return std::move(found->value);
+  }
+
+  /// Returns the element with the greatest key not greater than `key`, looked
+  /// up in the shard of `key`.
+  std::optional<std::pair<TKey, TValue>> FindFloor(const TKey &key) {
+    auto &shard = ShardOf(key);
+    std::lock_guard<utils::SpinLock> guard(shard.lock);
+    auto it = shard.keys.upper_bound(key);
+    if (it == shard.keys.begin()) {
+      CountLookup(false);
+      return std::nullopt;
+    }
+    --it;
+    auto found = shard.elements.Find(*it);
+    CountLookup(found.has_value());
+    if (!found) return std::nullopt;
+    return std::make_pair(*it, std::move(found->value));
+  }
+
+  /// Inserts the element, accounting `bytes` for it, and returns the number of
+  /// elements evicted to make room for it. Elements larger than a shard's
+  /// share of the budget aren't cached.
+  uint64_t Insert(const TKey &key, const TValue &value, uint64_t bytes) {
+    if (bytes > shard_budget_) return 0;
+    auto &shard = ShardOf(key);
+    std::lock_guard<utils::SpinLock> guard(shard.lock);
+    if (auto old = shard.elements.Find(key)) {
+      shard.bytes -= old->bytes;
+      bytes_.fetch_sub(old->bytes, std::memory_order_relaxed);
+    }
+    shard.elements.Insert(key, Element{value, bytes});
+    shard.keys.insert(key);
+    shard.bytes += bytes;
+    bytes_.fetch_add(bytes, std::memory_order_relaxed);
+    uint64_t evicted = 0;
+    while (shard.bytes > shard_budget_) {
+      auto rear = shard.elements.PopLeastRecent();
+      MG_ASSERT(rear, "The cache shard is over its budget without elements!");
+      shard.keys.erase(rear->first);
+      shard.bytes -= rear->second.bytes;
+      bytes_.fetch_sub(rear->second.bytes, std::memory_order_relaxed);
+      ++evicted;
+    }
+    evictions_.fetch_add(evicted, std::memory_order_relaxed);
+    return evicted;
+  }
+
+  void Clear() {
+    for (auto &shard : shards_) {
+      std::lock_guard<utils::SpinLock> guard(shard.lock);
+      bytes_.fetch_sub(shard.bytes, std::memory_order_relaxed);
+      shard.elements.Clear();
+      shard.keys.clear();
+      shard.bytes = 0;
+    }
+  }
+
+  Stats GetStats() const {
+    return {hits_.load(std::memory_order_relaxed), misses_.load(std::memory_order_relaxed),
+            evictions_.load(std::memory_order_relaxed), bytes_.load(std::memory_order_relaxed)};
+  }
+
+ private:
+  struct Element {
+    TValue value;
+    uint64_t bytes;
+  };
+
+  struct Shard {
+    // The capacity is never reached, elements are evicted by size.
+    Shard() : elements(std::numeric_limits<size_t>::max()) {}
+
+    utils::SpinLock lock;
+    LruCache<TKey, Element> elements;
+    std::set<TKey> keys;
+    uint64_t bytes{0};
+  };
+
+  Shard &ShardOf(const TKey &key) { return shards_[TShardHash{}(key) % shards_.size()]; }
+
+  void CountLookup(bool hit) { (hit ? hits_ : misses_).fetch_add(1, std::memory_order_relaxed); }
+
+  std::vector<Shard> shards_;
+  uint64_t shard_budget_;
+  std::atomic<uint64_t> hits_{0};
+  std::atomic<uint64_t> misses_{0};
+  std::atomic<uint64_t> evictions_{0};
+  std::atomic<uint64_t> bytes_{0};
+};
+
 /// Used for caching objects. Uses least recently used page replacement
 /// algorithm for evicting elements when maximum size is reached. This class
 /// is NOT thread safe.
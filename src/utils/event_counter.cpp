@@ -25,6 +25,11 @@
   M(ScanAllByLabelPropertyValueOperator, "Number of times ScanAllByLabelPropertyValue operator was used.") \
   M(ScanAllByLabelPropertyOperator, "Number of times ScanAllByLabelProperty operator was used.")           \
   M(ScanAllByIdOperator, "Number of times ScanAllById operator was used.")                                 \
+  M(ScanAllByTimeOperator, "Number of times ScanAllByTime operator was used.")                             \
+  M(ScanAllByLabelByTimeOperator, "Number of times ScanAllByLabelByTime operator was used.")               \
+  M(ScanAllByLabelPropertyValueByTimeOperator,                                                             \
+    "Number of times ScanAllByLabelPropertyValueByTime operator was used.")                                \
+  M(ScanAllByValidTimeOperator, "Number of times ScanAllByValidTime operator was used.")                   \
   M(ExpandOperator, "Number of times Expand operator was used.")                                           \
   M(ExpandVariableOperator, "Number of times ExpandVariable operator was used.")                           \
   M(ConstructNamedPathOperator, "Number of times ConstructNamedPath operator was used.")                   \
@@ -39,6 +44,7 @@
   M(EdgeUniquenessFilterOperator, "Number of times EdgeUniquenessFilter operator was used.")               \
   M(AccumulateOperator, "Number of times Accumulate operator was used.")                                   \
   M(AggregateOperator, "Number of times Aggregate operator was used.")                                     \
+  M(AggregateByTimeOperator, "Number of times AggregateByTime operator was used.")                         \
   M(SkipOperator, "Number of times Skip operator was used.")                                               \
   M(LimitOperator, "Number of times Limit operator was used.")                                             \
   M(OrderByOperator, "Number of times OrderBy operator was used.")                                         \
@@ -56,7 +62,13 @@
   M(StreamsCreated, "Number of Streams created.")                                                          \
   M(MessagesConsumed, "Number of consumed streamed messages.")                                             \
   M(TriggersCreated, "Number of Triggers created.")                                                        \
-  M(TriggersExecuted, "Number of Triggers executed.")
+  M(TriggersExecuted, "Number of Triggers executed.")                                                      \
+                                                                                                           \
+  M(HistoryProbes, "Number of object history lookups in the historical store.")                            \
+  M(HistoryProbesAvoided, "Number of object history lookups skipped by the history time tables.")          \
+  M(HistoryCacheHits, "Number of history windows answered by the history cache.")                          \
+  M(HistoryCacheMisses, "Number of history windows not answered by the history cache.")                    \
+  M(HistoryCacheEvictions, "Number of versions evicted from the history cache.")
 
 namespace EventCounter {
 
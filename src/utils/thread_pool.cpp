@@ -11,6 +11,9 @@
 
 #include "utils/thread_pool.hpp"
 
+#include <algorithm>
+#include <exception>
+
 namespace utils {
 
 ThreadPool::ThreadPool(const size_t pool_size) {
@@ -87,4 +90,29 @@ void ThreadPool::ThreadLoop() {
 
 size_t ThreadPool::UnfinishedTasksNum() const { return unfinished_tasks_num_.load(); }
 
+void RunRanges(ThreadPool *pool, const size_t size, size_t ranges, const std::function<void(size_t, size_t)> &func) {
+  ranges = std::min(ranges, size);
+  if (ranges == 0) return;
+  std::mutex done_lock;
+  std::condition_variable done_cv;
+  size_t remaining = ranges;
+  std::exception_ptr error;
+  for (size_t range = 0; range < ranges; ++range) {
+    pool->AddTask([&, begin = size * range / ranges, end = size * (range + 1) / ranges] {
+      std::exception_ptr range_error;
+      try {
+        func(begin, end);
+      } catch (...) {
+        range_error = std::current_exception();
+      }
+      std::lock_guard<std::mutex> guard(done_lock);
+      if (range_error && !error) error = range_error;
+      if (--remaining == 0) done_cv.notify_one();
+    });
+  }
+  std::unique_lock<std::mutex> guard(done_lock);
+  done_cv.wait(guard, [&] { return remaining == 0; });
+  if (error) std::rethrow_exception(error);
+}
+
 }  // namespace utils
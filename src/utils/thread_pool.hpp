@@ -12,6 +12,7 @@
 #pragma once
 #include <atomic>
 #include <condition_variable>
+#include <cstddef>
 #include <functional>
 #include <mutex>
 #include <queue>
@@ -57,4 +58,10 @@ class ThreadPool {
   std::condition_variable queue_cv_;
 };
 
+/// Splits [0, size) into at most `ranges` contiguous ranges of about the same
+/// length, calls `func(begin, end)` for each of them on the pool and waits
+/// until all of them returned. The first exception thrown by a range is
+/// rethrown once all ranges are done.
+void RunRanges(ThreadPool *pool, size_t size, size_t ranges, const std::function<void(size_t, size_t)> &func);
+
 }  // namespace utils
@@ -0,0 +1,127 @@
+// Copyright 2021 Memgraph Ltd.
+//
+// Use of this software is governed by the Business Source License
+// included in the file licenses/BSL.txt; by using this file, you agree to be bound by the terms of the Business Source
+// License, and you may not use this file except in compliance with the Business Source License.
+//
+// As of the Change Date specified in that file, in accordance with
+// the Business Source License, use of this software will be governed
+// by the Apache License, Version 2.0, included in the file
+// licenses/APL.txt.
+
+#include <algorithm>
+#include <memory>
+#include <optional>
+#include <random>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "common/history_store.hpp"
+
+// Historical point lookups against a history store holding `kVertexCount`
+// vertices with `state.range(0)` versions each. Every version lasts
+// `kVersionLength` timestamps and every `kAnchorInterval`-th version gets an
+// anchor, like the default anchor interval of the storage.
+constexpr uint64_t kVertexCount = 1000;
+constexpr uint64_t kVersionLength = 10;
+constexpr uint64_t kAnchorInterval = 10;
+
+class HistoryLookup : public benchmark::Fixture {
+ protected:
+  void SetUp(const benchmark::State &state) override {
+    versions_ = state.range(0);
+    store_.emplace("MG_benchmark_history_lookup", config_);
+    history_ = &**store_;
+    auto property = store_->Property("value");
+    for (uint64_t gid = 0; gid < kVertexCount; ++gid) {
+      for (uint64_t version = 0; version < versions_; ++version) {
+        auto start = version * kVersionLength + 1;
+        store_->SaveProperty(gid, start, start + kVersionLength, property,
+                             storage::PropertyValue(static_cast<int64_t>(version)));
+        if (version % kAnchorInterval == 0) {
+          history_->SaveVertexAnchor(storage::Gid::FromUint(gid), start, {},
+                                     {{property, storage::PropertyValue(static_cast<int64_t>(version))}});
+        }
+      }
+      history_->SaveDeltaAll();
+    }
+  }
+
+  void TearDown(const benchmark::State &) override { store_.reset(); }
+
+  uint64_t versions_{0};
+  storage::Config::History config_{test::SynchronousHistoryConfig()};
+  std::optional<test::HistoryStore> store_;
+  history_delta::History_delta *history_{nullptr};
+};
+
+// Same as `HistoryLookup` with `state.range(2)` scan threads.
+class HistoryScan : public HistoryLookup {
+ protected:
+  void SetUp(const benchmark::State &state) override {
+    config_.scan_threads = state.range(2);
+    HistoryLookup::SetUp(state);
+  }
+};
+
+BENCHMARK_DEFINE_F(HistoryLookup, AsOf)(benchmark::State &state) {
+  std::mt19937_64 gen(42);
+  std::uniform_int_distribution<uint64_t> gids(0, kVertexCount - 1);
+  std::uniform_int_distribution<uint64_t> timestamps(1, versions_ * kVersionLength);
+  for (auto _ : state) {
+    auto ts = timestamps(gen);
+    benchmark::DoNotOptimize(history_->GetVertexInfo(storage::Gid::FromUint(gids(gen)), ts, ts, "as of"));
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK_DEFINE_F(HistoryLookup, FromTo)(benchmark::State &state) {
+  std::mt19937_64 gen(42);
+  std::uniform_int_distribution<uint64_t> gids(0, kVertexCount - 1);
+  std::uniform_int_distribution<uint64_t> timestamps(1, versions_ * kVersionLength);
+  for (auto _ : state) {
+    auto ts = timestamps(gen);
+    auto te = ts + kAnchorInterval * kVersionLength;
+    benchmark::DoNotOptimize(history_->GetVertexInfo(storage::Gid::FromUint(gids(gen)), ts, te, "from to"));
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+// Looks up all vertices as of one timestamp, `state.range(1)` vertices at a
+// time, like a temporal scan with that batch size does.
+BENCHMARK_DEFINE_F(HistoryScan, ScanBatch)(benchmark::State &state) {
+  std::mt19937_64 gen(42);
+  std::uniform_int_distribution<uint64_t> timestamps(1, versions_ * kVersionLength);
+  const auto batch_size = static_cast<uint64_t>(state.range(1));
+  std::vector<storage::Gid> gids;
+  for (auto _ : state) {
+    auto ts = timestamps(gen);
+    for (uint64_t gid = 0; gid < kVertexCount; gid += batch_size) {
+      gids.clear();
+      for (auto batch_gid = gid; batch_gid < std::min(gid + batch_size, kVertexCount); ++batch_gid) {
+        gids.push_back(storage::Gid::FromUint(batch_gid));
+      }
+      benchmark::DoNotOptimize(history_->GetVerticesInfo(gids, ts, ts, "as of"));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * kVertexCount);
+}
+
+BENCHMARK_REGISTER_F(HistoryLookup, AsOf)->RangeMultiplier(4)->Range(4, 256)->Unit(benchmark::kMicrosecond);
+
+BENCHMARK_REGISTER_F(HistoryLookup, FromTo)->RangeMultiplier(4)->Range(4, 256)->Unit(benchmark::kMicrosecond);
+
+// The batch sizes run on a single scan thread, the scan threads with large
+// batches.
+BENCHMARK_REGISTER_F(HistoryScan, ScanBatch)
+    ->Apply([](benchmark::internal::Benchmark *bench) {
+      for (int64_t versions : {16, 256}) {
+        for (int64_t batch_size : {1, 16, 256, 1024, 4096}) bench->Args({versions, batch_size, 1});
+      }
+      for (int64_t threads : {2, 4, 8, 16, 32}) bench->Args({256, 4096, threads});
+    })
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
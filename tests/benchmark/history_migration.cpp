@@ -0,0 +1,76 @@
+// Copyright 2021 Memgraph Ltd.
+//
+// Use of this software is governed by the Business Source License
+// included in the file licenses/BSL.txt; by using this file, you agree to be bound by the terms of the Business Source
+// License, and you may not use this file except in compliance with the Business Source License.
+//
+// As of the Change Date specified in that file, in accordance with
+// the Business Source License, use of this software will be governed
+// by the Apache License, Version 2.0, included in the file
+// licenses/APL.txt.
+
+#include <optional>
+#include <string>
+
+#include <benchmark/benchmark.h>
+
+#include "common/history_store.hpp"
+#include "storage/v2/history_record.hpp"
+
+// Migrates GC cycles of `kCycleVertices` property changes, one per vertex,
+// with `state.range(0)` migration threads, like
+// `--history-migration-threads`. Every iteration collects one cycle and
+// measures how long it takes to encode and write it.
+constexpr uint64_t kCycleVertices = 10000;
+constexpr uint64_t kValueSize = 100;
+
+class HistoryMigration : public benchmark::Fixture {
+ protected:
+  void SetUp(const benchmark::State &state) override {
+    storage::Config::History config;
+    config.migration_threads = state.range(0);
+    store_.emplace("MG_benchmark_history_migration", config);
+    history_ = &**store_;
+    property_ = store_->Property("value");
+  }
+
+  void TearDown(const benchmark::State &) override { store_.reset(); }
+
+  storage::PropertyId property_;
+  std::optional<test::HistoryStore> store_;
+  history_delta::History_delta *history_{nullptr};
+};
+
+BENCHMARK_DEFINE_F(HistoryMigration, WriteCycle)(benchmark::State &state) {
+  const storage::PropertyValue value(std::string(kValueSize, 'x'));
+  uint64_t start = 1;
+  uint64_t bytes = 0;
+  for (auto _ : state) {
+    state.PauseTiming();
+    for (uint64_t gid = 0; gid < kCycleVertices; ++gid) {
+      store_->SaveProperty(gid, start, start + 1, property_, value);
+      // The size of the record as the migration writes it, the anchor key has
+      // the length of the delta key.
+      history_delta::HistoryRecord record;
+      record.tt_ts = start;
+      record.tt_te = start + 1;
+      record.properties.emplace(property_, value);
+      bytes += history_->getPrefix(storage::Gid::FromUint(gid), start, true).size() +
+               history_delta::EncodeRecord(record).size();
+    }
+    start += 2;
+    state.ResumeTiming();
+    history_->SaveDeltaAll();
+    history_->WaitForMigration();
+  }
+  state.SetItemsProcessed(state.iterations() * kCycleVertices);
+  state.SetBytesProcessed(bytes);
+}
+
+BENCHMARK_REGISTER_F(HistoryMigration, WriteCycle)
+    ->RangeMultiplier(2)
+    ->Range(1, 32)
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,167 @@
+// Copyright 2021 Memgraph Ltd.
+//
+// Use of this software is governed by the Business Source License
+// included in the file licenses/BSL.txt; by using this file, you agree to be bound by the terms of the Business Source
+// License, and you may not use this file except in compliance with the Business Source License.
+//
+// As of the Change Date specified in that file, in accordance with
+// the Business Source License, use of this software will be governed
+// by the Apache License, Version 2.0, included in the file
+// licenses/APL.txt.
+
+#include <random>
+#include <string>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+#include <json/json.hpp>
+
+#include "storage/v2/history_record.hpp"
+#include "storage/v2/name_id_mapper.hpp"
+
+namespace storage {
+nlohmann::json SerializePropertyValue(const PropertyValue &property_value);
+}  // namespace storage
+
+// Encodes and decodes the same history records in the binary format and in
+// the JSON format written before it. Every record holds `state.range(0)`
+// property changes, every fourth record also a label change and every eighth
+// one an added edge, like the records of a vertex delta.
+constexpr uint64_t kRecordCount = 1000;
+
+// The JSON layout of a record, as written by `SaveDelta` before the binary
+// format replaced it.
+nlohmann::json LegacyJson(const history_delta::HistoryRecord &record, storage::NameIdMapper *name_id_mapper) {
+  auto data = nlohmann::json::object();
+  if (!record.properties.empty()) {
+    auto properties = nlohmann::json::object();
+    for (const auto &[property, value] : record.properties) {
+      properties[name_id_mapper->IdToName(property.AsUint())] = storage::SerializePropertyValue(value);
+    }
+    data["SP"] = properties;
+  }
+  if (!record.labels.empty()) {
+    auto labels = std::vector<std::pair<std::string, std::string>>();
+    for (const auto &[action, label] : record.labels) {
+      labels.emplace_back(action == history_delta::LabelAction::ADD ? "AL" : "RL",
+                          name_id_mapper->IdToName(label.AsUint()));
+    }
+    data["L"] = labels;
+  }
+  for (const auto &[edge_gid, edge] : record.edges) {
+    auto edge_data = nlohmann::json::object();
+    edge_data["Type"] = edge.out ? "AOE" : "AIE";
+    edge_data["edgeType"] = name_id_mapper->IdToName(edge.edge_type.AsUint());
+    edge_data["edgeId"] = edge_gid;
+    edge_data["fromGid"] = edge.from_gid.AsUint();
+    edge_data["toGid"] = edge.to_gid.AsUint();
+    data[std::to_string(edge_gid)] = edge_data;
+  }
+  data["TT_TS"] = record.tt_ts;
+  data["TT_TE"] = record.tt_te;
+  return data;
+}
+
+class HistoryRecordFormat : public benchmark::Fixture {
+ protected:
+  void SetUp(const benchmark::State &state) override {
+    std::mt19937_64 gen(42);
+    std::uniform_int_distribution<int64_t> values(0, 1000000);
+    auto label = storage::LabelId::FromUint(name_id_mapper_.NameToId("Person"));
+    auto edge_type = storage::EdgeTypeId::FromUint(name_id_mapper_.NameToId("KNOWS"));
+    std::vector<storage::PropertyId> properties;
+    for (int64_t i = 0; i < state.range(0); ++i) {
+      properties.push_back(storage::PropertyId::FromUint(name_id_mapper_.NameToId("property" + std::to_string(i))));
+    }
+    records_.clear();
+    for (uint64_t i = 0; i < kRecordCount; ++i) {
+      history_delta::HistoryRecord record;
+      record.tt_ts = i * 10 + 1;
+      record.tt_te = i * 10 + 11;
+      for (size_t j = 0; j < properties.size(); ++j) {
+        // Integers, doubles and strings in turn.
+        switch (j % 3) {
+          case 0:
+            record.properties.emplace(properties[j], storage::PropertyValue(values(gen)));
+            break;
+          case 1:
+            record.properties.emplace(properties[j], storage::PropertyValue(values(gen) / 7.0));
+            break;
+          default:
+            record.properties.emplace(properties[j], storage::PropertyValue("value" + std::to_string(values(gen))));
+        }
+      }
+      if (i % 4 == 0) record.labels.emplace_back(history_delta::LabelAction::ADD, label);
+      if (i % 8 == 0) {
+        record.edges.emplace(i, history_delta::HistoryEdgeEntry{true, edge_type, storage::Gid::FromUint(i),
+                                                                storage::Gid::FromUint(i + 1)});
+      }
+      records_.push_back(std::move(record));
+    }
+    binary_.clear();
+    json_.clear();
+    for (const auto &record : records_) {
+      binary_.push_back(history_delta::EncodeRecord(record));
+      json_.push_back(LegacyJson(record, &name_id_mapper_).dump());
+    }
+  }
+
+  // Bytes of one format, reported as the size of an average record.
+  static uint64_t TotalSize(const std::vector<std::string> &encoded) {
+    uint64_t size = 0;
+    for (const auto &data : encoded) size += data.size();
+    return size;
+  }
+
+  void Report(benchmark::State &state, const std::vector<std::string> &encoded) const {
+    auto size = TotalSize(encoded);
+    state.SetItemsProcessed(state.iterations() * kRecordCount);
+    state.SetBytesProcessed(state.iterations() * size);
+    state.counters["bytes_per_record"] = static_cast<double>(size) / kRecordCount;
+  }
+
+  storage::NameIdMapper name_id_mapper_;
+  std::vector<history_delta::HistoryRecord> records_;
+  std::vector<std::string> binary_;
+  std::vector<std::string> json_;
+};
+
+BENCHMARK_DEFINE_F(HistoryRecordFormat, EncodeBinary)(benchmark::State &state) {
+  for (auto _ : state) {
+    for (const auto &record : records_) benchmark::DoNotOptimize(history_delta::EncodeRecord(record));
+  }
+  Report(state, binary_);
+}
+
+BENCHMARK_DEFINE_F(HistoryRecordFormat, EncodeJson)(benchmark::State &state) {
+  for (auto _ : state) {
+    for (const auto &record : records_) benchmark::DoNotOptimize(LegacyJson(record, &name_id_mapper_).dump());
+  }
+  Report(state, json_);
+}
+
+BENCHMARK_DEFINE_F(HistoryRecordFormat, DecodeBinary)(benchmark::State &state) {
+  for (auto _ : state) {
+    for (const auto &data : binary_) benchmark::DoNotOptimize(history_delta::DecodeRecord(data));
+  }
+  Report(state, binary_);
+}
+
+BENCHMARK_DEFINE_F(HistoryRecordFormat, DecodeJson)(benchmark::State &state) {
+  for (auto _ : state) {
+    for (const auto &data : json_) {
+      benchmark::DoNotOptimize(history_delta::DecodeLegacyRecord(data, &name_id_mapper_));
+    }
+  }
+  Report(state, json_);
+}
+
+BENCHMARK_REGISTER_F(HistoryRecordFormat, EncodeBinary)->RangeMultiplier(4)->Range(1, 64)->Unit(benchmark::kMicrosecond);
+
+BENCHMARK_REGISTER_F(HistoryRecordFormat, EncodeJson)->RangeMultiplier(4)->Range(1, 64)->Unit(benchmark::kMicrosecond);
+
+BENCHMARK_REGISTER_F(HistoryRecordFormat, DecodeBinary)->RangeMultiplier(4)->Range(1, 64)->Unit(benchmark::kMicrosecond);
+
+BENCHMARK_REGISTER_F(HistoryRecordFormat, DecodeJson)->RangeMultiplier(4)->Range(1, 64)->Unit(benchmark::kMicrosecond);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,71 @@
+// Copyright 2021 Memgraph Ltd.
+//
+// Use of this software is governed by the Business Source License
+// included in the file licenses/BSL.txt; by using this file, you agree to be bound by the terms of the Business Source
+// License, and you may not use this file except in compliance with the Business Source License.
+//
+// As of the Change Date specified in that file, in accordance with
+// the Business Source License, use of this software will be governed
+// by the Apache License, Version 2.0, included in the file
+// licenses/APL.txt.
+
+#include <optional>
+#include <string>
+
+#include <benchmark/benchmark.h>
+
+#include "common/history_store.hpp"
+
+// Reconstruction of a single vertex with `state.range(0)` versions and no
+// anchors. Every version sets one of `kPropertyCount` properties, so reading
+// the oldest version replays the whole chain onto a growing state.
+constexpr uint64_t kPropertyCount = 100;
+constexpr uint64_t kVersionLength = 10;
+
+class HistoryReplay : public benchmark::Fixture {
+ protected:
+  void SetUp(const benchmark::State &state) override {
+    versions_ = state.range(0);
+    store_.emplace("MG_benchmark_history_replay");
+    history_ = &**store_;
+    for (uint64_t version = 0; version < versions_; ++version) {
+      auto property = store_->Property("property" + std::to_string(version % kPropertyCount));
+      auto start = version * kVersionLength + 1;
+      store_->SaveProperty(0, start, start + kVersionLength, property,
+                           storage::PropertyValue(static_cast<int64_t>(version)));
+    }
+    history_->SaveDeltaAll();
+  }
+
+  void TearDown(const benchmark::State &) override { store_.reset(); }
+
+  uint64_t versions_{0};
+  std::optional<test::HistoryStore> store_;
+  history_delta::History_delta *history_{nullptr};
+};
+
+BENCHMARK_DEFINE_F(HistoryReplay, Oldest)(benchmark::State &state) {
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(history_->GetVertexInfo(storage::Gid::FromUint(0), 1, 1, "as of"));
+  }
+  state.SetItemsProcessed(state.iterations() * versions_);
+}
+
+BENCHMARK_DEFINE_F(HistoryReplay, All)(benchmark::State &state) {
+  for (auto _ : state) {
+    uint64_t count = 0;
+    history_->ForEachVertexVersion(storage::Gid::FromUint(0), 1, versions_ * kVersionLength, "from to",
+                                   [&count](history_delta::HistoryRecord &&) {
+                                     ++count;
+                                     return true;
+                                   });
+    benchmark::DoNotOptimize(count);
+  }
+  state.SetItemsProcessed(state.iterations() * versions_);
+}
+
+BENCHMARK_REGISTER_F(HistoryReplay, Oldest)->RangeMultiplier(10)->Range(100, 10000)->Unit(benchmark::kMillisecond);
+
+BENCHMARK_REGISTER_F(HistoryReplay, All)->RangeMultiplier(10)->Range(100, 10000)->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,101 @@
+import argparse
+import json
+import os
+import sys
+sys.path.append('../../mgbench')
+import helpers
+import runners
+from neo4j import GraphDatabase
+
+# Read counters of the historical storage reported by SHOW STORAGE INFO.
+COUNTERS = ["history_block_cache_hits", "history_block_cache_misses", "history_bloom_filter_useful"]
+
+# Historical storage configurations which are compared. Compression only
+# applies to the files written after a configuration is chosen, so the counters
+# mostly reflect the column families, filters and block cache.
+CONFIGS = {
+    "tuned": {"history_column_families": True, "history_bloom_bits_per_key": 10,
+              "history_block_cache_size_mib": 512, "history_compression": "lz4",
+              "history_bottommost_compression": "zstd"},
+    "baseline": {"history_column_families": False, "history_bloom_bits_per_key": 0,
+                 "history_block_cache_size_mib": 8, "history_compression": "none",
+                 "history_bottommost_compression": "none"},
+}
+
+
+def get_counters(port):
+    driver = GraphDatabase.driver("bolt://127.0.0.1:{}".format(port), auth=None, encrypted=False)
+    with driver.session() as session:
+        info = {row["storage info"]: row["value"] for row in session.run("SHOW STORAGE INFO").data()}
+    driver.close()
+    return {counter: info[counter] for counter in COUNTERS}
+
+
+def count_queries(file_path):
+    with open(file_path) as f:
+        return sum(1 for line in f if line.strip())
+
+
+def run_config(args, name, flags):
+    aeong = runners.Memgraph(args.aeong_binary, args.data_directory, not args.no_properties_on_edges,
+                             memgraph_port=args.port, snapshot_interval_sec=30, memory_limit=0, anchor_num=10,
+                             real_time_flag=False)
+    aeong.start_benchmark(history_statistics=True, **flags)
+    client = runners.Client(args.client_binary, args.data_directory, memgraph_port=args.port)
+    results = {}
+    for index in range(1, 7):
+        file_path = os.path.join(args.temporal_query_directory, "IS{}_cypher.txt".format(index))
+        if not os.path.exists(file_path):
+            print("Skipping IS{}, {} doesn't exist.".format(index, file_path))
+            continue
+        num_queries = count_queries(file_path)
+        before = get_counters(args.port)
+        ret = client.execute(file_path=file_path, num_workers=args.num_workers)
+        after = get_counters(args.port)
+        result = {"duration": ret[0]["duration"], "queries": num_queries}
+        for counter in COUNTERS:
+            result[counter + "_per_query"] = (after[counter] - before[counter]) / max(num_queries, 1)
+        results["IS{}".format(index)] = result
+        print(name, "IS{}".format(index), result)
+    aeong.stop()
+    return results
+
+
+if __name__ == "__main__":
+    # Parse options.
+    parser = argparse.ArgumentParser(
+        description="AeonG read amplification of the T-LDBC temporal queries.",
+        formatter_class=argparse.ArgumentDefaultsHelpFormatter)
+    parser.add_argument("--aeong-binary",
+                        default=helpers.get_binary_path("memgraph"),
+                        help="AeonG binary used for benchmarking")
+    parser.add_argument("--client-binary",
+                        default=helpers.get_binary_path("tests/mgbench/client"),
+                        help="client binary used for benchmarking")
+    parser.add_argument("--num-workers", type=int,
+                        default=1,
+                        help="number of workers used to execute the benchmark")
+    parser.add_argument("--port", type=int,
+                        default=7687,
+                        help="port of the database")
+    parser.add_argument("--data-directory",
+                        default=helpers.get_binary_path("../tests/results/database"),
+                        help="directory path of the temporal database")
+    parser.add_argument("--temporal-query-directory",
+                        default=helpers.get_binary_path("../tests/results/temporal_query"),
+                        help="directory path of the IS temporal queries written by create_temporal_query.py")
+    parser.add_argument("--no-properties-on-edges",
+                        action="store_true",
+                        help="disable properties on edges")
+    parser.add_argument("--configs", nargs="+",
+                        default=list(CONFIGS),
+                        choices=list(CONFIGS),
+                        help="historical storage configurations to compare")
+    parser.add_argument("--output",
+                        default="read_amplification.json",
+                        help="Filename to store the counters")
+
+    args = parser.parse_args()
+    results = {name: run_config(args, name, CONFIGS[name]) for name in args.configs}
+    with open(args.output, "w") as f:
+        json.dump(results, f, indent=2)
@@ -0,0 +1,92 @@
+import argparse
+import json
+import time
+from neo4j import GraphDatabase
+
+# Updates a numeric property of a share of the persons several times, so they
+# get many versions, then aggregates their versions in windows of transaction
+# time. Grouping by the person is answered one person at a time while its
+# versions are read, grouping by its id keeps the groups of all persons until
+# the scan ends, and the last query returns every version to the client.
+UPDATE_QUERY = "MATCH (p:Person) WHERE p.id % $modulo = 0 SET p.score = $score"
+PER_OBJECT_QUERY = ("MATCH (p:Person) WHERE p.id % {0} = 0 TT FROM {1} TO {2} "
+                    "WITH p, tt_window(p.score, {3}) AS windows RETURN count(*) AS groups, sum(size(windows)) AS windows")
+PER_ID_QUERY = ("MATCH (p:Person) WHERE p.id % {0} = 0 TT FROM {1} TO {2} "
+                "WITH p.id AS id, tt_window(p.score, {3}) AS windows RETURN count(*) AS groups, "
+                "sum(size(windows)) AS windows")
+VERSIONS_QUERY = "MATCH (p:Person) WHERE p.id % {0} = 0 TT FROM {1} TO {2} RETURN p.score AS score"
+
+
+def memory_usage(session):
+    info = {row["storage info"]: row["value"] for row in session.run("SHOW STORAGE INFO").data()}
+    return info["memory_usage"]
+
+
+def measure(session, query, repetitions):
+    durations = []
+    rows = []
+    before = memory_usage(session)
+    for _ in range(repetitions):
+        start = time.time()
+        rows = session.run(query).data()
+        durations.append(time.time() - start)
+    result = {"duration": sum(durations) / len(durations), "memory_delta": memory_usage(session) - before}
+    if len(rows) == 1 and "windows" in rows[0]:
+        result.update(rows[0])
+    else:
+        result["versions"] = len(rows)
+    return result
+
+
+if __name__ == "__main__":
+    # Parse options.
+    parser = argparse.ArgumentParser(
+        description="AeonG latency and memory of aggregating the versions of update-heavy T-LDBC persons in windows "
+                    "of transaction time.",
+        formatter_class=argparse.ArgumentDefaultsHelpFormatter)
+    parser.add_argument("--port", type=int,
+                        default=7687,
+                        help="port of the database")
+    parser.add_argument("--modulo", type=int,
+                        default=100,
+                        help="the persons whose id is divisible by the modulo are updated and aggregated")
+    parser.add_argument("--updates", type=int,
+                        default=100,
+                        help="number of updates of every aggregated person, 0 to use the existing history")
+    parser.add_argument("--min-time", type=int,
+                        default=0,
+                        help="start of the TT window")
+    parser.add_argument("--max-time", type=int,
+                        default=10000000,
+                        help="end of the TT window, the windows of a version may span at most a million widths")
+    parser.add_argument("--widths", type=int, nargs="+",
+                        required=True,
+                        help="widths of the windows the versions are aggregated in")
+    parser.add_argument("--repetitions", type=int,
+                        default=5,
+                        help="the durations of every query are averaged over the repetitions")
+    parser.add_argument("--output",
+                        default="temporal_aggregation.json",
+                        help="Filename to store the measurements")
+
+    args = parser.parse_args()
+    driver = GraphDatabase.driver("bolt://127.0.0.1:{}".format(args.port), auth=None, encrypted=False)
+    results = {}
+    with driver.session() as session:
+        for score in range(args.updates):
+            session.run(UPDATE_QUERY, modulo=args.modulo, score=score).consume()
+        results["versions"] = measure(session, VERSIONS_QUERY.format(args.modulo, args.min_time, args.max_time),
+                                      args.repetitions)
+        print("versions", results["versions"])
+        for width in args.widths:
+            result = {
+                "per_object": measure(session, PER_OBJECT_QUERY.format(args.modulo, args.min_time, args.max_time,
+                                                                       width), args.repetitions),
+                "per_id": measure(session, PER_ID_QUERY.format(args.modulo, args.min_time, args.max_time, width),
+                                  args.repetitions),
+            }
+            results["width={}".format(width)] = result
+            print(width, result)
+    driver.close()
+    with open(args.output, "w") as f:
+        json.dump(results, f, indent=2)
@@ -0,0 +1,115 @@
+import argparse
+import json
+import math
+import sys
+import time
+from neo4j import GraphDatabase
+
+# Declares a rollup of the score of the persons for every aggregate, updates
+# the score of a share of the persons several times and removes it again, so
+# the current versions don't hold a score. Once the garbage collector has
+# migrated the versions, every rollup has to return exactly the windows which
+# tt_window computes from the raw history over the same buckets.
+AGGREGATES = ["count", "sum", "min", "max", "avg"]
+CREATE_QUERY = "CREATE TEMPORAL ROLLUP {0} ON :Person(score) AS {1} EVERY {2}"
+DROP_QUERY = "DROP TEMPORAL ROLLUP {}"
+UPDATE_QUERY = "MATCH (p:Person) WHERE p.id % $modulo = 0 SET p.score = $score"
+REMOVE_QUERY = "MATCH (p:Person) WHERE p.score IS NOT NULL REMOVE p.score"
+ALL_BUCKETS_QUERY = "SHOW TEMPORAL ROLLUP {}"
+ROLLUP_QUERY = "SHOW TEMPORAL ROLLUP {0} TT FROM {1} TO {2}"
+RAW_QUERY = "MATCH (p:Person) TT FROM {0} TO {1} RETURN tt_window(p.score, {2}) AS windows"
+
+
+def rollup_name(aggregate):
+    return "score_{}".format(aggregate)
+
+
+def measure(session, query, repetitions):
+    durations = []
+    rows = []
+    for _ in range(repetitions):
+        start = time.time()
+        rows = session.run(query).data()
+        durations.append(time.time() - start)
+    return sum(durations) / len(durations), rows
+
+
+def same_value(expected, actual):
+    if isinstance(expected, float) or isinstance(actual, float):
+        return math.isclose(expected, actual, rel_tol=1e-9)
+    return expected == actual
+
+
+if __name__ == "__main__":
+    # Parse options.
+    parser = argparse.ArgumentParser(
+        description="AeonG consistency and latency of temporal rollups of T-LDBC persons, compared with aggregating "
+                    "their raw history.",
+        formatter_class=argparse.ArgumentDefaultsHelpFormatter)
+    parser.add_argument("--port", type=int,
+                        default=7687,
+                        help="port of the database")
+    parser.add_argument("--modulo", type=int,
+                        default=100,
+                        help="the persons whose id is divisible by the modulo are updated")
+    parser.add_argument("--updates", type=int,
+                        default=100,
+                        help="number of updates of every updated person")
+    parser.add_argument("--width", type=int,
+                        default=10,
+                        help="width of the buckets of the rollups")
+    parser.add_argument("--repetitions", type=int,
+                        default=5,
+                        help="the durations of every query are averaged over the repetitions")
+    parser.add_argument("--output",
+                        default="temporal_rollup.json",
+                        help="Filename to store the measurements")
+
+    args = parser.parse_args()
+    driver = GraphDatabase.driver("bolt://127.0.0.1:{}".format(args.port), auth=None, encrypted=False)
+    results = {}
+    mismatches = 0
+    with driver.session() as session:
+        existing = {row["rollup name"] for row in session.run("SHOW TEMPORAL ROLLUPS").data()}
+        for aggregate in AGGREGATES:
+            if rollup_name(aggregate) in existing:
+                session.run(DROP_QUERY.format(rollup_name(aggregate))).consume()
+            session.run(CREATE_QUERY.format(rollup_name(aggregate), aggregate, args.width)).consume()
+        for score in range(args.updates):
+            session.run(UPDATE_QUERY, modulo=args.modulo, score=score).consume()
+        session.run(REMOVE_QUERY).consume()
+        session.run("FREE MEMORY").consume()
+
+        rollups = {row["rollup name"]: row for row in session.run("SHOW TEMPORAL ROLLUPS").data()}
+        for aggregate in AGGREGATES:
+            # The buckets of a rollup start at its own since bound and end
+            # with the last migrated version, the raw windows are aligned with
+            # them.
+            since = rollups[rollup_name(aggregate)]["since"]
+            buckets = session.run(ALL_BUCKETS_QUERY.format(rollup_name(aggregate))).data()
+            if not buckets:
+                print(aggregate, "rollup holds no version")
+                mismatches += 1
+                continue
+            end = buckets[-1]["end"] - 1
+            duration, rows = measure(session, ROLLUP_QUERY.format(rollup_name(aggregate), since, end),
+                                     args.repetitions)
+            raw_duration, raw_rows = measure(session, RAW_QUERY.format(since, end, args.width), args.repetitions)
+            windows = {window["start"]: window for window in raw_rows[0]["windows"]}
+            if len(rows) != len(windows):
+                print(aggregate, "has", len(rows), "buckets, the raw history", len(windows), "windows")
+                mismatches += 1
+            for row in rows:
+                window = windows.get(row["start"])
+                if window is None or window["end"] != row["end"] or window["count"] != row["count"] or \
+                        not same_value(window[aggregate], row["value"]):
+                    print(aggregate, "mismatch at", row["start"], "rollup", row, "raw", window)
+                    mismatches += 1
+            results[aggregate] = {"rollup_duration": duration, "raw_duration": raw_duration, "buckets": len(rows)}
+            print(aggregate, results[aggregate])
+    driver.close()
+    results["mismatches"] = mismatches
+    with open(args.output, "w") as f:
+        json.dump(results, f, indent=2)
+    if mismatches:
+        sys.exit(1)
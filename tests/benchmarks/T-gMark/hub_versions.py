@@ -0,0 +1,64 @@
+import argparse
+import json
+import sys
+import time
+from neo4j import GraphDatabase
+
+# Reads all versions of the highest degree vertices in a TT FROM ... TO ...
+# window and reports the latency of the queries together with the memory
+# usage of the database, as reported by SHOW STORAGE INFO.
+HUBS_QUERY = "MATCH (n)-[e]-() RETURN id(n) AS id, count(e) AS degree ORDER BY degree DESC LIMIT $limit"
+VERSIONS_QUERY = "MATCH (n) WHERE id(n) = $id TT FROM {} TO {} RETURN n"
+EXPAND_QUERY = "MATCH (n)-[e]-(m) WHERE id(n) = $id TT FROM {} TO {} RETURN count(m) AS neighbours"
+
+
+def memory_usage(session):
+    info = {row["storage info"]: row["value"] for row in session.run("SHOW STORAGE INFO").data()}
+    return info["memory_usage"]
+
+
+def measure(session, query, parameters):
+    start = time.time()
+    rows = session.run(query, parameters).data()
+    return time.time() - start, len(rows)
+
+
+if __name__ == "__main__":
+    # Parse options.
+    parser = argparse.ArgumentParser(
+        description="AeonG memory and latency of reading the versions of T-gMark hub vertices.",
+        formatter_class=argparse.ArgumentDefaultsHelpFormatter)
+    parser.add_argument("--port", type=int,
+                        default=7687,
+                        help="port of the database")
+    parser.add_argument("--hubs", type=int,
+                        default=10,
+                        help="number of the highest degree vertices which are read")
+    parser.add_argument("--min-time", type=int,
+                        default=0,
+                        help="start of the TT window")
+    parser.add_argument("--max-time", type=int,
+                        default=sys.maxsize,
+                        help="end of the TT window")
+    parser.add_argument("--output",
+                        default="hub_versions.json",
+                        help="Filename to store the measurements")
+
+    args = parser.parse_args()
+    driver = GraphDatabase.driver("bolt://127.0.0.1:{}".format(args.port), auth=None, encrypted=False)
+    results = []
+    with driver.session() as session:
+        hubs = session.run(HUBS_QUERY, {"limit": args.hubs}).data()
+        for hub in hubs:
+            before = memory_usage(session)
+            versions_time, versions = measure(session, VERSIONS_QUERY.format(args.min_time, args.max_time),
+                                              {"id": hub["id"]})
+            expand_time, _ = measure(session, EXPAND_QUERY.format(args.min_time, args.max_time), {"id": hub["id"]})
+            result = {"id": hub["id"], "degree": hub["degree"], "versions": versions,
+                      "versions_duration": versions_time, "expand_duration": expand_time,
+                      "memory_delta": memory_usage(session) - before}
+            results.append(result)
+            print(result)
+    driver.close()
+    with open(args.output, "w") as f:
+        json.dump(results, f, indent=2)
@@ -0,0 +1,132 @@
+import argparse
+import csv
+import json
+import os
+import random
+import shutil
+import sys
+import tempfile
+import time
+sys.path.append('../../mgbench')
+import helpers
+import runners
+from neo4j import GraphDatabase
+
+# Replays the same read and update mix on hot, warm and cold users of an
+# imported T-mgBench database, once with the fixed anchor interval and once
+# with --adaptive-anchor. Every user is read before it is updated, so the
+# adaptive policy sees its reads, and is updated as often as the update count
+# file of its class says, up to --max-updates. The reads which follow rebuild
+# all versions of the user, their latency and the anchors placed for the users
+# of every class are reported for both policies.
+CLASSES = ["hot", "warm", "cold"]
+READ_QUERY = "MATCH (r:User {{id: {0}}}) TT FROM {1} TO {2} RETURN count(r) AS versions"
+UPDATE_QUERY = "MATCH (r:User {id: $id}) SET r.anchor_probe = $value"
+STATS_QUERY = ("MATCH (r:User) WHERE r.id IN $ids WITH anchorStats(r) AS stats "
+               "RETURN sum(stats.anchors) AS anchors, sum(stats.versions) AS versions, "
+               "avg(stats.interval) AS interval")
+
+
+def read_users(path, samples, max_updates):
+    # The first column holds the user id, the second one its update count.
+    with open(path) as f:
+        users = [(int(row[0]), min(int(row[1]), max_updates)) for row in csv.reader(f, delimiter=',')]
+    random.seed(42)
+    return random.sample(users, min(samples, len(users)))
+
+
+def read_versions(session, users, args):
+    durations = []
+    versions = 0
+    for user, _ in users:
+        start = time.time()
+        versions += session.run(READ_QUERY.format(user, args.min_time, args.max_time)).single()["versions"]
+        durations.append(time.time() - start)
+    return sum(durations) / len(durations), versions
+
+
+def run_policy(args, users, adaptive, directory):
+    aeong = runners.Memgraph(args.aeong_binary, directory, True, memgraph_port=args.port,
+                             snapshot_interval_sec=30, memory_limit=0, anchor_num=args.anchor_num,
+                             real_time_flag=False)
+    aeong.start_benchmark(adaptive_anchor=adaptive, max_anchor_num=args.max_anchor_num)
+    driver = GraphDatabase.driver("bolt://127.0.0.1:{}".format(args.port), auth=None, encrypted=False)
+    results = {}
+    with driver.session() as session:
+        for _ in range(args.reads):
+            for sampled in users.values():
+                read_versions(session, sampled, args)
+        for sampled in users.values():
+            for user, updates in sampled:
+                for value in range(updates):
+                    session.run(UPDATE_QUERY, id=user, value=value).consume()
+        session.run("FREE MEMORY").consume()
+        for name, sampled in users.items():
+            latencies = [read_versions(session, sampled, args) for _ in range(args.reads)]
+            stats = session.run(STATS_QUERY, ids=[user for user, _ in sampled]).single()
+            results[name] = {"read_latency": sum(latency for latency, _ in latencies) / len(latencies),
+                             "versions_read": latencies[-1][1], "anchors": stats["anchors"],
+                             "versions": stats["versions"], "average_interval": stats["interval"]}
+    driver.close()
+    aeong.stop()
+    return results
+
+
+if __name__ == "__main__":
+    # Parse options.
+    parser = argparse.ArgumentParser(
+        description="AeonG anchors and reconstruction latency of hot, warm and cold T-mgBench users with the fixed "
+                    "and the adaptive anchor policy.",
+        formatter_class=argparse.ArgumentDefaultsHelpFormatter)
+    parser.add_argument("--aeong-binary",
+                        default=helpers.get_binary_path("memgraph"),
+                        help="AeonG binary used for benchmarking")
+    parser.add_argument("--port", type=int,
+                        default=7687,
+                        help="port of the database")
+    parser.add_argument("--data-directory",
+                        default=helpers.get_binary_path("../tests/results/database"),
+                        help="directory path of the temporal database")
+    parser.add_argument("--update-count-prefix",
+                        required=True,
+                        help="path of the update count files written by create_graph_op_queries.py up to "
+                             "_hot.csv, _warm.csv and _cold.csv")
+    parser.add_argument("--samples", type=int,
+                        default=100,
+                        help="number of users sampled from every class")
+    parser.add_argument("--max-updates", type=int,
+                        default=100,
+                        help="upper bound on the updates of a sampled user")
+    parser.add_argument("--reads", type=int,
+                        default=3,
+                        help="reads of every sampled user before the updates, and measured reads after them")
+    parser.add_argument("--min-time", type=int,
+                        default=0,
+                        help="start of the TT window of the reads")
+    parser.add_argument("--max-time", type=int,
+                        default=10000000,
+                        help="end of the TT window of the reads, past the updates of the benchmark")
+    parser.add_argument("--anchor-num", type=int,
+                        default=11,
+                        help="fixed anchor interval, --anchor-num of AeonG")
+    parser.add_argument("--max-anchor-num", type=int,
+                        default=64,
+                        help="upper bound on the adaptive anchor interval, --max-anchor-num of AeonG")
+    parser.add_argument("--output",
+                        default="adaptive_anchor.json",
+                        help="Filename to store the measurements")
+
+    args = parser.parse_args()
+    users = {name: read_users("{}_{}.csv".format(args.update_count_prefix, name), args.samples, args.max_updates)
+             for name in CLASSES}
+    results = {}
+    for adaptive in [False, True]:
+        # Both policies start from a copy of the same database, so the updates
+        # of the first run aren't read by the second one.
+        name = "adaptive" if adaptive else "fixed"
+        with tempfile.TemporaryDirectory() as directory:
+            shutil.copytree(args.data_directory, os.path.join(directory, "database"))
+            results[name] = run_policy(args, users, adaptive, os.path.join(directory, "database"))
+        print(name, results[name])
+    with open(args.output, "w") as f:
+        json.dump(results, f, indent=2)
@@ -0,0 +1,71 @@
+import argparse
+import json
+import sys
+import time
+sys.path.append('../../mgbench')
+import helpers
+import runners
+from neo4j import GraphDatabase
+
+# Scans all users as of a timestamp, so that the history of every vertex is
+# looked up, and reports the scan throughput for every batch size and number
+# of scan threads of the temporal scan.
+SCAN_QUERY = "MATCH (n:User) TT AS {} RETURN count(n) AS versions"
+BATCH_SIZES = [1, 4, 16, 64, 256, 1024, 4096]
+
+
+def run_batch_size(args, batch_size, threads):
+    aeong = runners.Memgraph(args.aeong_binary, args.data_directory, True, memgraph_port=args.port,
+                             snapshot_interval_sec=30, memory_limit=0, anchor_num=10, real_time_flag=False)
+    aeong.start_benchmark(history_scan_batch_size=batch_size, history_scan_threads=threads)
+    driver = GraphDatabase.driver("bolt://127.0.0.1:{}".format(args.port), auth=None, encrypted=False)
+    durations = []
+    versions = 0
+    with driver.session() as session:
+        for timestamp in args.timestamps:
+            start = time.time()
+            versions = session.run(SCAN_QUERY.format(timestamp)).single()["versions"]
+            durations.append(time.time() - start)
+    driver.close()
+    aeong.stop()
+    duration = sum(durations) / len(durations)
+    return {"duration": duration, "versions": versions, "throughput": versions / duration if duration > 0 else 0}
+
+
+if __name__ == "__main__":
+    # Parse options.
+    parser = argparse.ArgumentParser(
+        description="AeonG throughput of temporal scans of T-mgBench by the batch size and the threads of the "
+                    "history lookups.",
+        formatter_class=argparse.ArgumentDefaultsHelpFormatter)
+    parser.add_argument("--aeong-binary",
+                        default=helpers.get_binary_path("memgraph"),
+                        help="AeonG binary used for benchmarking")
+    parser.add_argument("--port", type=int,
+                        default=7687,
+                        help="port of the database")
+    parser.add_argument("--data-directory",
+                        default=helpers.get_binary_path("../tests/results/database"),
+                        help="directory path of the temporal database")
+    parser.add_argument("--timestamps", type=int, nargs="+",
+                        required=True,
+                        help="timestamps the users are scanned at, the durations are averaged")
+    parser.add_argument("--batch-sizes", type=int, nargs="+",
+                        default=BATCH_SIZES,
+                        help="batch sizes of the temporal scan which are compared")
+    parser.add_argument("--scan-threads", type=int, nargs="+",
+                        default=[1],
+                        help="numbers of scan threads which are compared, with every batch size")
+    parser.add_argument("--output",
+                        default="scan_batch_size.json",
+                        help="Filename to store the measurements")
+
+    args = parser.parse_args()
+    results = {}
+    for threads in args.scan_threads:
+        for batch_size in args.batch_sizes:
+            name = "threads={},batch_size={}".format(threads, batch_size)
+            results[name] = run_batch_size(args, batch_size, threads)
+            print(name, results[name])
+    with open(args.output, "w") as f:
+        json.dump(results, f, indent=2)
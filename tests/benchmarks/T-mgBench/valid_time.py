@@ -0,0 +1,85 @@
+import argparse
+import json
+import sys
+import time
+sys.path.append('../../mgbench')
+import helpers
+import runners
+from neo4j import GraphDatabase
+
+# Gives every user a valid time derived from its id, then compares the VT
+# clause, which looks the users up in the valid time index, with the same
+# window read by a filter on the valid time properties.
+SETUP_QUERY = ("MATCH (n:User) SET n.vt_from = (id(n) * 7919) % $span, "
+               "n.vt_to = (id(n) * 7919) % $span + $length")
+VT_QUERY = "MATCH (n:User) VT AS {} RETURN count(n) AS users"
+FILTER_QUERY = ("MATCH (n:User) WHERE n.vt_from <= {0} AND (n.vt_to IS NULL OR n.vt_to > {0}) "
+                "RETURN count(n) AS users")
+BITEMPORAL_QUERY = "MATCH (n:User) TT AS {} VT AS {} RETURN count(n) AS users"
+
+
+def measure(session, query, repetitions):
+    durations = []
+    users = 0
+    for _ in range(repetitions):
+        start = time.time()
+        users = session.run(query).single()["users"]
+        durations.append(time.time() - start)
+    return {"duration": sum(durations) / len(durations), "users": users}
+
+
+if __name__ == "__main__":
+    # Parse options.
+    parser = argparse.ArgumentParser(
+        description="AeonG latency of valid time queries of T-mgBench, answered by the valid time index and by a "
+                    "filter on the valid time properties.",
+        formatter_class=argparse.ArgumentDefaultsHelpFormatter)
+    parser.add_argument("--aeong-binary",
+                        default=helpers.get_binary_path("memgraph"),
+                        help="AeonG binary used for benchmarking")
+    parser.add_argument("--port", type=int,
+                        default=7687,
+                        help="port of the database")
+    parser.add_argument("--data-directory",
+                        default=helpers.get_binary_path("../tests/results/database"),
+                        help="directory path of the temporal database")
+    parser.add_argument("--span", type=int,
+                        default=1000000,
+                        help="valid times of the users start in [0, span)")
+    parser.add_argument("--length", type=int,
+                        default=1000,
+                        help="length of the valid time of every user")
+    parser.add_argument("--valid-times", type=int, nargs="+",
+                        required=True,
+                        help="valid times the users are matched at")
+    parser.add_argument("--timestamp", type=int,
+                        help="transaction timestamp of the bitemporal queries, after the setup")
+    parser.add_argument("--repetitions", type=int,
+                        default=5,
+                        help="the durations of every query are averaged over the repetitions")
+    parser.add_argument("--output",
+                        default="valid_time.json",
+                        help="Filename to store the measurements")
+
+    args = parser.parse_args()
+    aeong = runners.Memgraph(args.aeong_binary, args.data_directory, True, memgraph_port=args.port,
+                             snapshot_interval_sec=30, memory_limit=0, anchor_num=10, real_time_flag=False)
+    aeong.start_benchmark()
+    driver = GraphDatabase.driver("bolt://127.0.0.1:{}".format(args.port), auth=None, encrypted=False)
+    results = {}
+    with driver.session() as session:
+        session.run(SETUP_QUERY, span=args.span, length=args.length).consume()
+        for valid_time in args.valid_times:
+            result = {
+                "vt": measure(session, VT_QUERY.format(valid_time), args.repetitions),
+                "filter": measure(session, FILTER_QUERY.format(valid_time), args.repetitions),
+            }
+            if args.timestamp is not None:
+                result["bitemporal"] = measure(session, BITEMPORAL_QUERY.format(args.timestamp, valid_time),
+                                               args.repetitions)
+            results["vt={}".format(valid_time)] = result
+            print(valid_time, result)
+    driver.close()
+    aeong.stop()
+    with open(args.output, "w") as f:
+        json.dump(results, f, indent=2)
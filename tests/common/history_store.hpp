@@ -0,0 +1,87 @@
+// Copyright 2021 Memgraph Ltd.
+//
+// Use of this software is governed by the Business Source License
+// included in the file licenses/BSL.txt; by using this file, you agree to be bound by the terms of the Business Source
+// License, and you may not use this file except in compliance with the Business Source License.
+//
+// As of the Change Date specified in that file, in accordance with
+// the Business Source License, use of this software will be governed
+// by the Apache License, Version 2.0, included in the file
+// licenses/APL.txt.
+
+#pragma once
+
+#include <atomic>
+#include <filesystem>
+#include <optional>
+#include <string>
+
+#include "storage/v2/delta.hpp"
+#include "storage/v2/history_delta.hpp"
+#include "storage/v2/name_id_mapper.hpp"
+
+namespace test {
+
+/// The history store configuration of the tests and benchmarks. The records
+/// are encoded and written by the thread which hands them over, so they are
+/// stored once `SaveDeltaAll` returns.
+inline storage::Config::History SynchronousHistoryConfig() {
+  storage::Config::History config;
+  config.migration_threads = 0;
+  return config;
+}
+
+/// A history store in its own temporary directory, which is emptied when the
+/// store is opened and removed with it.
+class HistoryStore {
+ public:
+  explicit HistoryStore(const std::string &name, const storage::Config::History &config = SynchronousHistoryConfig())
+      : directory_(std::filesystem::temp_directory_path() / name), config_(config) {
+    std::filesystem::remove_all(directory_);
+    Reopen();
+  }
+
+  HistoryStore(const HistoryStore &) = delete;
+  HistoryStore &operator=(const HistoryStore &) = delete;
+
+  ~HistoryStore() {
+    history_.reset();
+    std::filesystem::remove_all(directory_);
+  }
+
+  /// Closes the store and opens it again, so everything is read back from
+  /// the directory.
+  void Reopen() {
+    history_.reset();
+    history_.emplace(directory_.string(), &name_id_mapper_, config_);
+  }
+
+  history_delta::History_delta &operator*() { return *history_; }
+  history_delta::History_delta *operator->() { return &*history_; }
+
+  storage::NameIdMapper &NameIdMapper() { return name_id_mapper_; }
+
+  storage::PropertyId Property(const std::string &name) {
+    return storage::PropertyId::FromUint(name_id_mapper_.NameToId(name));
+  }
+
+  storage::LabelId Label(const std::string &name) { return storage::LabelId::FromUint(name_id_mapper_.NameToId(name)); }
+
+  /// Saves the record of a vertex version [start, end) which set the
+  /// property, like the GC does when it unlinks the delta. The records are
+  /// written by the next `SaveDeltaAll`.
+  void SaveProperty(uint64_t gid, uint64_t start, uint64_t end, storage::PropertyId property,
+                    const storage::PropertyValue &value) {
+    storage::Delta delta(storage::Delta::SetPropertyTag(), property, value, &timestamp_, 0);
+    history_->SaveDelta(storage::Gid::FromUint(gid), std::nullopt, start, end, delta, name_id_mapper_);
+  }
+
+ private:
+  std::filesystem::path directory_;
+  storage::Config::History config_;
+  storage::NameIdMapper name_id_mapper_;
+  std::atomic<uint64_t> timestamp_{0};
+  std::optional<history_delta::History_delta> history_;
+};
+
+}  // namespace test
@@ -135,6 +135,15 @@ class Pokec(Dataset):
             vertex_to = self._get_random_vertex()
         return (vertex_from, vertex_to)
 
+    def _get_random_timestamp(self):
+        # The setup script commits roughly one transaction per vertex and
+        # edge, so the commit timestamps of the dataset fall in this range.
+        return random.randint(1, self._num_vertices + self._num_edges)
+
+    def _get_random_window(self):
+        return tuple(sorted((self._get_random_timestamp(),
+                             self._get_random_timestamp())))
+
     # Arango benchmarks
 
     def benchmark__arango__single_vertex_read(self):
@@ -289,3 +298,22 @@ class Pokec(Dataset):
     def benchmark__match__vertex_on_property(self):
         return ("MATCH (n {id: $id}) RETURN n",
                 {"id": self._get_random_vertex()})
+
+    # Temporal benchmarks, every query reads a different window through the
+    # same cached plan, so their planning time should be close to zero.
+
+    def benchmark__temporal__vertex_as_of(self):
+        return ("MATCH (n:User {id: $id}) TT AS $t RETURN n",
+                {"id": self._get_random_vertex(),
+                 "t": self._get_random_timestamp()})
+
+    def benchmark__temporal__vertex_from_to(self):
+        ts, te = self._get_random_window()
+        return ("MATCH (n:User {id: $id}) TT FROM $ts TO $te RETURN n",
+                {"id": self._get_random_vertex(), "ts": ts, "te": te})
+
+    def benchmark__temporal__expansion_1_as_of(self):
+        return ("MATCH (s:User {id: $id})-->(n:User) TT AS $t "
+                "RETURN n.id",
+                {"id": self._get_random_vertex(),
+                 "t": self._get_random_timestamp()})
@@ -123,19 +123,20 @@ class Memgraph:
         else:
             self._start(snapshot_on_exit=True)
 
-    def start_benchmark(self):
+    def start_benchmark(self, **kwargs):
         # TODO: support custom benchmarking config files!
+        # `kwargs` are passed to the database as additional flags.
         if self._memgraph_version >= (0, 50, 0):
             if self._query_modules_directory != "":
                 self._start(storage_recover_on_startup=True, bolt_port=self._port, storage_properties_on_edges="true",
                             query_modules_directory=self._query_modules_directory, memory_limit=self._memory_limit,
                             anchor_num=self._anchor_num, storage_gc_cycle_sec=self._storage_gc_cycle_sec,
-                            real_time_flag=self._real_time_flag)
+                            real_time_flag=self._real_time_flag, **kwargs)
             else:
                 self._start(storage_recover_on_startup=True, bolt_port=self._port, storage_properties_on_edges="true",
                             memory_limit=self._memory_limit, anchor_num=self._anchor_num,
                             storage_gc_cycle_sec=self._storage_gc_cycle_sec,
-                            real_time_flag=self._real_time_flag)  # memory_limit=self._memory_limit
+                            real_time_flag=self._real_time_flag, **kwargs)  # memory_limit=self._memory_limit
 
         else:
             self._start(db_recover_on_startup=True)
@@ -0,0 +1,206 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+
+# Copyright 2021 Memgraph Ltd.
+#
+# Use of this software is governed by the Business Source License
+# included in the file licenses/BSL.txt; by using this file, you agree to be bound by the terms of the Business Source
+# License, and you may not use this file except in compliance with the Business Source License.
+#
+# As of the Change Date specified in that file, in accordance with
+# the Business Source License, use of this software will be governed
+# by the Apache License, Version 2.0, included in the file
+# licenses/APL.txt.
+
+'''
+Concurrent temporal query stress test.
+
+Every vertex is updated a number of times and the commit timestamp of each of
+its versions is recorded. Concurrent clients then mix TT AS, TT FROM TO and
+non-temporal queries over the same plans and check that each query sees the
+versions of its own window.
+'''
+
+import atexit
+import bisect
+import logging
+import multiprocessing
+import random
+import time
+
+from common import connection_argument_parser, assert_equal, \
+                   OutputData, execute_till_success, SessionCache
+
+
+def parse_args():
+    '''
+    Parses user arguments
+
+    :return: parsed arguments
+    '''
+    parser = connection_argument_parser()
+    parser.add_argument('--worker-count', type=int,
+                        default=multiprocessing.cpu_count(),
+                        help='Number of concurrent workers.')
+    parser.add_argument("--logging", default="INFO",
+                        choices=["INFO", "DEBUG", "WARNING", "ERROR"],
+                        help="Logging level")
+    parser.add_argument('--vertex-count', type=int, default=100,
+                        help='Number of updated vertices.')
+    parser.add_argument('--update-count', type=int, default=20,
+                        help='Number of updates of every vertex.')
+    parser.add_argument('--query-count', type=int, default=10000,
+                        help='Number of queries run by all workers.')
+    return parser.parse_args()
+
+
+log = logging.getLogger(__name__)
+args = parse_args()
+output_data = OutputData()
+
+
+atexit.register(SessionCache.cleanup)
+
+
+def version_start(session, vertex_id):
+    '''
+    :return: commit timestamp of the current version of the vertex
+    '''
+    data = session.run('MATCH (n:Temporal {id: %d}) RETURN n' %
+                       vertex_id).data()
+    return data[0]['n']['transaction_ts']
+
+
+def update_worker(vertex_id):
+    '''
+    Updates the vertex and records the start of each of its versions.
+
+    :return: tuple (vertex_id, list of version starts, number of failures)
+    '''
+    session = SessionCache.argument_session(args)
+    no_failures = 0
+    starts = [version_start(session, vertex_id)]
+    for version in range(1, args.update_count + 1):
+        no_failures += execute_till_success(
+            session, 'MATCH (n:Temporal {id: %d}) SET n.version = %d' %
+            (vertex_id, version))[1]
+        starts.append(version_start(session, vertex_id))
+    return vertex_id, starts, no_failures
+
+
+def expected_as_of(starts, ts):
+    '''
+    :return: versions visible as of `ts`, version `i` is valid in
+             [starts[i], starts[i + 1])
+    '''
+    return [bisect.bisect_right(starts, ts) - 1]
+
+
+def expected_from_to(starts, ts, te):
+    '''
+    :return: versions which overlap the window from `ts` to `te`
+    '''
+    ends = starts[1:] + [float('inf')]
+    return [version for version, (start, end) in enumerate(zip(starts, ends))
+            if start < te and end > ts]
+
+
+def query_worker(worker_args):
+    '''
+    Runs a random mix of temporal and non-temporal queries. All queries of the
+    same kind share a cached plan, so a window leaking from one session to
+    another shows up as a wrong set of versions.
+
+    :return: tuple (worker_id, number of queries per kind)
+    '''
+    worker_id, timelines, query_count = worker_args
+    session = SessionCache.argument_session(args)
+    counts = {"as of": 0, "from to": 0, "current": 0}
+    match = 'MATCH (n:Temporal {id: %d}) '
+    for _ in range(query_count):
+        vertex_id = random.randrange(len(timelines))
+        starts = timelines[vertex_id]
+        kind = random.choice(list(counts))
+        if kind == "as of":
+            ts = random.randint(starts[0], starts[-1] + 1)
+            query = match % vertex_id + 'TT AS %d RETURN n.version AS version' % ts
+            expected = expected_as_of(starts, ts)
+        elif kind == "from to":
+            # Bounds at a version start are left out, the window is open
+            # there and either result would be right.
+            ts, te = sorted(random.sample(range(starts[0], starts[-1] + 2), 2))
+            if ts in starts or te in starts:
+                continue
+            query = match % vertex_id + \
+                'TT FROM %d TO %d RETURN n.version AS version' % (ts, te)
+            expected = expected_from_to(starts, ts, te)
+        else:
+            query = match % vertex_id + 'RETURN n.version AS version'
+            expected = [len(starts) - 1]
+        actual = sorted(row['version']
+                        for row in session.run(query).data())
+        assert_equal(expected, actual,
+                     "Query '%s' returned wrong versions! " % query +
+                     "Expected: %s Actual: %s")
+        counts[kind] += 1
+    return worker_id, counts
+
+
+def execution_handler():
+    '''
+    Initializes client processes, database and starts the execution.
+    '''
+    session = SessionCache.argument_session(args)
+    start_time = time.time()
+
+    # clean existing database
+    session.run('MATCH (n) DETACH DELETE n').consume()
+    session.run('CREATE INDEX ON :Temporal(id)').consume()
+    session.run('UNWIND range(0, %d) AS id '
+                'CREATE (:Temporal {id: id, version: 0})' %
+                (args.vertex_count - 1)).consume()
+    setup_end_time = time.time()
+    output_data.add_measurement("setup_time", setup_end_time - start_time)
+    log.info("All vertices created.")
+
+    with multiprocessing.Pool(args.worker_count) as p:
+        timelines = [None] * args.vertex_count
+        for vertex_id, starts, no_failures in \
+                p.map(update_worker, range(args.vertex_count)):
+            log.debug('Vertex ID: %s; Version starts: %s Failures: %s' %
+                      (vertex_id, starts, no_failures))
+            timelines[vertex_id] = starts
+        update_end_time = time.time()
+        output_data.add_measurement("update_time",
+                                    update_end_time - setup_end_time)
+        log.info("All vertices updated.")
+
+        query_count = args.query_count // args.worker_count + 1
+        totals = {}
+        for worker_id, counts in \
+                p.map(query_worker, [(i, timelines, query_count)
+                                     for i in range(args.worker_count)]):
+            log.info('Worker ID: %s; Queries: %s' % (worker_id, counts))
+            for kind, count in counts.items():
+                totals[kind] = totals.get(kind, 0) + count
+        query_end_time = time.time()
+        output_data.add_measurement("query_time",
+                                    query_end_time - update_end_time)
+        for kind, count in totals.items():
+            output_data.add_status("%s_queries" % kind.replace(" ", "_"),
+                                   count)
+
+    output_data.add_measurement("total_execution_time",
+                                time.time() - start_time)
+
+
+if __name__ == '__main__':
+    logging.basicConfig(level=args.logging)
+    if args.logging != "DEBUG":
+        logging.getLogger("neo4j").setLevel(logging.WARNING)
+    output_data.add_status("stress_test_name", "temporal")
+    output_data.add_status("number_of_vertices", args.vertex_count)
+    output_data.add_status("number_of_updates", args.update_count)
+    execution_handler()
+    if args.logging in ["DEBUG", "INFO"]:
+        output_data.dump()
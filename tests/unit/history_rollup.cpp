@@ -0,0 +1,202 @@
+// Copyright 2021 Memgraph Ltd.
+//
+// Use of this software is governed by the Business Source License
+// included in the file licenses/BSL.txt; by using this file, you agree to be bound by the terms of the Business Source
+// License, and you may not use this file except in compliance with the Business Source License.
+//
+// As of the Change Date specified in that file, in accordance with
+// the Business Source License, use of this software will be governed
+// by the Apache License, Version 2.0, included in the file
+// licenses/APL.txt.
+
+#include <algorithm>
+#include <limits>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "common/history_store.hpp"
+
+// A version of a vertex as the GC hands it to `SaveVertexVersion`.
+struct Version {
+  uint64_t gid;
+  uint64_t start;
+  uint64_t commit;
+  bool has_label;
+  storage::PropertyValue value;
+};
+
+// Migrates vertex versions like the GC does and checks every bucket of the
+// rollups against the buckets computed by replaying the same versions.
+class HistoryRollup : public ::testing::Test {
+ protected:
+  void CreateRollups(uint64_t width, uint64_t since) {
+    for (auto aggregate : kAggregates) {
+      ASSERT_TRUE(history_->CreateRollup(history_delta::TemporalRollup{
+          Name(aggregate), label_, property_, aggregate, width, since}));
+    }
+  }
+
+  // Saves the versions as one GC cycle, with the records of their deltas.
+  void Migrate(const std::vector<Version> &versions) {
+    for (const auto &version : versions) {
+      history_.SaveProperty(version.gid, version.start, version.commit, property_, version.value);
+      std::vector<storage::LabelId> labels;
+      if (version.has_label) labels.push_back(label_);
+      history_->SaveVertexVersion(storage::Gid::FromUint(version.gid), version.start, version.commit, labels,
+                                  {{property_, version.value}});
+      versions_.push_back(version);
+    }
+    history_->SaveDeltaAll();
+    history_->WaitForMigration();
+  }
+
+  // The non-empty buckets overlapping [c_ts, c_te], from the migrated
+  // versions.
+  std::map<uint64_t, history_delta::RollupBucket> Replay(uint64_t width, uint64_t since, uint64_t c_ts,
+                                                         uint64_t c_te) const {
+    std::map<uint64_t, history_delta::RollupBucket> buckets;
+    for (const auto &version : versions_) {
+      if (!version.has_label) continue;
+      auto from = std::max(version.start, since);
+      if (from >= version.commit) continue;
+      // Only the buckets in the window are replayed, the versions may span
+      // far more.
+      if (c_ts > from) from = c_ts;
+      for (auto start = since + (from - since) / width * width; start < version.commit && start <= c_te;
+           start += width) {
+        auto &bucket = buckets.try_emplace(start, history_delta::RollupBucket{start, start + width}).first->second;
+        auto number = [](const storage::PropertyValue &value) {
+          return value.IsInt() ? static_cast<double>(value.ValueInt()) : value.ValueDouble();
+        };
+        if (bucket.count++ == 0) {
+          bucket.sum = bucket.min = bucket.max = version.value;
+          continue;
+        }
+        if (bucket.sum.IsInt() && version.value.IsInt()) {
+          bucket.sum = storage::PropertyValue(bucket.sum.ValueInt() + version.value.ValueInt());
+        } else {
+          bucket.sum = storage::PropertyValue(number(bucket.sum) + number(version.value));
+        }
+        if (number(version.value) < number(bucket.min)) bucket.min = version.value;
+        if (number(version.value) > number(bucket.max)) bucket.max = version.value;
+      }
+    }
+    return buckets;
+  }
+
+  void ExpectReplay(uint64_t width, uint64_t since, uint64_t c_ts, uint64_t c_te) {
+    auto expected = Replay(width, since, c_ts, c_te);
+    for (auto aggregate : kAggregates) {
+      auto buckets = history_->GetRollupBuckets(Name(aggregate), c_ts, c_te);
+      ASSERT_TRUE(buckets);
+      ASSERT_EQ(buckets->size(), expected.size()) << Name(aggregate);
+      for (const auto &bucket : *buckets) {
+        auto found = expected.find(bucket.start);
+        ASSERT_NE(found, expected.end()) << Name(aggregate) << " " << bucket.start;
+        EXPECT_EQ(bucket.end, found->second.end);
+        EXPECT_EQ(bucket.count, found->second.count);
+        auto value = bucket.Value(aggregate);
+        auto expected_value = found->second.Value(aggregate);
+        if (value.IsDouble() || expected_value.IsDouble()) {
+          ASSERT_TRUE(value.IsDouble() && expected_value.IsDouble()) << Name(aggregate) << " " << bucket.start;
+          EXPECT_DOUBLE_EQ(value.ValueDouble(), expected_value.ValueDouble())
+              << Name(aggregate) << " " << bucket.start;
+        } else {
+          EXPECT_EQ(value, expected_value) << Name(aggregate) << " " << bucket.start;
+        }
+      }
+    }
+  }
+
+  static std::string Name(history_delta::TemporalRollup::Aggregate aggregate) {
+    return "score_" + std::to_string(static_cast<int>(aggregate));
+  }
+
+  static constexpr history_delta::TemporalRollup::Aggregate kAggregates[] = {
+      history_delta::TemporalRollup::Aggregate::COUNT, history_delta::TemporalRollup::Aggregate::SUM,
+      history_delta::TemporalRollup::Aggregate::MIN, history_delta::TemporalRollup::Aggregate::MAX,
+      history_delta::TemporalRollup::Aggregate::AVG};
+
+  test::HistoryStore history_{"MG_test_unit_history_rollup"};
+  storage::LabelId label_{history_.Label("Person")};
+  storage::PropertyId property_{history_.Property("score")};
+  std::vector<Version> versions_;
+};
+
+TEST_F(HistoryRollup, MatchesReplay) {
+  const uint64_t width = 10;
+  const uint64_t since = 25;
+  CreateRollups(width, since);
+  std::mt19937_64 gen(42);
+  std::uniform_int_distribution<uint64_t> lengths(1, 35);
+  std::uniform_int_distribution<int64_t> values(-1000, 1000);
+  // Every cycle ends the current version of each vertex, the versions before
+  // `since` and the ones without the label mustn't be counted.
+  std::vector<uint64_t> starts(8, 1);
+  for (int cycle = 0; cycle < 20; ++cycle) {
+    std::vector<Version> versions;
+    for (uint64_t gid = 0; gid < starts.size(); ++gid) {
+      auto commit = starts[gid] + lengths(gen);
+      // Integers only in the first cycles, so the sums turn into doubles
+      // later on.
+      auto value = cycle < 10 || gid % 2 ? storage::PropertyValue(values(gen))
+                                         : storage::PropertyValue(values(gen) / 4.0);
+      versions.push_back(Version{gid, starts[gid], commit, gid % 4 != 3, value});
+      starts[gid] = commit;
+    }
+    Migrate(versions);
+    ExpectReplay(width, since, 0, std::numeric_limits<uint64_t>::max());
+  }
+  ExpectReplay(width, since, 100, 200);
+  ExpectReplay(width, since, 104, 104);
+  ExpectReplay(width, since, 0, since - 1);
+
+  // The buckets are read back from the history store.
+  history_.Reopen();
+  ExpectReplay(width, since, 0, std::numeric_limits<uint64_t>::max());
+  Migrate({Version{0, starts[0], starts[0] + 50, true, storage::PropertyValue(7)}});
+  ExpectReplay(width, since, 0, std::numeric_limits<uint64_t>::max());
+}
+
+TEST_F(HistoryRollup, UpdatesEvictedBuckets) {
+  const uint64_t width = 1;
+  const uint64_t since = 0;
+  CreateRollups(width, since);
+  // More single bucket versions than buckets are cached, the oldest ones are
+  // updated from the history store.
+  std::vector<Version> versions;
+  for (uint64_t start = 0; start < 10000; start += 2) {
+    versions.push_back(Version{0, start, start + 1, true, storage::PropertyValue(3)});
+  }
+  Migrate(versions);
+  Migrate({Version{1, 0, 20, true, storage::PropertyValue(5)},
+           Version{2, 9990, 10010, true, storage::PropertyValue(1.5)}});
+  Migrate({Version{1, 20, 40, true, storage::PropertyValue(-2)}});
+  ExpectReplay(width, since, 0, 20000);
+  ExpectReplay(width, since, 9995, 10005);
+}
+
+TEST_F(HistoryRollup, LongVersions) {
+  const uint64_t width = 1;
+  const uint64_t since = 5;
+  CreateRollups(width, since);
+  // A version updates at most two nodes per level of the buckets it covers,
+  // which are combined when the buckets are read.
+  Migrate({Version{0, 0, 1000000000000, true, storage::PropertyValue(4)},
+           Version{1, 123456789, 987654321, true, storage::PropertyValue(-1)}});
+  Migrate({Version{2, 500000000, 500000100, true, storage::PropertyValue(2.5)},
+           Version{0, 1000000000000, 1000000000010, true, storage::PropertyValue(7)}});
+  ExpectReplay(width, since, 0, 100);
+  ExpectReplay(width, since, 123456700, 123456800);
+  ExpectReplay(width, since, 499999950, 500000150);
+  ExpectReplay(width, since, 987654300, 987654400);
+  ExpectReplay(width, since, 999999999950, std::numeric_limits<uint64_t>::max());
+
+  history_.Reopen();
+  ExpectReplay(width, since, 499999950, 500000150);
+  ExpectReplay(width, since, 999999999950, std::numeric_limits<uint64_t>::max());
+}
@@ -0,0 +1,129 @@
+// Copyright 2021 Memgraph Ltd.
+//
+// Use of this software is governed by the Business Source License
+// included in the file licenses/BSL.txt; by using this file, you agree to be bound by the terms of the Business Source
+// License, and you may not use this file except in compliance with the Business Source License.
+//
+// As of the Change Date specified in that file, in accordance with
+// the Business Source License, use of this software will be governed
+// by the Apache License, Version 2.0, included in the file
+// licenses/APL.txt.
+
+#include <cstdint>
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include "storage/v2/history_cache.hpp"
+#include "utils/cache.hpp"
+
+using storage::HistoryVersionKey;
+
+// Places the versions of object `gid` in shard `gid % shards`, like the
+// history cache keeps all versions of an object in one shard.
+struct ShardOfGid {
+  size_t operator()(const HistoryVersionKey &key) const { return key.gid; }
+};
+
+using VersionCache = utils::ShardedLruCache<HistoryVersionKey, std::string, ShardOfGid>;
+
+TEST(ShardedLruCache, EvictsPerShardByBytes) {
+  // Two shards of 100 bytes each.
+  VersionCache cache(2, 200);
+  EXPECT_EQ(cache.Insert({0, 1}, "a", 40), 0U);
+  EXPECT_EQ(cache.Insert({0, 2}, "b", 40), 0U);
+  EXPECT_EQ(cache.Insert({1, 1}, "c", 40), 0U);
+  EXPECT_EQ(cache.Insert({1, 2}, "d", 40), 0U);
+  EXPECT_EQ(cache.GetStats().bytes, 160U);
+
+  // The oldest version of the full shard goes, the other shard keeps its own.
+  EXPECT_EQ(cache.Insert({0, 3}, "e", 40), 1U);
+  EXPECT_FALSE(cache.Find({0, 1}));
+  EXPECT_EQ(cache.Find({0, 2}), "b");
+  EXPECT_EQ(cache.Find({1, 1}), "c");
+  EXPECT_EQ(cache.Find({1, 2}), "d");
+  EXPECT_EQ(cache.GetStats().bytes, 160U);
+
+  // A lookup makes a version the most recently used one of its shard, so the
+  // version inserted after it goes first.
+  EXPECT_EQ(cache.Find({0, 2}), "b");
+  EXPECT_EQ(cache.Insert({0, 4}, "f", 60), 1U);
+  EXPECT_FALSE(cache.Find({0, 3}));
+  EXPECT_EQ(cache.Find({0, 2}), "b");
+  EXPECT_EQ(cache.Find({0, 4}), "f");
+
+  // Replacing a version accounts only its new size.
+  EXPECT_EQ(cache.Insert({1, 1}, "g", 20), 0U);
+  EXPECT_EQ(cache.Find({1, 1}), "g");
+  EXPECT_EQ(cache.GetStats().bytes, 100U + 60U);
+
+  // A version larger than a shard's share isn't cached.
+  EXPECT_EQ(cache.Insert({1, 3}, "h", 101), 0U);
+  EXPECT_FALSE(cache.Find({1, 3}));
+  EXPECT_EQ(cache.Find({1, 2}), "d");
+
+  EXPECT_EQ(cache.GetStats().evictions, 2U);
+  cache.Clear();
+  EXPECT_EQ(cache.GetStats().bytes, 0U);
+  EXPECT_FALSE(cache.Find({1, 2}));
+}
+
+TEST(ShardedLruCache, FindFloor) {
+  VersionCache cache(4, 4000);
+  cache.Insert({1, 10}, "10", 1);
+  cache.Insert({1, 20}, "20", 1);
+  cache.Insert({2, 5}, "other", 1);
+
+  // At a cached key.
+  auto at = cache.FindFloor({1, 10});
+  ASSERT_TRUE(at);
+  EXPECT_EQ(at->first, (HistoryVersionKey{1, 10}));
+  EXPECT_EQ(at->second, "10");
+
+  // Between two keys, and after the last one.
+  auto between = cache.FindFloor({1, 15});
+  ASSERT_TRUE(between);
+  EXPECT_EQ(between->first, (HistoryVersionKey{1, 10}));
+  auto after = cache.FindFloor({1, 1000});
+  ASSERT_TRUE(after);
+  EXPECT_EQ(after->first, (HistoryVersionKey{1, 20}));
+  EXPECT_EQ(after->second, "20");
+
+  // Before the first version of the object, whose shard holds no smaller
+  // key.
+  EXPECT_FALSE(cache.FindFloor({1, 9}));
+
+  // The floor stays within the shard, versions of other objects in it are
+  // returned and have to be checked by the caller.
+  cache.Insert({5, 30}, "shard 1", 1);
+  auto other_object = cache.FindFloor({5, 3});
+  ASSERT_TRUE(other_object);
+  EXPECT_EQ(other_object->first, (HistoryVersionKey{1, 20}));
+
+  // An evicted version isn't found as a floor.
+  VersionCache small(1, 2);
+  small.Insert({1, 10}, "10", 1);
+  small.Insert({1, 20}, "20", 1);
+  small.Insert({1, 30}, "30", 1);
+  EXPECT_FALSE(small.FindFloor({1, 15}));
+  auto remaining = small.FindFloor({1, 25});
+  ASSERT_TRUE(remaining);
+  EXPECT_EQ(remaining->second, "20");
+}
+
+TEST(ShardedLruCache, Stats) {
+  VersionCache cache(2, 200);
+  EXPECT_EQ(cache.GetStats().hits, 0U);
+  EXPECT_EQ(cache.GetStats().misses, 0U);
+  cache.Insert({0, 1}, "a", 10);
+  EXPECT_TRUE(cache.Find({0, 1}));
+  EXPECT_FALSE(cache.Find({0, 2}));
+  EXPECT_TRUE(cache.FindFloor({0, 5}));
+  EXPECT_FALSE(cache.FindFloor({1, 5}));
+  EXPECT_FALSE(cache.FindFloor({0, 0}));
+  auto stats = cache.GetStats();
+  EXPECT_EQ(stats.hits, 2U);
+  EXPECT_EQ(stats.misses, 3U);
+  EXPECT_EQ(stats.evictions, 0U);
+  EXPECT_EQ(stats.bytes, 10U);
+}